@@ -2,7 +2,17 @@
 #include "mozilla/Try.h"
 #include "builtin.h"
 
+#include "js/ArrayBuffer.h"
+#include "js/experimental/TypedData.h"
+
+#include <algorithm>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 DEF_ERR(InvalidCharacterError, JSEXN_RANGEERR, "String contains an invalid character", 0)
+DEF_ERR(InvalidEncodingError, JSEXN_SYNTAXERR, "{0}: String is not valid {1}", 2)
 
 
 
@@ -112,91 +122,15 @@ const char base64EncodeTable[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
                       "abcdefghijklmnopqrstuvwxyz"
                       "0123456789+/";
 
+const char base64URLEncodeTable[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                      "abcdefghijklmnopqrstuvwxyz"
+                      "0123456789-_";
+
 // clang-format on
 
-bool base64CharacterToValue(char character, uint8_t *value, const uint8_t *decodeTable) {
-  static const size_t mask = 127;
-  auto index = static_cast<uint8_t>(character);
-
-  if ((index & ~mask) != 0U) {
-    return false;
-  }
-  *value = decodeTable[index & mask];
-
-  return *value != 255;
-}
-
-inline JS::Result<mozilla::Ok> base64Decode4to3(std::string_view input, std::string &output,
-                                                const uint8_t *decodeTable) {
-  uint8_t w = 0;
-  uint8_t x = 0;
-  uint8_t y = 0;
-  uint8_t z = 0;
-  // 8.1 Find the code point pointed to by position in the second column of
-  // Table 1: The Base 64 Alphabet of RFC 4648. Let n be the number given in the
-  // first cell of the same row. [RFC4648]
-  if (!base64CharacterToValue(input[0], &w, decodeTable) ||
-      !base64CharacterToValue(input[1], &x, decodeTable) ||
-      !base64CharacterToValue(input[2], &y, decodeTable) ||
-      !base64CharacterToValue(input[3], &z, decodeTable)) {
-    return JS::Result<mozilla::Ok>(JS::Error());
-  }
-
-  // 8.3 If buffer has accumulated 24 bits, interpret them as three 8-bit
-  // big-endian numbers. Append three bytes with values equal to those numbers
-  // to output, in the same order, and then empty buffer.
-  output += (uint8_t(w << 2 | x >> 4));
-  output += (uint8_t(x << 4 | y >> 2));
-  output += (uint8_t(y << 6 | z));
-  return mozilla::Ok();
-}
-
-inline JS::Result<mozilla::Ok> base64Decode3to2(std::string_view input, std::string &output,
-                                                const uint8_t *decodeTable) {
-  uint8_t w = 0;
-  uint8_t x = 0;
-  uint8_t y = 0;
-  // 8.1 Find the code point pointed to by position in the second column of
-  // Table 1: The Base 64 Alphabet of RFC 4648. Let n be the number given in the
-  // first cell of the same row. [RFC4648]
-  if (!base64CharacterToValue(input[0], &w, decodeTable) ||
-      !base64CharacterToValue(input[1], &x, decodeTable) ||
-      !base64CharacterToValue(input[2], &y, decodeTable)) {
-    return JS::Result<mozilla::Ok>(JS::Error());
-  }
-  // 9. If buffer is not empty, it contains either 12 or 18 bits. If it contains
-  // 12 bits, then discard the last four and interpret the remaining eight as an
-  // 8-bit big-endian number. If it contains 18 bits, then discard the last two
-  // and interpret the remaining 16 as two 8-bit big-endian numbers. Append the
-  // one or two bytes with values equal to those one or two numbers to output,
-  // in the same order.
-  output += (uint8_t(w << 2 | x >> 4));
-  output += (uint8_t(x << 4 | y >> 2));
-  return mozilla::Ok();
-}
-
-inline JS::Result<mozilla::Ok> base64Decode2to1(std::string_view input, std::string &output,
-                                                const uint8_t *decodeTable) {
-  uint8_t w = 0;
-  uint8_t x = 0;
-  // 8.1 Find the code point pointed to by position in the second column of
-  // Table 1: The Base 64 Alphabet of RFC 4648. Let n be the number given in the
-  // first cell of the same row. [RFC4648]
-  if (!base64CharacterToValue(input[0], &w, decodeTable) ||
-      !base64CharacterToValue(input[1], &x, decodeTable)) {
-    return JS::Result<mozilla::Ok>(JS::Error());
-  }
-  // 9. If buffer is not empty, it contains either 12 or 18 bits. If it contains
-  // 12 bits, then discard the last four and interpret the remaining eight as an
-  // 8-bit big-endian number. If it contains 18 bits, then discard the last two
-  // and interpret the remaining 16 as two 8-bit big-endian numbers. Append the
-  // one or two bytes with values equal to those one or two numbers to output,
-  // in the same order.
-  output += (uint8_t(w << 2 | x >> 4));
-  return mozilla::Ok();
-}
-
-bool isAsciiWhitespace(char c) {
+namespace {
+
+bool isAsciiWhitespace(char16_t c) {
   switch (c) {
   case '\t':
   case '\n':
@@ -209,117 +143,495 @@ bool isAsciiWhitespace(char c) {
   }
 }
 
-// https://infra.spec.whatwg.org/#forgiving-base64-decode
-JS::Result<std::string> forgivingBase64Decode(std::string_view data,
-                                              const uint8_t *decodeTable = base64DecodeTable) {
-  // 1. Remove all ASCII whitespace from data.
-  // ASCII whitespace is U+0009 TAB, U+000A LF, U+000C FF, U+000D CR, or U+0020
-  // SPACE.
-  auto hasWhitespace = std::find_if(data.begin(), data.end(), &isAsciiWhitespace);
-  std::string dataWithoutAsciiWhitespace;
-
-  if (*hasWhitespace != 0) {
-    dataWithoutAsciiWhitespace = data;
-    dataWithoutAsciiWhitespace.erase(std::remove_if(dataWithoutAsciiWhitespace.begin() +
-                                                        std::distance(data.begin(), hasWhitespace),
-                                                    dataWithoutAsciiWhitespace.end(),
-                                                    &isAsciiWhitespace),
-                                     dataWithoutAsciiWhitespace.end());
-    data = dataWithoutAsciiWhitespace;
-  }
-  std::string_view data_view(data);
-  size_t length = data_view.length();
-
-  // 2. If data’s code point length divides by 4 leaving no remainder, then:
-  if ((length != 0U) && (length % 4 == 0)) {
-    // 2.1 If data ends with one or two U+003D (=) code points, then remove them
-    // from data.
-    if (data_view.at(length - 1) == '=') {
-      if (data_view.at(length - 2) == '=') {
-        data_view.remove_suffix(2);
-      } else {
-        data_view.remove_suffix(1);
-      }
-    }
+#ifdef __wasm_simd128__
+
+// The characters encoding the values 62 and 63, which are the only ones differing between the
+// base64 and base64url alphabets.
+struct AlphabetTail {
+  uint8_t char62;
+  uint8_t char63;
+};
+
+AlphabetTail alphabetTail(const char *encodeTable) {
+  return {static_cast<uint8_t>(encodeTable[62]), static_cast<uint8_t>(encodeTable[63])};
+}
+
+AlphabetTail alphabetTail(const uint8_t *decodeTable) {
+  return decodeTable == base64URLDecodeTable ? AlphabetTail{'-', '_'} : AlphabetTail{'+', '/'};
+}
+
+// Decodes 16 characters into 12 bytes, returning false without writing anything if any of the
+// characters isn't part of the alphabet, including whitespace and padding.
+//
+// Instead of table lookups, each character is classified by range, and the offset mapping its
+// class onto the alphabet is added to it.
+bool decodeBlock(const uint8_t *src, uint8_t *dst, AlphabetTail tail) {
+  const v128_t in = wasm_v128_load(src);
+  const v128_t upper =
+      wasm_v128_and(wasm_u8x16_ge(in, wasm_u8x16_splat('A')), wasm_u8x16_le(in, wasm_u8x16_splat('Z')));
+  const v128_t lower =
+      wasm_v128_and(wasm_u8x16_ge(in, wasm_u8x16_splat('a')), wasm_u8x16_le(in, wasm_u8x16_splat('z')));
+  const v128_t digit =
+      wasm_v128_and(wasm_u8x16_ge(in, wasm_u8x16_splat('0')), wasm_u8x16_le(in, wasm_u8x16_splat('9')));
+  const v128_t is62 = wasm_i8x16_eq(in, wasm_u8x16_splat(tail.char62));
+  const v128_t is63 = wasm_i8x16_eq(in, wasm_u8x16_splat(tail.char63));
+  const v128_t valid =
+      wasm_v128_or(wasm_v128_or(wasm_v128_or(upper, lower), wasm_v128_or(digit, is62)), is63);
+  if (!wasm_i8x16_all_true(valid)) {
+    return false;
   }
 
-  // 3. If data’s code point length divides by 4 leaving a remainder of 1, then
-  // return failure.
-  if ((data_view.length() % 4 == 1)) {
-    return JS::Result<std::string>(JS::Error());
+  // The classes are disjoint, so their offsets can be combined with a plain `or`.
+  const v128_t offset = wasm_v128_or(
+      wasm_v128_or(wasm_v128_and(upper, wasm_u8x16_splat(uint8_t(0 - 'A'))),
+                   wasm_v128_and(lower, wasm_u8x16_splat(uint8_t(26 - 'a')))),
+      wasm_v128_or(wasm_v128_and(digit, wasm_u8x16_splat(uint8_t(52 - '0'))),
+                   wasm_v128_or(wasm_v128_and(is62, wasm_u8x16_splat(uint8_t(62 - tail.char62))),
+                                wasm_v128_and(is63, wasm_u8x16_splat(uint8_t(63 - tail.char63))))));
+  const v128_t values = wasm_i8x16_add(in, offset);
+
+  // Each 32-bit lane now holds four 6-bit values a, b, c, d in its bytes. Merge them into the
+  // 24-bit big-endian number a:b:c:d ...
+  const v128_t mask = wasm_i32x4_splat(0x3F);
+  const v128_t merged = wasm_v128_or(
+      wasm_v128_or(wasm_i32x4_shl(wasm_v128_and(values, mask), 18),
+                   wasm_i32x4_shl(wasm_v128_and(wasm_u32x4_shr(values, 8), mask), 12)),
+      wasm_v128_or(wasm_i32x4_shl(wasm_v128_and(wasm_u32x4_shr(values, 16), mask), 6),
+                   wasm_u32x4_shr(values, 24)));
+
+  // ... and pack the three bytes of each lane, most significant first.
+  const v128_t out =
+      wasm_i8x16_shuffle(merged, merged, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 0, 0, 0, 0);
+  wasm_v128_store64_lane(dst, out, 0);
+  wasm_v128_store32_lane(dst + 8, out, 2);
+  return true;
+}
+
+// Encodes 12 bytes into 16 characters. Reads 16 bytes from `src`.
+void encodeBlock(const uint8_t *src, char *dst, AlphabetTail tail) {
+  const v128_t in = wasm_v128_load(src);
+
+  // Move each group of three bytes x, y, z into a 32-bit lane holding the number x:y:z ...
+  const v128_t groups =
+      wasm_i8x16_shuffle(in, in, 2, 1, 0, 0, 5, 4, 3, 3, 8, 7, 6, 6, 11, 10, 9, 9);
+
+  // ... and split that into four 6-bit values, one per byte, most significant first.
+  const v128_t values = wasm_v128_or(
+      wasm_v128_or(wasm_v128_and(wasm_u32x4_shr(groups, 18), wasm_i32x4_splat(0x3F)),
+                   wasm_v128_and(wasm_u32x4_shr(groups, 4), wasm_i32x4_splat(0x3F00))),
+      wasm_v128_or(wasm_v128_and(wasm_i32x4_shl(groups, 10), wasm_i32x4_splat(0x3F0000)),
+                   wasm_v128_and(wasm_i32x4_shl(groups, 24), wasm_i32x4_splat(0x3F000000))));
+
+  // Map the values onto the alphabet by adding the offset of the range they fall into.
+  v128_t offset = wasm_u8x16_splat('A');
+  offset = wasm_v128_bitselect(wasm_u8x16_splat('a' - 26), offset,
+                               wasm_u8x16_ge(values, wasm_u8x16_splat(26)));
+  offset = wasm_v128_bitselect(wasm_u8x16_splat(uint8_t('0' - 52)), offset,
+                               wasm_u8x16_ge(values, wasm_u8x16_splat(52)));
+  offset = wasm_v128_bitselect(wasm_u8x16_splat(uint8_t(tail.char62 - 62)), offset,
+                               wasm_i8x16_eq(values, wasm_u8x16_splat(62)));
+  offset = wasm_v128_bitselect(wasm_u8x16_splat(uint8_t(tail.char63 - 63)), offset,
+                               wasm_i8x16_eq(values, wasm_u8x16_splat(63)));
+  wasm_v128_store(dst, wasm_i8x16_add(values, offset));
+}
+
+#endif
+
+enum class LastChunkHandling : uint8_t { Loose, Strict, StopBeforePartial };
+
+struct DecodeResult {
+  // The number of chars consumed.
+  size_t read;
+  // The number of bytes written.
+  size_t written;
+  bool error;
+};
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-frombase64
+//
+// With `LastChunkHandling::Loose` and no `maxLength`, this is equivalent to
+// https://infra.spec.whatwg.org/#forgiving-base64-decode, but doesn't require removing whitespace
+// and padding from the input first.
+//
+// Runs of 16 characters without whitespace are decoded using SIMD where available.
+template <typename CharT>
+DecodeResult decodeChars(const CharT *src, size_t length, uint8_t *dst, size_t maxLength,
+                         const uint8_t *decodeTable, LastChunkHandling lastChunkHandling) {
+  // 2. If maxLength is 0, then
+  //   a. Return the Record { [[Read]]: 0, [[Bytes]]: « », [[Error]]: none }.
+  if (maxLength == 0) {
+    return {0, 0, false};
   }
 
-  // 4. If data contains a code point that is not one of
-  //    U+002B (+)
-  //    U+002F (/)
-  //    ASCII alphanumeric
-  // then return failure.
+  size_t read = 0;
+  size_t written = 0;
+  uint32_t chunk = 0;
+  size_t chunkLength = 0;
+  size_t index = 0;
+
+  auto skipWhitespace = [&] {
+    while (index < length && isAsciiWhitespace(src[index])) {
+      index++;
+    }
+  };
+
+  // https://tc39.es/proposal-arraybuffer-base64/spec/#sec-decodefinalbase64chunk
+  auto decodeFinalChunk = [&](bool throwOnExtraBits) {
+    if (chunkLength == 2) {
+      if (throwOnExtraBits && (chunk & 0xF) != 0) {
+        return false;
+      }
+      dst[written++] = uint8_t(chunk >> 4);
+    } else {
+      MOZ_ASSERT(chunkLength == 3);
+      if (throwOnExtraBits && (chunk & 0x3) != 0) {
+        return false;
+      }
+      dst[written++] = uint8_t(chunk >> 10);
+      dst[written++] = uint8_t(chunk >> 2);
+    }
+    return true;
+  };
+
+  // 10. Repeat,
+  while (true) {
+#ifdef __wasm_simd128__
+    if constexpr (sizeof(CharT) == 1) {
+      if (chunkLength == 0) {
+        const auto tail = alphabetTail(decodeTable);
+        while (index + 16 <= length && maxLength - written >= 12 &&
+               decodeBlock(reinterpret_cast<const uint8_t *>(src + index), dst + written, tail)) {
+          index += 16;
+          written += 12;
+          read = index;
+        }
+        if (written == maxLength) {
+          return {read, written, false};
+        }
+      }
+    }
+#endif
+
+    // a. Set index to SkipAsciiWhitespace(string, index).
+    skipWhitespace();
 
-  // Step 4 is handled within the calls below to
-  // base64Decode4to3, base64Decode3to2, and base64Decode2to1
+    // b. If index = length, then
+    if (index == length) {
+      if (chunkLength > 0) {
+        if (lastChunkHandling == LastChunkHandling::StopBeforePartial) {
+          return {read, written, false};
+        }
+        if (lastChunkHandling == LastChunkHandling::Strict || chunkLength == 1) {
+          return {read, written, true};
+        }
+        decodeFinalChunk(false);
+      }
+      return {length, written, false};
+    }
 
-  // 5. Let output be an empty byte sequence.
-  std::string output;
-  output.reserve(data_view.length() / 3);
+    // c. Let char be the substring of string from index to index + 1.
+    // d. Set index to index + 1.
+    const CharT c = src[index++];
 
-  // 6. Let buffer be an empty buffer that can have bits appended to it.
+    // e. If char is "=", then
+    if (c == '=') {
+      if (chunkLength < 2) {
+        return {read, written, true};
+      }
+      skipWhitespace();
+      if (chunkLength == 2) {
+        if (index == length) {
+          if (lastChunkHandling == LastChunkHandling::StopBeforePartial) {
+            return {read, written, false};
+          }
+          return {read, written, true};
+        }
+        if (src[index] == '=') {
+          index++;
+          skipWhitespace();
+        }
+      }
+      if (index < length) {
+        return {read, written, true};
+      }
+      if (!decodeFinalChunk(lastChunkHandling == LastChunkHandling::Strict)) {
+        return {read, written, true};
+      }
+      return {length, written, false};
+    }
 
-  // Step 6 is handled within the calls below to
-  // base64Decode4to3, base64Decode3to2, and base64Decode2to1
+    // f. If alphabet is "base64url", then [...]
+    // g. If the code units of char are not an element of the standard base64 alphabet, then
+    //   i. Let error be a new SyntaxError exception.
+    if (c >= 128 || decodeTable[c] == nonAlphabet) {
+      return {read, written, true};
+    }
 
-  // 7. Let position be a position variable for data, initially pointing at the
-  // start of data.
+    // h. Let remaining be maxLength - the length of bytes.
+    // i. If remaining = 1 and chunkLength = 2, or if remaining = 2 and chunkLength = 3, then
+    //   i. Return the Record { [[Read]]: read, [[Bytes]]: bytes, [[Error]]: none }.
+    const size_t remaining = maxLength - written;
+    if ((remaining == 1 && chunkLength == 2) || (remaining == 2 && chunkLength == 3)) {
+      return {read, written, false};
+    }
 
-  // We don't use a position variable, instead we remove_prefix from the `data`
-  // each time we have dealt with some characters.
+    // j. Set chunk to the string-concatenation of chunk and char.
+    chunk = chunk << 6 | decodeTable[c];
+    chunkLength++;
+
+    // l. If chunkLength = 4, then
+    if (chunkLength == 4) {
+      dst[written++] = uint8_t(chunk >> 16);
+      dst[written++] = uint8_t(chunk >> 8);
+      dst[written++] = uint8_t(chunk);
+      chunk = 0;
+      chunkLength = 0;
+      read = index;
+      if (written == maxLength) {
+        return {read, written, false};
+      }
+    }
+  }
+}
 
-  while (data_view.length() >= 4) {
-    MOZ_TRY(base64Decode4to3(data_view, output, decodeTable));
-    data_view.remove_prefix(4);
+// https://infra.spec.whatwg.org/#forgiving-base64-encode
+// To forgiving-base64 encode given a byte sequence data, apply the base64
+// algorithm defined in section 4 of RFC 4648 to data and return the result.
+// [RFC4648] Note: This is named forgiving-base64 encode for symmetry with
+// forgiving-base64 decode, which is different from the RFC as it defines error
+// handling for certain inputs.
+//
+// All chars in `src` must be < 256. `dst` must have room for `encodedLength(length, pad)` chars.
+template <typename CharT>
+void encodeChars(const CharT *src, size_t length, char *dst, const char *encodeTable,
+                 bool pad = true) {
+  size_t i = 0;
+#ifdef __wasm_simd128__
+  if constexpr (sizeof(CharT) == 1) {
+    const auto tail = alphabetTail(encodeTable);
+    // Blocks consume 12 bytes, but load 16.
+    for (; i + 16 <= length; i += 12) {
+      encodeBlock(reinterpret_cast<const uint8_t *>(src + i), dst, tail);
+      dst += 16;
+    }
   }
+#endif
 
-  switch (data_view.length()) {
-  case 3: {
-    MOZ_TRY(base64Decode3to2(data_view, output, decodeTable));
-    break;
+  for (; i + 3 <= length; i += 3) {
+    const uint32_t b32 = uint32_t(src[i]) << 16 | uint32_t(src[i + 1]) << 8 | uint32_t(src[i + 2]);
+    *dst++ = encodeTable[(b32 >> 18) & 0x3F];
+    *dst++ = encodeTable[(b32 >> 12) & 0x3F];
+    *dst++ = encodeTable[(b32 >> 6) & 0x3F];
+    *dst++ = encodeTable[b32 & 0x3F];
   }
+
+  switch (length - i) {
   case 2: {
-    MOZ_TRY(base64Decode2to1(data_view, output, decodeTable));
+    const auto src0 = uint8_t(src[i]);
+    const auto src1 = uint8_t(src[i + 1]);
+    *dst++ = encodeTable[(src0 >> 2) & 0x3F];
+    *dst++ = encodeTable[((src0 & 0x03) << 4) | ((src1 >> 4) & 0x0F)];
+    *dst++ = encodeTable[(src1 & 0x0F) << 2];
+    if (pad) {
+      *dst++ = '=';
+    }
+    break;
+  }
+  case 1: {
+    const auto src0 = uint8_t(src[i]);
+    *dst++ = encodeTable[(src0 >> 2) & 0x3F];
+    *dst++ = encodeTable[(src0 & 0x03) << 4];
+    if (pad) {
+      *dst++ = '=';
+      *dst++ = '=';
+    }
     break;
   }
-  case 1:
-    return JS::Result<std::string>(JS::Error());
   case 0:
     break;
   default:
-    MOZ_CRASH("Too many characters leftover");
+    MOZ_ASSERT_UNREACHABLE("coding error");
+  }
+}
+
+size_t encodedLength(size_t length, bool pad) {
+  return pad ? (length + 2) / 3 * 4 : length / 3 * 4 + (length % 3 == 0 ? 0 : length % 3 + 1);
+}
+
+const char hexDigits[17] = "0123456789abcdef";
+
+// Encodes `length` bytes as lowercase hex into `dst`, which must have room for `length * 2`
+// chars.
+void encodeHex(const uint8_t *src, size_t length, char *dst) {
+  size_t i = 0;
+#ifdef __wasm_simd128__
+  const v128_t digits = wasm_v128_load(hexDigits);
+  for (; i + 16 <= length; i += 16) {
+    const v128_t in = wasm_v128_load(src + i);
+    const v128_t high = wasm_i8x16_swizzle(digits, wasm_u8x16_shr(in, 4));
+    const v128_t low = wasm_i8x16_swizzle(digits, wasm_v128_and(in, wasm_u8x16_splat(0xF)));
+    wasm_v128_store(dst, wasm_i8x16_shuffle(high, low, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21,
+                                            6, 22, 7, 23));
+    wasm_v128_store(dst + 16, wasm_i8x16_shuffle(high, low, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28,
+                                                 13, 29, 14, 30, 15, 31));
+    dst += 32;
+  }
+#endif
+  for (; i < length; i++) {
+    *dst++ = hexDigits[src[i] >> 4];
+    *dst++ = hexDigits[src[i] & 0xF];
   }
+}
 
+// Returns the value of the given hex digit, or nonAlphabet if it isn't one.
+template <typename CharT> uint8_t hexValue(CharT c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+    return (c | 0x20) - 'a' + 10;
+  }
+  return nonAlphabet;
+}
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-fromhex
+template <typename CharT>
+DecodeResult decodeHexChars(const CharT *src, size_t length, uint8_t *dst, size_t maxLength) {
+  // 4. If length modulo 2 is not 0, then
+  //   a. Let error be a new SyntaxError exception.
+  if (length % 2 != 0) {
+    return {0, 0, true};
+  }
+
+  size_t read = 0;
+  size_t written = 0;
+  // 5. Repeat, while read < length and the length of bytes < maxLength,
+  while (read < length && written < maxLength) {
+    const uint8_t high = hexValue(src[read]);
+    const uint8_t low = hexValue(src[read + 1]);
+    if (high == nonAlphabet || low == nonAlphabet) {
+      return {read, written, true};
+    }
+    read += 2;
+    dst[written++] = uint8_t(high << 4 | low);
+  }
+  return {read, written, false};
+}
+
+// Converts `v` to a string, throwing an "InvalidCharacterError" if that fails.
+JSString *toStringForByteString(JSContext *cx, HandleValue v) {
+  if (v.isString()) {
+    return v.toString();
+  }
+  JSString *s = JS::ToString(cx, v);
+  if (!s) {
+    api::throw_error(cx, InvalidCharacterError);
+  }
+  return s;
+}
+
+} // namespace
+
+size_t encodedLength(size_t length) { return encodedLength(length, true); }
+
+size_t maxDecodedLength(size_t length) { return length / 4 * 3 + 2; }
+
+void encode(const uint8_t *src, size_t length, char *dst, const char *encodeTable) {
+  encodeChars(src, length, dst, encodeTable);
+}
+
+bool decode(const JS::Latin1Char *src, size_t length, uint8_t *dst, size_t *written,
+            const uint8_t *decodeTable) {
+  auto result = decodeChars(src, length, dst, SIZE_MAX, decodeTable, LastChunkHandling::Loose);
+  *written = result.written;
+  return !result.error;
+}
+
+bool decode(const char16_t *src, size_t length, uint8_t *dst, size_t *written,
+            const uint8_t *decodeTable) {
+  auto result = decodeChars(src, length, dst, SIZE_MAX, decodeTable, LastChunkHandling::Loose);
+  *written = result.written;
+  return !result.error;
+}
+
+JS::Result<std::string> forgivingBase64Decode(std::string_view data,
+                                              const uint8_t *decodeTable = base64DecodeTable) {
+  std::string output(maxDecodedLength(data.length()), '\0');
+  size_t written = 0;
+  if (!decode(reinterpret_cast<const JS::Latin1Char *>(data.data()), data.length(),
+              reinterpret_cast<uint8_t *>(output.data()), &written, decodeTable)) {
+    return JS::Result<std::string>(JS::Error());
+  }
+  output.resize(written);
+  return output;
+}
+
+std::string forgivingBase64Encode(std::string_view data, const char *encodeTable) {
+  std::string output(encodedLength(data.length()), '\0');
+  encode(reinterpret_cast<const uint8_t *>(data.data()), data.length(), output.data(),
+         encodeTable);
+  return output;
+}
+
+std::string base64URLEncode(std::span<const uint8_t> data) {
+  std::string output(encodedLength(data.size(), false), '\0');
+  encodeChars(data.data(), data.size(), output.data(), base64URLEncodeTable, false);
   return output;
 }
 
 // https://html.spec.whatwg.org/multipage/webappapis.html#dom-atob
+//
+// The input string's chars are decoded in place, and the output is written directly into the
+// buffer of the resulting string.
 bool atob(JSContext *cx, unsigned argc, Value *vp) {
   CallArgs args = CallArgsFromVp(argc, vp);
   if (!args.requireAtLeast(cx, "atob", 1)) {
     return false;
   }
-  auto dataResult = valueToJSByteString(cx, args.get(0));
-  if (dataResult.isErr()) {
+  RootedString data(cx, toStringForByteString(cx, args.get(0)));
+  if (!data) {
+    return false;
+  }
+
+  // Linearizing the string up front means that getting its chars can't fail below. If it fails,
+  // the OOM has already been reported.
+  JSLinearString *linear = JS_EnsureLinearString(cx, data);
+  if (!linear) {
+    return false;
+  }
+
+  size_t length = JS::GetLinearStringLength(linear);
+  auto decoded = JS::UniqueLatin1Chars(
+      static_cast<JS::Latin1Char *>(js_malloc(std::max(maxDecodedLength(length), size_t(1)))));
+  if (!decoded) {
+    JS_ReportOutOfMemory(cx);
     return false;
   }
-  auto data = dataResult.unwrap();
 
   // 1. Let decodedData be the result of running forgiving-base64 decode on
   // data.
-  auto decoded_result = forgivingBase64Decode(data);
+  size_t decodedLength = 0;
+  bool success = false;
+  {
+    JS::AutoCheckCannotGC nogc(cx);
+    if (JS::LinearStringHasLatin1Chars(linear)) {
+      const auto *chars = JS::GetLatin1LinearStringChars(nogc, linear);
+      success = decode(chars, length, decoded.get(), &decodedLength, base64DecodeTable);
+    } else {
+      const auto *chars = JS::GetTwoByteLinearStringChars(nogc, linear);
+      success = decode(chars, length, decoded.get(), &decodedLength, base64DecodeTable);
+    }
+  }
+
   // 2. If decodedData is failure, then throw an "InvalidCharacterError"
   // DOMException.
-  if (decoded_result.isErr()) {
+  if (!success) {
     return api::throw_error(cx, InvalidCharacterError);
   }
-  auto decoded = decoded_result.unwrap();
-  RootedString decodedData(cx, JS_NewStringCopyN(cx, decoded.c_str(), decoded.length()));
+
+  RootedString decodedData(cx, decodedLength == 0
+                                   ? JS_GetEmptyString(cx)
+                                   : JS_NewLatin1String(cx, std::move(decoded), decodedLength));
   if (!decodedData) {
     return false;
   }
@@ -329,112 +641,557 @@ bool atob(JSContext *cx, unsigned argc, Value *vp) {
   return true;
 }
 
-inline uint8_t CharTo8Bit(char character) { return uint8_t(character); }
-inline void base64Encode3to4(std::string_view data, std::string &output, const char *encodeTable) {
-  uint32_t b32 = 0;
-  int i = 0;
-  int j = 18;
+// The btoa(data) method must throw an "InvalidCharacterError" DOMException
+// if data contains any character whose code point is greater than U+00FF.
+// Otherwise, the user agent must convert data to a byte sequence whose
+// nth byte is the eight-bit representation of the nth code point of data,
+// and then must apply forgiving-base64 encode to that byte sequence and return
+// the result.
+//
+// As with `atob`, the input string's chars are encoded in place, without first converting them
+// to a byte sequence.
+bool btoa(JSContext *cx, unsigned argc, Value *vp) {
+  CallArgs args = CallArgsFromVp(argc, vp);
+
+  if (!args.requireAtLeast(cx, "btoa", 1)) {
+    return false;
+  }
+
+  RootedString data(cx, toStringForByteString(cx, args.get(0)));
+  if (!data) {
+    return false;
+  }
+
+  // See `atob` for why the string is linearized first.
+  JSLinearString *linear = JS_EnsureLinearString(cx, data);
+  if (!linear) {
+    return false;
+  }
 
-  for (i = 0; i < 3; ++i) {
-    b32 <<= 8;
-    b32 |= CharTo8Bit(data[i]);
+  size_t length = JS::GetLinearStringLength(linear);
+  if (length == 0) {
+    args.rval().setString(JS_GetEmptyString(cx));
+    return true;
   }
 
-  for (i = 0; i < 4; ++i) {
-    output += encodeTable[(uint32_t)((b32 >> j) & 0x3F)];
-    j -= 6;
+  const size_t encodedLen = encodedLength(length);
+  auto encoded = JS::UniqueLatin1Chars(static_cast<JS::Latin1Char *>(js_malloc(encodedLen)));
+  if (!encoded) {
+    JS_ReportOutOfMemory(cx);
+    return false;
   }
+
+  auto *dst = reinterpret_cast<char *>(encoded.get());
+  bool hasNonLatin1Chars = false;
+  {
+    JS::AutoCheckCannotGC nogc(cx);
+    if (JS::LinearStringHasLatin1Chars(linear)) {
+      const auto *chars = JS::GetLatin1LinearStringChars(nogc, linear);
+      encodeChars(chars, length, dst, base64EncodeTable);
+    } else {
+      const auto *chars = JS::GetTwoByteLinearStringChars(nogc, linear);
+      hasNonLatin1Chars = std::any_of(chars, chars + length, [](char16_t c) { return c > 255; });
+      if (!hasNonLatin1Chars) {
+        encodeChars(chars, length, dst, base64EncodeTable);
+      }
+    }
+  }
+
+  if (hasNonLatin1Chars) {
+    return api::throw_error(cx, InvalidCharacterError);
+  }
+
+  JSString *str = JS_NewLatin1String(cx, std::move(encoded), encodedLen);
+  if (!str) {
+    return false;
+  }
+
+  args.rval().setString(str);
+  return true;
 }
+// Uint8Array base64 and hex conversions
+// https://tc39.es/proposal-arraybuffer-base64/spec/
+//
+// These use the same codec as `atob` and `btoa`, but convert directly between the array's bytes
+// and the chars of the base64 or hex string, without an intermediate byte string.
+
+namespace {
 
-inline void base64Encode2to4(std::string_view data, std::string &output, const char *encodeTable) {
-  uint8_t src0 = CharTo8Bit(data[0]);
-  uint8_t src1 = CharTo8Bit(data[1]);
-  output += encodeTable[(uint32_t)((src0 >> 2) & 0x3F)];
-  output += encodeTable[(uint32_t)(((src0 & 0x03) << 4) | ((src1 >> 4) & 0x0F))];
-  output += encodeTable[(uint32_t)((src1 & 0x0F) << 2)];
-  output += '=';
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-validateuint8array
+bool validateUint8Array(JSContext *cx, HandleValue value, const char *method,
+                        MutableHandleObject array) {
+  if (!value.isObject() || !JS_IsUint8Array(&value.toObject())) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "receiver", "be a Uint8Array");
+  }
+  array.set(&value.toObject());
+  return true;
 }
 
-inline void base64Encode1to4(std::string_view data, std::string &output, const char *encodeTable) {
-  uint8_t src0 = CharTo8Bit(data[0]);
-  output += encodeTable[(uint32_t)((src0 >> 2) & 0x3F)];
-  output += encodeTable[(uint32_t)((src0 & 0x03) << 4)];
-  output += '=';
-  output += '=';
+// The original `%TypedArray%.prototype.at`, used to check whether an array is out of bounds.
+JS::PersistentRooted<JS::Value> original_at;
+
+// Sets `length` to the current byte length of `array`, which follows its buffer's if that's
+// resizable, and throws a TypeError if the array is detached or out of bounds.
+//
+// This has to be called after all arguments have been converted, as that can run content that
+// resizes or detaches the buffer.
+bool uint8ArrayLength(JSContext *cx, HandleObject array, const char *method, size_t *length) {
+  *length = JS_GetArrayBufferViewByteLength(array);
+  if (*length > 0) {
+    return true;
+  }
+
+  // Detached and out-of-bounds arrays have a length of 0, so only empty arrays need checking.
+  bool isShared = false;
+  RootedObject buffer(cx, JS_GetArrayBufferViewBuffer(cx, array, &isShared));
+  if (!buffer) {
+    return false;
+  }
+  if (!isShared && JS::IsDetachedArrayBufferObject(buffer)) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "Uint8Array",
+                            "not be detached");
+  }
+
+  // `at` starts with ValidateTypedArray, which throws a TypeError iff the array is out of bounds.
+  RootedValue array_val(cx, JS::ObjectValue(*array));
+  RootedValue rval(cx);
+  return JS::Call(cx, array_val, original_at, JS::HandleValueArray::empty(), &rval);
 }
 
-// https://infra.spec.whatwg.org/#forgiving-base64-encode
-// To forgiving-base64 encode given a byte sequence data, apply the base64
-// algorithm defined in section 4 of RFC 4648 to data and return the result.
-// [RFC4648] Note: This is named forgiving-base64 encode for symmetry with
-// forgiving-base64 decode, which is different from the RFC as it defines error
-// handling for certain inputs.
-std::string forgivingBase64Encode(std::string_view data, const char *encodeTable) {
-  int length = data.length();
-  std::string output;
-  // The Base64 version of a string will be at least 133% the size of the
-  // string.
-  output.reserve(length * 1.33);
-  while (length >= 3) {
-    base64Encode3to4(data, output, encodeTable);
-    data.remove_prefix(3);
-    length -= 3;
-  }
-
-  switch (length) {
-  case 2:
-    base64Encode2to4(data, output, encodeTable);
-    break;
-  case 1:
-    base64Encode1to4(data, output, encodeTable);
-    break;
-  case 0:
-    break;
-  default:
-    MOZ_ASSERT_UNREACHABLE("coding error");
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-getoptionsobject
+//
+// Leaves `options` null if the given value is undefined.
+bool getOptionsObject(JSContext *cx, HandleValue value, const char *method,
+                      MutableHandleObject options) {
+  if (value.isUndefined()) {
+    return true;
   }
-  return output;
+  if (!value.isObject()) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "options", "be an object");
+  }
+  options.set(&value.toObject());
+  return true;
 }
 
-// The btoa(data) method must throw an "InvalidCharacterError" DOMException
-// if data contains any character whose code point is greater than U+00FF.
-// Otherwise, the user agent must convert data to a byte sequence whose
-// nth byte is the eight-bit representation of the nth code point of data,
-// and then must apply forgiving-base64 encode to that byte sequence and return
-// the result.
-bool btoa(JSContext *cx, unsigned argc, Value *vp) {
+// Reads the `name` option, which has to be one of the given strings if it's not undefined. Sets
+// `index` to the index of the matching string, or leaves it untouched if the option is undefined.
+template <size_t N>
+bool getEnumOption(JSContext *cx, HandleObject options, const char *name,
+                   const char *const (&values)[N], const char *method, const char *expected,
+                   size_t *index) {
+  if (!options) {
+    return true;
+  }
+  RootedValue value(cx);
+  if (!JS_GetProperty(cx, options, name, &value)) {
+    return false;
+  }
+  if (value.isUndefined()) {
+    return true;
+  }
+  if (value.isString()) {
+    for (size_t i = 0; i < N; i++) {
+      bool match = false;
+      if (!JS_StringEqualsAscii(cx, value.toString(), values[i], &match)) {
+        return false;
+      }
+      if (match) {
+        *index = i;
+        return true;
+      }
+    }
+  }
+  return api::throw_error(cx, api::Errors::TypeError, method, name, expected);
+}
+
+const char *const ALPHABETS[] = {"base64", "base64url"};
+const char *const LAST_CHUNK_HANDLINGS[] = {"loose", "strict", "stop-before-partial"};
+
+bool getAlphabetOption(JSContext *cx, HandleObject options, const char *method, bool *url) {
+  size_t index = 0;
+  if (!getEnumOption(cx, options, "alphabet", ALPHABETS, method,
+                     "be either \"base64\" or \"base64url\"", &index)) {
+    return false;
+  }
+  *url = index == 1;
+  return true;
+}
+
+bool getLastChunkHandlingOption(JSContext *cx, HandleObject options, const char *method,
+                                LastChunkHandling *lastChunkHandling) {
+  size_t index = 0;
+  if (!getEnumOption(cx, options, "lastChunkHandling", LAST_CHUNK_HANDLINGS, method,
+                     "be one of \"loose\", \"strict\", or \"stop-before-partial\"", &index)) {
+    return false;
+  }
+  *lastChunkHandling = static_cast<LastChunkHandling>(index);
+  return true;
+}
+
+// Creates a Uint8Array taking ownership of `length` bytes of `data`, which has room for
+// `capacity` bytes.
+JSObject *newUint8ArrayWithContents(JSContext *cx, UniqueChars data, size_t length,
+                                    size_t capacity) {
+  if (length == 0) {
+    return JS_NewUint8Array(cx, 0);
+  }
+
+  if (length < capacity) {
+    // Shrinking an allocation can't fail in practice, but if it does the original one is kept.
+    if (auto *shrunk = static_cast<char *>(js_realloc(data.get(), length))) {
+      std::ignore = data.release();
+      data.reset(shrunk);
+    }
+  }
+
+  RootedObject buffer(
+      cx, JS::NewArrayBufferWithContents(cx, length, data.get(),
+                                         JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+  if (!buffer) {
+    return nullptr;
+  }
+  std::ignore = data.release();
+  return JS_NewUint8ArrayWithBuffer(cx, buffer, 0, length);
+}
+
+// Runs `decode` on the chars of `string`, with `dst` pointing to the data of `array` if it's
+// given, or to a new buffer otherwise. `capacity` is the length of `array`, or of the new buffer.
+//
+// For `Uint8Array.from*`, the resulting array is stored in `result`, unless decoding failed.
+// For `Uint8Array.prototype.setFrom*`, the decoded bytes are written into `array` directly,
+// including when decoding failed partway through.
+template <typename Decode>
+bool decodeString(JSContext *cx, HandleString string, HandleObject array, size_t capacity,
+                  Decode decode, DecodeResult *decoded, MutableHandleObject result) {
+  // See `atob` for why the string is linearized first.
+  JSLinearString *linear = JS_EnsureLinearString(cx, string);
+  if (!linear) {
+    return false;
+  }
+
+  UniqueChars buffer;
+  if (!array) {
+    buffer.reset(static_cast<char *>(js_malloc(std::max(capacity, size_t(1)))));
+    if (!buffer) {
+      JS_ReportOutOfMemory(cx);
+      return false;
+    }
+  }
+
+  {
+    JS::AutoCheckCannotGC nogc(cx);
+    uint8_t *dst = nullptr;
+    if (array) {
+      bool isShared = false;
+      dst = JS_GetUint8ArrayData(array, &isShared, nogc);
+    } else {
+      dst = reinterpret_cast<uint8_t *>(buffer.get());
+    }
+
+    size_t length = JS::GetLinearStringLength(linear);
+    if (JS::LinearStringHasLatin1Chars(linear)) {
+      const auto *chars = JS::GetLatin1LinearStringChars(nogc, linear);
+      *decoded = decode(chars, length, dst, capacity);
+    } else {
+      const auto *chars = JS::GetTwoByteLinearStringChars(nogc, linear);
+      *decoded = decode(chars, length, dst, capacity);
+    }
+  }
+
+  if (!array && !decoded->error) {
+    result.set(newUint8ArrayWithContents(cx, std::move(buffer), decoded->written, capacity));
+    return result != nullptr;
+  }
+  return true;
+}
+
+// Creates the `{ read, written }` result object of the `setFrom*` methods.
+bool setFromResult(JSContext *cx, const DecodeResult &decoded, MutableHandleValue rval) {
+  RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+  RootedValue read(cx, JS::NumberValue(decoded.read));
+  RootedValue written(cx, JS::NumberValue(decoded.written));
+  if (!JS_DefineProperty(cx, result, "read", read, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "written", written, JSPROP_ENUMERATE)) {
+    return false;
+  }
+  rval.setObject(*result);
+  return true;
+}
+
+// Creates a string from `length` Latin-1 chars written by `encode`.
+template <typename Encode>
+JSString *newEncodedString(JSContext *cx, size_t length, Encode encode) {
+  if (length == 0) {
+    return JS_GetEmptyString(cx);
+  }
+  auto chars = JS::UniqueLatin1Chars(static_cast<JS::Latin1Char *>(js_malloc(length)));
+  if (!chars) {
+    JS_ReportOutOfMemory(cx);
+    return nullptr;
+  }
+  encode(reinterpret_cast<char *>(chars.get()));
+  return JS_NewLatin1String(cx, std::move(chars), length);
+}
+
+} // namespace
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.frombase64
+bool fromBase64(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.fromBase64";
   CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.get(0).isString()) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "argument", "be a string");
+  }
+  RootedString string(cx, args[0].toString());
 
-  if (!args.requireAtLeast(cx, "btoa", 1)) {
+  RootedObject options(cx);
+  bool url = false;
+  auto lastChunkHandling = LastChunkHandling::Loose;
+  if (!getOptionsObject(cx, args.get(1), method, &options) ||
+      !getAlphabetOption(cx, options, method, &url) ||
+      !getLastChunkHandlingOption(cx, options, method, &lastChunkHandling)) {
     return false;
   }
 
-  auto data = args.get(0);
-  auto out = args.rval();
-  // Note: We do not check if data contains any character whose code point is
-  // greater than U+00FF before calling convertJSValueToByteString as
-  // convertJSValueToByteString does the same check
-  auto byteStringResult = valueToJSByteString(cx, data);
-  if (byteStringResult.isErr()) {
+  const uint8_t *decodeTable = url ? base64URLDecodeTable : base64DecodeTable;
+  auto decode = [&](const auto *chars, size_t length, uint8_t *dst, size_t maxLength) {
+    return decodeChars(chars, length, dst, maxLength, decodeTable, lastChunkHandling);
+  };
+  DecodeResult decoded{};
+  RootedObject result(cx);
+  if (!decodeString(cx, string, nullptr, maxDecodedLength(JS::GetStringLength(string)), decode,
+                    &decoded, &result)) {
     return false;
   }
-  auto byteString = byteStringResult.unwrap();
+  if (decoded.error) {
+    return api::throw_error(cx, InvalidEncodingError, method, "base64");
+  }
 
-  auto result = forgivingBase64Encode(byteString, base64EncodeTable);
+  args.rval().setObject(*result);
+  return true;
+}
 
-  JSString *str = JS_NewStringCopyN(cx, result.c_str(), result.length());
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.fromhex
+bool fromHex(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.fromHex";
+  CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.get(0).isString()) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "argument", "be a string");
+  }
+  RootedString string(cx, args[0].toString());
+
+  auto decode = [](const auto *chars, size_t length, uint8_t *dst, size_t maxLength) {
+    return decodeHexChars(chars, length, dst, maxLength);
+  };
+  DecodeResult decoded{};
+  RootedObject result(cx);
+  if (!decodeString(cx, string, nullptr, JS::GetStringLength(string) / 2, decode, &decoded,
+                    &result)) {
+    return false;
+  }
+  if (decoded.error) {
+    return api::throw_error(cx, InvalidEncodingError, method, "hex");
+  }
+
+  args.rval().setObject(*result);
+  return true;
+}
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.prototype.setfrombase64
+bool setFromBase64(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.prototype.setFromBase64";
+  CallArgs args = CallArgsFromVp(argc, vp);
+  RootedObject array(cx);
+  if (!validateUint8Array(cx, args.thisv(), method, &array)) {
+    return false;
+  }
+  if (!args.get(0).isString()) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "argument", "be a string");
+  }
+  RootedString string(cx, args[0].toString());
+
+  RootedObject options(cx);
+  bool url = false;
+  auto lastChunkHandling = LastChunkHandling::Loose;
+  if (!getOptionsObject(cx, args.get(1), method, &options) ||
+      !getAlphabetOption(cx, options, method, &url) ||
+      !getLastChunkHandlingOption(cx, options, method, &lastChunkHandling)) {
+    return false;
+  }
+  size_t arrayLength = 0;
+  if (!uint8ArrayLength(cx, array, method, &arrayLength)) {
+    return false;
+  }
+
+  const uint8_t *decodeTable = url ? base64URLDecodeTable : base64DecodeTable;
+  auto decode = [&](const auto *chars, size_t length, uint8_t *dst, size_t maxLength) {
+    return decodeChars(chars, length, dst, maxLength, decodeTable, lastChunkHandling);
+  };
+  DecodeResult decoded{};
+  RootedObject unused(cx);
+  if (!decodeString(cx, string, array, arrayLength, decode, &decoded, &unused)) {
+    return false;
+  }
+  if (decoded.error) {
+    return api::throw_error(cx, InvalidEncodingError, method, "base64");
+  }
+
+  return setFromResult(cx, decoded, args.rval());
+}
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.prototype.setfromhex
+bool setFromHex(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.prototype.setFromHex";
+  CallArgs args = CallArgsFromVp(argc, vp);
+  RootedObject array(cx);
+  if (!validateUint8Array(cx, args.thisv(), method, &array)) {
+    return false;
+  }
+  if (!args.get(0).isString()) {
+    return api::throw_error(cx, api::Errors::TypeError, method, "argument", "be a string");
+  }
+  RootedString string(cx, args[0].toString());
+  size_t arrayLength = 0;
+  if (!uint8ArrayLength(cx, array, method, &arrayLength)) {
+    return false;
+  }
+
+  auto decode = [](const auto *chars, size_t length, uint8_t *dst, size_t maxLength) {
+    return decodeHexChars(chars, length, dst, maxLength);
+  };
+  DecodeResult decoded{};
+  RootedObject unused(cx);
+  if (!decodeString(cx, string, array, arrayLength, decode, &decoded, &unused)) {
+    return false;
+  }
+  if (decoded.error) {
+    return api::throw_error(cx, InvalidEncodingError, method, "hex");
+  }
+
+  return setFromResult(cx, decoded, args.rval());
+}
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.prototype.tobase64
+bool toBase64(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.prototype.toBase64";
+  CallArgs args = CallArgsFromVp(argc, vp);
+  RootedObject array(cx);
+  if (!validateUint8Array(cx, args.thisv(), method, &array)) {
+    return false;
+  }
+
+  RootedObject options(cx);
+  bool url = false;
+  if (!getOptionsObject(cx, args.get(0), method, &options) ||
+      !getAlphabetOption(cx, options, method, &url)) {
+    return false;
+  }
+
+  bool omitPadding = false;
+  if (options) {
+    RootedValue value(cx);
+    if (!JS_GetProperty(cx, options, "omitPadding", &value)) {
+      return false;
+    }
+    omitPadding = JS::ToBoolean(value);
+  }
+
+  size_t length = 0;
+  if (!uint8ArrayLength(cx, array, method, &length)) {
+    return false;
+  }
+
+  const char *encodeTable = url ? base64URLEncodeTable : base64EncodeTable;
+  JSString *str = newEncodedString(cx, encodedLength(length, !omitPadding), [&](char *dst) {
+    JS::AutoCheckCannotGC nogc(cx);
+    bool isShared = false;
+    encodeChars(JS_GetUint8ArrayData(array, &isShared, nogc), length, dst, encodeTable,
+                !omitPadding);
+  });
   if (!str) {
-    return api::throw_error(cx, InvalidCharacterError);
+    return false;
   }
 
-  out.setString(str);
+  args.rval().setString(str);
   return true;
 }
+
+// https://tc39.es/proposal-arraybuffer-base64/spec/#sec-uint8array.prototype.tohex
+bool toHex(JSContext *cx, unsigned argc, Value *vp) {
+  constexpr const char *method = "Uint8Array.prototype.toHex";
+  CallArgs args = CallArgsFromVp(argc, vp);
+  RootedObject array(cx);
+  size_t length = 0;
+  if (!validateUint8Array(cx, args.thisv(), method, &array) ||
+      !uint8ArrayLength(cx, array, method, &length)) {
+    return false;
+  }
+
+  JSString *str = newEncodedString(cx, length * 2, [&](char *dst) {
+    JS::AutoCheckCannotGC nogc(cx);
+    bool isShared = false;
+    encodeHex(JS_GetUint8ArrayData(array, &isShared, nogc), length, dst);
+  });
+  if (!str) {
+    return false;
+  }
+
+  args.rval().setString(str);
+  return true;
+}
+
 const JSFunctionSpec methods[] = {JS_FN("atob", atob, 1, JSPROP_ENUMERATE),
                                   JS_FN("btoa", btoa, 1, JSPROP_ENUMERATE), JS_FS_END};
 
+const JSFunctionSpec uint8array_static_methods[] = {
+    JS_FN("fromBase64", fromBase64, 1, 0),
+    JS_FN("fromHex", fromHex, 1, 0),
+    JS_FS_END,
+};
+
+const JSFunctionSpec uint8array_methods[] = {
+    JS_FN("setFromBase64", setFromBase64, 1, 0),
+    JS_FN("setFromHex", setFromHex, 1, 0),
+    JS_FN("toBase64", toBase64, 0, 0),
+    JS_FN("toHex", toHex, 0, 0),
+    JS_FS_END,
+};
+
 bool install(api::Engine *engine) {
-  return JS_DefineFunctions(engine->cx(), engine->global(), methods);
+  JSContext *cx = engine->cx();
+  if (!JS_DefineFunctions(cx, engine->global(), methods)) {
+    return false;
+  }
+
+  // Defined on Uint8Array even if the engine provides its own versions, so all base64 conversions
+  // share the same codec.
+  RootedValue val(cx);
+  if (!JS_GetProperty(cx, engine->global(), "Uint8Array", &val)) {
+    return false;
+  }
+  RootedObject uint8array(cx, &val.toObject());
+  if (!JS_GetProperty(cx, uint8array, "prototype", &val)) {
+    return false;
+  }
+  RootedObject uint8array_proto(cx, &val.toObject());
+  if (!JS_DefineFunctions(cx, uint8array, uint8array_static_methods) ||
+      !JS_DefineFunctions(cx, uint8array_proto, uint8array_methods)) {
+    return false;
+  }
+
+  RootedObject typedarray_proto(cx);
+  if (!JS_GetPrototype(cx, uint8array_proto, &typedarray_proto)) {
+    return false;
+  }
+  original_at.init(cx);
+  if (!JS_GetProperty(cx, typedarray_proto, "at", &original_at)) {
+    return false;
+  }
+  MOZ_ASSERT(JS::IsCallable(&original_at.toObject()));
+  return true;
 }
 
 } // namespace builtins::web::base64
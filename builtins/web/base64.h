@@ -3,6 +3,8 @@
 
 #include "extension-api.h"
 
+#include <span>
+
 
 
 namespace builtins::web::base64 {
@@ -14,7 +16,29 @@ extern const uint8_t base64URLDecodeTable[128];
 extern const char base64EncodeTable[65];
 extern const char base64URLEncodeTable[65];
 
+/// Returns the length of the padded encoding of `length` bytes.
+size_t encodedLength(size_t length);
+
+/// Returns an upper bound for the number of bytes `length` chars of base64 decode to.
+size_t maxDecodedLength(size_t length);
+
+/// Encodes `length` bytes into `dst`, which must have room for `encodedLength(length)` chars.
+void encode(const uint8_t *src, size_t length, char *dst, const char *encodeTable);
+
+/// Runs forgiving-base64 decode on the given chars, writing the result into `dst`, which must
+/// have room for `maxDecodedLength(length)` bytes. Returns false if the input is invalid.
+///
+/// Decoding operates directly on a string's chars, so callers can avoid converting JS strings
+/// to a byte string first.
+bool decode(const JS::Latin1Char *src, size_t length, uint8_t *dst, size_t *written,
+            const uint8_t *decodeTable);
+bool decode(const char16_t *src, size_t length, uint8_t *dst, size_t *written,
+            const uint8_t *decodeTable);
+
 std::string forgivingBase64Encode(std::string_view data, const char *encodeTable);
+
+/// Returns the base64url encoding of `data` without padding, as used by JSON Web Keys.
+std::string base64URLEncode(std::span<const uint8_t> data);
 JS::Result<std::string> forgivingBase64Decode(std::string_view data, const uint8_t *decodeTable);
 
 JS::Result<std::string> valueToJSByteString(JSContext *cx, HandleValue v);
@@ -1,6 +1,7 @@
 #include "blob.h"
 #include "file.h"
 #include "builtin.h"
+#include "dom-exception.h"
 #include "encode.h"
 #include "rust-encoding.h"
 #include "streams/buf-reader.h"
@@ -13,6 +14,12 @@
 #include "js/TypeDecls.h"
 #include "js/Value.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace {
 
 template <typename T> bool validate_type(T *chars, size_t strlen) {
@@ -72,6 +79,286 @@ std::string convert_line_endings_to_native(std::string_view s) {
 
 namespace builtins::web::blob {
 
+// The maximum size of the chunks enqueued by `Blob.prototype.stream()`.
+constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+struct BlobSegment::FileBacking {
+  UniqueChars path;
+  // Offset of the segment's data within the file.
+  size_t offset;
+  // The file's size and modification time when the segment was created.
+  off_t size;
+  struct timespec mtime;
+};
+
+BlobSegment::BlobSegment(mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data, size_t length)
+    : data_(std::move(data)), length_(length) {}
+
+BlobSegment::BlobSegment(js::UniquePtr<FileBacking> file, size_t length)
+    : file_(std::move(file)), length_(length) {}
+
+BlobSegment::~BlobSegment() = default;
+
+BlobSegment *BlobSegment::create_for_file(const char *path, const struct stat &st, size_t offset,
+                                          size_t length) {
+  MOZ_ASSERT(S_ISREG(st.st_mode));
+  auto file = js::MakeUnique<FileBacking>();
+  if (!file) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+
+  file->path = js::DuplicateString(path);
+  if (!file->path) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+
+  file->offset = offset;
+  file->size = st.st_size;
+  file->mtime = st.st_mtim;
+
+  auto *segment = js_new<BlobSegment>(std::move(file), length);
+  if (!segment) {
+    errno = ENOMEM;
+  }
+  return segment;
+}
+
+bool BlobSegment::read(size_t offset, std::span<uint8_t> dst) const {
+  MOZ_ASSERT(offset + dst.size() <= length_);
+  if (data_) {
+    std::copy_n(data_.get() + offset, dst.size(), dst.data());
+    return true;
+  }
+
+  // The file is only opened for the duration of each read, so that Blobs don't hold on to
+  // descriptors however long they're kept alive, and none can end up in a pre-initialization
+  // snapshot.
+  const auto &file = *file_;
+  int fd = open(file.path.get(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  // https://w3c.github.io/FileAPI/#file-section
+  // A File's snapshot state is what it had at creation time: if the file changed in the
+  // meantime, reading from it must fail.
+  struct stat st {};
+  bool ok = fstat(fd, &st) == 0 && st.st_size == file.size &&
+            st.st_mtim.tv_sec == file.mtime.tv_sec && st.st_mtim.tv_nsec == file.mtime.tv_nsec;
+
+  size_t total = 0;
+  while (ok && total < dst.size()) {
+    auto n = pread(fd, dst.data() + total, dst.size() - total,
+                   static_cast<off_t>(file.offset + offset + total));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // Reading nothing means that the file was truncated after it was opened.
+    if (n <= 0) {
+      ok = false;
+      break;
+    }
+    total += n;
+  }
+
+  close(fd);
+  return ok;
+}
+
+size_t BlobRope::find_range(size_t pos) const {
+  auto *it = std::upper_bound(ranges_.begin(), ranges_.end(), pos,
+                              [](size_t value, const Range &range) {
+                                return value < range.start + range.length;
+                              });
+  return it - ranges_.begin();
+}
+
+bool BlobRope::append_bytes(std::span<const uint8_t> bytes) {
+  if (!pending_.append(bytes.data(), bytes.size())) {
+    return false;
+  }
+
+  length_ += bytes.size();
+  return true;
+}
+
+bool BlobRope::append_segment(BlobSegment *segment, size_t offset, size_t length) {
+  if (length == 0) {
+    return true;
+  }
+
+  if (!finish() || !ranges_.append(Range{segment, offset, length_, length})) {
+    return false;
+  }
+
+  length_ += length;
+  return true;
+}
+
+bool BlobRope::append_rope(const BlobRope &src, size_t start, size_t length) {
+  MOZ_ASSERT(&src != this);
+  size_t end = start + length;
+  for (size_t i = src.find_range(start); i < src.ranges_.length() && start < end; i++) {
+    const auto &range = src.ranges_[i];
+    size_t skip = start - range.start;
+    size_t n = std::min(range.length - skip, end - start);
+    bool ok = n < MIN_SHARED_RANGE_LENGTH && range.segment->in_memory()
+                  ? append_bytes(range.segment->span().subspan(range.offset + skip, n))
+                  : append_segment(range.segment, range.offset + skip, n);
+    if (!ok) {
+      return false;
+    }
+    start += n;
+  }
+
+  return true;
+}
+
+bool BlobRope::finish() {
+  if (pending_.empty()) {
+    return true;
+  }
+
+  size_t length = pending_.length();
+  pending_.podResizeToFit();
+  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data(pending_.extractOrCopyRawBuffer());
+  if (!data) {
+    return false;
+  }
+
+  RefPtr<BlobSegment> segment = js_new<BlobSegment>(std::move(data), length);
+  if (!segment) {
+    return false;
+  }
+
+  return ranges_.append(Range{segment, 0, length_ - length, length});
+}
+
+bool BlobRope::read(size_t start, std::span<uint8_t> dst) const {
+  MOZ_ASSERT(pending_.empty());
+  MOZ_ASSERT(start + dst.size() <= length_);
+  for (size_t i = find_range(start); i < ranges_.length() && !dst.empty(); i++) {
+    const auto &range = ranges_[i];
+    size_t skip = start - range.start;
+    size_t n = std::min(range.length - skip, dst.size());
+    if (!range.segment->read(range.offset + skip, dst.first(n))) {
+      return false;
+    }
+    dst = dst.subspan(n);
+    start += n;
+  }
+
+  return true;
+}
+
+BlobData *BlobData::create() {
+  RefPtr<BlobRope> rope = js_new<BlobRope>();
+  if (!rope) {
+    return nullptr;
+  }
+
+  return js_new<BlobData>(rope, 0, 0);
+}
+
+BlobData *BlobData::create(mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data, size_t length) {
+  js::UniquePtr<BlobData> blob(create());
+  if (!blob || length == 0) {
+    return blob.release();
+  }
+
+  RefPtr<BlobSegment> segment = js_new<BlobSegment>(std::move(data), length);
+  if (!segment || !blob->rope_->append_segment(segment, 0, length)) {
+    return nullptr;
+  }
+
+  blob->length_ = length;
+  return blob.release();
+}
+
+BlobData *BlobData::create_for_file(const char *path) {
+  // The file is only `stat`ed once, so the size the Blob gets is the one its reads are checked
+  // against.
+  struct stat st {};
+  if (stat(path, &st) != 0) {
+    return nullptr;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    errno = EISDIR;
+    return nullptr;
+  }
+
+  auto length = static_cast<size_t>(st.st_size);
+  RefPtr<BlobSegment> segment = BlobSegment::create_for_file(path, st, 0, length);
+  if (!segment) {
+    return nullptr;
+  }
+
+  js::UniquePtr<BlobData> blob(create());
+  if (!blob || !blob->rope_->append_segment(segment, 0, length)) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+
+  blob->length_ = length;
+  return blob.release();
+}
+
+bool BlobData::append_bytes(std::span<const uint8_t> bytes) {
+  MOZ_ASSERT(offset_ == 0 && length_ == rope_->length());
+  if (!rope_->append_bytes(bytes)) {
+    return false;
+  }
+
+  length_ = rope_->length();
+  return true;
+}
+
+bool BlobData::append_segment(BlobSegment *segment, size_t offset, size_t length) {
+  MOZ_ASSERT(offset_ == 0 && length_ == rope_->length());
+  MOZ_ASSERT(offset + length <= segment->length());
+  bool ok = length < BlobRope::MIN_SHARED_RANGE_LENGTH && segment->in_memory()
+                ? rope_->append_bytes(segment->span().subspan(offset, length))
+                : rope_->append_segment(segment, offset, length);
+  if (!ok) {
+    return false;
+  }
+
+  length_ = rope_->length();
+  return true;
+}
+
+bool BlobData::append_data(const BlobData &src) {
+  MOZ_ASSERT(offset_ == 0 && length_ == rope_->length());
+  if (!rope_->append_rope(*src.rope_, src.offset_, src.length_)) {
+    return false;
+  }
+
+  length_ = rope_->length();
+  return true;
+}
+
+BlobData *BlobData::slice(size_t start, size_t length) const {
+  MOZ_ASSERT(start + length <= length_);
+  return js_new<BlobData>(rope_, offset_ + start, length);
+}
+
+bool BlobData::read(size_t start, std::span<uint8_t> dst, size_t *read) const {
+  *read = 0;
+  if (start >= length_) {
+    return true;
+  }
+
+  size_t to_read = std::min(dst.size(), length_ - start);
+  if (!rope_->read(offset_ + start, dst.first(to_read))) {
+    return false;
+  }
+
+  *read = to_read;
+  return true;
+}
+
 // https://w3c.github.io/FileAPI/#dfn-type
 // 1. If type contains any characters outside the range U+0020 to U+007E, then set t to the empty string.
 // 2. Convert every character in type to ASCII lowercase.
@@ -170,13 +457,19 @@ JSObject *Blob::data_to_owned_array_buffer(JSContext *cx, HandleObject self) {
   auto *src = Blob::blob(self);
   auto size = src->length();
 
-  auto buf = mozilla::MakeUnique<uint8_t[]>(size);
+  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> buf(js_pod_malloc<uint8_t>(size));
   if (!buf) {
     JS_ReportOutOfMemory(cx);
     return nullptr;
   }
 
-  std::copy_n(src->begin(), size, buf.get());
+  // This is where a segmented Blob is flattened into contiguous memory.
+  size_t read = 0;
+  if (!src->read(0, {buf.get(), size}, &read)) {
+    report_read_error(cx);
+    return nullptr;
+  }
+  MOZ_ASSERT(read == size);
 
   auto *array_buffer = JS::NewArrayBufferWithContents(
       cx, size, buf.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory);
@@ -200,15 +493,18 @@ bool Blob::read_blob_slice(JSContext *cx, HandleObject self, std::span<uint8_t>
     return true;
   }
 
-  size_t available = src->length() - start;
-  size_t to_read = std::min(buf.size(), available);
-
-  std::copy_n(src->begin() + start, to_read, buf.data());
-  *read = to_read;
+  if (!src->read(start, buf, read)) {
+    return report_read_error(cx);
+  }
 
  return true;
 }
 
+bool Blob::report_read_error(JSContext *cx) {
+  return dom_exception::DOMException::raise(cx, "The requested file could not be read",
+                                            "NotReadableError");
+}
+
 DEFINE_BLOB_METHOD(arrayBuffer)
 DEFINE_BLOB_METHOD(bytes)
 DEFINE_BLOB_METHOD(stream)
@@ -295,13 +591,13 @@ bool Blob::slice(JSContext *cx, HandleObject self, const CallArgs &args, Mutable
   end = (end < 0) ? std::max((size + end), 0LL) : std::min(end, size);
 
   auto slice_len = std::max(end - start, 0LL);
-  auto dst = (slice_len > 0) ? UniqueChars(js_pod_malloc<char>(slice_len)) : nullptr;
-
-  if (dst) {
-    std::copy(src->begin() + start, src->begin() + end, dst.get());
+  js::UniquePtr<BlobData> data(src->slice(start, slice_len));
+  if (!data) {
+    JS_ReportOutOfMemory(cx);
+    return false;
   }
 
-  JS::RootedObject new_blob(cx, create(cx, std::move(dst), slice_len, contentType));
+  JS::RootedObject new_blob(cx, create(cx, std::move(data), contentType));
   if (!new_blob) {
     return false;
   }
@@ -311,7 +607,10 @@ bool Blob::slice(JSContext *cx, HandleObject self, const CallArgs &args, Mutable
 }
 
 bool Blob::stream(JSContext *cx, HandleObject self, MutableHandleValue rval) {
-  RootedObject reader(cx, BufReader::create(cx, self, read_blob_slice));
+  // Blobs are immutable and their size is known, so they can be read in large chunks, without
+  // allocating more than the Blob's size for small ones.
+  auto chunk_size = std::clamp(blob_size(self), size_t(1), STREAM_CHUNK_SIZE);
+  RootedObject reader(cx, BufReader::create(cx, self, read_blob_slice, chunk_size));
   if (!reader) {
     return false;
   }
@@ -343,8 +642,7 @@ bool Blob::text(JSContext *cx, HandleObject self, MutableHandleValue rval) {
 
   MOZ_ASSERT(decoder);
 
-  auto src_len = src->length();
-  auto dst_len = jsencoding::decoder_max_utf16_buffer_length(decoder.get(), src_len);
+  auto dst_len = jsencoding::decoder_max_utf16_buffer_length(decoder.get(), src->length());
 
   JS::UniqueTwoByteChars dst(static_cast<char16_t *>(js_pod_malloc<char16_t>(dst_len + 1)));
   if (!dst) {
@@ -354,9 +652,29 @@ bool Blob::text(JSContext *cx, HandleObject self, MutableHandleValue rval) {
 
   bool had_replacements = false;
   auto *dst_data = reinterpret_cast<uint16_t *>(dst.get());
-
-  jsencoding::decoder_decode_to_utf16(decoder.get(), src->begin(), &src_len, dst_data, &dst_len,
-                                      true, &had_replacements);
+  size_t written = 0;
+
+  // Decode segment by segment: the decoder carries sequences split across segment boundaries
+  // over to the next call, so the data never has to be flattened.
+  auto decode = [&](std::span<const uint8_t> span, bool last) {
+    size_t src_len = span.size();
+    size_t out_len = dst_len - written;
+    jsencoding::decoder_decode_to_utf16(decoder.get(), span.data(), &src_len, dst_data + written,
+                                        &out_len, last, &had_replacements);
+    MOZ_ASSERT(src_len == span.size());
+    written += out_len;
+  };
+
+  bool ok = src->for_each_span(0, [&](std::span<const uint8_t> span) {
+    decode(span, false);
+    return true;
+  });
+  if (!ok) {
+    report_read_error(cx);
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+  decode({}, true);
+  dst_len = written;
 
   JS::RootedString str(cx, JS_NewUCString(cx, std::move(dst), dst_len));
   if (!str) {
@@ -394,9 +712,9 @@ bool Blob::type_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
-Blob::ByteBuffer *Blob::blob(JSObject *self) {
+BlobData *Blob::blob(JSObject *self) {
   MOZ_ASSERT(is_instance(self));
-  auto *blob = static_cast<ByteBuffer *>(
+  auto *blob = static_cast<BlobData *>(
       JS::GetReservedSlot(self, static_cast<size_t>(Blob::Slots::Data)).toPrivate());
 
   MOZ_ASSERT(blob);
@@ -425,16 +743,21 @@ bool Blob::append_value(JSContext *cx, HandleObject self, HandleValue val) {
     RootedObject obj(cx, &val.toObject());
 
     if (Blob::is_instance(obj)) {
-      auto *src = Blob::blob(obj);
-      return blob->append(src->begin(), src->end());
+      if (!blob->append_data(*Blob::blob(obj))) {
+        JS_ReportOutOfMemory(cx);
+        return false;
+      }
+      return true;
     }
 
     if (JS_IsArrayBufferViewObject(obj) || JS::IsArrayBufferObject(obj)) {
       auto span = value_to_buffer(cx, val, "Blob Parts");
       if (span.has_value()) {
-        auto *src = span->data();
-        auto len = span->size();
-        return blob->append(src, src + len);
+        if (!blob->append_bytes(*span)) {
+          JS_ReportOutOfMemory(cx);
+          return false;
+        }
+        return true;
       }
 
       return true;
@@ -447,12 +770,20 @@ bool Blob::append_value(JSContext *cx, HandleObject self, HandleValue val) {
 
     if (line_endings(self) == LineEndings::Native) {
       auto converted = convert_line_endings_to_native(chars);
-      auto *src = converted.data();
-      auto len = converted.length();
-      return blob->append(src, src + len);
+      auto *src = reinterpret_cast<const uint8_t *>(converted.data());
+      if (!blob->append_bytes({src, converted.length()})) {
+        JS_ReportOutOfMemory(cx);
+        return false;
+      }
+      return true;
     }
 
-    return blob->append(chars.ptr.get(), chars.ptr.get() + chars.len);
+    auto *src = reinterpret_cast<const uint8_t *>(chars.ptr.get());
+    if (!blob->append_bytes({src, chars.len})) {
+      JS_ReportOutOfMemory(cx);
+      return false;
+    }
+    return true;
   }
 
   // FALLBACK: if we ever get here convert, to string and call append again
@@ -557,31 +888,36 @@ bool Blob::init_options(JSContext *cx, HandleObject self, HandleValue initv) {
   return true;
 }
 
-JSObject *Blob::create(JSContext *cx, UniqueChars data, size_t data_len, HandleString type) {
+void Blob::init_slots(JSObject *self, js::UniquePtr<BlobData> data, JSString *type) {
+  SetReservedSlot(self, std::to_underlying(Slots::Data), JS::PrivateValue(data.release()));
+  SetReservedSlot(self, std::to_underlying(Slots::Type), JS::StringValue(type));
+  SetReservedSlot(self, std::to_underlying(Slots::Endings), JS::Int32Value(std::to_underlying(LineEndings::Transparent)));
+}
+
+JSObject *Blob::create(JSContext *cx, js::UniquePtr<BlobData> data, HandleString type) {
   JSObject *self = JS_NewObjectWithGivenProto(cx, &class_, proto_obj);
   if (!self) {
     return nullptr;
   }
 
-  auto blob = js::MakeUnique<ByteBuffer>();
+  init_slots(self, std::move(data), type);
+  return self;
+}
+
+JSObject *Blob::create(JSContext *cx, UniqueChars data, size_t data_len, HandleString type) {
+  // Take the ownership of given data.
+  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> bytes(reinterpret_cast<uint8_t *>(data.release()));
+  js::UniquePtr<BlobData> blob(BlobData::create(std::move(bytes), data_len));
   if (!blob) {
     JS_ReportOutOfMemory(cx);
     return nullptr;
   }
 
-  if (data != nullptr) {
-    // Take the ownership of given data.
-    blob->replaceRawBuffer(reinterpret_cast<uint8_t *>(data.release()), data_len);
-  }
-
-  SetReservedSlot(self, std::to_underlying(Slots::Data), JS::PrivateValue(blob.release()));
-  SetReservedSlot(self, std::to_underlying(Slots::Type), JS::StringValue(type));
-  SetReservedSlot(self, std::to_underlying(Slots::Endings), JS::Int32Value(std::to_underlying(LineEndings::Transparent)));
-  return self;
+  return create(cx, std::move(blob), type);
 }
 
 bool Blob::init(JSContext *cx, HandleObject self, HandleValue blobParts, HandleValue opts) {
-  auto blob = js::MakeUnique<ByteBuffer>();
+  auto *blob = BlobData::create();
   if (blob == nullptr) {
     JS_ReportOutOfMemory(cx);
     return false;
@@ -589,9 +925,9 @@ bool Blob::init(JSContext *cx, HandleObject self, HandleValue blobParts, HandleV
 
   SetReservedSlot(self, std::to_underlying(Slots::Type), JS_GetEmptyStringValue(cx));
   SetReservedSlot(self, std::to_underlying(Slots::Endings), JS::Int32Value(std::to_underlying(LineEndings::Transparent)));
-  SetReservedSlot(self, std::to_underlying(Slots::Data), JS::PrivateValue(blob.release()));
+  SetReservedSlot(self, std::to_underlying(Slots::Data), JS::PrivateValue(blob));
 
-  // Walk the blob parts and append them to the blob's buffer.
+  // Walk the blob parts and append them to the blob's data.
   if (blobParts.isNull()) {
     return api::throw_error(cx, api::Errors::TypeError, "Blob.constructor", "blobParts", "be an object");
   }
@@ -600,6 +936,11 @@ bool Blob::init(JSContext *cx, HandleObject self, HandleValue blobParts, HandleV
     return false;
   }
 
+  if (!blob->finish()) {
+    JS_ReportOutOfMemory(cx);
+    return false;
+  }
+
   if (!opts.isNullOrUndefined() && !init_options(cx, self, opts)) {
     return false;
   }
@@ -632,10 +973,12 @@ bool Blob::init_class(JSContext *cx, JS::HandleObject global) {
 
 void Blob::finalize(JS::GCContext *gcx, JSObject *self) {
   MOZ_ASSERT(is_instance(self));
-  auto *blob = Blob::blob(self);
-  if (blob) {
-    js_delete(blob);
+  // The data is missing for prototypes, and for instances whose initialization failed.
+  auto slot = JS::GetReservedSlot(self, std::to_underlying(Slots::Data));
+  if (slot.isUndefined()) {
+    return;
   }
+  js_delete(static_cast<BlobData *>(slot.toPrivate()));
 }
 
 bool install(api::Engine *engine) {
@@ -4,12 +4,211 @@
 #include "builtin.h"
 #include "extension-api.h"
 #include "js/AllocPolicy.h"
+#include "js/RefCounted.h"
+#include "js/UniquePtr.h"
 #include "js/Vector.h"
+#include "mozilla/RefPtr.h"
+
+#include <sys/stat.h>
 
 
 
 namespace builtins::web::blob {
 
+/// An immutable chunk of Blob data.
+///
+/// Segments are shared by all Blobs that contain them, either because a Blob was passed as a
+/// part to another Blob's constructor, or because it was sliced. A segment is freed once the last
+/// Blob referring to it is finalized.
+///
+/// A segment's data is either held in memory, or is a range of a file that is only read when the
+/// data is needed. File-backed segments capture the file's size and modification time when
+/// created, and fail to read if the file has been changed since.
+class BlobSegment final : public js::RefCounted<BlobSegment> {
+public:
+  struct FileBacking;
+
+private:
+  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data_;
+  js::UniquePtr<FileBacking> file_;
+  size_t length_;
+
+public:
+  BlobSegment(mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data, size_t length);
+  BlobSegment(js::UniquePtr<FileBacking> file, size_t length);
+  ~BlobSegment();
+
+  /// Creates a segment backed by `length` bytes of the regular file at `path`, starting at
+  /// `offset`. `st` is the result of `stat`ing the file, which reads are checked against.
+  /// Returns nullptr with `errno` set on OOM.
+  static BlobSegment *create_for_file(const char *path, const struct stat &st, size_t offset,
+                                      size_t length);
+
+  [[nodiscard]] bool in_memory() const { return data_ != nullptr; }
+  [[nodiscard]] size_t length() const { return length_; }
+
+  /// Returns the segment's data. Only valid for in-memory segments.
+  [[nodiscard]] std::span<const uint8_t> span() const {
+    MOZ_ASSERT(in_memory());
+    return {data_.get(), length_};
+  }
+
+  /// Copies `dst.size()` bytes starting at `offset` into `dst`. Returns false if the segment is
+  /// backed by a file that can't be read anymore.
+  bool read(size_t offset, std::span<uint8_t> dst) const;
+};
+
+/// The list of segment ranges a Blob's data was assembled from.
+///
+/// A rope is only appended to while the Blob owning it is being constructed. Consecutive parts
+/// that have to be copied, such as strings and buffer sources, are collected into a single
+/// segment, whereas parts that are Blobs themselves share that Blob's segments. Once constructed,
+/// a rope is immutable, and can be shared by any number of `BlobData` views.
+class BlobRope final : public js::RefCounted<BlobRope> {
+  struct Range {
+    RefPtr<BlobSegment> segment;
+    // Offset of the range within the segment.
+    size_t offset;
+    // Offset of the range within the rope.
+    size_t start;
+    size_t length;
+  };
+
+  js::Vector<Range, 1, js::SystemAllocPolicy> ranges_;
+  // Copied bytes that haven't been turned into a segment yet.
+  js::Vector<uint8_t, 0, js::SystemAllocPolicy> pending_;
+  size_t length_ = 0;
+
+  [[nodiscard]] size_t find_range(size_t pos) const;
+
+public:
+  static constexpr size_t FILE_CHUNK_SIZE = 64 * 1024;
+
+  /// Ranges of other segments smaller than this are copied instead of shared, so that assembling
+  /// a Blob from many small pieces doesn't leave it fragmented into tiny ranges.
+  static constexpr size_t MIN_SHARED_RANGE_LENGTH = 256;
+
+  [[nodiscard]] size_t length() const { return length_; }
+
+  /// Appends a copy of `bytes`.
+  bool append_bytes(std::span<const uint8_t> bytes);
+
+  /// Appends `[offset, offset + length)` of `segment`, without copying it.
+  bool append_segment(BlobSegment *segment, size_t offset, size_t length);
+
+  /// Appends `[start, start + length)` of `src`, sharing its segments.
+  bool append_rope(const BlobRope &src, size_t start, size_t length);
+
+  /// Turns all pending copied bytes into a segment. Must be called before the rope is read.
+  bool finish();
+
+  /// Copies `dst.size()` bytes starting at `start` into `dst`. Returns false if a file-backed
+  /// segment couldn't be read.
+  bool read(size_t start, std::span<uint8_t> dst) const;
+
+  /// Calls `f` with consecutive spans covering `[start, start + length)` of the rope, until `f`
+  /// returns false. Data of file-backed segments is read in chunks of up to `FILE_CHUNK_SIZE`
+  /// bytes, and only valid for the duration of the call to `f`.
+  ///
+  /// Returns false if a file-backed segment couldn't be read.
+  template <typename F> bool for_each_span(size_t start, size_t length, F &&f) const {
+    MOZ_ASSERT(pending_.empty());
+    MOZ_ASSERT(start + length <= length_);
+    mozilla::UniquePtr<uint8_t[], JS::FreePolicy> chunk;
+    size_t end = start + length;
+    for (size_t i = find_range(start); i < ranges_.length() && start < end; i++) {
+      const auto &range = ranges_[i];
+      size_t offset = range.offset + start - range.start;
+      size_t n = std::min(range.length - (start - range.start), end - start);
+      start += n;
+
+      if (range.segment->in_memory()) {
+        if (!f(range.segment->span().subspan(offset, n))) {
+          return true;
+        }
+        continue;
+      }
+
+      if (!chunk) {
+        chunk.reset(js_pod_malloc<uint8_t>(FILE_CHUNK_SIZE));
+        if (!chunk) {
+          return false;
+        }
+      }
+
+      while (n > 0) {
+        size_t chunk_len = std::min(n, FILE_CHUNK_SIZE);
+        std::span<uint8_t> buf(chunk.get(), chunk_len);
+        if (!range.segment->read(offset, buf)) {
+          return false;
+        }
+        if (!f(std::span<const uint8_t>(buf))) {
+          return true;
+        }
+        offset += chunk_len;
+        n -= chunk_len;
+      }
+    }
+
+    return true;
+  }
+};
+
+/// A Blob's data: a view of `length` bytes into a rope, starting at `offset`.
+///
+/// Slicing a Blob creates a new view into the same rope, so neither the rope nor any of its
+/// segments have to be copied. A contiguous copy of the data is only created when it has to be
+/// handed out as a single buffer, e.g. by `arrayBuffer()` and `bytes()`.
+class BlobData final {
+  RefPtr<BlobRope> rope_;
+  size_t offset_;
+  size_t length_;
+
+public:
+  BlobData(BlobRope *rope, size_t offset, size_t length)
+      : rope_(rope), offset_(offset), length_(length) {}
+
+  /// Creates the data for a Blob under construction, or returns nullptr on OOM.
+  static BlobData *create();
+
+  /// Creates the data for a Blob taking ownership of `data`, or returns nullptr on OOM.
+  static BlobData *create(mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data, size_t length);
+
+  /// Creates the data for a Blob backed by the file at `path`, which is only read on demand.
+  /// Returns nullptr with `errno` set if the file can't be opened.
+  static BlobData *create_for_file(const char *path);
+
+  [[nodiscard]] size_t length() const { return length_; }
+
+  /// Appends a Blob part. Only valid while the owning Blob is being constructed.
+  bool append_bytes(std::span<const uint8_t> bytes);
+  bool append_segment(BlobSegment *segment, size_t offset, size_t length);
+  bool append_data(const BlobData &src);
+  bool finish() { return rope_->finish(); }
+
+  /// Returns a new view of `[start, start + length)` of this Blob's data, or nullptr on OOM.
+  [[nodiscard]] BlobData *slice(size_t start, size_t length) const;
+
+  /// Copies up to `dst.size()` bytes starting at `start` into `dst`, storing the number of bytes
+  /// copied in `read`. Returns false if a file backing the data couldn't be read.
+  bool read(size_t start, std::span<uint8_t> dst, size_t *read) const;
+
+  /// Calls `f` with consecutive spans covering `[start, start + length)` of the data, until `f`
+  /// returns false. See `BlobRope::for_each_span`.
+  template <typename F> bool for_each_span(size_t start, size_t length, F &&f) const {
+    MOZ_ASSERT(start + length <= length_);
+    return rope_->for_each_span(offset_ + start, length, std::forward<F>(f));
+  }
+
+  /// Calls `f` with consecutive spans covering the data from `start` onwards.
+  template <typename F> bool for_each_span(size_t start, F &&f) const {
+    if (start >= length_) {
+      return true;
+    }
+    return for_each_span(start, length_ - start, std::forward<F>(f));
+  }
+};
+
 class Blob : public BuiltinImpl<Blob, FinalizableClassPolicy> {
   static bool arrayBuffer(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool bytes(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -32,15 +231,13 @@ public:
   enum class Slots : uint8_t { Data, Type, Endings, Readers, Count };
   enum class LineEndings : uint8_t { Transparent, Native };
 
-  using ByteBuffer = js::Vector<uint8_t, 0, js::SystemAllocPolicy>;
-
   static bool arrayBuffer(JSContext *cx, HandleObject self, MutableHandleValue rval);
   static bool bytes(JSContext *cx, HandleObject self, MutableHandleValue rval);
   static bool stream(JSContext *cx, HandleObject self, MutableHandleValue rval);
   static bool text(JSContext *cx, HandleObject self, MutableHandleValue rval);
   static bool slice(JSContext *cx, HandleObject self, const CallArgs &args, MutableHandleValue rval);
 
-  static ByteBuffer *blob(JSObject *self);
+  static BlobData *blob(JSObject *self);
   static size_t blob_size(JSObject *self);
   static JSString *type(JSObject *self);
   static LineEndings line_endings(JSObject *self);
@@ -54,8 +251,14 @@ public:
   static bool read_blob_slice(JSContext *cx, HandleObject self, std::span<uint8_t> buf,
                               size_t start, size_t *read, bool *done);
 
+  /// Throws a `NotReadableError` for a Blob whose backing file couldn't be read.
+  static bool report_read_error(JSContext *cx);
+
   static JSString *normalize_type(JSContext *cx, JS::HandleValue value);
   static JSObject *create(JSContext *cx, UniqueChars data, size_t data_len, HandleString type);
+  static JSObject *create(JSContext *cx, js::UniquePtr<BlobData> data, HandleString type);
+  /// Initializes the slots of a newly created Blob or File, taking ownership of `data`.
+  static void init_slots(JSObject *self, js::UniquePtr<BlobData> data, JSString *type);
 
   static bool init_class(JSContext *cx, HandleObject global);
   static bool constructor(JSContext *cx, unsigned argc, Value *vp);
@@ -2,10 +2,18 @@
 #include "openssl/sha.h"
 #include <fmt/format.h>
 #include <openssl/core_names.h>
+#include <openssl/crypto.h>
 #include <openssl/ecdsa.h>
 #include <openssl/err.h>
+#include <openssl/params.h>
+#include <openssl/x509.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <optional>
 #include <span>
+#include <utility>
 #include <vector>
 
 #include "../base64.h"
@@ -16,6 +24,7 @@
 #include "crypto-key-rsa-components.h"
 #include "crypto-raii.h"
 #include "encode.h"
+#include "host_api.h"
 
 namespace builtins::web::crypto {
 
@@ -25,6 +34,148 @@ using dom_exception::DOMException;
 
 int num_bits_to_bytes(int x) { return (x / 8) + ((7 + (x % 8)) / 8); }
 
+namespace {
+
+using OutputPtr = mozilla::UniquePtr<uint8_t[], JS::FreePolicy>;
+
+// The largest DER encoding of an ECDSA signature on any of the supported curves: a SEQUENCE of
+// two INTEGERs of at most 67 bytes each for P-521, including their headers.
+constexpr size_t MAX_ECDSA_DER_SIZE = 160;
+
+// Results of operations are written straight into the allocation that backs the ArrayBuffer
+// returned to content: `allocateOutput` allocates the largest size the result can have, and
+// `toArrayBuffer` hands the allocation over to an ArrayBuffer of the result's actual size.
+OutputPtr allocateOutput(JSContext *cx, size_t capacity) {
+  OutputPtr output{static_cast<uint8_t *>(JS_malloc(cx, std::max<size_t>(capacity, 1)))};
+  if (!output) {
+    JS_ReportOutOfMemory(cx);
+  }
+  return output;
+}
+
+// Takes ownership of `output`, of which `length` bytes are used, and returns a new ArrayBuffer
+// holding it.
+JSObject *toArrayBuffer(JSContext *cx, OutputPtr output, size_t length) {
+  JS::RootedObject array_buffer(cx, JS::NewArrayBufferWithContents(
+      cx, length, output.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+  if (!array_buffer) {
+    // We can be here if the array buffer was too large -- if that was the case then a
+    // JSMSG_BAD_ARRAY_LENGTH will have been created. Otherwise we're probably out of memory.
+    if (!JS_IsExceptionPending(cx)) {
+      JS_ReportOutOfMemory(cx);
+    }
+    return nullptr;
+  }
+
+  // `array_buffer` now owns `output`
+  static_cast<void>(output.release());
+  return array_buffer;
+}
+
+// A digest that's only used as the input of another operation, so it's kept on the stack.
+class RawDigest final {
+  std::array<uint8_t, EVP_MAX_MD_SIZE> bytes_{};
+  unsigned int size_ = 0;
+
+  friend std::optional<RawDigest> rawDigest(JSContext *cx, std::span<uint8_t> data,
+                                            const EVP_MD *algorithm);
+
+public:
+  [[nodiscard]] const uint8_t *data() const { return bytes_.data(); }
+  [[nodiscard]] size_t size() const { return size_; }
+};
+
+// This implements https://w3c.github.io/webcrypto/#sha-operations for all
+// the SHA algorithms that we support.
+std::optional<RawDigest> rawDigest(JSContext *cx, std::span<uint8_t> data,
+                                   const EVP_MD *algorithm) {
+  RawDigest digest;
+  if (EVP_Digest(data.data(), data.size(), digest.bytes_.data(), &digest.size_, algorithm,
+                 nullptr) == 0) {
+    // 2. If performing the operation results in an error, then throw an OperationError.
+    DOMException::raise(cx, "SubtleCrypto.digest: failed to create digest", "OperationError");
+    return std::nullopt;
+  }
+  return digest;
+}
+
+using OffloadResult = std::optional<host_api::Result<host_api::HostBytes>>;
+
+// Whether CPU-heavy operations can be offloaded to the host. Host calls aren't available during
+// pre-initialization, so operations performed then always run in the guest.
+bool canOffload(JSContext *cx) {
+  return host_api::CryptoOffload::enabled() &&
+         api::Engine::get(cx)->state() == api::EngineState::Initialized;
+}
+
+// Returns the host's identifier for the hash function `algorithm`, if it has one.
+std::optional<host_api::CryptoOffload::Hash> offloadHash(const EVP_MD *algorithm) {
+  using Hash = host_api::CryptoOffload::Hash;
+  switch (algorithm ? EVP_MD_get_type(algorithm) : NID_undef) {
+  case NID_sha1:
+    return Hash::SHA1;
+  case NID_sha256:
+    return Hash::SHA256;
+  case NID_sha384:
+    return Hash::SHA384;
+  case NID_sha512:
+    return Hash::SHA512;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Returns a new ArrayBuffer holding the result of an operation offloaded to the host, or `nullptr`
+// with an OperationError pending if the operation failed. Returns `std::nullopt` if the host
+// declined the operation, in which case the caller performs it itself.
+//
+// Results outside of [`min_size`, `max_size`] can't be correct, so they're treated as failures,
+// too. Otherwise, the ArrayBuffer takes over the host's allocation of the result, which is made
+// with `cabi_realloc` and thus by `JS_malloc`, instead of copying it.
+std::optional<JSObject *> offloadedResult(JSContext *cx, OffloadResult result, size_t min_size,
+                                          size_t max_size, const char *error) {
+  if (!result.has_value()) {
+    return std::nullopt;
+  }
+  if (result->is_err() || result->unwrap().len < min_size || result->unwrap().len > max_size) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+  auto &bytes = result->unwrap();
+  if (bytes.len == 0) {
+    auto output = allocateOutput(cx, 0);
+    return output ? toArrayBuffer(cx, std::move(output), 0) : nullptr;
+  }
+  size_t length = bytes.len;
+  return toArrayBuffer(cx, OutputPtr(bytes.ptr.release()), length);
+}
+
+// Offloads signing `data` with the private `key` to the host, using `sign`, one of the signing
+// functions of `host_api::CryptoOffload`. The key is passed in its PKCS #8 encoding, which the key
+// caches. Signatures other than `signature_size` bytes long are treated as failures.
+template <typename Sign>
+std::optional<JSObject *> offloadSign(JSContext *cx, JS::HandleObject key, const EVP_MD *algorithm,
+                                      std::span<uint8_t> data, size_t signature_size, Sign sign) {
+  if (!canOffload(cx)) {
+    return std::nullopt;
+  }
+  auto hash = offloadHash(algorithm);
+  if (!hash.has_value()) {
+    return std::nullopt;
+  }
+
+  // Encoding failures leave it to the guest to report errors.
+  auto pkcs8 = CryptoKey::pkcs8(key);
+  if (pkcs8.empty()) {
+    return std::nullopt;
+  }
+
+  return offloadedResult(cx, sign(pkcs8, hash.value(), data), signature_size, signature_size,
+                         "SubtleCrypto.sign: failed to sign");
+}
+
+} // namespace
+
 std::pair<mozilla::UniquePtr<uint8_t[], JS::FreePolicy>, size_t>
 to_bytes_expand(JSContext *cx, const BIGNUM *bignum, size_t minimumBufferSize) {
   int length = BN_num_bytes(bignum);
@@ -108,29 +259,13 @@ const EVP_MD *createDigestAlgorithm(JSContext *cx, JS::HandleObject key) {
   DOMException::raise(cx, "NotSupportedError", "NotSupportedError");
   return nullptr;
 }
-// This implements https://w3c.github.io/webcrypto/#sha-operations for all
-// the SHA algorithms that we support.
-std::optional<std::vector<uint8_t>> rawDigest(JSContext *cx, std::span<uint8_t> data,
-                                              const EVP_MD *algorithm, size_t buffer_size) {
-  unsigned int size = 0;
-  std::vector<uint8_t> buf(buffer_size, 0);
-  if (EVP_Digest(data.data(), data.size(), buf.data(), &size, algorithm, nullptr) == 0) {
-    // 2. If performing the operation results in an error, then throw an OperationError.
-    DOMException::raise(cx, "SubtleCrypto.digest: failed to create digest", "OperationError");
-    return std::nullopt;
-  }
-  return {std::move(buf)};
-};
-
 // This implements https://w3c.github.io/webcrypto/#sha-operations for all
 // the SHA algorithms that we support.
 JSObject *digest(JSContext *cx, std::span<uint8_t> data, const EVP_MD *algorithm,
                  size_t buffer_size) {
   unsigned int size = 0;
-  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> buf{
-      static_cast<uint8_t *>(JS_malloc(cx, buffer_size))};
+  auto buf = allocateOutput(cx, buffer_size);
   if (!buf) {
-    JS_ReportOutOfMemory(cx);
     return nullptr;
   }
   if (EVP_Digest(data.data(), data.size(), buf.get(), &size, algorithm, nullptr) == 0) {
@@ -139,18 +274,7 @@ JSObject *digest(JSContext *cx, std::span<uint8_t> data, const EVP_MD *algorithm
     return nullptr;
   }
   // 3. Return a new ArrayBuffer containing result.
-  JS::RootedObject array_buffer(cx);
-  array_buffer.set(JS::NewArrayBufferWithContents(
-      cx, size, buf.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-  if (!array_buffer) {
-    JS_ReportOutOfMemory(cx);
-    return nullptr;
-  }
-
-  // `array_buffer` now owns `buf`
-  static_cast<void>(buf.release());
-
-  return array_buffer;
+  return toArrayBuffer(cx, std::move(buf), size);
 };
 
 // https://datatracker.ietf.org/doc/html/rfc7518#section-6.3.1
@@ -173,14 +297,7 @@ std::unique_ptr<CryptoKeyRSAComponents> createRSAPublicKeyFromJWK(JSContext *cx,
   if (modulus.starts_with('0')) {
     modulus = modulus.erase(0, 1);
   }
-  auto dataResult = base64::stringToJSByteString(cx, jwk->e.value());
-  if (dataResult.isErr()) {
-    DOMException::raise(cx, "Data provided to an operation does not meet requirements",
-                        "DataError");
-    return nullptr;
-  }
-  auto data = dataResult.unwrap();
-  auto exponentResult = base64::forgivingBase64Decode(data, base64::base64URLDecodeTable);
+  auto exponentResult = base64::forgivingBase64Decode(jwk->e.value(), base64::base64URLDecodeTable);
   if (exponentResult.isErr()) {
     DOMException::raise(
         cx, "The JWK member 'e' could not be base64url decoded or contained padding", "DataError");
@@ -265,14 +382,7 @@ std::unique_ptr<CryptoKeyRSAComponents> createRSAPrivateKeyFromJWK(JSContext *cx
   if (modulus.starts_with('0')) {
     modulus = modulus.erase(0, 1);
   }
-  auto dataResult = base64::stringToJSByteString(cx, jwk->e.value_or(""));
-  if (dataResult.isErr()) {
-    DOMException::raise(cx, "Data provided to an operation does not meet requirements",
-                        "DataError");
-    return nullptr;
-  }
-  auto data = dataResult.unwrap();
-  auto exponentResult = base64::forgivingBase64Decode(data, base64::base64URLDecodeTable);
+  auto exponentResult = base64::forgivingBase64Decode(jwk->e.value_or(""), base64::base64URLDecodeTable);
   if (exponentResult.isErr()) {
     DOMException::raise(
         cx, "The JWK member 'e' could not be base64url decoded or contained padding", "DataError");
@@ -381,12 +491,29 @@ std::unique_ptr<CryptoKeyRSAComponents> createRSAPrivateKeyFromJWK(JSContext *cx
   return privateKeyComponents;
 }
 
+JS::Result<CryptoAlgorithmIdentifier> normalizeIdentifier(JSContext *cx, JS::HandleValue value);
+
 JS::Result<CryptoAlgorithmIdentifier> toHashIdentifier(JSContext *cx, JS::HandleValue value) {
-  auto normalizedHashAlgorithm = CryptoAlgorithmDigest::normalize(cx, value);
-  if (!normalizedHashAlgorithm) {
+  // Equivalent to `CryptoAlgorithmDigest::normalize(cx, value)->identifier()`, without allocating
+  // an algorithm object that'd be thrown away immediately.
+  auto identifierResult = normalizeIdentifier(cx, value);
+  if (identifierResult.isErr()) {
+    return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
+  }
+  auto identifier = identifierResult.unwrap();
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::MD5:
+  case CryptoAlgorithmIdentifier::SHA_1:
+  case CryptoAlgorithmIdentifier::SHA_256:
+  case CryptoAlgorithmIdentifier::SHA_384:
+  case CryptoAlgorithmIdentifier::SHA_512: {
+    return identifier;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the digest operation", "NotSupportedError");
     return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
   }
-  return normalizedHashAlgorithm->identifier();
+  }
 }
 
 std::optional<NamedCurve> toNamedCurve(std::string_view name) {
@@ -412,29 +539,35 @@ JS::Result<NamedCurve> toNamedCurve(JSContext *cx, JS::HandleValue value) {
   return JS::Result<NamedCurve>(JS::Error());
 }
 
+// Returns the size of the curve of the EC key `key`, in bits. This is read from the key itself
+// rather than from the namedCurve member of its algorithm, which script can modify.
 JS::Result<size_t> curveSize(JSContext *cx, JS::HandleObject key) {
-  JS::RootedObject alg(cx, CryptoKey::get_algorithm(key));
-  JS::RootedValue namedCurve_val(cx);
-
-  JS_GetProperty(cx, alg, "namedCurve", &namedCurve_val);
-  auto namedCurve_chars = core::encode(cx, namedCurve_val);
-  if (!namedCurve_chars) {
+  int bits = EVP_PKEY_get_bits(CryptoKey::key(key));
+  if (bits != 256 && bits != 384 && bits != 521) {
+    DOMException::raise(cx, "Unsupported curve", "OperationError");
     return JS::Result<size_t>(JS::Error());
   }
+  return bits;
+}
 
-  std::string_view namedCurve = namedCurve_chars;
-  if (namedCurve == "P-256") {
-    return 256;
-  }
-  if (namedCurve == "P-384") {
-    return 384;
-  }
-  if (namedCurve == "P-521") {
-    return 521;
-  }
+namespace {
+
+constexpr size_t ALGORITHM_COUNT = std::to_underlying(CryptoAlgorithmIdentifier::PBKDF2) + 1;
+
+// Pinned atoms for the registered algorithm names, indexed by `CryptoAlgorithmIdentifier`.
+std::array<JSString *, ALGORITHM_COUNT> algorithmAtoms;
+JSString *nameAtom;
+
+} // namespace
 
-  MOZ_ASSERT_UNREACHABLE();
-  return 0;
+bool initAlgorithmNames(JSContext *cx) {
+  for (size_t i = 0; i < ALGORITHM_COUNT; i++) {
+    auto name = algorithmName(static_cast<CryptoAlgorithmIdentifier>(i));
+    if (!(algorithmAtoms[i] = JS_AtomizeAndPinString(cx, name))) {
+      return false;
+    }
+  }
+  return (nameAtom = JS_AtomizeAndPinString(cx, "name")) != nullptr;
 }
 
 // This implements the first section of
@@ -466,9 +599,11 @@ JS::Result<CryptoAlgorithmIdentifier> normalizeIdentifier(JSContext *cx, JS::Han
   // 4. Let algName be the value of the name attribute of initialAlg.
   JS::Rooted<JSString *> algName(cx);
   if (value.isObject()) {
+    MOZ_ASSERT(nameAtom, "initAlgorithmNames must have been called");
     JS::Rooted<JSObject *> params(cx, &value.toObject());
+    JS::RootedId name_id(cx, JS::PropertyKey::fromPinnedString(nameAtom));
     JS::Rooted<JS::Value> name_val(cx);
-    if (!JS_GetProperty(cx, params, "name", &name_val)) {
+    if (!JS_GetPropertyById(cx, params, name_id, &name_val)) {
       return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
     }
     algName.set(JS::ToString(cx, name_val));
@@ -482,6 +617,15 @@ JS::Result<CryptoAlgorithmIdentifier> normalizeIdentifier(JSContext *cx, JS::Han
     return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
   }
 
+  // Names given as string literals, e.g. in `crypto.subtle.digest("SHA-256", data)`, are atoms,
+  // and so the very same strings as the pinned atoms created for the registered names. Those are
+  // recognized by comparing pointers, without decoding the name.
+  for (size_t i = 0; i < ALGORITHM_COUNT; i++) {
+    if (algName == algorithmAtoms[i]) {
+      return static_cast<CryptoAlgorithmIdentifier>(i);
+    }
+  }
+
   // TODO: We convert from JSString to std::string quite a lot in the codebase, should we pull this
   // logic out into a new function?
   auto algorithmChars = core::encode(cx, algName);
@@ -741,41 +885,24 @@ CryptoAlgorithmSignVerify::normalize(JSContext *cx, JS::HandleValue value) {
 
 
 namespace {
-  std::optional<std::pair<mozilla::UniquePtr<uint8_t[], JS::FreePolicy>, size_t>> hmacSignature(JSContext *cx,
-  const EVP_MD* algorithm, const std::span<uint8_t>& keyData, const std::span<uint8_t> data) {
-    EvpMdCtxPtr ctx(EVP_MD_CTX_new());
+  // Writes the HMAC of `data` to `out`, which must be at least `EVP_MD_size(algorithm)` bytes
+  // long, and returns its length.
+  std::optional<size_t> hmacSignature(JS::HandleObject key, const EVP_MD* algorithm,
+                                      const std::span<uint8_t> data, std::span<uint8_t> out) {
+    EvpMacCtxPtr ctx = CryptoKey::hmacContext(key, algorithm);
     if (!ctx) {
       return std::nullopt;
     }
 
-    EvpPkeyPtr hkey(EVP_PKEY_new_mac_key(EVP_PKEY_HMAC, nullptr, keyData.data(), keyData.size()));
-    if (!hkey) {
-      return std::nullopt;
-    }
-
-    if (1 != EVP_DigestSignInit(ctx.get(), nullptr, algorithm, nullptr, hkey.get())) {
-      return std::nullopt;
-    }
-
-    if (1 != EVP_DigestSignUpdate(ctx.get(), data.data(), data.size())) {
+    if (1 != EVP_MAC_update(ctx.get(), data.data(), data.size())) {
       return std::nullopt;
     }
 
     size_t len = 0;
-    if (1 != EVP_DigestSignFinal(ctx.get(), nullptr, &len)) {
-      return std::nullopt;
-    }
-
-    mozilla::UniquePtr<uint8_t[], JS::FreePolicy> cipherText{static_cast<uint8_t *>(JS_malloc(cx, len))};
-    if (!cipherText) {
-      JS_ReportOutOfMemory(cx);
-      return std::nullopt;
-    }
-
-    if (1 != EVP_DigestSignFinal(ctx.get(), cipherText.get(), &len)) {
+    if (1 != EVP_MAC_final(ctx.get(), out.data(), &len, out.size())) {
       return std::nullopt;
     }
-    return std::pair<mozilla::UniquePtr<uint8_t[], JS::FreePolicy>, size_t>(std::move(cipherText), len);
+    return len;
   }
 }
 
@@ -789,28 +916,19 @@ JSObject *CryptoAlgorithmHMAC_Sign_Verify::sign(JSContext *cx, JS::HandleObject
     return nullptr;
   }
 
-  std::span<uint8_t> keyData = CryptoKey::hmacKeyData(key);
-  auto result = hmacSignature(cx, algorithm, keyData, data);
-  if (!result.has_value()) {
-    DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
+  size_t capacity = EVP_MD_size(algorithm);
+  auto sig = allocateOutput(cx, capacity);
+  if (!sig) {
     return nullptr;
   }
-  auto sig = std::move(result.value().first);
-  auto size = result.value().second;
-
-  // 2. Return a new ArrayBuffer object, associated with the relevant global object of this [HTML], and containing the bytes of mac.
-  JS::RootedObject array_buffer(cx);
-  array_buffer.set(JS::NewArrayBufferWithContents(cx, size, sig.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-  if (!array_buffer) {
-    JS_ReportOutOfMemory(cx);
+  auto size = hmacSignature(key, algorithm, data, {sig.get(), capacity});
+  if (!size.has_value()) {
+    DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
     return nullptr;
   }
 
-   // `array_buffer` now owns `sig`
-  static_cast<void>(sig.release());
-
-  return array_buffer;
-
+  // 2. Return a new ArrayBuffer object, associated with the relevant global object of this [HTML], and containing the bytes of mac.
+  return toArrayBuffer(cx, std::move(sig), size.value());
 };
 JS::Result<bool> CryptoAlgorithmHMAC_Sign_Verify::verify(JSContext *cx, JS::HandleObject key, std::span<uint8_t> signature, std::span<uint8_t> data) {
   MOZ_ASSERT(CryptoKey::is_instance(key));
@@ -821,18 +939,16 @@ JS::Result<bool> CryptoAlgorithmHMAC_Sign_Verify::verify(JSContext *cx, JS::Hand
     return JS::Result<bool>(JS::Error());
   }
 
-  std::span<uint8_t> keyData = CryptoKey::hmacKeyData(key);
-  auto result = hmacSignature(cx, algorithm, keyData, data);
-  if (!result.has_value()) {
+  std::array<uint8_t, EVP_MAX_MD_SIZE> sig;
+  auto size = hmacSignature(key, algorithm, data, sig);
+  if (!size.has_value()) {
     DOMException::raise(cx, "SubtleCrypto.verify: failed to verify", "OperationError");
     return JS::Result<bool>(JS::Error());
   }
-  auto sig = std::move(result.value().first);
-  auto size = result.value().second;
-
 
   // 2. Return true if mac is equal to signature and false otherwise.
-  bool match = size == signature.size() && (CRYPTO_memcmp(sig.get(), signature.data(), size) == 0);
+  bool match = size.value() == signature.size() &&
+               (CRYPTO_memcmp(sig.data(), signature.data(), size.value()) == 0);
   return match;
 };
 JSObject *CryptoAlgorithmHMAC_Sign_Verify::toObject(JSContext *cx) {
@@ -855,8 +971,22 @@ JSObject *CryptoAlgorithmECDSA_Sign_Verify::sign(JSContext *cx, JS::HandleObject
     return nullptr;
   }
 
+  auto keySize = curveSize(cx, key);
+  if (keySize.isErr()) {
+    return nullptr;
+  }
+  int coord_size = num_bits_to_bytes(keySize.unwrap());
+  size_t result_size = coord_size * 2;
+
+  // The host performs all remaining steps if it supports offloading them.
+  auto offloaded =
+      offloadSign(cx, key, algorithm, data, result_size, host_api::CryptoOffload::ecdsa_sign);
+  if (offloaded.has_value()) {
+    return offloaded.value();
+  }
+
   // 3. Let M be the result of performing the digest operation specified by hashAlgorithm using message.
-  auto digestOption = rawDigest(cx, data, algorithm, EVP_MD_size(algorithm));
+  auto digestOption = rawDigest(cx, data, algorithm);
   if (!digestOption.has_value()) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return nullptr;
@@ -865,34 +995,21 @@ JSObject *CryptoAlgorithmECDSA_Sign_Verify::sign(JSContext *cx, JS::HandleObject
   const auto& digest = digestOption.value();
 
   // 4. Let d be the ECDSA private key associated with key.
-  EVP_PKEY *pkey = CryptoKey::key(key);
-  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(pkey, nullptr));
-  if (!ctx ||
-      EVP_PKEY_sign_init(ctx.get()) <= 0 ||
-      EVP_PKEY_CTX_set_signature_md(ctx.get(), algorithm) <= 0) {
-    DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
-    return nullptr;
-  }
-
-  size_t derLen = 0;
-  if (EVP_PKEY_sign(ctx.get(), nullptr, &derLen, digest.data(), digest.size()) <= 0) {
+  EvpPkeyCtxPtr ctx = CryptoKey::signatureContext(key, true, algorithm);
+  if (!ctx) {
     DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
     return nullptr;
   }
 
-  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> derBuf{
-    static_cast<uint8_t *>(JS_malloc(cx, derLen))};
-  if (!derBuf) {
-    JS_ReportOutOfMemory(cx);
-    return nullptr;
-  }
-
-  if (EVP_PKEY_sign(ctx.get(), derBuf.get(), &derLen, digest.data(), digest.size()) <= 0) {
+  // OpenSSL produces DER encoded signatures, which are converted to the raw `r | s` form below.
+  std::array<uint8_t, MAX_ECDSA_DER_SIZE> derBuf;
+  size_t derLen = derBuf.size();
+  if (EVP_PKEY_sign(ctx.get(), derBuf.data(), &derLen, digest.data(), digest.size()) <= 0) {
     DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
     return nullptr;
   }
 
-  const unsigned char *p = derBuf.get();
+  const unsigned char *p = derBuf.data();
   EcdsaSigPtr sig(d2i_ECDSA_SIG(nullptr, &p, derLen));
   if (!sig) {
     DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
@@ -911,36 +1028,19 @@ JSObject *CryptoAlgorithmECDSA_Sign_Verify::sign(JSContext *cx, JS::HandleObject
   const BIGNUM *r_raw = nullptr;
   const BIGNUM *s_raw = nullptr;
   ECDSA_SIG_get0(sig.get(), &r_raw, &s_raw);
-  size_t coord_size = num_bits_to_bytes(curveSize(cx, key).unwrap());
-
-  auto [r_bytes, r_len] = to_bytes_expand(cx, r_raw, coord_size);
-  auto [s_bytes, s_len] = to_bytes_expand(cx, s_raw, coord_size);
-
-  size_t result_size = r_len + s_len;
-  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> result{
-    static_cast<uint8_t *>(JS_malloc(cx, result_size))};
+  auto result = allocateOutput(cx, result_size);
   if (!result) {
-    JS_ReportOutOfMemory(cx);
     return nullptr;
   }
 
-  memcpy(result.get(), r_bytes.get(), r_len);
-  memcpy(result.get() + r_len, s_bytes.get(), s_len);
-
-  // 7. Return the result of creating an ArrayBuffer containing result.
-  JS::RootedObject buffer(cx, JS::NewArrayBufferWithContents(cx, result_size, result.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-  if (!buffer) {
-    // We can be here if the array buffer was too large -- if that was the case then a
-    // JSMSG_BAD_ARRAY_LENGTH will have been created. Otherwise we're probably out of memory.
-    if (!JS_IsExceptionPending(cx)) {
-      js::ReportOutOfMemory(cx);
-    }
+  if (BN_bn2binpad(r_raw, result.get(), coord_size) != coord_size ||
+      BN_bn2binpad(s_raw, result.get() + coord_size, coord_size) != coord_size) {
+    DOMException::raise(cx, "SubtleCrypto.sign: failed to sign", "OperationError");
     return nullptr;
   }
 
-  // `signature` is now owned by `buffer`
-  static_cast<void>(result.release());
-  return buffer;
+  // 7. Return the result of creating an ArrayBuffer containing result.
+  return toArrayBuffer(cx, std::move(result), result_size);
 };
 
 JS::Result<bool> CryptoAlgorithmECDSA_Sign_Verify::verify(JSContext *cx, JS::HandleObject key, std::span<uint8_t> signature, std::span<uint8_t> data) {
@@ -959,7 +1059,7 @@ JS::Result<bool> CryptoAlgorithmECDSA_Sign_Verify::verify(JSContext *cx, JS::Han
   }
 
   // 3. Let M be the result of performing the digest operation specified by hashAlgorithm using message.
-  auto digestOption = rawDigest(cx, data, algorithm, EVP_MD_size(algorithm));
+  auto digestOption = rawDigest(cx, data, algorithm);
   if (!digestOption.has_value()) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return JS::Result<bool>(JS::Error());
@@ -1000,33 +1100,24 @@ JS::Result<bool> CryptoAlgorithmECDSA_Sign_Verify::verify(JSContext *cx, JS::Han
     return JS::Result<bool>(JS::Error());
   }
 
+  std::array<uint8_t, MAX_ECDSA_DER_SIZE> derBuf;
   int derLen = i2d_ECDSA_SIG(sig.get(), nullptr);
-  if (derLen <= 0) {
+  if (derLen <= 0 || static_cast<size_t>(derLen) > derBuf.size()) {
     DOMException::raise(cx, "SubtleCrypto.verify: failed to verify", "OperationError");
     return JS::Result<bool>(JS::Error());
   }
 
-  mozilla::UniquePtr<unsigned char[], JS::FreePolicy> derBuf{
-    static_cast<unsigned char *>(JS_malloc(cx, derLen))};
-  if (!derBuf) {
-    JS_ReportOutOfMemory(cx);
-    return JS::Result<bool>(JS::Error());
-  }
-
-  unsigned char *p = derBuf.get();
+  unsigned char *p = derBuf.data();
   i2d_ECDSA_SIG(sig.get(), &p);
 
-  EVP_PKEY *pkey = CryptoKey::key(key);
-  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(pkey, nullptr));
-  if (!ctx ||
-      EVP_PKEY_verify_init(ctx.get()) <= 0 ||
-      EVP_PKEY_CTX_set_signature_md(ctx.get(), algorithm) <= 0) {
+  EvpPkeyCtxPtr ctx = CryptoKey::signatureContext(key, false, algorithm);
+  if (!ctx) {
     DOMException::raise(cx, "SubtleCrypto.verify: failed to verify", "OperationError");
     return JS::Result<bool>(JS::Error());
   }
 
   // 7. Let result be a boolean with the value true if the signature is valid and the value false otherwise.
-  int ret = EVP_PKEY_verify(ctx.get(), derBuf.get(), derLen, digest.data(), digest.size());
+  int ret = EVP_PKEY_verify(ctx.get(), derBuf.data(), derLen, digest.data(), digest.size());
 
   // 8. Return result.
   return ret == 1;
@@ -1057,7 +1148,15 @@ JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::sign(JSContext *cx, JS::
     return nullptr;
   }
 
-  auto digest = rawDigest(cx, data, algorithm, EVP_MD_size(algorithm));
+  // The host performs steps 2 through 4 if it supports offloading them. Signatures are as long as
+  // the modulus.
+  auto offloaded = offloadSign(cx, key, algorithm, data, EVP_PKEY_get_size(CryptoKey::key(key)),
+                               host_api::CryptoOffload::rsassa_pkcs1_sign);
+  if (offloaded.has_value()) {
+    return offloaded.value();
+  }
+
+  auto digest = rawDigest(cx, data, algorithm);
   if (!digest.has_value()) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return nullptr;
@@ -1069,27 +1168,12 @@ JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::sign(JSContext *cx, JS::
   //  [[algorithm]] internal slot of key as the Hash option for the EMSA-PKCS1-v1_5 encoding
   //  method.
   // 3. If performing the operation results in an error, then throw an OperationError.
-  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(CryptoKey::key(key), nullptr));
+  EvpPkeyCtxPtr ctx = CryptoKey::signatureContext(key, true, algorithm);
   if (!ctx) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return nullptr;
   }
 
-  if (EVP_PKEY_sign_init(ctx.get()) <= 0) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return nullptr;
-  }
-
-  if (EVP_PKEY_CTX_set_rsa_padding(ctx.get(), RSA_PKCS1_PADDING) <= 0) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return nullptr;
-  }
-
-  if (EVP_PKEY_CTX_set_signature_md(ctx.get(), algorithm) <= 0) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return nullptr;
-  }
-
   size_t signature_length = 0;
   if (EVP_PKEY_sign(ctx.get(), nullptr, &signature_length, digest->data(), digest->size()) <= 0) {
     DOMException::raise(cx, "OperationError", "OperationError");
@@ -1097,7 +1181,10 @@ JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::sign(JSContext *cx, JS::
   }
 
   // 4. Let signature be the value S that results from performing the operation.
-  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> signature{static_cast<uint8_t *>(JS_malloc(cx, signature_length))};
+  auto signature = allocateOutput(cx, signature_length);
+  if (!signature) {
+    return nullptr;
+  }
   if (EVP_PKEY_sign(ctx.get(), signature.get(), &signature_length, digest->data(), digest->size()) <= 0) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return nullptr;
@@ -1105,20 +1192,7 @@ JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::sign(JSContext *cx, JS::
 
   // 5. Return a new ArrayBuffer associated with the relevant global object of this [HTML], and
   // containing the bytes of signature.
-  JS::RootedObject buffer(cx, JS::NewArrayBufferWithContents(cx, signature_length, signature.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-  if (!buffer) {
-    // We can be here if the array buffer was too large -- if that was the case then a
-    // JSMSG_BAD_ARRAY_LENGTH will have been created. Otherwise we're probably out of memory.
-    if (!JS_IsExceptionPending(cx)) {
-      js::ReportOutOfMemory(cx);
-    }
-    return nullptr;
-  }
-
-  // `signature` is now owned by `buffer`
-  static_cast<void>(signature.release());
-
-  return buffer;
+  return toArrayBuffer(cx, std::move(signature), signature_length);
 }
 
 JS::Result<bool> CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::verify(JSContext *cx, JS::HandleObject key,
@@ -1132,7 +1206,7 @@ JS::Result<bool> CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::verify(JSContext
   }
   const EVP_MD *algorithm = createDigestAlgorithm(cx, key);
 
-  auto digestOption = rawDigest(cx, data, algorithm, EVP_MD_size(algorithm));
+  auto digestOption = rawDigest(cx, data, algorithm);
   if (!digestOption.has_value()) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return JS::Result<bool>(JS::Error());
@@ -1140,27 +1214,12 @@ JS::Result<bool> CryptoAlgorithmRSASSA_PKCS1_v1_5_Sign_Verify::verify(JSContext
 
   const auto& digest = digestOption.value();
 
-  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(CryptoKey::key(key), nullptr));
+  EvpPkeyCtxPtr ctx = CryptoKey::signatureContext(key, false, algorithm);
   if (!ctx) {
     DOMException::raise(cx, "OperationError", "OperationError");
     return JS::Result<bool>(JS::Error());
   }
 
-  if (EVP_PKEY_verify_init(ctx.get()) != 1) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return JS::Result<bool>(JS::Error());
-  }
-
-  if (EVP_PKEY_CTX_set_rsa_padding(ctx.get(), RSA_PKCS1_PADDING) != 1) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return JS::Result<bool>(JS::Error());
-  }
-
-  if (EVP_PKEY_CTX_set_signature_md(ctx.get(), algorithm) != 1) {
-    DOMException::raise(cx, "OperationError", "OperationError");
-    return JS::Result<bool>(JS::Error());
-  }
-
   return EVP_PKEY_verify(ctx.get(), signature.data(), signature.size(), digest.data(), digest.size()) ==
          1;
 }
@@ -1200,15 +1259,19 @@ CryptoAlgorithmImportKey::normalize(JSContext *cx, JS::HandleValue value) {
   case CryptoAlgorithmIdentifier::ECDSA: {
     return CryptoAlgorithmECDSA_Import::fromParameters(cx, params);
   }
-  case CryptoAlgorithmIdentifier::RSA_PSS:
-  case CryptoAlgorithmIdentifier::RSA_OAEP:
   case CryptoAlgorithmIdentifier::AES_CTR:
   case CryptoAlgorithmIdentifier::AES_CBC:
-  case CryptoAlgorithmIdentifier::AES_GCM:
-  case CryptoAlgorithmIdentifier::AES_KW:
-  case CryptoAlgorithmIdentifier::ECDH:
+  case CryptoAlgorithmIdentifier::AES_GCM: {
+    return std::make_unique<CryptoAlgorithmAES_Import>(identifier);
+  }
   case CryptoAlgorithmIdentifier::HKDF:
   case CryptoAlgorithmIdentifier::PBKDF2: {
+    return std::make_unique<CryptoAlgorithmKDF_Import>(identifier);
+  }
+  case CryptoAlgorithmIdentifier::RSA_PSS:
+  case CryptoAlgorithmIdentifier::RSA_OAEP:
+  case CryptoAlgorithmIdentifier::AES_KW:
+  case CryptoAlgorithmIdentifier::ECDH: {
     DOMException::raise(cx, "Supplied algorithm is not yet supported", "NotSupportedError");
     return nullptr;
   }
@@ -1262,6 +1325,8 @@ JSObject *CryptoAlgorithmHMAC_Import::importKey(JSContext *cx, CryptoKeyFormat f
   }
 
   std::unique_ptr<std::span<uint8_t>> data;
+  // Backs `data` for keys decoded from a JWK, until the key has copied it.
+  std::vector<uint8_t> decoded_data;
   // 3. Let hash be a new KeyAlgorithm.
   // 4.
   switch (format) {
@@ -1303,10 +1368,8 @@ JSObject *CryptoAlgorithmHMAC_Import::importKey(JSContext *cx, CryptoKeyFormat f
       return nullptr;
     }
     auto data_string = dataResult.unwrap();
-    auto ddd = std::vector<uint8_t>(data_string.begin(), data_string.end());
-    data = std::make_unique<std::span<uint8_t>>(
-      ddd
-    );
+    decoded_data.assign(data_string.begin(), data_string.end());
+    data = std::make_unique<std::span<uint8_t>>(decoded_data);
     // 6.7 Set the hash to equal the hash member of normalizedAlgorithm.
     CryptoAlgorithmIdentifier hash = this->hashIdentifier;
     switch(hash) {
@@ -2325,20 +2388,1949 @@ JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Import::toObject(JSContext *cx) const
   return algorithm;
 }
 
-JSObject *CryptoAlgorithmMD5::digest(JSContext *cx, std::span<uint8_t> data) {
-  return builtins::web::crypto::digest(cx, data, EVP_md5(), MD5_DIGEST_LENGTH);
-}
-JSObject *CryptoAlgorithmSHA1::digest(JSContext *cx, std::span<uint8_t> data) {
-  return builtins::web::crypto::digest(cx, data, EVP_sha1(), SHA_DIGEST_LENGTH);
-}
-JSObject *CryptoAlgorithmSHA256::digest(JSContext *cx, std::span<uint8_t> data) {
-  return builtins::web::crypto::digest(cx, data, EVP_sha256(), SHA256_DIGEST_LENGTH);
-}
-JSObject *CryptoAlgorithmSHA384::digest(JSContext *cx, std::span<uint8_t> data) {
-  return builtins::web::crypto::digest(cx, data, EVP_sha384(), SHA384_DIGEST_LENGTH);
-}
-JSObject *CryptoAlgorithmSHA512::digest(JSContext *cx, std::span<uint8_t> data) {
-  return builtins::web::crypto::digest(cx, data, EVP_sha512(), SHA512_DIGEST_LENGTH);
+// https://w3c.github.io/webcrypto/#aes-ctr-operations
+// https://w3c.github.io/webcrypto/#aes-cbc-operations
+// https://w3c.github.io/webcrypto/#aes-gcm-operations
+// The import key operation is the same for all three algorithms, except for the JWK `alg` names.
+JSObject *CryptoAlgorithmAES_Import::importKey(JSContext *cx, CryptoKeyFormat format,
+                                               KeyData key_data, bool extractable,
+                                               CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+
+  // 1. If usages contains an entry which is not one of "encrypt", "decrypt", "wrapKey" or
+  // "unwrapKey", then throw a SyntaxError.
+  constexpr uint8_t allowed_usages = CryptoKeyUsages::encrypt_flag | CryptoKeyUsages::decrypt_flag |
+                                     CryptoKeyUsages::wrap_key_flag |
+                                     CryptoKeyUsages::unwrap_key_flag;
+  if ((usages.toInt() & ~allowed_usages) != 0) {
+    DOMException::raise(cx,
+                        fmt::format("{} keys only support 'encrypt', 'decrypt', 'wrapKey' and "
+                                    "'unwrapKey' operations",
+                                    this->name()),
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  std::span<uint8_t> data;
+  // Backs `data` for keys decoded from a JWK, until the key has copied it.
+  std::vector<uint8_t> decoded_data;
+  switch (format) {
+  // 2. If format is "raw":
+  case CryptoKeyFormat::Raw: {
+    // 2.1. Let data be keyData.
+    data = std::get<std::span<uint8_t>>(key_data);
+    // 2.2. If the length in bits of data is not 128, 192 or 256 then throw a DataError.
+    if (data.size() != 16 && data.size() != 24 && data.size() != 32) {
+      DOMException::raise(cx, "AES key data must be 128, 192 or 256 bits", "DataError");
+      return nullptr;
+    }
+    break;
+  }
+  // 2. If format is "jwk":
+  case CryptoKeyFormat::Jwk: {
+    // 2.1. If keyData is a JsonWebKey dictionary: Let jwk equal keyData.
+    // Otherwise: Throw a DataError.
+    auto *jwk = std::get<JsonWebKey *>(key_data);
+    if (!jwk) {
+      DOMException::raise(cx, "Supplied keyData is not a JSONWebKey", "DataError");
+      return nullptr;
+    }
+    // 2.2. If the kty field of jwk is not "oct", then throw a DataError.
+    // Step 2.2 has already been done in the other implementation of
+    // CryptoAlgorithmAES_Import::importKey which is called before this one.
+    // 2.3. If jwk does not meet the requirements of Section 6.4 of JSON Web Algorithms [JWA],
+    // then throw a DataError.
+    if (!jwk->k.has_value()) {
+      DOMException::raise(cx, "The required JWK member 'k' was missing", "DataError");
+      return nullptr;
+    }
+    // 2.4. Let data be the byte sequence obtained by decoding the k field of jwk.
+    auto dataResult = base64::forgivingBase64Decode(jwk->k.value(), base64::base64URLDecodeTable);
+    if (dataResult.isErr()) {
+      DOMException::raise(
+          cx, "The JWK member 'k' could not be base64url decoded or contained padding", "DataError");
+      return nullptr;
+    }
+    auto data_string = dataResult.unwrap();
+    decoded_data.assign(data_string.begin(), data_string.end());
+    data = decoded_data;
+
+    // 2.5. If the length in bits of data is 128, 192 or 256, and the alg field of jwk is present
+    // and is not "A128CTR", "A192CTR" or "A256CTR" respectively (or the equivalent names for
+    // AES-CBC and AES-GCM), then throw a DataError.
+    // 2.6. Otherwise: throw a DataError.
+    if (data.size() != 16 && data.size() != 24 && data.size() != 32) {
+      DOMException::raise(cx, "AES key data must be 128, 192 or 256 bits", "DataError");
+      return nullptr;
+    }
+    // The JWK name of the mode is the part of the algorithm name after "AES-".
+    auto mode = std::string_view(this->name()).substr(4);
+    if (jwk->alg.has_value() && jwk->alg.value() != fmt::format("A{}{}", data.size() * 8, mode)) {
+      DOMException::raise(cx, "The JWK 'alg' member was inconsistent with that specified by the "
+                              "Web Crypto call", "DataError");
+      return nullptr;
+    }
+    // 2.7. If usages is non-empty and the use field of jwk is present and is not "enc", then
+    // throw a DataError.
+    if (!usages.isEmpty() && jwk->use.has_value() && jwk->use != "enc") {
+      DOMException::raise(cx, "Operation not permitted", "DataError");
+      return nullptr;
+    }
+    // 2.8. If the key_ops field of jwk is present, and is invalid according to the requirements
+    // of JSON Web Key [JWK] or does not contain all of the specified usages values, then throw a
+    // DataError.
+    if (!jwk->key_ops.empty()) {
+      auto ops = CryptoKeyUsages::from(jwk->key_ops);
+      if (!ops.isSuperSetOf(usages)) {
+        DOMException::raise(cx,
+                            "The JWK 'key_ops' member was inconsistent with that specified by the "
+                            "Web Crypto call. The JWK usage must be a superset of those requested", "DataError");
+        return nullptr;
+      }
+    }
+    // 2.9. If the ext field of jwk is present and has the value false and extractable is true,
+    // then throw a DataError.
+    if (jwk->ext && !jwk->ext.value() && extractable) {
+      DOMException::raise(cx, "Data provided to an operation does not meet requirements", "DataError");
+      return nullptr;
+    }
+    break;
+  }
+  // 2. Otherwise: throw a NotSupportedError.
+  default: {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+  }
+
+  // https://w3c.github.io/webcrypto/#SubtleCrypto-method-importKey
+  // 9. If the [[type]] internal slot of result is "secret" or "private" and usages is empty,
+  // then throw a SyntaxError.
+  if (usages.isEmpty()) {
+    DOMException::raise(cx, "Secret keys must be given at least one usage", "SyntaxError");
+    return nullptr;
+  }
+
+  // 3. Let key be a new CryptoKey object representing an AES key with value data.
+  // 4. Let algorithm be a new AesKeyAlgorithm.
+  // 5. Set the name attribute of algorithm to the name of the algorithm.
+  // 6. Set the length attribute of algorithm to the length, in bits, of data.
+  // 7. Set the [[algorithm]] internal slot of key to algorithm.
+  // 8. Return key.
+  this->length = data.size() * 8;
+  return CryptoKey::createAES(cx, this, data, extractable, usages);
+}
+
+JSObject *CryptoAlgorithmAES_Import::importKey(JSContext *cx, CryptoKeyFormat format,
+                                               JS::HandleValue key_data, bool extractable,
+                                               CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  // The only supported formats for AES are raw, and jwk.
+  if (format != CryptoKeyFormat::Raw && format != CryptoKeyFormat::Jwk) {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+
+  KeyData data;
+  if (format == CryptoKeyFormat::Jwk) {
+    // This handles step 2.2: If the kty field of jwk is not "oct", then throw a DataError.
+    auto jwk = JsonWebKey::parse(cx, key_data, "oct");
+    if (!jwk) {
+      return nullptr;
+    }
+    return this->importKey(cx, format, jwk.get(), extractable, usages);
+  }
+
+  std::optional<std::span<uint8_t>> buffer = value_to_buffer(cx, key_data, "");
+  if (!buffer.has_value()) {
+    // value_to_buffer would have already created a JS exception so we don't need to create one
+    // ourselves.
+    return nullptr;
+  }
+  data = buffer.value();
+  return this->importKey(cx, format, data, extractable, usages);
+}
+
+JSObject *CryptoAlgorithmAES_Import::toObject(JSContext *cx) const {
+  // Let algorithm be a new AesKeyAlgorithm dictionary.
+  JS::RootedObject algorithm(cx, JS_NewPlainObject(cx));
+  if (!algorithm) {
+    return nullptr;
+  }
+
+  // Set the name attribute of algorithm to the name of the algorithm.
+  auto *alg_name = JS_NewStringCopyZ(cx, this->name());
+  if (!alg_name) {
+    return nullptr;
+  }
+  JS::RootedValue name_val(cx, JS::StringValue(alg_name));
+  if (!JS_SetProperty(cx, algorithm, "name", name_val)) {
+    return nullptr;
+  }
+
+  // Set the length attribute of algorithm to the length, in bits, of the key.
+  JS::RootedValue length_val(cx, JS::NumberValue(this->length));
+  if (!JS_SetProperty(cx, algorithm, "length", length_val)) {
+    return nullptr;
+  }
+  return algorithm;
+}
+
+namespace {
+
+// Gets a copy of the bytes held by the BufferSource member `member` of the `dictionary`
+// dictionary `parameters`, or std::nullopt with a pending exception.
+// If the member is optional and not present, returns an empty vector.
+std::optional<std::vector<uint8_t>> bufferSourceMember(JSContext *cx, JS::HandleObject parameters,
+                                                       const char *dictionary, const char *member,
+                                                       bool required) {
+  JS::RootedValue value(cx);
+  if (!JS_GetProperty(cx, parameters, member, &value)) {
+    return std::nullopt;
+  }
+  if (value.isUndefined()) {
+    if (required) {
+      api::throw_error(cx, api::Errors::TypeError, dictionary, member, "be present");
+      return std::nullopt;
+    }
+    return std::vector<uint8_t>();
+  }
+  auto description = fmt::format("{}: {}", dictionary, member);
+  auto buffer = value_to_buffer(cx, value, description.c_str());
+  if (!buffer.has_value()) {
+    return std::nullopt;
+  }
+  return std::vector<uint8_t>(buffer->begin(), buffer->end());
+}
+
+// Converts `value`, the `[EnforceRange]` integer member `member` of the `dictionary` dictionary.
+template <typename T>
+std::optional<T> enforceRange(JSContext *cx, JS::HandleValue value, const char *dictionary,
+                              const char *member) {
+  double number = 0;
+  if (!JS::ToNumber(cx, value, &number)) {
+    return std::nullopt;
+  }
+  constexpr double max = std::numeric_limits<T>::max();
+  if (!std::isfinite(number) || std::trunc(number) < 0 || std::trunc(number) > max) {
+    auto expectation = fmt::format("be an integer between 0 and {}", max);
+    api::throw_error(cx, api::Errors::TypeError, dictionary, member, expectation.c_str());
+    return std::nullopt;
+  }
+  return static_cast<T>(std::trunc(number));
+}
+
+// Converts the `[EnforceRange]` integer member `member` of the `dictionary` dictionary
+// `parameters`, and returns it, or `default_value` if it's not present.
+template <typename T>
+std::optional<T> enforceRangeMember(JSContext *cx, JS::HandleObject parameters,
+                                    const char *dictionary, const char *member,
+                                    std::optional<T> default_value) {
+  JS::RootedValue value(cx);
+  if (!JS_GetProperty(cx, parameters, member, &value)) {
+    return std::nullopt;
+  }
+  if (value.isUndefined()) {
+    if (!default_value.has_value()) {
+      api::throw_error(cx, api::Errors::TypeError, dictionary, member, "be present");
+    }
+    return default_value;
+  }
+  return enforceRange<T>(cx, value, dictionary, member);
+}
+
+// Returns the cipher implementing `algorithm` for keys of `key_size` bytes.
+//
+// The ciphers are fetched from the default provider once and kept around, which saves the
+// implicit fetch OpenSSL would otherwise do every time a cipher context is initialized.
+const EVP_CIPHER *aesCipher(CryptoAlgorithmIdentifier algorithm, size_t key_size) {
+  static const char *names[3][3] = {
+      {"AES-128-CTR", "AES-192-CTR", "AES-256-CTR"},
+      {"AES-128-CBC", "AES-192-CBC", "AES-256-CBC"},
+      {"AES-128-GCM", "AES-192-GCM", "AES-256-GCM"},
+  };
+  static EVP_CIPHER *ciphers[3][3] = {};
+
+  size_t mode = 0;
+  switch (algorithm) {
+  case CryptoAlgorithmIdentifier::AES_CTR: {
+    mode = 0;
+    break;
+  }
+  case CryptoAlgorithmIdentifier::AES_CBC: {
+    mode = 1;
+    break;
+  }
+  case CryptoAlgorithmIdentifier::AES_GCM: {
+    mode = 2;
+    break;
+  }
+  default: {
+    MOZ_ASSERT_UNREACHABLE("Not an AES encryption algorithm");
+    return nullptr;
+  }
+  }
+
+  size_t size = 0;
+  switch (key_size) {
+  case 16: {
+    size = 0;
+    break;
+  }
+  case 24: {
+    size = 1;
+    break;
+  }
+  case 32: {
+    size = 2;
+    break;
+  }
+  default: {
+    return nullptr;
+  }
+  }
+
+  if (!ciphers[mode][size]) {
+    ciphers[mode][size] = EVP_CIPHER_fetch(nullptr, names[mode][size], nullptr);
+  }
+  return ciphers[mode][size];
+}
+
+// Runs `input` through the cipher context, writing the output to `output`, which must have room
+// for `input.size()` bytes plus one block, or be nullptr when passing AES-GCM additional data.
+// OpenSSL takes `int` lengths, so large inputs are processed in chunks.
+std::optional<size_t> cipherUpdate(EVP_CIPHER_CTX *ctx, uint8_t *output,
+                                   std::span<const uint8_t> input) {
+  constexpr size_t max_chunk = 1 << 30;
+  size_t written = 0;
+  do {
+    auto chunk = input.first(std::min(input.size(), max_chunk));
+    int len = 0;
+    if (EVP_CipherUpdate(ctx, output ? output + written : nullptr, &len, chunk.data(),
+                         static_cast<int>(chunk.size())) != 1) {
+      return std::nullopt;
+    }
+    written += len;
+    input = input.subspan(chunk.size());
+  } while (!input.empty());
+  return written;
+}
+
+// The size from which AES encryption and decryption are offloaded to the host. Below it, the cost
+// of copying the data to the host and back outweighs the time saved.
+constexpr size_t MIN_OFFLOADED_CIPHER_SIZE = 64 * 1024;
+
+// Performs AES-CBC encryption or decryption of `data` with `key` and `iv`, returning the result
+// as a new ArrayBuffer.
+JSObject *aesCbc(JSContext *cx, JS::HandleObject key, std::span<uint8_t> iv,
+                 std::span<uint8_t> data, bool encrypt) {
+  const char *error = encrypt ? "AES-CBC encryption failed" : "AES-CBC decryption failed";
+  // If the iv member of normalizedAlgorithm does not have a length of 16 bytes, then throw an
+  // OperationError.
+  if (iv.size() != 16) {
+    DOMException::raise(cx, "AES-CBC iv must be 16 bytes long", "OperationError");
+    return nullptr;
+  }
+
+  auto key_data = CryptoKey::secretKeyData(key);
+  if (data.size() >= MIN_OFFLOADED_CIPHER_SIZE && canOffload(cx)) {
+    // Encryption pads the plaintext to the next multiple of the block size, adding between 1 and
+    // 16 bytes, and decryption removes that padding again.
+    size_t min_size = encrypt ? data.size() + 1 : std::max<size_t>(data.size(), 16) - 16;
+    size_t max_size = encrypt ? data.size() + 16 : data.size() - 1;
+    auto offloaded =
+        offloadedResult(cx, host_api::CryptoOffload::aes_cbc(key_data, iv, data, encrypt),
+                        min_size, max_size, error);
+    if (offloaded.has_value()) {
+      return offloaded.value();
+    }
+  }
+  const auto *cipher = aesCipher(CryptoAlgorithmIdentifier::AES_CBC, key_data.size());
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  if (!cipher || !ctx ||
+      EVP_CipherInit_ex2(ctx.get(), cipher, key_data.data(), iv.data(), encrypt ? 1 : 0,
+                         nullptr) != 1) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+
+  // Encryption adds up to a block of padding; decryption output is never longer than the input.
+  auto output = allocateOutput(cx, data.size() + 16);
+  if (!output) {
+    return nullptr;
+  }
+
+  // Encryption: let ciphertext be the result of adding padding to plaintext according to the
+  // procedure defined in Section 10.3 of [RFC2315], step 2, and performing the CBC Encryption
+  // operation described in Section 6.2 of [NIST SP800-38A].
+  // Decryption: let paddedPlaintext be the result of performing the CBC Decryption operation,
+  // and let plaintext be the result of removing p bytes of padding from it. If that fails, e.g.
+  // because the padding is invalid, throw an OperationError.
+  auto written = cipherUpdate(ctx.get(), output.get(), data);
+  int final_len = 0;
+  if (!written.has_value() ||
+      EVP_CipherFinal_ex(ctx.get(), output.get() + written.value(), &final_len) != 1) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+
+  return toArrayBuffer(cx, std::move(output), written.value() + final_len);
+}
+
+// Performs AES-CTR encryption, which is the same operation as decryption, of `data` with `key`,
+// returning the result as a new ArrayBuffer.
+JSObject *aesCtr(JSContext *cx, JS::HandleObject key, std::span<uint8_t> counter, uint8_t length,
+                 std::span<uint8_t> data) {
+  // If the counter member of normalizedAlgorithm does not have a length of 16 bytes, then throw
+  // an OperationError.
+  if (counter.size() != 16) {
+    DOMException::raise(cx, "AES-CTR counter must be 16 bytes long", "OperationError");
+    return nullptr;
+  }
+  // If the length member of normalizedAlgorithm is zero or is greater than 128, then throw an
+  // OperationError.
+  if (length == 0 || length > 128) {
+    DOMException::raise(cx, "AES-CTR length must be between 1 and 128", "OperationError");
+    return nullptr;
+  }
+
+  // Only the rightmost `length` bits of the counter block are incremented, and they wrap around
+  // without carrying into the rest of the block. OpenSSL increments the whole block, so if the
+  // counter wraps during the operation, it's split in two: the blocks up to the wrap, and the
+  // rest, starting from a counter block with the rightmost `length` bits set to zero.
+  size_t blocks = (data.size() + 15) / 16;
+  size_t blocks_before_wrap = blocks;
+  {
+    BignumPtr counter_bits(BN_bin2bn(counter.data(), static_cast<int>(counter.size()), nullptr));
+    BignumPtr capacity(BN_new());
+    BignumPtr remaining(BN_new());
+    BignumPtr needed(BN_new());
+    if (!counter_bits || !capacity || !remaining || !needed ||
+        BN_mask_bits(counter_bits.get(), length) != 1 || BN_set_bit(capacity.get(), length) != 1 ||
+        BN_sub(remaining.get(), capacity.get(), counter_bits.get()) != 1 ||
+        BN_set_word(needed.get(), blocks) != 1) {
+      DOMException::raise(cx, "AES-CTR encryption failed", "OperationError");
+      return nullptr;
+    }
+    // Reusing a counter block would reveal information about the plaintext.
+    if (BN_cmp(needed.get(), capacity.get()) > 0) {
+      DOMException::raise(cx, "AES-CTR counter would repeat for data of this length",
+                          "OperationError");
+      return nullptr;
+    }
+    if (BN_cmp(needed.get(), remaining.get()) > 0) {
+      blocks_before_wrap = BN_get_word(remaining.get());
+    }
+  }
+
+  auto key_data = CryptoKey::secretKeyData(key);
+  const auto *cipher = aesCipher(CryptoAlgorithmIdentifier::AES_CTR, key_data.size());
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  if (!cipher || !ctx ||
+      EVP_CipherInit_ex2(ctx.get(), cipher, key_data.data(), counter.data(), 1, nullptr) != 1) {
+    DOMException::raise(cx, "AES-CTR encryption failed", "OperationError");
+    return nullptr;
+  }
+
+  auto output = allocateOutput(cx, data.size() + 16);
+  if (!output) {
+    return nullptr;
+  }
+
+  auto first = data.first(std::min(data.size(), blocks_before_wrap * 16));
+  auto written = cipherUpdate(ctx.get(), output.get(), first);
+  if (written.has_value() && first.size() < data.size()) {
+    std::array<uint8_t, 16> wrapped;
+    std::copy(counter.begin(), counter.end(), wrapped.begin());
+    std::fill(wrapped.end() - length / 8, wrapped.end(), 0);
+    if (length % 8 != 0) {
+      wrapped[15 - length / 8] &= static_cast<uint8_t>(0xff << (length % 8));
+    }
+    if (EVP_CipherInit_ex2(ctx.get(), nullptr, nullptr, wrapped.data(), 1, nullptr) != 1) {
+      written = std::nullopt;
+    } else {
+      auto rest = cipherUpdate(ctx.get(), output.get() + first.size(), data.subspan(first.size()));
+      written = rest.has_value() ? std::optional(first.size() + rest.value()) : std::nullopt;
+    }
+  }
+  int final_len = 0;
+  if (!written.has_value() ||
+      EVP_CipherFinal_ex(ctx.get(), output.get() + written.value(), &final_len) != 1) {
+    DOMException::raise(cx, "AES-CTR encryption failed", "OperationError");
+    return nullptr;
+  }
+
+  return toArrayBuffer(cx, std::move(output), written.value() + final_len);
+}
+
+// Performs AES-GCM encryption or decryption of `data` with `key`, returning the result as a new
+// ArrayBuffer. Encryption appends the authentication tag to the ciphertext, and decryption expects
+// it to be appended to the ciphertext.
+JSObject *aesGcm(JSContext *cx, JS::HandleObject key, std::span<uint8_t> iv,
+                 std::span<uint8_t> additional_data, uint8_t tag_length, std::span<uint8_t> data,
+                 bool encrypt) {
+  const char *error = encrypt ? "AES-GCM encryption failed" : "AES-GCM decryption failed";
+  // If the tagLength member of normalizedAlgorithm is not one of 32, 64, 96, 104, 112, 120 or
+  // 128: throw an OperationError.
+  switch (tag_length) {
+  case 32:
+  case 64:
+  case 96:
+  case 104:
+  case 112:
+  case 120:
+  case 128:
+    break;
+  default: {
+    DOMException::raise(cx, "AES-GCM tagLength must be one of 32, 64, 96, 104, 112, 120 or 128",
+                        "OperationError");
+    return nullptr;
+  }
+  }
+  size_t tag_size = tag_length / 8;
+
+  // The host takes the ciphertext with the tag appended, just like it's passed in.
+  if (data.size() >= MIN_OFFLOADED_CIPHER_SIZE && canOffload(cx)) {
+    size_t result_size = encrypt ? data.size() + tag_size : data.size() - tag_size;
+    auto offloaded = offloadedResult(
+        cx,
+        host_api::CryptoOffload::aes_gcm(CryptoKey::secretKeyData(key), iv, additional_data,
+                                         static_cast<uint8_t>(tag_size), data, encrypt),
+        result_size, result_size, error);
+    if (offloaded.has_value()) {
+      return offloaded.value();
+    }
+  }
+
+  // Decryption: if the length of ciphertext is less than tagLength bits, then throw an
+  // OperationError. Otherwise, let tag be the last tagLength bits of ciphertext, and
+  // actualCiphertext the rest.
+  std::span<uint8_t> tag;
+  if (!encrypt) {
+    if (data.size() < tag_size) {
+      DOMException::raise(cx, "AES-GCM ciphertext is shorter than the tag length",
+                          "OperationError");
+      return nullptr;
+    }
+    tag = data.last(tag_size);
+    data = data.first(data.size() - tag_size);
+  }
+
+  auto key_data = CryptoKey::secretKeyData(key);
+  const auto *cipher = aesCipher(CryptoAlgorithmIdentifier::AES_GCM, key_data.size());
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  if (!cipher || !ctx || iv.empty() ||
+      EVP_CipherInit_ex2(ctx.get(), cipher, nullptr, nullptr, encrypt ? 1 : 0, nullptr) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_AEAD_SET_IVLEN, static_cast<int>(iv.size()),
+                          nullptr) != 1 ||
+      EVP_CipherInit_ex2(ctx.get(), nullptr, key_data.data(), iv.data(), encrypt ? 1 : 0,
+                         nullptr) != 1) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+
+  // Let additionalData be the additionalData member of normalizedAlgorithm if present or the
+  // empty octet string otherwise.
+  if (!additional_data.empty() &&
+      !cipherUpdate(ctx.get(), nullptr, additional_data).has_value()) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+
+  size_t output_size = encrypt ? data.size() + tag_size : data.size();
+  auto output = allocateOutput(cx, output_size + 16);
+  if (!output) {
+    return nullptr;
+  }
+
+  // Decryption: if the tag is not valid, the result of performing the Authenticated Decryption
+  // Function is FAIL, and an OperationError is thrown.
+  if (!encrypt && EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_AEAD_SET_TAG,
+                                      static_cast<int>(tag.size()), tag.data()) != 1) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+  auto written = cipherUpdate(ctx.get(), output.get(), data);
+  int final_len = 0;
+  if (!written.has_value() ||
+      EVP_CipherFinal_ex(ctx.get(), output.get() + written.value(), &final_len) != 1) {
+    DOMException::raise(cx, error, "OperationError");
+    return nullptr;
+  }
+  size_t length = written.value() + final_len;
+
+  // Encryption: let ciphertext be equal to C | T, where '|' denotes concatenation.
+  if (encrypt) {
+    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_AEAD_GET_TAG, static_cast<int>(tag_size),
+                            output.get() + length) != 1) {
+      DOMException::raise(cx, error, "OperationError");
+      return nullptr;
+    }
+    length += tag_size;
+  }
+
+  return toArrayBuffer(cx, std::move(output), length);
+}
+
+} // namespace
+
+std::unique_ptr<CryptoAlgorithmEncryptDecrypt>
+CryptoAlgorithmEncryptDecrypt::normalize(JSContext *cx, JS::HandleValue value) {
+  // Do steps 1 through 5.1 of https://w3c.github.io/webcrypto/#algorithm-normalization-normalize-an-algorithm
+  auto identifierResult = normalizeIdentifier(cx, value);
+  if (identifierResult.isErr()) {
+    // If we are here, this means either the identifier could not be coerced to a String or was not recognized
+    // In both those scenarios an exception will have already been created, which is why we are not creating one here.
+    return nullptr;
+  }
+  auto identifier = identifierResult.unwrap();
+  JS::RootedObject params(cx);
+
+  // The value can either be a JS String or a JS Object with a 'name' property which is the algorithm identifier.
+  // Other properties within the object will be the parameters for the algorithm to use.
+  if (value.isString()) {
+    auto *obj = JS_NewPlainObject(cx);
+    params.set(obj);
+    if (!obj || !JS_SetProperty(cx, params, "name", value)) {
+      return nullptr;
+    }
+  } else if (value.isObject()) {
+    params.set(&value.toObject());
+  }
+
+  // The table listed at https://w3c.github.io/webcrypto/#h-note-15 is what defines which algorithms support which operations
+  // RSA-OAEP, AES-CTR, AES-CBC, AES-GCM are the algorithms which support the encrypt and decrypt operations
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::AES_CTR: {
+    return CryptoAlgorithmAES_CTR_Encrypt_Decrypt::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::AES_CBC: {
+    return CryptoAlgorithmAES_CBC_Encrypt_Decrypt::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::AES_GCM: {
+    return CryptoAlgorithmAES_GCM_Encrypt_Decrypt::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::RSA_OAEP: {
+    DOMException::raise(cx, "Supplied algorithm is not yet supported", "NotSupportedError");
+    return nullptr;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the encrypt and decrypt operations", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+std::unique_ptr<CryptoAlgorithmAES_CBC_Encrypt_Decrypt>
+CryptoAlgorithmAES_CBC_Encrypt_Decrypt::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  auto iv = bufferSourceMember(cx, parameters, "AesCbcParams", "iv", true);
+  if (!iv.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmAES_CBC_Encrypt_Decrypt>(std::move(iv.value()));
+}
+
+// https://w3c.github.io/webcrypto/#aes-cbc-operations
+JSObject *CryptoAlgorithmAES_CBC_Encrypt_Decrypt::encrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesCbc(cx, key, this->iv, data, true);
+}
+
+JSObject *CryptoAlgorithmAES_CBC_Encrypt_Decrypt::decrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesCbc(cx, key, this->iv, data, false);
+}
+
+std::unique_ptr<CryptoAlgorithmAES_CTR_Encrypt_Decrypt>
+CryptoAlgorithmAES_CTR_Encrypt_Decrypt::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order.
+  auto counter = bufferSourceMember(cx, parameters, "AesCtrParams", "counter", true);
+  if (!counter.has_value()) {
+    return nullptr;
+  }
+  auto length =
+      enforceRangeMember<uint8_t>(cx, parameters, "AesCtrParams", "length", std::nullopt);
+  if (!length.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmAES_CTR_Encrypt_Decrypt>(std::move(counter.value()),
+                                                                  length.value());
+}
+
+// https://w3c.github.io/webcrypto/#aes-ctr-operations
+JSObject *CryptoAlgorithmAES_CTR_Encrypt_Decrypt::encrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesCtr(cx, key, this->counter, this->length, data);
+}
+
+JSObject *CryptoAlgorithmAES_CTR_Encrypt_Decrypt::decrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesCtr(cx, key, this->counter, this->length, data);
+}
+
+std::unique_ptr<CryptoAlgorithmAES_GCM_Encrypt_Decrypt>
+CryptoAlgorithmAES_GCM_Encrypt_Decrypt::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order.
+  auto additionalData =
+      bufferSourceMember(cx, parameters, "AesGcmParams", "additionalData", false);
+  if (!additionalData.has_value()) {
+    return nullptr;
+  }
+  auto iv = bufferSourceMember(cx, parameters, "AesGcmParams", "iv", true);
+  if (!iv.has_value()) {
+    return nullptr;
+  }
+  auto tagLength =
+      enforceRangeMember<uint8_t>(cx, parameters, "AesGcmParams", "tagLength", 128);
+  if (!tagLength.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmAES_GCM_Encrypt_Decrypt>(
+      std::move(iv.value()), std::move(additionalData.value()), tagLength.value());
+}
+
+// https://w3c.github.io/webcrypto/#aes-gcm-operations
+JSObject *CryptoAlgorithmAES_GCM_Encrypt_Decrypt::encrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesGcm(cx, key, this->iv, this->additionalData, this->tagLength, data, true);
+}
+
+JSObject *CryptoAlgorithmAES_GCM_Encrypt_Decrypt::decrypt(JSContext *cx, JS::HandleObject key,
+                                                          std::span<uint8_t> data) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  return aesGcm(cx, key, this->iv, this->additionalData, this->tagLength, data, false);
+}
+
+// https://w3c.github.io/webcrypto/#hkdf-operations
+// https://w3c.github.io/webcrypto/#pbkdf2-operations
+// The import key operation is the same for both algorithms.
+JSObject *CryptoAlgorithmKDF_Import::importKey(JSContext *cx, CryptoKeyFormat format,
+                                               KeyData key_data, bool extractable,
+                                               CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  // 1. If format is not "raw", throw a NotSupportedError.
+  if (format != CryptoKeyFormat::Raw) {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+
+  // 2. If usages contains a value that is not "deriveKey" or "deriveBits", then throw a
+  // SyntaxError.
+  constexpr uint8_t allowed_usages =
+      CryptoKeyUsages::derive_key_flag | CryptoKeyUsages::derive_bits_flag;
+  if ((usages.toInt() & ~allowed_usages) != 0) {
+    DOMException::raise(cx,
+                        fmt::format("{} keys only support 'deriveKey' and 'deriveBits' operations",
+                                    this->name()),
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // 3. If extractable is not false, then throw a SyntaxError.
+  if (extractable) {
+    DOMException::raise(cx, fmt::format("{} keys can't be extractable", this->name()),
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // https://w3c.github.io/webcrypto/#SubtleCrypto-method-importKey
+  // 9. If the [[type]] internal slot of result is "secret" or "private" and usages is empty,
+  // then throw a SyntaxError.
+  if (usages.isEmpty()) {
+    DOMException::raise(cx, "Secret keys must be given at least one usage", "SyntaxError");
+    return nullptr;
+  }
+
+  // 4. Let key be a new CryptoKey representing the key data provided in keyData.
+  // 5. Set the [[type]] internal slot of key to "secret".
+  // 6. Let algorithm be a new KeyAlgorithm object.
+  // 7. Set the name attribute of algorithm to the name of the algorithm.
+  // 8. Set the [[algorithm]] internal slot of key to algorithm.
+  // 9. Return key.
+  return CryptoKey::createKDF(cx, this, std::get<std::span<uint8_t>>(key_data), usages);
+}
+
+JSObject *CryptoAlgorithmKDF_Import::importKey(JSContext *cx, CryptoKeyFormat format,
+                                               JS::HandleValue key_data, bool extractable,
+                                               CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  if (format != CryptoKeyFormat::Raw) {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+
+  std::optional<std::span<uint8_t>> buffer = value_to_buffer(cx, key_data, "");
+  if (!buffer.has_value()) {
+    // value_to_buffer would have already created a JS exception so we don't need to create one
+    // ourselves.
+    return nullptr;
+  }
+  KeyData data = buffer.value();
+  return this->importKey(cx, format, data, extractable, usages);
+}
+
+JSObject *CryptoAlgorithmKDF_Import::toObject(JSContext *cx) const {
+  // Let algorithm be a new KeyAlgorithm object.
+  JS::RootedObject algorithm(cx, JS_NewPlainObject(cx));
+  if (!algorithm) {
+    return nullptr;
+  }
+
+  // Set the name attribute of algorithm to the name of the algorithm.
+  auto *alg_name = JS_NewStringCopyZ(cx, this->name());
+  if (!alg_name) {
+    return nullptr;
+  }
+  JS::RootedValue name_val(cx, JS::StringValue(alg_name));
+  if (!JS_SetProperty(cx, algorithm, "name", name_val)) {
+    return nullptr;
+  }
+  return algorithm;
+}
+
+namespace {
+
+// Reads the required HashAlgorithmIdentifier member `hash` of the `dictionary` dictionary
+// `parameters`.
+JS::Result<CryptoAlgorithmIdentifier> hashMember(JSContext *cx, JS::HandleObject parameters,
+                                                 const char *dictionary) {
+  JS::RootedValue hash_val(cx);
+  if (!JS_GetProperty(cx, parameters, "hash", &hash_val)) {
+    return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
+  }
+  if (hash_val.isUndefined()) {
+    api::throw_error(cx, api::Errors::TypeError, dictionary, "hash", "be present");
+    return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
+  }
+  return toHashIdentifier(cx, hash_val);
+}
+
+// Returns the key derivation function implementing `algorithm`, which is fetched from the default
+// provider once and kept around.
+EVP_KDF *kdfImplementation(CryptoAlgorithmIdentifier algorithm) {
+  static EVP_KDF *hkdf = nullptr;
+  static EVP_KDF *pbkdf2 = nullptr;
+  bool is_hkdf = algorithm == CryptoAlgorithmIdentifier::HKDF;
+  auto *&kdf = is_hkdf ? hkdf : pbkdf2;
+  if (!kdf) {
+    kdf = EVP_KDF_fetch(nullptr, is_hkdf ? "HKDF" : "PBKDF2", nullptr);
+  }
+  return kdf;
+}
+
+// Creates an OSSL_PARAM for the octet string `data`. OpenSSL doesn't accept null pointers for empty
+// strings, so those point to a static byte instead.
+OSSL_PARAM octetStringParam(const char *key, std::span<uint8_t> data) {
+  static uint8_t empty = 0;
+  return OSSL_PARAM_construct_octet_string(key, data.empty() ? &empty : data.data(), data.size());
+}
+
+// Creates an OSSL_PARAM naming the digest identified by `hash`.
+std::optional<OSSL_PARAM> digestParam(JSContext *cx, CryptoAlgorithmIdentifier hash) {
+  const EVP_MD *md = createDigestAlgorithm(cx, hash);
+  if (!md) {
+    return std::nullopt;
+  }
+  // OpenSSL only reads the name, despite taking a mutable pointer.
+  auto *name = const_cast<char *>(EVP_MD_get0_name(md)); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+  return OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, name, 0);
+}
+
+// Derives `length` bits using `algorithm` configured with `params`, and returns them in a new
+// ArrayBuffer. Both HKDF and PBKDF2 require the length to be present and a multiple of 8.
+//
+// If the host supports it, the derivation is offloaded to it instead, by calling `offload` with
+// the host's identifier for `hash` and the length in bytes.
+template <typename Offload>
+JSObject *deriveWithKDF(JSContext *cx, CryptoAlgorithmIdentifier algorithm,
+                        CryptoAlgorithmIdentifier hash, std::optional<size_t> length,
+                        OSSL_PARAM *params, Offload offload) {
+  // If length is null or is not a multiple of 8, then throw an OperationError.
+  if (!length.has_value() || length.value() % 8 != 0) {
+    DOMException::raise(cx,
+                        fmt::format("{}: length must be a multiple of 8",
+                                    algorithmName(algorithm)),
+                        "OperationError");
+    return nullptr;
+  }
+
+  size_t size = length.value() / 8;
+  auto error = fmt::format("{}: key derivation failed", algorithmName(algorithm));
+  if (size > 0 && size <= std::numeric_limits<uint32_t>::max() && canOffload(cx)) {
+    auto offloaded_hash = offloadHash(createDigestAlgorithm(cx, hash));
+    if (offloaded_hash.has_value()) {
+      auto offloaded =
+          offloadedResult(cx, offload(offloaded_hash.value(), static_cast<uint32_t>(size)),
+                          size, size, error.c_str());
+      if (offloaded.has_value()) {
+        return offloaded.value();
+      }
+    }
+  }
+
+  auto output = allocateOutput(cx, size);
+  if (!output) {
+    return nullptr;
+  }
+
+  // If length is zero, return an empty byte sequence.
+  if (size > 0) {
+    // If the key derivation operation fails, then throw an OperationError.
+    auto *kdf = kdfImplementation(algorithm);
+    EvpKdfCtxPtr ctx(kdf ? EVP_KDF_CTX_new(kdf) : nullptr);
+    if (!ctx || EVP_KDF_derive(ctx.get(), output.get(), size, params) != 1) {
+      DOMException::raise(cx, error, "OperationError");
+      return nullptr;
+    }
+  }
+
+  return toArrayBuffer(cx, std::move(output), size);
+}
+
+} // namespace
+
+std::unique_ptr<CryptoAlgorithmDeriveBits>
+CryptoAlgorithmDeriveBits::normalize(JSContext *cx, JS::HandleValue value) {
+  // Do steps 1 through 5.1 of https://w3c.github.io/webcrypto/#algorithm-normalization-normalize-an-algorithm
+  auto identifierResult = normalizeIdentifier(cx, value);
+  if (identifierResult.isErr()) {
+    // If we are here, this means either the identifier could not be coerced to a String or was not recognized
+    // In both those scenarios an exception will have already been created, which is why we are not creating one here.
+    return nullptr;
+  }
+  auto identifier = identifierResult.unwrap();
+  JS::RootedObject params(cx);
+
+  // The value can either be a JS String or a JS Object with a 'name' property which is the algorithm identifier.
+  // Other properties within the object will be the parameters for the algorithm to use.
+  if (value.isString()) {
+    auto *obj = JS_NewPlainObject(cx);
+    params.set(obj);
+    if (!obj || !JS_SetProperty(cx, params, "name", value)) {
+      return nullptr;
+    }
+  } else if (value.isObject()) {
+    params.set(&value.toObject());
+  }
+
+  // The table listed at https://w3c.github.io/webcrypto/#h-note-15 is what defines which algorithms support which operations
+  // ECDH, HKDF, PBKDF2 are the algorithms which support the deriveBits operation
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::HKDF: {
+    return CryptoAlgorithmHKDF_Derive::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::PBKDF2: {
+    return CryptoAlgorithmPBKDF2_Derive::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::ECDH: {
+    DOMException::raise(cx, "Supplied algorithm is not yet supported", "NotSupportedError");
+    return nullptr;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the deriveBits operation", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+std::unique_ptr<CryptoAlgorithmHKDF_Derive>
+CryptoAlgorithmHKDF_Derive::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order.
+  auto hashIdentifier = hashMember(cx, parameters, "HkdfParams");
+  if (hashIdentifier.isErr()) {
+    return nullptr;
+  }
+  auto info = bufferSourceMember(cx, parameters, "HkdfParams", "info", true);
+  if (!info.has_value()) {
+    return nullptr;
+  }
+  auto salt = bufferSourceMember(cx, parameters, "HkdfParams", "salt", true);
+  if (!salt.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmHKDF_Derive>(
+      hashIdentifier.unwrap(), std::move(salt.value()), std::move(info.value()));
+}
+
+// https://w3c.github.io/webcrypto/#hkdf-operations
+JSObject *CryptoAlgorithmHKDF_Derive::deriveBits(JSContext *cx, JS::HandleObject key,
+                                                 std::optional<size_t> length) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  auto digest = digestParam(cx, this->hashIdentifier);
+  if (!digest.has_value()) {
+    return nullptr;
+  }
+
+  // 2. Let keyDerivationKey be the secret represented by the [[handle]] internal slot of key as
+  // the message.
+  // 3. Let result be the result of performing the HKDF extract and then the HKDF expand step
+  // described in Section 2 of [RFC5869] using:
+  //   - the hash member of normalizedAlgorithm as Hash,
+  //   - keyDerivationKey as the input keying material, IKM,
+  //   - the salt member of normalizedAlgorithm as salt,
+  //   - the info member of normalizedAlgorithm as info,
+  //   - length divided by 8 as the value of L,
+  std::array<OSSL_PARAM, 5> params = {
+      digest.value(),
+      octetStringParam(OSSL_KDF_PARAM_KEY, CryptoKey::secretKeyData(key)),
+      octetStringParam(OSSL_KDF_PARAM_SALT, this->salt),
+      octetStringParam(OSSL_KDF_PARAM_INFO, this->info),
+      OSSL_PARAM_construct_end(),
+  };
+  auto offload = [&](host_api::CryptoOffload::Hash hash, uint32_t size) {
+    return host_api::CryptoOffload::hkdf(CryptoKey::secretKeyData(key), this->salt, this->info,
+                                         hash, size);
+  };
+  return deriveWithKDF(cx, CryptoAlgorithmIdentifier::HKDF, this->hashIdentifier, length,
+                       params.data(), offload);
+}
+
+std::unique_ptr<CryptoAlgorithmPBKDF2_Derive>
+CryptoAlgorithmPBKDF2_Derive::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order.
+  auto hashIdentifier = hashMember(cx, parameters, "Pbkdf2Params");
+  if (hashIdentifier.isErr()) {
+    return nullptr;
+  }
+  auto iterations =
+      enforceRangeMember<uint32_t>(cx, parameters, "Pbkdf2Params", "iterations", std::nullopt);
+  if (!iterations.has_value()) {
+    return nullptr;
+  }
+  auto salt = bufferSourceMember(cx, parameters, "Pbkdf2Params", "salt", true);
+  if (!salt.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmPBKDF2_Derive>(
+      hashIdentifier.unwrap(), std::move(salt.value()), iterations.value());
+}
+
+// https://w3c.github.io/webcrypto/#pbkdf2-operations
+JSObject *CryptoAlgorithmPBKDF2_Derive::deriveBits(JSContext *cx, JS::HandleObject key,
+                                                   std::optional<size_t> length) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  // 2. If the iterations member of normalizedAlgorithm is zero, then throw an OperationError.
+  if (this->iterations == 0) {
+    DOMException::raise(cx, "PBKDF2: iterations must be greater than zero", "OperationError");
+    return nullptr;
+  }
+  auto digest = digestParam(cx, this->hashIdentifier);
+  if (!digest.has_value()) {
+    return nullptr;
+  }
+
+  // 4. Let prf be the MAC Generation function described in Section 4 of [FIPS-198-1] using the
+  // hash function described by the hash member of normalizedAlgorithm.
+  // 5. Let result be the result of performing the PBKDF2 operation defined in Section 5.2 of
+  // [RFC8018] using prf as the pseudo-random function, PRF, the password represented by the
+  // [[handle]] internal slot of key as the password, P, the salt attribute of
+  // normalizedAlgorithm as the salt, S, the value of the iterations attribute of
+  // normalizedAlgorithm as the iteration count, c, and length divided by 8 as the intended key
+  // length, dkLen.
+  //
+  // OpenSSL defaults to the lower bounds SP 800-132 puts on the iteration count, salt and key
+  // lengths, which Web Crypto doesn't have, so they're turned off with the PKCS5 parameter.
+  unsigned int iterations = this->iterations;
+  int pkcs5 = 1;
+  std::array<OSSL_PARAM, 6> params = {
+      digest.value(),
+      octetStringParam(OSSL_KDF_PARAM_PASSWORD, CryptoKey::secretKeyData(key)),
+      octetStringParam(OSSL_KDF_PARAM_SALT, this->salt),
+      OSSL_PARAM_construct_uint(OSSL_KDF_PARAM_ITER, &iterations),
+      OSSL_PARAM_construct_int(OSSL_KDF_PARAM_PKCS5, &pkcs5),
+      OSSL_PARAM_construct_end(),
+  };
+  auto offload = [&](host_api::CryptoOffload::Hash hash, uint32_t size) {
+    return host_api::CryptoOffload::pbkdf2(CryptoKey::secretKeyData(key), this->salt,
+                                           this->iterations, hash, size);
+  };
+  return deriveWithKDF(cx, CryptoAlgorithmIdentifier::PBKDF2, this->hashIdentifier, length,
+                       params.data(), offload);
+}
+
+std::unique_ptr<CryptoAlgorithmGetKeyLength>
+CryptoAlgorithmGetKeyLength::normalize(JSContext *cx, JS::HandleValue value) {
+  // Do steps 1 through 5.1 of https://w3c.github.io/webcrypto/#algorithm-normalization-normalize-an-algorithm
+  auto identifierResult = normalizeIdentifier(cx, value);
+  if (identifierResult.isErr()) {
+    // If we are here, this means either the identifier could not be coerced to a String or was not recognized
+    // In both those scenarios an exception will have already been created, which is why we are not creating one here.
+    return nullptr;
+  }
+  auto identifier = identifierResult.unwrap();
+  JS::RootedObject params(cx);
+
+  // The value can either be a JS String or a JS Object with a 'name' property which is the algorithm identifier.
+  // Other properties within the object will be the parameters for the algorithm to use.
+  if (value.isString()) {
+    auto *obj = JS_NewPlainObject(cx);
+    params.set(obj);
+    if (!obj || !JS_SetProperty(cx, params, "name", value)) {
+      return nullptr;
+    }
+  } else if (value.isObject()) {
+    params.set(&value.toObject());
+  }
+
+  // The table listed at https://w3c.github.io/webcrypto/#h-note-15 is what defines which algorithms support which operations
+  // AES-CTR, AES-CBC, AES-GCM, AES-KW, HMAC, HKDF, PBKDF2 are the algorithms which support the get key length operation
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::AES_CTR:
+  case CryptoAlgorithmIdentifier::AES_CBC:
+  case CryptoAlgorithmIdentifier::AES_GCM:
+  case CryptoAlgorithmIdentifier::AES_KW: {
+    // https://w3c.github.io/webcrypto/#aes-derivedkey-params
+    // 26.7. AesDerivedKeyParams dictionary
+    auto length = enforceRangeMember<uint16_t>(cx, params, "AesDerivedKeyParams", "length",
+                                               std::nullopt);
+    if (!length.has_value()) {
+      return nullptr;
+    }
+    return std::make_unique<CryptoAlgorithmGetKeyLength>(identifier, length.value(),
+                                                         std::nullopt);
+  }
+  case CryptoAlgorithmIdentifier::HMAC: {
+    // https://w3c.github.io/webcrypto/#hmac-importparams
+    // 29.3 HmacImportParams dictionary
+    auto hashIdentifier = hashMember(cx, params, "HmacImportParams");
+    if (hashIdentifier.isErr()) {
+      return nullptr;
+    }
+    JS::RootedValue length_val(cx);
+    if (!JS_GetProperty(cx, params, "length", &length_val)) {
+      return nullptr;
+    }
+    std::optional<size_t> length;
+    if (!length_val.isUndefined()) {
+      auto enforced = enforceRange<uint32_t>(cx, length_val, "HmacImportParams", "length");
+      if (!enforced.has_value()) {
+        return nullptr;
+      }
+      length = enforced.value();
+    }
+    return std::make_unique<CryptoAlgorithmGetKeyLength>(identifier, length,
+                                                         hashIdentifier.unwrap());
+  }
+  case CryptoAlgorithmIdentifier::HKDF:
+  case CryptoAlgorithmIdentifier::PBKDF2: {
+    return std::make_unique<CryptoAlgorithmGetKeyLength>(identifier, std::nullopt, std::nullopt);
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the get key length operation", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+JS::Result<std::optional<size_t>> CryptoAlgorithmGetKeyLength::keyLength(JSContext *cx) {
+  switch (this->algorithm) {
+  // https://w3c.github.io/webcrypto/#aes-ctr-operations
+  case CryptoAlgorithmIdentifier::AES_CTR:
+  case CryptoAlgorithmIdentifier::AES_CBC:
+  case CryptoAlgorithmIdentifier::AES_GCM:
+  case CryptoAlgorithmIdentifier::AES_KW: {
+    // 1. If the length member of normalizedDerivedKeyAlgorithm is not 128, 192 or 256, then
+    // throw an OperationError.
+    auto length = this->length.value_or(0);
+    if (length != 128 && length != 192 && length != 256) {
+      DOMException::raise(cx, "AES key length must be 128, 192 or 256 bits", "OperationError");
+      return JS::Result<std::optional<size_t>>(JS::Error());
+    }
+    // 2. Return the length member of normalizedDerivedKeyAlgorithm.
+    return std::optional<size_t>(length);
+  }
+  // https://w3c.github.io/webcrypto/#hmac-operations
+  case CryptoAlgorithmIdentifier::HMAC: {
+    // 1. If the length member of normalizedDerivedKeyAlgorithm is not present:
+    if (!this->length.has_value()) {
+      // Let length be the block size in bits of the hash function identified by the hash member
+      // of normalizedDerivedKeyAlgorithm.
+      MOZ_ASSERT(this->hashIdentifier.has_value());
+      const EVP_MD *md = createDigestAlgorithm(cx, this->hashIdentifier.value());
+      if (!md) {
+        return JS::Result<std::optional<size_t>>(JS::Error());
+      }
+      return std::optional<size_t>(EVP_MD_get_block_size(md) * 8);
+    }
+    // Otherwise, if the length member of normalizedDerivedKeyAlgorithm is non-zero:
+    // Let length be equal to the length member of normalizedDerivedKeyAlgorithm.
+    // Otherwise: throw a TypeError.
+    if (this->length.value() == 0) {
+      api::throw_error(cx, api::Errors::TypeError, "HmacImportParams", "length", "be non-zero");
+      return JS::Result<std::optional<size_t>>(JS::Error());
+    }
+    return this->length;
+  }
+  // https://w3c.github.io/webcrypto/#hkdf-operations
+  // https://w3c.github.io/webcrypto/#pbkdf2-operations
+  // 1. Return null.
+  default: {
+    return std::optional<size_t>();
+  }
+  }
+}
+
+JSObject *CryptoAlgorithmMD5::digest(JSContext *cx, std::span<uint8_t> data) {
+  return builtins::web::crypto::digest(cx, data, EVP_md5(), MD5_DIGEST_LENGTH);
+}
+JSObject *CryptoAlgorithmSHA1::digest(JSContext *cx, std::span<uint8_t> data) {
+  return builtins::web::crypto::digest(cx, data, EVP_sha1(), SHA_DIGEST_LENGTH);
+}
+JSObject *CryptoAlgorithmSHA256::digest(JSContext *cx, std::span<uint8_t> data) {
+  return builtins::web::crypto::digest(cx, data, EVP_sha256(), SHA256_DIGEST_LENGTH);
+}
+JSObject *CryptoAlgorithmSHA384::digest(JSContext *cx, std::span<uint8_t> data) {
+  return builtins::web::crypto::digest(cx, data, EVP_sha384(), SHA384_DIGEST_LENGTH);
+}
+JSObject *CryptoAlgorithmSHA512::digest(JSContext *cx, std::span<uint8_t> data) {
+  return builtins::web::crypto::digest(cx, data, EVP_sha512(), SHA512_DIGEST_LENGTH);
+}
+
+std::unique_ptr<CryptoAlgorithmGenerateKey>
+CryptoAlgorithmGenerateKey::normalize(JSContext *cx, JS::HandleValue value) {
+  // Do steps 1 through 5.1 of https://w3c.github.io/webcrypto/#algorithm-normalization-normalize-an-algorithm
+  auto identifierResult = normalizeIdentifier(cx, value);
+  if (identifierResult.isErr()) {
+    // If we are here, this means either the identifier could not be coerced to a String or was not recognized
+    // In both those scenarios an exception will have already been created, which is why we are not creating one here.
+    return nullptr;
+  }
+  auto identifier = identifierResult.unwrap();
+  JS::RootedObject params(cx);
+
+  // The value can either be a JS String or a JS Object with a 'name' property which is the algorithm identifier.
+  // Other properties within the object will be the parameters for the algorithm to use.
+  if (value.isString()) {
+    auto *obj = JS_NewPlainObject(cx);
+    params.set(obj);
+    if (!obj || !JS_SetProperty(cx, params, "name", value)) {
+      return nullptr;
+    }
+  } else if (value.isObject()) {
+    params.set(&value.toObject());
+  }
+
+  // The table listed at https://w3c.github.io/webcrypto/#h-note-15 is what defines which algorithms support which operations
+  // RSASSA-PKCS1-v1_5, RSA-PSS, RSA-OAEP, ECDSA, ECDH, AES-CTR, AES-CBC, AES-GCM, AES-KW and HMAC are the algorithms
+  // which support the generateKey operation
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::RSASSA_PKCS1_v1_5: {
+    return CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::ECDSA: {
+    return CryptoAlgorithmECDSA_Generate::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::HMAC: {
+    return CryptoAlgorithmHMAC_Generate::fromParameters(cx, params);
+  }
+  case CryptoAlgorithmIdentifier::AES_CTR:
+  case CryptoAlgorithmIdentifier::AES_CBC:
+  case CryptoAlgorithmIdentifier::AES_GCM: {
+    return CryptoAlgorithmAES_Generate::fromParameters(cx, identifier, params);
+  }
+  case CryptoAlgorithmIdentifier::RSA_PSS:
+  case CryptoAlgorithmIdentifier::RSA_OAEP:
+  case CryptoAlgorithmIdentifier::AES_KW:
+  case CryptoAlgorithmIdentifier::ECDH: {
+    DOMException::raise(cx, "Supplied algorithm is not yet supported", "NotSupportedError");
+    return nullptr;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the generateKey operation", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+namespace {
+
+// Returns a new CryptoKeyPair dictionary holding `publicKey` and `privateKey`.
+JSObject *createKeyPair(JSContext *cx, JS::HandleObject publicKey, JS::HandleObject privateKey) {
+  JS::RootedObject pair(cx, JS_NewPlainObject(cx));
+  if (!pair) {
+    return nullptr;
+  }
+  JS::RootedValue private_val(cx, JS::ObjectValue(*privateKey));
+  JS::RootedValue public_val(cx, JS::ObjectValue(*publicKey));
+  if (!JS_DefineProperty(cx, pair, "privateKey", private_val, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, pair, "publicKey", public_val, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+  return pair;
+}
+
+// Generates a key pair with the parameters set up on `ctx`, and returns it together with a copy
+// of just its public key, so that public CryptoKeys don't hold the private key.
+std::optional<std::pair<EvpPkeyPtr, EvpPkeyPtr>> generateKeyPair(EVP_PKEY_CTX *ctx) {
+  EVP_PKEY *raw_pkey = nullptr;
+  if (EVP_PKEY_generate(ctx, &raw_pkey) <= 0) {
+    return std::nullopt;
+  }
+  EvpPkeyPtr pkey(raw_pkey);
+
+  OSSL_PARAM *raw_params = nullptr;
+  if (EVP_PKEY_todata(pkey.get(), EVP_PKEY_PUBLIC_KEY, &raw_params) != 1) {
+    return std::nullopt;
+  }
+  ParamPtr params(raw_params);
+  EvpPkeyCtxPtr public_ctx(EVP_PKEY_CTX_new_from_pkey(nullptr, pkey.get(), nullptr));
+  EVP_PKEY *raw_public_pkey = nullptr;
+  if (!public_ctx || EVP_PKEY_fromdata_init(public_ctx.get()) <= 0 ||
+      EVP_PKEY_fromdata(public_ctx.get(), &raw_public_pkey, EVP_PKEY_PUBLIC_KEY, params.get()) <=
+          0) {
+    return std::nullopt;
+  }
+  return std::pair(EvpPkeyPtr(raw_public_pkey), std::move(pkey));
+}
+
+// Returns `length` bytes of random data for a secret key, or std::nullopt with a pending exception.
+std::optional<host_api::HostBytes> randomKeyData(JSContext *cx, size_t length) {
+  auto res = host_api::Random::get_bytes(length);
+  if (const auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return std::nullopt;
+  }
+  return std::move(res.unwrap());
+}
+
+} // namespace
+
+std::unique_ptr<CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate>
+CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate::fromParameters(JSContext *cx,
+                                                          JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order, starting with the inherited
+  // RsaKeyGenParams members.
+  auto modulusLength = enforceRangeMember<uint32_t>(cx, parameters, "RsaHashedKeyGenParams",
+                                                    "modulusLength", std::nullopt);
+  if (!modulusLength.has_value()) {
+    return nullptr;
+  }
+  auto publicExponent =
+      bufferSourceMember(cx, parameters, "RsaHashedKeyGenParams", "publicExponent", true);
+  if (!publicExponent.has_value()) {
+    return nullptr;
+  }
+  auto hashIdentifier = hashMember(cx, parameters, "RsaHashedKeyGenParams");
+  if (hashIdentifier.isErr()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate>(
+      hashIdentifier.unwrap(), modulusLength.value(), std::move(publicExponent.value()));
+}
+
+// https://w3c.github.io/webcrypto/#rsassa-pkcs1-operations
+JSObject *CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate::generateKey(JSContext *cx, bool extractable,
+                                                                 CryptoKeyUsages usages) {
+  // 1. If usages contains an entry which is not "sign" or "verify", then throw a SyntaxError.
+  if (!usages.isSubsetOf(CryptoKeyUsages::sign_flag | CryptoKeyUsages::verify_flag)) {
+    DOMException::raise(cx, "RSASSA-PKCS1-v1_5 keys only support 'sign' and 'verify' operations",
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // 2. Generate an RSA key pair, as defined in [RFC3447], with RSA modulus length equal to the
+  // modulusLength member of normalizedAlgorithm and RSA public exponent equal to the
+  // publicExponent member of normalizedAlgorithm.
+  // 3. If performing the operation results in an error, then throw an OperationError.
+  //
+  // OpenSSL retries prime generation until p - 1 is coprime with the exponent, which never happens
+  // for even exponents, so those are rejected up front.
+  BignumPtr exponent(BN_bin2bn(this->publicExponent.data(),
+                               static_cast<int>(this->publicExponent.size()), nullptr));
+  if (!exponent || !BN_is_odd(exponent.get()) || BN_is_one(exponent.get())) {
+    DOMException::raise(cx, "The RSA public exponent must be an odd number greater than 1",
+                        "OperationError");
+    return nullptr;
+  }
+  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new_from_name(nullptr, "RSA", nullptr));
+  if (!ctx || EVP_PKEY_keygen_init(ctx.get()) <= 0 ||
+      EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), static_cast<int>(this->modulusLength)) <= 0 ||
+      EVP_PKEY_CTX_set1_rsa_keygen_pubexp(ctx.get(), exponent.get()) <= 0) {
+    DOMException::raise(cx, "Failed to generate RSA key", "OperationError");
+    return nullptr;
+  }
+  auto keys = generateKeyPair(ctx.get());
+  if (!keys.has_value()) {
+    DOMException::raise(cx, "Failed to generate RSA key", "OperationError");
+    return nullptr;
+  }
+
+  // 4. - 9. Let algorithm be a new RsaHashedKeyAlgorithm dictionary, with the name, modulusLength,
+  // publicExponent and hash of the generated key.
+  CryptoAlgorithmRSASSA_PKCS1_v1_5_Import algorithm(this->hashIdentifier);
+
+  // 10. Let publicKey be a new CryptoKey representing the public key of the generated key pair,
+  // with [[extractable]] set to true, and [[usages]] set to the intersection of usages and
+  // [ "verify" ].
+  JS::RootedObject publicKey(
+      cx, CryptoKey::createRSA(cx, &algorithm, std::move(keys->first), CryptoKeyType::Public,
+                               true, CryptoKeyUsages(usages.toInt() & CryptoKeyUsages::verify_flag)));
+  if (!publicKey) {
+    return nullptr;
+  }
+
+  // 11. Let privateKey be a new CryptoKey representing the private key of the generated key pair,
+  // with [[extractable]] set to extractable, and [[usages]] set to the intersection of usages and
+  // [ "sign" ].
+  JS::RootedObject privateKey(
+      cx, CryptoKey::createRSA(cx, &algorithm, std::move(keys->second), CryptoKeyType::Private,
+                               extractable, CryptoKeyUsages(usages.toInt() & CryptoKeyUsages::sign_flag)));
+  if (!privateKey) {
+    return nullptr;
+  }
+
+  // 12. - 14. Return a new CryptoKeyPair holding publicKey and privateKey.
+  return createKeyPair(cx, publicKey, privateKey);
+}
+
+std::unique_ptr<CryptoAlgorithmECDSA_Generate>
+CryptoAlgorithmECDSA_Generate::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  JS::RootedValue namedCurve_val(cx);
+  if (!JS_GetProperty(cx, parameters, "namedCurve", &namedCurve_val)) {
+    return nullptr;
+  }
+  if (namedCurve_val.isUndefined()) {
+    api::throw_error(cx, api::Errors::TypeError, "EcKeyGenParams", "namedCurve", "be present");
+    return nullptr;
+  }
+  auto namedCurve_chars = core::encode(cx, namedCurve_val);
+  if (!namedCurve_chars) {
+    return nullptr;
+  }
+  // If the namedCurve member of normalizedAlgorithm is not "P-256", "P-384" or "P-521", then
+  // throw a NotSupportedError.
+  auto namedCurve = toNamedCurve(namedCurve_chars);
+  if (!namedCurve.has_value()) {
+    DOMException::raise(cx, "Supplied namedCurve is not supported", "NotSupportedError");
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmECDSA_Generate>(namedCurve.value());
+}
+
+// https://w3c.github.io/webcrypto/#ecdsa-operations
+JSObject *CryptoAlgorithmECDSA_Generate::generateKey(JSContext *cx, bool extractable,
+                                                     CryptoKeyUsages usages) {
+  // 1. If usages contains a value which is not one of "sign" or "verify", then throw a
+  // SyntaxError.
+  if (!usages.isSubsetOf(CryptoKeyUsages::sign_flag | CryptoKeyUsages::verify_flag)) {
+    DOMException::raise(cx, "ECDSA keys only support 'sign' and 'verify' operations",
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // 2. Generate an Elliptic Curve key pair, as defined in [RFC6090] with domain parameters for the
+  // curve identified by the namedCurve member of normalizedAlgorithm.
+  // 3. If performing the key generation operation results in an error, then throw an
+  // OperationError.
+  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr));
+  if (!ctx || EVP_PKEY_keygen_init(ctx.get()) <= 0 ||
+      EVP_PKEY_CTX_set_group_name(ctx.get(), curveName(this->namedCurve)) <= 0) {
+    DOMException::raise(cx, "Failed to generate EC key", "OperationError");
+    return nullptr;
+  }
+  auto keys = generateKeyPair(ctx.get());
+  if (!keys.has_value()) {
+    DOMException::raise(cx, "Failed to generate EC key", "OperationError");
+    return nullptr;
+  }
+
+  // 4. - 6. Let algorithm be a new EcKeyAlgorithm object, with the name "ECDSA" and the
+  // namedCurve of normalizedAlgorithm.
+  CryptoAlgorithmECDSA_Import algorithm(this->namedCurve);
+
+  // 7. - 11. Let publicKey be a new CryptoKey representing the public key of the generated key
+  // pair, with [[extractable]] set to true, and [[usages]] set to the intersection of usages and
+  // [ "verify" ].
+  JS::RootedObject publicKey(
+      cx, CryptoKey::createECDSA(
+              cx, &algorithm, std::move(keys->first), CryptoKeyType::Public, true,
+              CryptoKeyUsages(usages.toInt() & CryptoKeyUsages::verify_flag)));
+  if (!publicKey) {
+    return nullptr;
+  }
+
+  // 12. - 16. Let privateKey be a new CryptoKey representing the private key of the generated key
+  // pair, with [[extractable]] set to extractable, and [[usages]] set to the intersection of
+  // usages and [ "sign" ].
+  JS::RootedObject privateKey(
+      cx, CryptoKey::createECDSA(
+              cx, &algorithm, std::move(keys->second), CryptoKeyType::Private, extractable,
+              CryptoKeyUsages(usages.toInt() & CryptoKeyUsages::sign_flag)));
+  if (!privateKey) {
+    return nullptr;
+  }
+
+  // 17. - 20. Return a new CryptoKeyPair holding publicKey and privateKey.
+  return createKeyPair(cx, publicKey, privateKey);
+}
+
+std::unique_ptr<CryptoAlgorithmHMAC_Generate>
+CryptoAlgorithmHMAC_Generate::fromParameters(JSContext *cx, JS::HandleObject parameters) {
+  // Dictionary members are converted in lexicographical order.
+  auto hashIdentifier = hashMember(cx, parameters, "HmacKeyGenParams");
+  if (hashIdentifier.isErr()) {
+    return nullptr;
+  }
+  JS::RootedValue length_val(cx);
+  if (!JS_GetProperty(cx, parameters, "length", &length_val)) {
+    return nullptr;
+  }
+  std::optional<size_t> length;
+  if (!length_val.isUndefined()) {
+    auto enforced = enforceRange<uint32_t>(cx, length_val, "HmacKeyGenParams", "length");
+    if (!enforced.has_value()) {
+      return nullptr;
+    }
+    length = enforced.value();
+  }
+  return std::make_unique<CryptoAlgorithmHMAC_Generate>(hashIdentifier.unwrap(), length);
+}
+
+// https://w3c.github.io/webcrypto/#hmac-operations
+JSObject *CryptoAlgorithmHMAC_Generate::generateKey(JSContext *cx, bool extractable,
+                                                    CryptoKeyUsages usages) {
+  // 1. If usages contains any entry which is not "sign" or "verify", then throw a SyntaxError.
+  if (!usages.isSubsetOf(CryptoKeyUsages::sign_flag | CryptoKeyUsages::verify_flag)) {
+    DOMException::raise(cx, "HMAC keys only support 'sign' and 'verify' operations",
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // 2. If the length member of normalizedAlgorithm is not present: Let length be the block size
+  // in bits of the hash function identified by the hash member of normalizedAlgorithm.
+  // Otherwise, if the length member of normalizedAlgorithm is non-zero: Let length be equal to
+  // the length member of normalizedAlgorithm.
+  // Otherwise: throw an OperationError.
+  size_t length = 0;
+  if (!this->length.has_value()) {
+    const EVP_MD *md = createDigestAlgorithm(cx, this->hashIdentifier);
+    if (!md) {
+      return nullptr;
+    }
+    length = EVP_MD_get_block_size(md) * 8;
+  } else if (this->length.value() != 0) {
+    length = this->length.value();
+  } else {
+    DOMException::raise(cx, "HMAC key length must be non-zero", "OperationError");
+    return nullptr;
+  }
+
+  // 3. Generate a key of length length bits.
+  // 4. If the key generation step fails, then throw an OperationError.
+  auto data = randomKeyData(cx, (length + 7) / 8);
+  if (!data.has_value()) {
+    return nullptr;
+  }
+  // The key is exactly length bits long, so the unused low-order bits of its last byte are zero.
+  if (length % 8 != 0) {
+    data->ptr[data->len - 1] &= static_cast<uint8_t>(0xFF << (8 - length % 8));
+  }
+
+  // 5. - 13. Let key be a new CryptoKey object representing the generated key, with an
+  // HmacKeyAlgorithm holding length and hash.
+  CryptoAlgorithmHMAC_Import algorithm(this->hashIdentifier, length);
+  auto key_data = std::make_unique<std::span<uint8_t>>(data->ptr.get(), data->len);
+  JSObject *key =
+      CryptoKey::createHMAC(cx, &algorithm, std::move(key_data), length, extractable, usages);
+  OPENSSL_cleanse(data->ptr.get(), data->len);
+  return key;
+}
+
+std::unique_ptr<CryptoAlgorithmAES_Generate>
+CryptoAlgorithmAES_Generate::fromParameters(JSContext *cx, CryptoAlgorithmIdentifier algorithm,
+                                            JS::HandleObject parameters) {
+  auto length =
+      enforceRangeMember<uint16_t>(cx, parameters, "AesKeyGenParams", "length", std::nullopt);
+  if (!length.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<CryptoAlgorithmAES_Generate>(algorithm, length.value());
+}
+
+// https://w3c.github.io/webcrypto/#aes-ctr-operations
+// https://w3c.github.io/webcrypto/#aes-cbc-operations
+// https://w3c.github.io/webcrypto/#aes-gcm-operations
+JSObject *CryptoAlgorithmAES_Generate::generateKey(JSContext *cx, bool extractable,
+                                                   CryptoKeyUsages usages) {
+  // 1. If usages contains any entry which is not one of "encrypt", "decrypt", "wrapKey" or
+  // "unwrapKey", then throw a SyntaxError.
+  if (!usages.isSubsetOf(CryptoKeyUsages::encrypt_flag | CryptoKeyUsages::decrypt_flag |
+                         CryptoKeyUsages::wrap_key_flag | CryptoKeyUsages::unwrap_key_flag)) {
+    DOMException::raise(cx,
+                        "AES keys only support 'encrypt', 'decrypt', 'wrapKey' and 'unwrapKey' "
+                        "operations",
+                        "SyntaxError");
+    return nullptr;
+  }
+
+  // 2. If the length member of normalizedAlgorithm is not equal to one of 128, 192 or 256, then
+  // throw an OperationError.
+  if (this->length != 128 && this->length != 192 && this->length != 256) {
+    DOMException::raise(cx, "AES key length must be 128, 192 or 256 bits", "OperationError");
+    return nullptr;
+  }
+
+  // 3. Generate a key of length bits.
+  // 4. If the key generation step fails, then throw an OperationError.
+  auto data = randomKeyData(cx, this->length / 8);
+  if (!data.has_value()) {
+    return nullptr;
+  }
+
+  // 5. - 10. Let key be a new CryptoKey object representing the generated AES key, with an
+  // AesKeyAlgorithm holding the name and length.
+  CryptoAlgorithmAES_Import algorithm(this->algorithm);
+  algorithm.length = this->length;
+  JSObject *key = CryptoKey::createAES(cx, &algorithm, {data->ptr.get(), data->len}, extractable,
+                                       usages);
+  OPENSSL_cleanse(data->ptr.get(), data->len);
+  return key;
+}
+
+namespace {
+
+// Returns a new ArrayBuffer holding a copy of `data`.
+JSObject *copyToArrayBuffer(JSContext *cx, std::span<const uint8_t> data) {
+  auto bytes = allocateOutput(cx, data.size());
+  if (!bytes) {
+    return nullptr;
+  }
+  std::copy(data.begin(), data.end(), bytes.get());
+  return toArrayBuffer(cx, std::move(bytes), data.size());
+}
+
+// Returns a new ArrayBuffer holding the DER encoding written by `encode`, which has the signature
+// of OpenSSL's `i2d` functions.
+template <typename Encoder> JSObject *encodeDER(JSContext *cx, Encoder encode) {
+  int length = encode(nullptr);
+  if (length <= 0) {
+    DOMException::raise(cx, "Failed to encode the key", "OperationError");
+    return nullptr;
+  }
+  auto bytes = allocateOutput(cx, length);
+  if (!bytes) {
+    return nullptr;
+  }
+  uint8_t *out = bytes.get();
+  if (encode(&out) != length) {
+    DOMException::raise(cx, "Failed to encode the key", "OperationError");
+    return nullptr;
+  }
+  return toArrayBuffer(cx, std::move(bytes), length);
+}
+
+JSObject *exportSPKI(JSContext *cx, JS::HandleObject key) {
+  // If the [[type]] internal slot of key is not "public", then throw an InvalidAccessError.
+  if (CryptoKey::type(key) != CryptoKeyType::Public) {
+    DOMException::raise(cx, "Only public keys can be exported as 'spki'", "InvalidAccessError");
+    return nullptr;
+  }
+  EVP_PKEY *pkey = CryptoKey::key(key);
+  return encodeDER(cx, [pkey](uint8_t **out) { return i2d_PUBKEY(pkey, out); });
+}
+
+JSObject *exportPKCS8(JSContext *cx, JS::HandleObject key) {
+  // If the [[type]] internal slot of key is not "private", then throw an InvalidAccessError.
+  if (CryptoKey::type(key) != CryptoKeyType::Private) {
+    DOMException::raise(cx, "Only private keys can be exported as 'pkcs8'", "InvalidAccessError");
+    return nullptr;
+  }
+  std::unique_ptr<PKCS8_PRIV_KEY_INFO, decltype(&PKCS8_PRIV_KEY_INFO_free)> info(
+      EVP_PKEY2PKCS8(CryptoKey::key(key)), PKCS8_PRIV_KEY_INFO_free);
+  if (!info) {
+    DOMException::raise(cx, "Failed to encode the key", "OperationError");
+    return nullptr;
+  }
+  return encodeDER(cx, [&info](uint8_t **out) {
+    return i2d_PKCS8_PRIV_KEY_INFO(info.get(), out);
+  });
+}
+
+// Returns the base64url encoding of the big-endian bytes of the key parameter `param`, padded to
+// `size` bytes, or to the minimal length if `size` is 0.
+std::optional<std::string> bignumParam(const EVP_PKEY *pkey, const char *param, size_t size = 0) {
+  BIGNUM *raw = nullptr;
+  if (EVP_PKEY_get_bn_param(pkey, param, &raw) != 1) {
+    return std::nullopt;
+  }
+  BignumPtr bn(raw);
+  if (size == 0) {
+    size = std::max(BN_num_bytes(bn.get()), 1);
+  }
+  std::vector<uint8_t> bytes(size);
+  if (BN_bn2binpad(bn.get(), bytes.data(), static_cast<int>(size)) < 0) {
+    return std::nullopt;
+  }
+  auto encoded = base64::base64URLEncode(bytes);
+  OPENSSL_cleanse(bytes.data(), bytes.size());
+  BN_clear(bn.get());
+  return encoded;
+}
+
+// Returns the identifier of the hash of the keyed hash algorithm of `key`.
+JS::Result<CryptoAlgorithmIdentifier> keyHash(JSContext *cx, JS::HandleObject key) {
+  JS::RootedObject alg(cx, CryptoKey::get_algorithm(key));
+  JS::RootedValue hash_val(cx);
+  if (!JS_GetProperty(cx, alg, "hash", &hash_val)) {
+    return JS::Result<CryptoAlgorithmIdentifier>(JS::Error());
+  }
+  return toHashIdentifier(cx, hash_val);
+}
+
+// Returns the JWK algorithm name suffix for the hash `hash`, e.g. "256" for "HS256".
+const char *jwkHashSuffix(CryptoAlgorithmIdentifier hash) {
+  switch (hash) {
+  case CryptoAlgorithmIdentifier::SHA_1: {
+    return "1";
+  }
+  case CryptoAlgorithmIdentifier::SHA_256: {
+    return "256";
+  }
+  case CryptoAlgorithmIdentifier::SHA_384: {
+    return "384";
+  }
+  case CryptoAlgorithmIdentifier::SHA_512: {
+    return "512";
+  }
+  default: {
+    return nullptr;
+  }
+  }
+}
+
+// https://w3c.github.io/webcrypto/#hmac-operations
+// https://w3c.github.io/webcrypto/#aes-ctr-operations
+// https://w3c.github.io/webcrypto/#aes-cbc-operations
+// https://w3c.github.io/webcrypto/#aes-gcm-operations
+JSObject *exportSecretKey(JSContext *cx, CryptoAlgorithmIdentifier algorithm,
+                          CryptoKeyFormat format, JS::HandleObject key) {
+  auto data = CryptoKey::secretKeyData(key);
+  switch (format) {
+  // If format is "raw": Let data be the raw octets of the key represented by the [[handle]]
+  // internal slot of key, and let result be a new ArrayBuffer containing data.
+  case CryptoKeyFormat::Raw: {
+    return copyToArrayBuffer(cx, data);
+  }
+  // If format is "jwk":
+  case CryptoKeyFormat::Jwk: {
+    // Let jwk be a new JsonWebKey dictionary, with the kty attribute set to "oct", the k attribute
+    // set to the base64url encoded raw octets of the key, the key_ops attribute set to the usages
+    // attribute of key and the ext attribute set to the [[extractable]] internal slot of key.
+    JsonWebKey jwk("oct", CryptoKey::usages(key).names(), CryptoKey::extractable(key));
+    jwk.k = base64::base64URLEncode(data);
+
+    // Set the alg attribute of jwk to "HS1", "HS256", "HS384" or "HS512" for HMAC keys, depending
+    // on their hash, and to e.g. "A128GCM" for AES keys, depending on their length and mode.
+    if (algorithm == CryptoAlgorithmIdentifier::HMAC) {
+      auto hash = keyHash(cx, key);
+      if (hash.isErr()) {
+        return nullptr;
+      }
+      const char *suffix = jwkHashSuffix(hash.unwrap());
+      if (!suffix) {
+        DOMException::raise(cx, "The key's hash algorithm has no JWK representation",
+                            "NotSupportedError");
+        return nullptr;
+      }
+      jwk.alg = fmt::format("HS{}", suffix);
+    } else {
+      auto mode = std::string_view(algorithmName(algorithm)).substr(4);
+      jwk.alg = fmt::format("A{}{}", data.size() * 8, mode);
+    }
+    JSObject *result = jwk.toObject(cx);
+    OPENSSL_cleanse(jwk.k->data(), jwk.k->size());
+    return result;
+  }
+  // Otherwise: throw a NotSupportedError.
+  default: {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+// https://w3c.github.io/webcrypto/#ecdsa-operations
+JSObject *exportECKey(JSContext *cx, CryptoKeyFormat format, JS::HandleObject key) {
+  EVP_PKEY *pkey = CryptoKey::key(key);
+  switch (format) {
+  case CryptoKeyFormat::Spki: {
+    return exportSPKI(cx, key);
+  }
+  case CryptoKeyFormat::Pkcs8: {
+    return exportPKCS8(cx, key);
+  }
+  // If format is "raw":
+  case CryptoKeyFormat::Raw: {
+    // If the [[type]] internal slot of key is not "public", then throw an InvalidAccessError.
+    if (CryptoKey::type(key) != CryptoKeyType::Public) {
+      DOMException::raise(cx, "Only public keys can be exported as 'raw'", "InvalidAccessError");
+      return nullptr;
+    }
+    // Let data be an octet string representing the Elliptic Curve point Q represented by the
+    // [[handle]] internal slot of key according to [SEC1] 2.3.3 using the uncompressed format.
+    size_t length = 0;
+    if (EVP_PKEY_get_octet_string_param(pkey, OSSL_PKEY_PARAM_PUB_KEY, nullptr, 0, &length) !=
+        1) {
+      DOMException::raise(cx, "Failed to encode the key", "OperationError");
+      return nullptr;
+    }
+    auto bytes = allocateOutput(cx, length);
+    if (!bytes) {
+      return nullptr;
+    }
+    if (EVP_PKEY_get_octet_string_param(pkey, OSSL_PKEY_PARAM_PUB_KEY, bytes.get(), length,
+                                        &length) != 1) {
+      DOMException::raise(cx, "Failed to encode the key", "OperationError");
+      return nullptr;
+    }
+    return toArrayBuffer(cx, std::move(bytes), length);
+  }
+  // If format is "jwk":
+  case CryptoKeyFormat::Jwk: {
+    // Let jwk be a new JsonWebKey dictionary, with the kty attribute set to "EC" and the crv
+    // attribute set to the namedCurve attribute of the [[algorithm]] internal slot of key.
+    // The curve is identified by its size, which is read from the key.
+    auto size = curveSize(cx, key);
+    if (size.isErr()) {
+      return nullptr;
+    }
+    JsonWebKey jwk("EC", CryptoKey::usages(key).names(), CryptoKey::extractable(key));
+    jwk.crv = "P-" + std::to_string(size.unwrap());
+
+    // Set the x and y attributes of jwk to the base64url encodings of the coordinates of the
+    // public point, and for private keys, the d attribute to the base64url encoding of the
+    // private scalar, all padded to the size of the curve, as required by [JWA] 6.2.
+    size_t coordinate_size = (size.unwrap() + 7) / 8;
+    jwk.x = bignumParam(pkey, OSSL_PKEY_PARAM_EC_PUB_X, coordinate_size);
+    jwk.y = bignumParam(pkey, OSSL_PKEY_PARAM_EC_PUB_Y, coordinate_size);
+    if (CryptoKey::type(key) == CryptoKeyType::Private) {
+      jwk.d = bignumParam(pkey, OSSL_PKEY_PARAM_PRIV_KEY, coordinate_size);
+    }
+    if (!jwk.x || !jwk.y || (CryptoKey::type(key) == CryptoKeyType::Private && !jwk.d)) {
+      DOMException::raise(cx, "Failed to encode the key", "OperationError");
+      return nullptr;
+    }
+    JSObject *result = jwk.toObject(cx);
+    if (jwk.d) {
+      OPENSSL_cleanse(jwk.d->data(), jwk.d->size());
+    }
+    return result;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+// https://w3c.github.io/webcrypto/#rsassa-pkcs1-operations
+JSObject *exportRSAKey(JSContext *cx, CryptoKeyFormat format, JS::HandleObject key) {
+  EVP_PKEY *pkey = CryptoKey::key(key);
+  switch (format) {
+  case CryptoKeyFormat::Spki: {
+    return exportSPKI(cx, key);
+  }
+  case CryptoKeyFormat::Pkcs8: {
+    return exportPKCS8(cx, key);
+  }
+  // If format is "jwk":
+  case CryptoKeyFormat::Jwk: {
+    // Let jwk be a new JsonWebKey dictionary, with the kty attribute set to "RSA".
+    JsonWebKey jwk("RSA", CryptoKey::usages(key).names(), CryptoKey::extractable(key));
+
+    // Set the alg attribute of jwk to "RS1", "RS256", "RS384" or "RS512", depending on the hash
+    // of the [[algorithm]] internal slot of key.
+    auto hash = keyHash(cx, key);
+    if (hash.isErr()) {
+      return nullptr;
+    }
+    const char *suffix = jwkHashSuffix(hash.unwrap());
+    if (!suffix) {
+      DOMException::raise(cx, "The key's hash algorithm has no JWK representation",
+                          "NotSupportedError");
+      return nullptr;
+    }
+    jwk.alg = fmt::format("RS{}", suffix);
+
+    // Set the attributes n and e of jwk according to the corresponding definitions in JSON Web
+    // Algorithms [JWA], Section 6.3.1, and for private keys, the attributes d, p, q, dp, dq and qi
+    // according to Section 6.3.2.
+    jwk.n = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_N);
+    jwk.e = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_E);
+    bool ok = jwk.n && jwk.e;
+    if (CryptoKey::type(key) == CryptoKeyType::Private) {
+      jwk.d = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_D);
+      jwk.p = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_FACTOR1);
+      jwk.q = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_FACTOR2);
+      jwk.dp = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_EXPONENT1);
+      jwk.dq = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_EXPONENT2);
+      jwk.qi = bignumParam(pkey, OSSL_PKEY_PARAM_RSA_COEFFICIENT1);
+      ok = ok && jwk.d && jwk.p && jwk.q && jwk.dp && jwk.dq && jwk.qi;
+    }
+    if (!ok) {
+      DOMException::raise(cx, "Failed to encode the key", "OperationError");
+      return nullptr;
+    }
+    JSObject *result = jwk.toObject(cx);
+    for (auto *member : {&jwk.d, &jwk.p, &jwk.q, &jwk.dp, &jwk.dq, &jwk.qi}) {
+      if (member->has_value()) {
+        OPENSSL_cleanse((*member)->data(), (*member)->size());
+      }
+    }
+    return result;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied format is not supported", "NotSupportedError");
+    return nullptr;
+  }
+  }
+}
+
+} // namespace
+
+JSObject *exportKey(JSContext *cx, CryptoKeyFormat format, JS::HandleObject key) {
+  MOZ_ASSERT(CryptoKey::is_instance(key));
+  auto identifier = CryptoKey::algorithm_identifier(key);
+
+  // https://w3c.github.io/webcrypto/#SubtleCrypto-method-exportKey
+  // 4. If the name member of the [[algorithm]] internal slot of key does not identify a registered
+  // algorithm that supports the export key operation, then throw a NotSupportedError.
+  switch (identifier) {
+  case CryptoAlgorithmIdentifier::HMAC:
+  case CryptoAlgorithmIdentifier::AES_CTR:
+  case CryptoAlgorithmIdentifier::AES_CBC:
+  case CryptoAlgorithmIdentifier::AES_GCM:
+  case CryptoAlgorithmIdentifier::ECDSA:
+  case CryptoAlgorithmIdentifier::RSASSA_PKCS1_v1_5: {
+    break;
+  }
+  default: {
+    DOMException::raise(cx, "Supplied algorithm does not support the exportKey operation",
+                        "NotSupportedError");
+    return nullptr;
+  }
+  }
+
+  // 5. If the [[extractable]] internal slot of key is false, then throw an InvalidAccessError.
+  if (!CryptoKey::extractable(key)) {
+    DOMException::raise(cx, "CryptoKey is not extractable", "InvalidAccessError");
+    return nullptr;
+  }
+
+  // 6. Let result be the result of performing the export key operation specified by the
+  // [[algorithm]] internal slot of key using key and format.
+  if (identifier == CryptoAlgorithmIdentifier::ECDSA) {
+    return exportECKey(cx, format, key);
+  }
+  if (identifier == CryptoAlgorithmIdentifier::RSASSA_PKCS1_v1_5) {
+    return exportRSAKey(cx, format, key);
+  }
+  return exportSecretKey(cx, identifier, format, key);
 }
 
 } // namespace builtins::web::crypto
@@ -1,6 +1,7 @@
 #ifndef BUILTINS_WEB_CRYPTO_CRYPTO_ALGORITHM_H
 #define BUILTINS_WEB_CRYPTO_CRYPTO_ALGORITHM_H
 #include <span>
+#include <vector>
 
 #include "builtin.h"
 #include "crypto-key.h"
@@ -43,6 +44,13 @@ enum class NamedCurve : uint8_t {
 };
 
 const char *algorithmName(CryptoAlgorithmIdentifier algorithm);
+const EVP_MD *createDigestAlgorithm(JSContext *cx, CryptoAlgorithmIdentifier hashIdentifier);
+
+/**
+ * Creates the pinned atoms that let algorithm names be recognized without decoding them. Must be
+ * called before any algorithm is normalized.
+ */
+bool initAlgorithmNames(JSContext *cx);
 
 /// The base class that all algorithm implementations should derive from.
 class CryptoAlgorithm {
@@ -206,6 +214,289 @@ public:
   JSObject *toObject(JSContext *cx);
 };
 
+class CryptoAlgorithmAES_Import final : public CryptoAlgorithmImportKey {
+public:
+  // One of AES_CTR, AES_CBC or AES_GCM.
+  CryptoAlgorithmIdentifier algorithm;
+  // The length in bits of the imported key. Set by importKey, as it is determined by the key data.
+  size_t length = 0;
+
+  [[nodiscard]] const char *name() const noexcept override { return algorithmName(algorithm); };
+  CryptoAlgorithmAES_Import(CryptoAlgorithmIdentifier algorithm) : algorithm{algorithm} {};
+
+  CryptoAlgorithmIdentifier identifier() final { return algorithm; };
+
+  JSObject *importKey(JSContext *cx, CryptoKeyFormat format, JS::HandleValue key_data, bool extractable,
+                      CryptoKeyUsages usages) override;
+  JSObject *importKey(JSContext *cx, CryptoKeyFormat format, KeyData key_data, bool extractable,
+                      CryptoKeyUsages usages) override;
+  JSObject *toObject(JSContext *cx) const;
+};
+
+class CryptoAlgorithmEncryptDecrypt : public CryptoAlgorithm {
+public:
+  virtual JSObject *encrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) = 0;
+  virtual JSObject *decrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) = 0;
+  static std::unique_ptr<CryptoAlgorithmEncryptDecrypt> normalize(JSContext *cx,
+                                                                  JS::HandleValue value);
+};
+
+class CryptoAlgorithmAES_CBC_Encrypt_Decrypt final : public CryptoAlgorithmEncryptDecrypt {
+public:
+  // The initialization vector. Must be 16 bytes long.
+  std::vector<uint8_t> iv;
+
+  [[nodiscard]] const char *name() const noexcept override { return "AES-CBC"; };
+  CryptoAlgorithmAES_CBC_Encrypt_Decrypt(std::vector<uint8_t> iv) : iv{std::move(iv)} {};
+
+  // https://w3c.github.io/webcrypto/#aes-cbc-params
+  // 27.4. AesCbcParams dictionary
+  static std::unique_ptr<CryptoAlgorithmAES_CBC_Encrypt_Decrypt>
+  fromParameters(JSContext *cx, JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::AES_CBC; };
+
+  JSObject *encrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+  JSObject *decrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+};
+
+class CryptoAlgorithmAES_CTR_Encrypt_Decrypt final : public CryptoAlgorithmEncryptDecrypt {
+public:
+  // The initial value of the counter block. Must be 16 bytes long.
+  std::vector<uint8_t> counter;
+  // The length, in bits, of the rightmost part of the counter block that is incremented.
+  uint8_t length;
+
+  [[nodiscard]] const char *name() const noexcept override { return "AES-CTR"; };
+  CryptoAlgorithmAES_CTR_Encrypt_Decrypt(std::vector<uint8_t> counter, uint8_t length)
+      : counter{std::move(counter)}, length{length} {};
+
+  // https://w3c.github.io/webcrypto/#aes-ctr-params
+  // 26.3. AesCtrParams dictionary
+  static std::unique_ptr<CryptoAlgorithmAES_CTR_Encrypt_Decrypt>
+  fromParameters(JSContext *cx, JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::AES_CTR; };
+
+  JSObject *encrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+  JSObject *decrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+};
+
+class CryptoAlgorithmAES_GCM_Encrypt_Decrypt final : public CryptoAlgorithmEncryptDecrypt {
+public:
+  // The initialization vector.
+  std::vector<uint8_t> iv;
+  // Additional data that is authenticated, but not encrypted.
+  std::vector<uint8_t> additionalData;
+  // The length, in bits, of the authentication tag. Defaults to 128.
+  uint8_t tagLength;
+
+  [[nodiscard]] const char *name() const noexcept override { return "AES-GCM"; };
+  CryptoAlgorithmAES_GCM_Encrypt_Decrypt(std::vector<uint8_t> iv,
+                                         std::vector<uint8_t> additionalData, uint8_t tagLength)
+      : iv{std::move(iv)}, additionalData{std::move(additionalData)}, tagLength{tagLength} {};
+
+  // https://w3c.github.io/webcrypto/#aes-gcm-params
+  // 28.3. AesGcmParams dictionary
+  static std::unique_ptr<CryptoAlgorithmAES_GCM_Encrypt_Decrypt>
+  fromParameters(JSContext *cx, JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::AES_GCM; };
+
+  JSObject *encrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+  JSObject *decrypt(JSContext *cx, JS::HandleObject key, std::span<uint8_t> data) override;
+};
+
+class CryptoAlgorithmKDF_Import final : public CryptoAlgorithmImportKey {
+public:
+  // Either HKDF or PBKDF2.
+  CryptoAlgorithmIdentifier algorithm;
+
+  [[nodiscard]] const char *name() const noexcept override { return algorithmName(algorithm); };
+  CryptoAlgorithmKDF_Import(CryptoAlgorithmIdentifier algorithm) : algorithm{algorithm} {};
+
+  CryptoAlgorithmIdentifier identifier() final { return algorithm; };
+
+  JSObject *importKey(JSContext *cx, CryptoKeyFormat format, JS::HandleValue key_data, bool extractable,
+                      CryptoKeyUsages usages) override;
+  JSObject *importKey(JSContext *cx, CryptoKeyFormat format, KeyData key_data, bool extractable,
+                      CryptoKeyUsages usages) override;
+  JSObject *toObject(JSContext *cx) const;
+};
+
+class CryptoAlgorithmDeriveBits : public CryptoAlgorithm {
+public:
+  // Returns a new ArrayBuffer containing `length` bits derived from `key`. `length` is null if it
+  // wasn't given, which algorithms that require a length reject with an OperationError.
+  virtual JSObject *deriveBits(JSContext *cx, JS::HandleObject key,
+                               std::optional<size_t> length) = 0;
+  static std::unique_ptr<CryptoAlgorithmDeriveBits> normalize(JSContext *cx, JS::HandleValue value);
+};
+
+class CryptoAlgorithmHKDF_Derive final : public CryptoAlgorithmDeriveBits {
+public:
+  // The hash member describes the hash algorithm to use.
+  CryptoAlgorithmIdentifier hashIdentifier;
+  // The salt and the application-specific contextual information of the derivation.
+  std::vector<uint8_t> salt;
+  std::vector<uint8_t> info;
+
+  [[nodiscard]] const char *name() const noexcept override { return "HKDF"; };
+  CryptoAlgorithmHKDF_Derive(CryptoAlgorithmIdentifier hashIdentifier, std::vector<uint8_t> salt,
+                             std::vector<uint8_t> info)
+      : hashIdentifier{hashIdentifier}, salt{std::move(salt)}, info{std::move(info)} {};
+
+  // https://w3c.github.io/webcrypto/#hkdf-params
+  // 30.2. HkdfParams dictionary
+  static std::unique_ptr<CryptoAlgorithmHKDF_Derive> fromParameters(JSContext *cx,
+                                                                    JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::HKDF; };
+
+  JSObject *deriveBits(JSContext *cx, JS::HandleObject key, std::optional<size_t> length) override;
+};
+
+class CryptoAlgorithmPBKDF2_Derive final : public CryptoAlgorithmDeriveBits {
+public:
+  // The hash member describes the hash algorithm to use.
+  CryptoAlgorithmIdentifier hashIdentifier;
+  std::vector<uint8_t> salt;
+  // The number of iterations of the hash function to perform.
+  uint32_t iterations;
+
+  [[nodiscard]] const char *name() const noexcept override { return "PBKDF2"; };
+  CryptoAlgorithmPBKDF2_Derive(CryptoAlgorithmIdentifier hashIdentifier, std::vector<uint8_t> salt,
+                               uint32_t iterations)
+      : hashIdentifier{hashIdentifier}, salt{std::move(salt)}, iterations{iterations} {};
+
+  // https://w3c.github.io/webcrypto/#pbkdf2-params
+  // 31.2. Pbkdf2Params dictionary
+  static std::unique_ptr<CryptoAlgorithmPBKDF2_Derive> fromParameters(JSContext *cx,
+                                                                      JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::PBKDF2; };
+
+  JSObject *deriveBits(JSContext *cx, JS::HandleObject key, std::optional<size_t> length) override;
+};
+
+// The "get key length" operation, which deriveKey uses to determine how many bits to derive for
+// the key it imports.
+class CryptoAlgorithmGetKeyLength final : public CryptoAlgorithm {
+public:
+  CryptoAlgorithmIdentifier algorithm;
+  // The length member of AesDerivedKeyParams or HmacImportParams.
+  std::optional<size_t> length;
+  // The hash member of HmacImportParams.
+  std::optional<CryptoAlgorithmIdentifier> hashIdentifier;
+
+  [[nodiscard]] const char *name() const noexcept override { return algorithmName(algorithm); };
+  CryptoAlgorithmGetKeyLength(CryptoAlgorithmIdentifier algorithm,
+                              std::optional<size_t> length,
+                              std::optional<CryptoAlgorithmIdentifier> hashIdentifier)
+      : algorithm{algorithm}, length{length}, hashIdentifier{hashIdentifier} {};
+  CryptoAlgorithmIdentifier identifier() final { return algorithm; };
+
+  // Returns the length in bits of keys of the algorithm, or null for algorithms whose keys don't
+  // have a fixed length.
+  JS::Result<std::optional<size_t>> keyLength(JSContext *cx);
+  static std::unique_ptr<CryptoAlgorithmGetKeyLength> normalize(JSContext *cx,
+                                                                JS::HandleValue value);
+};
+
+class CryptoAlgorithmGenerateKey : public CryptoAlgorithm {
+public:
+  // Returns a new CryptoKey for symmetric algorithms, or a new CryptoKeyPair dictionary for
+  // asymmetric ones.
+  virtual JSObject *generateKey(JSContext *cx, bool extractable, CryptoKeyUsages usages) = 0;
+  static std::unique_ptr<CryptoAlgorithmGenerateKey> normalize(JSContext *cx,
+                                                               JS::HandleValue value);
+};
+
+class CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate final : public CryptoAlgorithmGenerateKey {
+public:
+  // The hash member describes the hash algorithm to use.
+  CryptoAlgorithmIdentifier hashIdentifier;
+  // The length, in bits, of the RSA modulus.
+  uint32_t modulusLength;
+  // The RSA public exponent, as a big-endian unsigned integer.
+  std::vector<uint8_t> publicExponent;
+
+  [[nodiscard]] const char *name() const noexcept override { return "RSASSA-PKCS1-v1_5"; };
+  CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate(CryptoAlgorithmIdentifier hashIdentifier,
+                                            uint32_t modulusLength,
+                                            std::vector<uint8_t> publicExponent)
+      : hashIdentifier{hashIdentifier}, modulusLength{modulusLength},
+        publicExponent{std::move(publicExponent)} {};
+
+  // https://w3c.github.io/webcrypto/#RsaHashedKeyGenParams-dictionary
+  // 20.4. RsaHashedKeyGenParams dictionary
+  static std::unique_ptr<CryptoAlgorithmRSASSA_PKCS1_v1_5_Generate>
+  fromParameters(JSContext *cx, JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final {
+    return CryptoAlgorithmIdentifier::RSASSA_PKCS1_v1_5;
+  };
+
+  JSObject *generateKey(JSContext *cx, bool extractable, CryptoKeyUsages usages) override;
+};
+
+class CryptoAlgorithmECDSA_Generate final : public CryptoAlgorithmGenerateKey {
+public:
+  // A named curve.
+  NamedCurve namedCurve;
+
+  [[nodiscard]] const char *name() const noexcept override { return "ECDSA"; };
+  CryptoAlgorithmECDSA_Generate(NamedCurve namedCurve) : namedCurve{namedCurve} {};
+
+  // https://w3c.github.io/webcrypto/#EcKeyGenParams-dictionary
+  // 23.4. EcKeyGenParams dictionary
+  static std::unique_ptr<CryptoAlgorithmECDSA_Generate> fromParameters(JSContext *cx,
+                                                                       JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::ECDSA; };
+
+  JSObject *generateKey(JSContext *cx, bool extractable, CryptoKeyUsages usages) override;
+};
+
+class CryptoAlgorithmHMAC_Generate final : public CryptoAlgorithmGenerateKey {
+public:
+  // The hash member describes the hash algorithm to use.
+  CryptoAlgorithmIdentifier hashIdentifier;
+  // The length, in bits, of the key. Defaults to the block size of the hash function.
+  std::optional<size_t> length;
+
+  [[nodiscard]] const char *name() const noexcept override { return "HMAC"; };
+  CryptoAlgorithmHMAC_Generate(CryptoAlgorithmIdentifier hashIdentifier,
+                               std::optional<size_t> length)
+      : hashIdentifier{hashIdentifier}, length{length} {};
+
+  // https://w3c.github.io/webcrypto/#hmac-keygen-params
+  // 29.5. HmacKeyGenParams dictionary
+  static std::unique_ptr<CryptoAlgorithmHMAC_Generate> fromParameters(JSContext *cx,
+                                                                      JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return CryptoAlgorithmIdentifier::HMAC; };
+
+  JSObject *generateKey(JSContext *cx, bool extractable, CryptoKeyUsages usages) override;
+};
+
+class CryptoAlgorithmAES_Generate final : public CryptoAlgorithmGenerateKey {
+public:
+  // One of AES_CTR, AES_CBC or AES_GCM.
+  CryptoAlgorithmIdentifier algorithm;
+  // The length, in bits, of the key.
+  uint16_t length;
+
+  [[nodiscard]] const char *name() const noexcept override { return algorithmName(algorithm); };
+  CryptoAlgorithmAES_Generate(CryptoAlgorithmIdentifier algorithm, uint16_t length)
+      : algorithm{algorithm}, length{length} {};
+
+  // https://w3c.github.io/webcrypto/#aes-keygen-params
+  // 26.5. AesKeyGenParams dictionary
+  static std::unique_ptr<CryptoAlgorithmAES_Generate> fromParameters(JSContext *cx,
+                                                                     CryptoAlgorithmIdentifier algorithm,
+                                                                     JS::HandleObject parameters);
+  CryptoAlgorithmIdentifier identifier() final { return algorithm; };
+
+  JSObject *generateKey(JSContext *cx, bool extractable, CryptoKeyUsages usages) override;
+};
+
+// Performs steps 4 to 6 of exportKey, https://w3c.github.io/webcrypto/#SubtleCrypto-method-exportKey,
+// returning an ArrayBuffer, or a JsonWebKey dictionary for the "jwk" format.
+JSObject *exportKey(JSContext *cx, CryptoKeyFormat format, JS::HandleObject key);
+
 class CryptoAlgorithmDigest : public CryptoAlgorithm {
 public:
   virtual JSObject *digest(JSContext *cx, std::span<uint8_t>) = 0;
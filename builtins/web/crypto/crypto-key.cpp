@@ -8,6 +8,10 @@
 #include <openssl/core_names.h>
 #include <openssl/ec.h>
 #include <openssl/err.h>
+#include <openssl/params.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include <array>
 #include <utility>
 
 
@@ -69,6 +73,36 @@ CryptoKeyUsages CryptoKeyUsages::from(const std::vector<std::string>& key_usages
   return {mask};
 }
 
+std::vector<std::string> CryptoKeyUsages::names() const {
+  // The names are ordered alphabetically.
+  std::vector<std::string> names;
+  if (canDecrypt()) {
+    names.emplace_back("decrypt");
+  }
+  if (canDeriveBits()) {
+    names.emplace_back("deriveBits");
+  }
+  if (canDeriveKey()) {
+    names.emplace_back("deriveKey");
+  }
+  if (canEncrypt()) {
+    names.emplace_back("encrypt");
+  }
+  if (canSign()) {
+    names.emplace_back("sign");
+  }
+  if (canUnwrapKey()) {
+    names.emplace_back("unwrapKey");
+  }
+  if (canVerify()) {
+    names.emplace_back("verify");
+  }
+  if (canWrapKey()) {
+    names.emplace_back("wrapKey");
+  }
+  return names;
+}
+
 JS::Result<CryptoKeyUsages> CryptoKeyUsages::from(JSContext *cx, JS::HandleValue key_usages) {
   bool key_usages_is_array = false;
   if (!JS::IsArrayObject(cx, key_usages, &key_usages_is_array)) {
@@ -225,59 +259,16 @@ bool CryptoKey::usages_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
   MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
   auto usage = CryptoKeyUsages(static_cast<uint8_t>(usages));
-  // The result is ordered alphabetically.
   JS::RootedValueVector result(cx);
   JS::RootedString str(cx);
-  auto append = [&](const char *name) -> bool {
-    if (!(str = JS_AtomizeString(cx, name))) {
+  for (const auto &name : usage.names()) {
+    if (!(str = JS_AtomizeString(cx, name.c_str()))) {
       return false;
     }
     if (!result.append(JS::StringValue(str))) {
       js::ReportOutOfMemory(cx);
       return false;
     }
-    return true;
-  };
-
-  if (usage.canDecrypt()) {
-    if (!append("decrypt")) {
-      return false;
-    }
-  }
-  if (usage.canDeriveBits()) {
-    if (!append("deriveBits")) {
-      return false;
-    }
-  }
-  if (usage.canDeriveKey()) {
-    if (!append("deriveKey")) {
-      return false;
-    }
-  }
-  if (usage.canEncrypt()) {
-    if (!append("encrypt")) {
-      return false;
-    }
-  }
-  if (usage.canSign()) {
-    if (!append("sign")) {
-      return false;
-    }
-  }
-  if (usage.canUnwrapKey()) {
-    if (!append("unwrapKey")) {
-      return false;
-    }
-  }
-  if (usage.canVerify()) {
-    if (!append("verify")) {
-      return false;
-    }
-  }
-  if (usage.canWrapKey()) {
-    if (!append("wrapKey")) {
-      return false;
-    }
   }
 
   JS::Rooted<JSObject *> array(cx, JS::NewArrayObject(cx, result));
@@ -310,12 +301,61 @@ const JSPropertySpec CryptoKey::properties[] = {
     JS_PS_END};
 
 bool CryptoKey::init_class(JSContext *cx, JS::HandleObject global) {
-  return BuiltinImpl<CryptoKey>::init_class_impl(cx, global);
+  return init_class_impl(cx, global);
 }
 
 namespace {
 
-int bn_len(BIGNUM *a) { return BN_num_bytes(a) * 8; }
+// A context set up for a signature operation, together with the digest it was set up for.
+struct SignatureContext {
+  EvpPkeyCtxPtr ctx;
+  const EVP_MD *md = nullptr;
+};
+
+// The DER encoding of a private key, which is wiped when it's freed.
+struct Pkcs8Deleter {
+  int length = 0;
+  void operator()(uint8_t *der) const { OPENSSL_clear_free(der, length); }
+};
+
+// The contexts stored in the `Contexts` slot of a key.
+struct KeyContexts {
+  EvpMacCtxPtr hmac;
+  SignatureContext sign;
+  SignatureContext verify;
+  // The PKCS #8 encoding of private keys whose operations are offloaded to the host.
+  std::unique_ptr<uint8_t, Pkcs8Deleter> pkcs8;
+};
+
+KeyContexts *contexts(JSObject *self) {
+  auto slot = JS::GetReservedSlot(self, std::to_underlying(CryptoKey::Slots::Contexts));
+  if (!slot.isUndefined()) {
+    return static_cast<KeyContexts *>(slot.toPrivate());
+  }
+  auto *contexts = new KeyContexts();
+  JS::SetReservedSlot(self, std::to_underlying(CryptoKey::Slots::Contexts),
+                      JS::PrivateValue(contexts));
+  return contexts;
+}
+
+} // namespace
+
+void CryptoKey::finalize(JS::GCContext *gcx, JSObject *self) {
+  auto key = JS::GetReservedSlot(self, std::to_underlying(Slots::Key));
+  if (!key.isUndefined()) {
+    EVP_PKEY_free(static_cast<EVP_PKEY *>(key.toPrivate()));
+  }
+  auto key_data = JS::GetReservedSlot(self, std::to_underlying(Slots::KeyData));
+  if (!key_data.isUndefined()) {
+    delete[] static_cast<uint8_t *>(key_data.toPrivate());
+  }
+  auto key_contexts = JS::GetReservedSlot(self, std::to_underlying(Slots::Contexts));
+  if (!key_contexts.isUndefined()) {
+    delete static_cast<KeyContexts *>(key_contexts.toPrivate());
+  }
+}
+
+namespace {
 
 int curve_identifier(NamedCurve curve) {
   switch (curve) {
@@ -591,6 +631,40 @@ EvpPkeyPtr create_rsa_key_from_parts(
   return pkey;
 }
 
+// Copies secret key material into memory owned by the key.
+void set_key_data(JSObject *instance, std::span<uint8_t> data) {
+  auto *bytes = new uint8_t[data.size()];
+  std::copy(data.begin(), data.end(), bytes);
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::KeyDataLength),
+                      JS::Int32Value(data.size()));
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::KeyData),
+                      JS::PrivateValue(bytes));
+}
+
+// Sets up the contexts for the operations `usages` allow when a key is created during
+// initialization, so that they are included in the snapshot and don't need to be set up again
+// when the key is used to handle requests. Failures are ignored, as the contexts will be set up
+// again, and report their errors, when the key is used.
+void prepare_contexts(JSContext *cx, JS::HandleObject instance, CryptoAlgorithmIdentifier hash,
+                      CryptoKeyUsages usages) {
+  if (api::Engine::get(cx)->state() != api::EngineState::ScriptPreInitializing) {
+    return;
+  }
+  const EVP_MD *md = createDigestAlgorithm(cx, hash);
+  if (!md) {
+    JS_ClearPendingException(cx);
+    return;
+  }
+  if (CryptoKey::type(instance) == CryptoKeyType::Secret) {
+    static_cast<void>(CryptoKey::hmacContext(instance, md));
+  } else if (CryptoKey::type(instance) == CryptoKeyType::Private && usages.canSign()) {
+    static_cast<void>(CryptoKey::signatureContext(instance, true, md));
+  } else if (CryptoKey::type(instance) == CryptoKeyType::Public && usages.canVerify()) {
+    static_cast<void>(CryptoKey::signatureContext(instance, false, md));
+  }
+  ERR_clear_error();
+}
+
 } // namespace
 
 JSObject *CryptoKey::createHMAC(JSContext *cx, CryptoAlgorithmHMAC_Import *algorithm,
@@ -610,14 +684,62 @@ JSObject *CryptoKey::createHMAC(JSContext *cx, CryptoAlgorithmHMAC_Import *algor
   }
 
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Algorithm), JS::ObjectValue(*alg));
+  JS::SetReservedSlot(instance, std::to_underlying(Slots::AlgorithmIdentifier),
+                      JS::Int32Value(std::to_underlying(algorithm->identifier())));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Type), JS::Int32Value(static_cast<uint8_t>(CryptoKeyType::Secret)));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Extractable), JS::BooleanValue(extractable));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Usages), JS::Int32Value(usages.toInt()));
-  JS::SetReservedSlot(instance, std::to_underlying(Slots::KeyDataLength), JS::Int32Value(data->size()));
-  JS::SetReservedSlot(instance, std::to_underlying(Slots::KeyData), JS::PrivateValue(data.release()->data()));
+  set_key_data(instance, *data);
+  prepare_contexts(cx, instance, algorithm->hashIdentifier, usages);
+  return instance;
+}
+
+namespace {
+
+JSObject *create_secret_key(JSContext *cx, CryptoAlgorithmIdentifier identifier,
+                            JS::HandleObject alg, std::span<uint8_t> data, bool extractable,
+                            CryptoKeyUsages usages) {
+  JS::RootedObject instance(
+      cx, JS_NewObjectWithGivenProto(cx, &CryptoKey::class_, CryptoKey::proto_obj));
+  if (!instance) {
+    return nullptr;
+  }
+
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::Algorithm), JS::ObjectValue(*alg));
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::AlgorithmIdentifier),
+                      JS::Int32Value(std::to_underlying(identifier)));
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::Type), JS::Int32Value(static_cast<uint8_t>(CryptoKeyType::Secret)));
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::Extractable), JS::BooleanValue(extractable));
+  JS::SetReservedSlot(instance, std::to_underlying(CryptoKey::Slots::Usages), JS::Int32Value(usages.toInt()));
+  set_key_data(instance, data);
   return instance;
 }
 
+} // namespace
+
+JSObject *CryptoKey::createAES(JSContext *cx, CryptoAlgorithmAES_Import *algorithm,
+                               std::span<uint8_t> data, bool extractable, CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  MOZ_ASSERT(algorithm);
+  JS::RootedObject alg(cx, algorithm->toObject(cx));
+  if (!alg) {
+    return nullptr;
+  }
+  return create_secret_key(cx, algorithm->identifier(), alg, data, extractable, usages);
+}
+
+JSObject *CryptoKey::createKDF(JSContext *cx, CryptoAlgorithmKDF_Import *algorithm,
+                               std::span<uint8_t> data, CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  MOZ_ASSERT(algorithm);
+  JS::RootedObject alg(cx, algorithm->toObject(cx));
+  if (!alg) {
+    return nullptr;
+  }
+  // Key derivation keys are never extractable.
+  return create_secret_key(cx, algorithm->identifier(), alg, data, false, usages);
+}
+
 JSObject *CryptoKey::createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *algorithm,
                                  std::unique_ptr<CryptoKeyECComponents> keyData, bool extractable,
                                  CryptoKeyUsages usages) {
@@ -659,6 +781,16 @@ JSObject *CryptoKey::createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *alg
     return nullptr;
   }
 
+  return createECDSA(cx, algorithm, std::move(pkey), keyType, extractable, usages);
+}
+
+JSObject *CryptoKey::createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *algorithm,
+                                 EvpPkeyPtr pkey, CryptoKeyType type, bool extractable,
+                                 CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  MOZ_ASSERT(algorithm);
+  MOZ_ASSERT(pkey);
+
   JS::RootedObject instance(
       cx, JS_NewObjectWithGivenProto(cx, &CryptoKey::class_, CryptoKey::proto_obj));
   if (!instance) {
@@ -671,7 +803,9 @@ JSObject *CryptoKey::createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *alg
   }
 
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Algorithm), JS::ObjectValue(*alg));
-  JS::SetReservedSlot(instance, std::to_underlying(Slots::Type), JS::Int32Value(static_cast<uint8_t>(keyType)));
+  JS::SetReservedSlot(instance, std::to_underlying(Slots::AlgorithmIdentifier),
+                      JS::Int32Value(std::to_underlying(algorithm->identifier())));
+  JS::SetReservedSlot(instance, std::to_underlying(Slots::Type), JS::Int32Value(static_cast<uint8_t>(type)));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Extractable), JS::BooleanValue(extractable));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Usages), JS::Int32Value(usages.toInt()));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Key), JS::PrivateValue(pkey.release()));
@@ -743,10 +877,22 @@ JSObject *CryptoKey::createRSA(JSContext *cx, CryptoAlgorithmRSASSA_PKCS1_v1_5_I
     return nullptr;
   }
 
-  auto n_copy = make_bignum(keyData->modulus);
-  if (!n_copy) {
+  return createRSA(cx, algorithm, std::move(pkey), keyType, extractable, usages);
+}
+
+JSObject *CryptoKey::createRSA(JSContext *cx, CryptoAlgorithmRSASSA_PKCS1_v1_5_Import *algorithm,
+                               EvpPkeyPtr pkey, CryptoKeyType type, bool extractable,
+                               CryptoKeyUsages usages) {
+  MOZ_ASSERT(cx);
+  MOZ_ASSERT(algorithm);
+  MOZ_ASSERT(pkey);
+
+  BIGNUM *e_raw = nullptr;
+  if (EVP_PKEY_get_bn_param(pkey.get(), OSSL_PKEY_PARAM_RSA_E, &e_raw) != 1) {
+    DOMException::raise(cx, "Failed to read the RSA public exponent", "OperationError");
     return nullptr;
   }
+  BignumPtr e(e_raw);
 
   JS::RootedObject instance(
       cx, JS_NewObjectWithGivenProto(cx, &CryptoKey::class_, CryptoKey::proto_obj));
@@ -760,46 +906,36 @@ JSObject *CryptoKey::createRSA(JSContext *cx, CryptoAlgorithmRSASSA_PKCS1_v1_5_I
   }
 
   // Set the modulusLength attribute of algorithm to the length, in bits, of the RSA public modulus.
-  JS::RootedValue modulusLength(cx, JS::NumberValue(bn_len(n_copy.get())));
+  JS::RootedValue modulusLength(cx, JS::NumberValue(EVP_PKEY_get_bits(pkey.get())));
   if (!JS_SetProperty(cx, alg, "modulusLength", modulusLength)) {
     return nullptr;
   }
 
-  auto p = mozilla::MakeUnique<uint8_t[]>(keyData->exponent.size());
-  auto exp = keyData->exponent;
-  std::copy(exp.begin(), exp.end(), p.get());
-
-  JS::RootedObject buffer(
-      cx, JS::NewArrayBufferWithContents(cx, keyData->exponent.size(), p.get(),
-                                         JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-
-  // `buffer` takes ownership of `p` if the call to NewArrayBufferWithContents was successful
-  // if the call was not successful, we need to free `p` before exiting from the function.
-  if (!buffer) {
-    // We can be here if the array buffer was too large -- if that was the case then a
-    // JSMSG_BAD_ARRAY_LENGTH will have been created. Otherwise we're probably out of memory.
-    if (!JS_IsExceptionPending(cx)) {
-      js::ReportOutOfMemory(cx);
-    }
-    return nullptr;
-  }
-
-  // At this point, `buffer` owns the memory managed by `p`.
-  static_cast<void>(p.release());
-
   // Set the publicExponent attribute of algorithm to the BigInteger representation of the RSA
   // public exponent.
-  JS::RootedObject byte_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, keyData->exponent.size()));
+  size_t exponent_length = BN_num_bytes(e.get());
+  JS::RootedObject byte_array(cx, JS_NewUint8Array(cx, exponent_length));
+  if (!byte_array) {
+    return nullptr;
+  }
+  {
+    JS::AutoCheckCannotGC noGC(cx);
+    bool is_shared = false;
+    BN_bn2bin(e.get(), JS_GetUint8ArrayData(byte_array, &is_shared, noGC));
+  }
   JS::RootedValue publicExponent(cx, JS::ObjectValue(*byte_array));
   if (!JS_SetProperty(cx, alg, "publicExponent", publicExponent)) {
     return nullptr;
   }
 
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Algorithm), JS::ObjectValue(*alg));
-  JS::SetReservedSlot(instance, std::to_underlying(Slots::Type), JS::Int32Value(static_cast<uint8_t>(keyType)));
+  JS::SetReservedSlot(instance, std::to_underlying(Slots::AlgorithmIdentifier),
+                      JS::Int32Value(std::to_underlying(algorithm->identifier())));
+  JS::SetReservedSlot(instance, std::to_underlying(Slots::Type), JS::Int32Value(static_cast<uint8_t>(type)));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Extractable), JS::BooleanValue(extractable));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Usages), JS::Int32Value(usages.toInt()));
   JS::SetReservedSlot(instance, std::to_underlying(Slots::Key), JS::PrivateValue(pkey.release()));
+  prepare_contexts(cx, instance, algorithm->hashIdentifier, usages);
   return instance;
 }
 
@@ -814,41 +950,145 @@ JSObject *CryptoKey::get_algorithm(JS::HandleObject self) {
   return algorithm;
 }
 
+CryptoAlgorithmIdentifier CryptoKey::algorithm_identifier(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  return static_cast<CryptoAlgorithmIdentifier>(
+      JS::GetReservedSlot(self, std::to_underlying(Slots::AlgorithmIdentifier)).toInt32());
+}
+
+bool CryptoKey::extractable(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  return JS::GetReservedSlot(self, std::to_underlying(Slots::Extractable)).toBoolean();
+}
+
+CryptoKeyUsages CryptoKey::usages(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
+  MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
+  return {static_cast<uint8_t>(usages)};
+}
+
 EVP_PKEY *CryptoKey::key(JSObject *self) {
   MOZ_ASSERT(is_instance(self));
   return static_cast<EVP_PKEY *>(JS::GetReservedSlot(self, std::to_underlying(Slots::Key)).toPrivate());
 }
 
-std::span<uint8_t> CryptoKey::hmacKeyData(JSObject *self) {
+std::span<uint8_t> CryptoKey::secretKeyData(JSObject *self) {
   MOZ_ASSERT(is_instance(self));
   return {
       static_cast<uint8_t *>(JS::GetReservedSlot(self, std::to_underlying(Slots::KeyData)).toPrivate()),
       static_cast<size_t>(JS::GetReservedSlot(self, std::to_underlying(Slots::KeyDataLength)).toInt32())};
 }
 
-JS::Result<bool> CryptoKey::is_algorithm(JSContext *cx, JS::HandleObject self,
-                                         CryptoAlgorithmIdentifier algorithm) {
-  MOZ_ASSERT(CryptoKey::is_instance(self));
-  JS::RootedObject self_algorithm(cx, JS::GetReservedSlot(self, std::to_underlying(Slots::Algorithm)).toObjectOrNull());
-  MOZ_ASSERT(self_algorithm != nullptr);
-  JS::Rooted<JS::Value> name_val(cx);
-  if (!JS_GetProperty(cx, self_algorithm, "name", &name_val)) {
-    return JS::Result<bool>(JS::Error());
+EvpMacCtxPtr CryptoKey::hmacContext(JSObject *self, const EVP_MD *md) {
+  MOZ_ASSERT(is_instance(self));
+  static EVP_MAC *hmac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+  if (!hmac) {
+    return nullptr;
   }
-  JS::Rooted<JSString *> str(cx, JS::ToString(cx, name_val));
-  if (!str) {
-    return JS::Result<bool>(JS::Error());
+
+  // An HMAC key is always used with the hash it was imported with, so its context only needs to
+  // be keyed once.
+  auto &context = contexts(self)->hmac;
+  if (!context) {
+    EvpMacCtxPtr ctx(EVP_MAC_CTX_new(hmac));
+    if (!ctx) {
+      return nullptr;
+    }
+    // OpenSSL only reads the name, despite taking a mutable pointer.
+    auto *md_name = const_cast<char *>(EVP_MD_get0_name(md)); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    std::array<OSSL_PARAM, 2> params = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, md_name, 0),
+        OSSL_PARAM_construct_end(),
+    };
+    auto key_data = secretKeyData(self);
+    if (EVP_MAC_init(ctx.get(), key_data.data(), key_data.size(), params.data()) != 1) {
+      return nullptr;
+    }
+    context = std::move(ctx);
   }
-  // TODO: should chars be used?
-  auto chars = core::encode(cx, str);
-  if (!chars) {
-    return JS::Result<bool>(JS::Error());
+  return EvpMacCtxPtr(EVP_MAC_CTX_dup(context.get()));
+}
+
+EvpPkeyCtxPtr CryptoKey::signatureContext(JSObject *self, bool sign, const EVP_MD *md) {
+  MOZ_ASSERT(is_instance(self));
+  auto &context = sign ? contexts(self)->sign : contexts(self)->verify;
+
+  // ECDSA keys can be used with a different hash for every operation, in which case the context
+  // is set up again for the new one.
+  if (!context.ctx || context.md != md) {
+    EVP_PKEY *pkey = key(self);
+    EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new(pkey, nullptr));
+    if (!ctx) {
+      return nullptr;
+    }
+    if ((sign ? EVP_PKEY_sign_init(ctx.get()) : EVP_PKEY_verify_init(ctx.get())) <= 0) {
+      return nullptr;
+    }
+    if (EVP_PKEY_get_base_id(pkey) == EVP_PKEY_RSA &&
+        EVP_PKEY_CTX_set_rsa_padding(ctx.get(), RSA_PKCS1_PADDING) <= 0) {
+      return nullptr;
+    }
+    if (EVP_PKEY_CTX_set_signature_md(ctx.get(), md) <= 0) {
+      return nullptr;
+    }
+    context.ctx = std::move(ctx);
+    context.md = md;
   }
-  bool match = false;
-  if (!JS_StringEqualsAscii(cx, JS::ToString(cx, name_val), algorithmName(algorithm), &match)) {
-    return JS::Result<bool>(JS::Error());
+  return EvpPkeyCtxPtr(EVP_PKEY_CTX_dup(context.ctx.get()));
+}
+
+std::span<const uint8_t> CryptoKey::pkcs8(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  MOZ_ASSERT(type(self) == CryptoKeyType::Private);
+  auto &pkcs8 = contexts(self)->pkcs8;
+  if (!pkcs8) {
+    std::unique_ptr<PKCS8_PRIV_KEY_INFO, decltype(&PKCS8_PRIV_KEY_INFO_free)> info(
+        EVP_PKEY2PKCS8(key(self)), PKCS8_PRIV_KEY_INFO_free);
+    uint8_t *der = nullptr;
+    int length = info ? i2d_PKCS8_PRIV_KEY_INFO(info.get(), &der) : 0;
+    if (length <= 0) {
+      return {};
+    }
+    pkcs8 = std::unique_ptr<uint8_t, Pkcs8Deleter>(der, Pkcs8Deleter{length});
   }
-  return match;
+  return {pkcs8.get(), static_cast<size_t>(pkcs8.get_deleter().length)};
+}
+
+bool CryptoKey::is_algorithm(JSObject *self, CryptoAlgorithmIdentifier algorithm) {
+  return algorithm_identifier(self) == algorithm;
+}
+
+bool CryptoKey::canEncrypt(JS::HandleObject self) {
+  MOZ_ASSERT(is_instance(self));
+  auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
+  MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
+  auto usage = CryptoKeyUsages(static_cast<uint8_t>(usages));
+  return usage.canEncrypt();
+}
+
+bool CryptoKey::canDecrypt(JS::HandleObject self) {
+  MOZ_ASSERT(is_instance(self));
+  auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
+  MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
+  auto usage = CryptoKeyUsages(static_cast<uint8_t>(usages));
+  return usage.canDecrypt();
+}
+
+bool CryptoKey::canDeriveKey(JS::HandleObject self) {
+  MOZ_ASSERT(is_instance(self));
+  auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
+  MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
+  auto usage = CryptoKeyUsages(static_cast<uint8_t>(usages));
+  return usage.canDeriveKey();
+}
+
+bool CryptoKey::canDeriveBits(JS::HandleObject self) {
+  MOZ_ASSERT(is_instance(self));
+  auto usages = JS::GetReservedSlot(self, std::to_underlying(Slots::Usages)).toInt32();
+  MOZ_ASSERT(std::in_range<std::uint8_t>(usages));
+  auto usage = CryptoKeyUsages(static_cast<uint8_t>(usages));
+  return usage.canDeriveBits();
 }
 
 bool CryptoKey::canSign(JS::HandleObject self) {
@@ -5,6 +5,7 @@
 
 #include "crypto-key-ec-components.h"
 #include "crypto-key-rsa-components.h"
+#include "crypto-raii.h"
 #include "openssl/evp.h"
 
 
@@ -14,6 +15,8 @@ enum class CryptoAlgorithmIdentifier : uint8_t;
 class CryptoAlgorithmRSASSA_PKCS1_v1_5_Import;
 class CryptoAlgorithmHMAC_Import;
 class CryptoAlgorithmECDSA_Import;
+class CryptoAlgorithmAES_Import;
+class CryptoAlgorithmKDF_Import;
 enum class CryptoKeyType : uint8_t { Public, Private, Secret };
 
 enum class CryptoKeyFormat : uint8_t { Raw, Spki, Pkcs8, Jwk };
@@ -39,9 +42,13 @@ public:
   static CryptoKeyUsages from(const std::vector<std::string>& key_usages);
   static JS::Result<CryptoKeyUsages> from(JSContext *cx, JS::HandleValue key_usages);
 
+  // Returns the names of the usages, ordered alphabetically as in `CryptoKey.prototype.usages`.
+  [[nodiscard]] std::vector<std::string> names() const;
+
   [[nodiscard]] uint8_t toInt() const { return this->mask; };
 
   [[nodiscard]] bool isEmpty() const { return this->mask == 0; };
+  [[nodiscard]] bool isSubsetOf(uint8_t flags) const { return (this->mask & ~flags) == 0; };
   bool isSuperSetOf(CryptoKeyUsages &other) const { return (this->mask & other.mask) != 0; };
 
   [[nodiscard]] bool canEncrypt() const { return (this->mask & encrypt_flag) != 0; };
@@ -64,7 +71,7 @@ public:
   [[nodiscard]] bool canOnlyUnwrapKey() const { return this->mask == unwrap_key_flag; };
 };
 
-class CryptoKey : public BuiltinNoConstructor<CryptoKey> {
+class CryptoKey : public BuiltinNoConstructor<CryptoKey, FinalizableClassPolicy> {
 public:
   static const int ctor_length = 0;
   static constexpr const char *class_name = "CryptoKey";
@@ -93,6 +100,10 @@ public:
     // We store a JS::ObjectValue within this slot which contains a JS Object representation of the
     // algorithm.
     Algorithm,
+    // The algorithm the key was created for, which operations check and dispatch on instead of the
+    // name member of the Algorithm object, as script can modify that.
+    // We store a JS::Int32Value representation of the CryptoAlgorithmIdentifier in this slot.
+    AlgorithmIdentifier,
     // The type of the underlying key.
     // We store a JS::Int32Value representation of the CryptoKeyType variant in this slot
     Type,
@@ -107,10 +118,16 @@ public:
     UsagesArray,
     // We store a JS::PrivateValue in this slot, it will contain either the raw key data.
     // It will either be an `EVP_PKEY *` or an `uint8_t *`.
-    // `uint8_t *` is used only for HMAC keys, `EVP_PKEY *` is used for all the other key types.
+    // `uint8_t *` is used for HMAC and AES keys, `EVP_PKEY *` is used for all the other key types.
+    // Both are owned by the key, and freed when it is finalized.
     Key,
     KeyData,
     KeyDataLength,
+    // We store a JS::PrivateValue in this slot, containing the OpenSSL contexts that were set up
+    // for operations with this key, which are duplicated for every operation instead of being
+    // set up from scratch, and the key's PKCS #8 encoding if it's passed to the host. They are
+    // created when first needed, and owned by the key.
+    Contexts,
     Count
   };
   static const JSFunctionSpec static_methods[];
@@ -119,6 +136,7 @@ public:
   static const JSPropertySpec properties[];
 
   static bool init_class(JSContext *cx, JS::HandleObject global);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
 
   static JSObject *createHMAC(JSContext *cx, CryptoAlgorithmHMAC_Import *algorithm,
                               std::unique_ptr<std::span<uint8_t>> data, unsigned long length,
@@ -126,17 +144,47 @@ public:
   static JSObject *createRSA(JSContext *cx, CryptoAlgorithmRSASSA_PKCS1_v1_5_Import *algorithm,
                              std::unique_ptr<CryptoKeyRSAComponents> keyData, bool extractable,
                              CryptoKeyUsages usages);
+  // Creates a key of type `type` that takes ownership of `pkey`.
+  static JSObject *createRSA(JSContext *cx, CryptoAlgorithmRSASSA_PKCS1_v1_5_Import *algorithm,
+                             EvpPkeyPtr pkey, CryptoKeyType type, bool extractable,
+                             CryptoKeyUsages usages);
   static JSObject *createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *algorithm,
                                std::unique_ptr<CryptoKeyECComponents> keyData, bool extractable,
                                CryptoKeyUsages usages);
+  // Creates a key of type `type` that takes ownership of `pkey`.
+  static JSObject *createECDSA(JSContext *cx, CryptoAlgorithmECDSA_Import *algorithm,
+                               EvpPkeyPtr pkey, CryptoKeyType type, bool extractable,
+                               CryptoKeyUsages usages);
+  static JSObject *createAES(JSContext *cx, CryptoAlgorithmAES_Import *algorithm,
+                             std::span<uint8_t> data, bool extractable, CryptoKeyUsages usages);
+  static JSObject *createKDF(JSContext *cx, CryptoAlgorithmKDF_Import *algorithm,
+                             std::span<uint8_t> data, CryptoKeyUsages usages);
   static CryptoKeyType type(JSObject *self);
   static JSObject *get_algorithm(JS::HandleObject self);
+  static CryptoAlgorithmIdentifier algorithm_identifier(JSObject *self);
+  static bool extractable(JSObject *self);
+  static CryptoKeyUsages usages(JSObject *self);
   static EVP_PKEY *key(JSObject *self);
-  static std::span<uint8_t> hmacKeyData(JSObject *self);
+  static std::span<uint8_t> secretKeyData(JSObject *self);
+
+  // Returns a new HMAC context keyed with the secret key data and `md`, ready for the message to
+  // be added, or nullptr on failure.
+  static EvpMacCtxPtr hmacContext(JSObject *self, const EVP_MD *md);
+
+  // Returns a new context initialized for signing, or for verifying if `sign` is false, with the
+  // key and `md`, or nullptr on failure. RSA keys use PKCS#1 v1.5 padding.
+  static EvpPkeyCtxPtr signatureContext(JSObject *self, bool sign, const EVP_MD *md);
+
+  // Returns the DER encoded PKCS #8 representation of the private key, which is created when
+  // first needed and then cached, or an empty span on failure.
+  static std::span<const uint8_t> pkcs8(JSObject *self);
+  static bool canEncrypt(JS::HandleObject self);
+  static bool canDecrypt(JS::HandleObject self);
+  static bool canDeriveKey(JS::HandleObject self);
+  static bool canDeriveBits(JS::HandleObject self);
   static bool canSign(JS::HandleObject self);
   static bool canVerify(JS::HandleObject self);
-  static JS::Result<bool> is_algorithm(JSContext *cx, JS::HandleObject self,
-                                       CryptoAlgorithmIdentifier algorithm);
+  static bool is_algorithm(JSObject *self, CryptoAlgorithmIdentifier algorithm);
 };
 
 } // namespace builtins::web::crypto
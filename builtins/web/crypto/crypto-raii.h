@@ -5,6 +5,7 @@
 #include <openssl/bn.h>
 #include <openssl/ec.h>
 #include <openssl/evp.h>
+#include <openssl/kdf.h>
 #include <openssl/param_build.h>
 
 namespace builtins::web::crypto {
@@ -47,6 +48,24 @@ namespace detail {
     }
   };
 
+  struct EvpCipherCtxDeleter {
+    void operator()(EVP_CIPHER_CTX *ctx) const {
+      if (ctx) { EVP_CIPHER_CTX_free(ctx); }
+    }
+  };
+
+  struct EvpMacCtxDeleter {
+    void operator()(EVP_MAC_CTX *ctx) const {
+      if (ctx) { EVP_MAC_CTX_free(ctx); }
+    }
+  };
+
+  struct EvpKdfCtxDeleter {
+    void operator()(EVP_KDF_CTX *ctx) const {
+      if (ctx) { EVP_KDF_CTX_free(ctx); }
+    }
+  };
+
   struct EcdsaSigDeleter {
     void operator()(ECDSA_SIG *sig) const {
       if (sig) { ECDSA_SIG_free(sig); }
@@ -72,6 +91,9 @@ using EvpPkeyCtxPtr = std::unique_ptr<EVP_PKEY_CTX, detail::EvpPkeyCtxDeleter>;
 using ParamBldPtr = std::unique_ptr<OSSL_PARAM_BLD, detail::ParamBldDeleter>;
 using ParamPtr = std::unique_ptr<OSSL_PARAM, detail::ParamDeleter>;
 using EvpMdCtxPtr = std::unique_ptr<EVP_MD_CTX, detail::EvpMdCtxDeleter>;
+using EvpCipherCtxPtr = std::unique_ptr<EVP_CIPHER_CTX, detail::EvpCipherCtxDeleter>;
+using EvpMacCtxPtr = std::unique_ptr<EVP_MAC_CTX, detail::EvpMacCtxDeleter>;
+using EvpKdfCtxPtr = std::unique_ptr<EVP_KDF_CTX, detail::EvpKdfCtxDeleter>;
 using EcdsaSigPtr = std::unique_ptr<ECDSA_SIG, detail::EcdsaSigDeleter>;
 using EcGroupPtr = std::unique_ptr<EC_GROUP, detail::EcGroupDeleter>;
 using EcPointPtr = std::unique_ptr<EC_POINT, detail::EcPointDeleter>;
@@ -1,5 +1,6 @@
 #include "../dom-exception.h"
 #include "crypto.h"
+#include "digest-stream.h"
 #include "host_api.h"
 #include "subtle-crypto.h"
 #include "uuid.h"
@@ -46,16 +47,13 @@ bool Crypto::get_random_values(JSContext *cx, unsigned argc, JS::Value *vp) {
   bool is_shared = false;
   auto *buffer = static_cast<uint8_t *>(JS_GetArrayBufferViewData(typed_array, &is_shared, noGC));
 
-  auto res = host_api::Random::get_bytes(byte_length);
+  auto res = host_api::Random::fill({buffer, byte_length});
   if (const auto *err = res.to_err()) {
     noGC.reset();
     HANDLE_ERROR(cx, *err);
     return false;
   }
 
-  auto bytes = std::move(res.unwrap());
-  std::copy_n(bytes.begin(), byte_length, buffer);
-
   args.rval().setObject(*typed_array);
   return true;
 }
@@ -144,6 +142,10 @@ bool install(api::Engine *engine) {
   if (!Crypto::init_class(engine->cx(), engine->global())) {
     return false;
   }
+  // DigestStream isn't a global, but is exposed as `crypto.DigestStream`.
+  if (!DigestStream::init_class(engine->cx(), crypto)) {
+    return false;
+  }
   if (!CryptoKey::init_class(engine->cx(), engine->global())) {
     return false;
   }
@@ -0,0 +1,296 @@
+#include "digest-stream.h"
+#include "../dom-exception.h"
+#include "../streams/transform-stream-default-controller.h"
+#include "../streams/transform-stream.h"
+#include "crypto-algorithm.h"
+#include "crypto-raii.h"
+
+namespace builtins::web::crypto {
+
+using dom_exception::DOMException;
+using streams::TransformStream;
+using streams::TransformStreamDefaultController;
+
+namespace {
+
+// A message digest that's computed incrementally, backed by an `EVP_MD_CTX`.
+class IncrementalDigest final {
+  EvpMdCtxPtr ctx_;
+
+  explicit IncrementalDigest(EvpMdCtxPtr ctx) : ctx_(std::move(ctx)) {}
+
+public:
+  // Returns a new digest using `algorithm`, or `nullptr` if it couldn't be initialized.
+  static std::unique_ptr<IncrementalDigest> create(const EVP_MD *algorithm) {
+    EvpMdCtxPtr ctx(EVP_MD_CTX_new());
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), algorithm, nullptr) != 1) {
+      return nullptr;
+    }
+    return std::unique_ptr<IncrementalDigest>(new IncrementalDigest(std::move(ctx)));
+  }
+
+  bool update(std::span<const uint8_t> data) {
+    return EVP_DigestUpdate(ctx_.get(), data.data(), data.size()) == 1;
+  }
+
+  [[nodiscard]] size_t size() const { return EVP_MD_CTX_get_size(ctx_.get()); }
+
+  // Writes the digest to `out`, which must be at least `size()` bytes long. No more data can be
+  // added afterwards.
+  bool finish(std::span<uint8_t> out) {
+    MOZ_ASSERT(out.size() >= size());
+    unsigned int written = 0;
+    return EVP_DigestFinal_ex(ctx_.get(), out.data(), &written) == 1;
+  }
+};
+
+JSObject *transform(JSObject *self) {
+  MOZ_ASSERT(DigestStream::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(DigestStream::Slots::Transform)).toObject();
+}
+
+JSObject *digest_promise(JSObject *self) {
+  MOZ_ASSERT(DigestStream::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(DigestStream::Slots::Digest)).toObject();
+}
+
+IncrementalDigest *state(JSObject *self) {
+  MOZ_ASSERT(DigestStream::is_instance(self));
+  auto slot = JS::GetReservedSlot(self, std::to_underlying(DigestStream::Slots::State));
+  return slot.isUndefined() ? nullptr : static_cast<IncrementalDigest *>(slot.toPrivate());
+}
+
+// Rejects the `digest` promise with the pending exception, which is left pending so that the
+// stream is errored with it, too.
+bool reject_digest(JSContext *cx, JS::HandleObject self) {
+  JS::RootedValue error(cx);
+  if (!JS_GetPendingException(cx, &error)) {
+    return false;
+  }
+  JS_ClearPendingException(cx);
+  JS::RootedObject promise(cx, digest_promise(self));
+  if (!JS::RejectPromise(cx, promise, error)) {
+    return false;
+  }
+  JS_SetPendingException(cx, error);
+  return false;
+}
+
+JS::PersistentRooted<JSObject *> transformAlgo;
+JS::PersistentRooted<JSObject *> flushAlgo;
+JS::PersistentRooted<JSObject *> cancelAlgo;
+
+} // namespace
+
+// Hashes the chunk and enqueues it unchanged.
+bool DigestStream::transformAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(1, "DigestStream transform algorithm")
+
+  auto data = value_to_buffer(cx, args[0], "DigestStream transform: chunks");
+  if (!data.has_value()) {
+    return reject_digest(cx, self);
+  }
+
+  // `data` is a live view into the chunk, which is fine because it's hashed before any content
+  // can run again.
+  if (!state(self)->update(data.value())) {
+    DOMException::raise(cx, "DigestStream: failed to hash chunk", "OperationError");
+    return reject_digest(cx, self);
+  }
+
+  JS::RootedObject controller(cx, TransformStream::controller(transform(self)));
+  if (!TransformStreamDefaultController::Enqueue(cx, controller, args[0])) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
+// Finishes the digest and resolves the `digest` promise with it.
+bool DigestStream::flushAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(0, "DigestStream flush algorithm")
+
+  std::unique_ptr<IncrementalDigest> digest(state(self));
+  JS::SetReservedSlot(self, std::to_underlying(Slots::State), JS::UndefinedValue());
+
+  size_t size = digest->size();
+  mozilla::UniquePtr<uint8_t[], JS::FreePolicy> buffer{
+      static_cast<uint8_t *>(JS_malloc(cx, size))};
+  if (!buffer) {
+    JS_ReportOutOfMemory(cx);
+    return reject_digest(cx, self);
+  }
+  if (!digest->finish({buffer.get(), size})) {
+    DOMException::raise(cx, "DigestStream: failed to create digest", "OperationError");
+    return reject_digest(cx, self);
+  }
+
+  JS::RootedObject array_buffer(cx, JS::NewArrayBufferWithContents(
+      cx, size, buffer.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+  if (!array_buffer) {
+    JS_ReportOutOfMemory(cx);
+    return reject_digest(cx, self);
+  }
+
+  // `array_buffer` now owns `buffer`
+  static_cast<void>(buffer.release());
+
+  JS::RootedObject promise(cx, digest_promise(self));
+  JS::RootedValue result(cx, JS::ObjectValue(*array_buffer));
+  if (!JS::ResolvePromise(cx, promise, result)) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
+// Rejects the `digest` promise with the reason the stream was aborted or canceled with, and frees
+// the digest state right away instead of waiting for the stream to be finalized.
+bool DigestStream::cancelAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(1, "DigestStream cancel algorithm")
+
+  delete state(self);
+  JS::SetReservedSlot(self, std::to_underlying(Slots::State), JS::UndefinedValue());
+
+  JS::RootedObject promise(cx, digest_promise(self));
+  if (!JS::RejectPromise(cx, promise, args[0])) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
+bool DigestStream::readable_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(0, "get readable")
+  args.rval().setObject(*TransformStream::readable(transform(self)));
+  return true;
+}
+
+bool DigestStream::writable_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(0, "get writable")
+  args.rval().setObject(*TransformStream::writable(transform(self)));
+  return true;
+}
+
+bool DigestStream::digest_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER_WITH_NAME(0, "get digest")
+  args.rval().setObject(*digest_promise(self));
+  return true;
+}
+
+const JSFunctionSpec DigestStream::static_methods[] = {
+    JS_FS_END,
+};
+
+const JSPropertySpec DigestStream::static_properties[] = {
+    JS_PS_END,
+};
+
+const JSFunctionSpec DigestStream::methods[] = {
+    JS_FS_END,
+};
+
+const JSPropertySpec DigestStream::properties[] = {
+    JS_PSG("readable", DigestStream::readable_get, JSPROP_ENUMERATE),
+    JS_PSG("writable", DigestStream::writable_get, JSPROP_ENUMERATE),
+    JS_PSG("digest", DigestStream::digest_get, JSPROP_ENUMERATE),
+    JS_STRING_SYM_PS(toStringTag, "DigestStream", JSPROP_READONLY),
+    JS_PS_END,
+};
+
+namespace {
+
+JSObject *initialize(JSContext *cx, JS::HandleObject stream, const EVP_MD *algorithm) {
+  JS::RootedValue stream_val(cx, JS::ObjectValue(*stream));
+
+  auto digest = IncrementalDigest::create(algorithm);
+  if (!digest) {
+    DOMException::raise(cx, "DigestStream: failed to initialize digest", "OperationError");
+    return nullptr;
+  }
+  JS::SetReservedSlot(stream, std::to_underlying(DigestStream::Slots::State),
+                      JS::PrivateValue(digest.release()));
+
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return nullptr;
+  }
+  JS::SetReservedSlot(stream, std::to_underlying(DigestStream::Slots::Digest),
+                      JS::ObjectValue(*promise));
+
+  JS::RootedObject transform(cx, TransformStream::create(cx, 1, nullptr, 0, nullptr, stream_val,
+                                                         nullptr, transformAlgo, flushAlgo,
+                                                         cancelAlgo));
+  if (!transform) {
+    return nullptr;
+  }
+
+  TransformStream::set_used_as_mixin(transform);
+  JS::SetReservedSlot(stream, std::to_underlying(DigestStream::Slots::Transform),
+                      JS::ObjectValue(*transform));
+  return stream;
+}
+
+} // namespace
+
+// new DigestStream(AlgorithmIdentifier algorithm)
+bool DigestStream::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
+  CTOR_HEADER("DigestStream", 1);
+
+  // The algorithm is normalized exactly like the one passed to `SubtleCrypto.digest`.
+  auto normalizedAlgorithm = CryptoAlgorithmDigest::normalize(cx, args[0]);
+  if (!normalizedAlgorithm) {
+    return false;
+  }
+  const EVP_MD *algorithm = createDigestAlgorithm(cx, normalizedAlgorithm->identifier());
+  if (!algorithm) {
+    return false;
+  }
+
+  JS::RootedObject instance(cx, JS_NewObjectForConstructor(cx, &class_, args));
+  if (!instance) {
+    return false;
+  }
+  JS::RootedObject stream(cx, initialize(cx, instance, algorithm));
+  if (!stream) {
+    return false;
+  }
+
+  args.rval().setObject(*stream);
+  return true;
+}
+
+void DigestStream::finalize(JS::GCContext *gcx, JSObject *self) {
+  delete state(self);
+}
+
+bool DigestStream::init_class(JSContext *cx, JS::HandleObject global) {
+  if (!init_class_impl(cx, global)) {
+    return false;
+  }
+
+  JSFunction *transformFun = JS_NewFunction(cx, transformAlgorithm, 1, 0, "DS Transform");
+  if (!transformFun) {
+    return false;
+  }
+  transformAlgo.init(cx, JS_GetFunctionObject(transformFun));
+
+  JSFunction *flushFun = JS_NewFunction(cx, flushAlgorithm, 1, 0, "DS Flush");
+  if (!flushFun) {
+    return false;
+  }
+  flushAlgo.init(cx, JS_GetFunctionObject(flushFun));
+
+  JSFunction *cancelFun = JS_NewFunction(cx, cancelAlgorithm, 1, 0, "DS Cancel");
+  if (!cancelFun) {
+    return false;
+  }
+  cancelAlgo.init(cx, JS_GetFunctionObject(cancelFun));
+
+  return true;
+}
+
+} // namespace builtins::web::crypto
@@ -0,0 +1,43 @@
+#ifndef BUILTINS_WEB_CRYPTO_DIGEST_STREAM_H
+#define BUILTINS_WEB_CRYPTO_DIGEST_STREAM_H
+
+#include "builtin.h"
+
+namespace builtins::web::crypto {
+
+/**
+ * `crypto.DigestStream`, a pass-through stream that hashes all chunks written to it.
+ *
+ * Chunks are enqueued to the readable side unchanged, and the `digest` promise is resolved with
+ * the digest once the writable side is closed, so a body can be hashed while it's forwarded,
+ * e.g. `new Response(body.pipeThrough(stream))`, without being buffered. If the stream is
+ * aborted or canceled instead, the `digest` promise is rejected with the reason.
+ */
+class DigestStream : public BuiltinImpl<DigestStream, FinalizableClassPolicy> {
+  static bool transformAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool flushAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool cancelAlgorithm(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool readable_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool writable_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool digest_get(JSContext *cx, unsigned argc, JS::Value *vp);
+
+public:
+  static constexpr const char *class_name = "DigestStream";
+
+  enum class Slots : uint8_t { Transform, Digest, State, Count };
+
+  static const JSFunctionSpec static_methods[];
+  static const JSPropertySpec static_properties[];
+  static const JSFunctionSpec methods[];
+  static const JSPropertySpec properties[];
+
+  static const unsigned ctor_length = 1;
+
+  static bool init_class(JSContext *cx, JS::HandleObject global);
+  static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
+};
+
+} // namespace builtins::web::crypto
+
+#endif
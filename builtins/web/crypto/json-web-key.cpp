@@ -37,6 +37,19 @@ extractStringPropertyFromObject(JSContext *cx, JS::HandleObject object, const ch
   }
   return std::optional<std::string>(std::string(chars.begin(), chars.len));
 }
+
+bool setStringProperty(JSContext *cx, JS::HandleObject object, const char *property,
+                       const std::optional<std::string> &value) {
+  if (!value.has_value()) {
+    return true;
+  }
+  JS::RootedString str(cx, JS_NewStringCopyN(cx, value->data(), value->size()));
+  if (!str) {
+    return false;
+  }
+  JS::RootedValue str_val(cx, JS::StringValue(str));
+  return JS_DefineProperty(cx, object, property, str_val, JSPROP_ENUMERATE);
+}
 } // namespace
 
 std::unique_ptr<JsonWebKey> JsonWebKey::parse(JSContext *cx, JS::HandleValue value,
@@ -357,6 +370,87 @@ std::unique_ptr<JsonWebKey> JsonWebKey::parse(JSContext *cx, JS::HandleValue val
   return std::make_unique<JsonWebKey>(kty, use, key_ops, alg, ext, crv, x, y, n, e, d, p, q, dp, dq,
                                       qi, oth, k);
 }
-} // namespace builtins::web::crypto
 
+// Dictionary members are converted in lexicographical order, see
+// https://webidl.spec.whatwg.org/#js-dictionary
+JSObject *JsonWebKey::toObject(JSContext *cx) const {
+  JS::RootedObject object(cx, JS_NewPlainObject(cx));
+  if (!object) {
+    return nullptr;
+  }
+
+  if (!setStringProperty(cx, object, "alg", alg) || !setStringProperty(cx, object, "crv", crv) ||
+      !setStringProperty(cx, object, "d", d) || !setStringProperty(cx, object, "dp", dp) ||
+      !setStringProperty(cx, object, "dq", dq) || !setStringProperty(cx, object, "e", e)) {
+    return nullptr;
+  }
+
+  if (ext.has_value()) {
+    JS::RootedValue ext_val(cx, JS::BooleanValue(ext.value()));
+    if (!JS_DefineProperty(cx, object, "ext", ext_val, JSPROP_ENUMERATE)) {
+      return nullptr;
+    }
+  }
+
+  if (!setStringProperty(cx, object, "k", k)) {
+    return nullptr;
+  }
+
+  JS::RootedValueVector ops(cx);
+  JS::RootedString op(cx);
+  for (const auto &name : key_ops) {
+    if (!(op = JS_AtomizeString(cx, name.c_str()))) {
+      return nullptr;
+    }
+    if (!ops.append(JS::StringValue(op))) {
+      js::ReportOutOfMemory(cx);
+      return nullptr;
+    }
+  }
+  JS::RootedObject ops_array(cx, JS::NewArrayObject(cx, ops));
+  if (!ops_array) {
+    return nullptr;
+  }
+  JS::RootedValue ops_val(cx, JS::ObjectValue(*ops_array));
+  if (!JS_DefineProperty(cx, object, "key_ops", ops_val, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+
+  if (!setStringProperty(cx, object, "kty", kty) || !setStringProperty(cx, object, "n", n)) {
+    return nullptr;
+  }
 
+  if (!oth.empty()) {
+    JS::RootedValueVector infos(cx);
+    JS::RootedObject info(cx);
+    for (const auto &prime : oth) {
+      info = JS_NewPlainObject(cx);
+      if (!info || !setStringProperty(cx, info, "d", prime.d) ||
+          !setStringProperty(cx, info, "r", prime.r) ||
+          !setStringProperty(cx, info, "t", prime.t)) {
+        return nullptr;
+      }
+      if (!infos.append(JS::ObjectValue(*info))) {
+        js::ReportOutOfMemory(cx);
+        return nullptr;
+      }
+    }
+    JS::RootedObject oth_array(cx, JS::NewArrayObject(cx, infos));
+    if (!oth_array) {
+      return nullptr;
+    }
+    JS::RootedValue oth_val(cx, JS::ObjectValue(*oth_array));
+    if (!JS_DefineProperty(cx, object, "oth", oth_val, JSPROP_ENUMERATE)) {
+      return nullptr;
+    }
+  }
+
+  if (!setStringProperty(cx, object, "p", p) || !setStringProperty(cx, object, "q", q) ||
+      !setStringProperty(cx, object, "qi", qi) || !setStringProperty(cx, object, "use", use) ||
+      !setStringProperty(cx, object, "x", x) || !setStringProperty(cx, object, "y", y)) {
+    return nullptr;
+  }
+  return object;
+}
+
+} // namespace builtins::web::crypto
@@ -148,6 +148,11 @@ public:
   // encoding of the octet sequence containing the key value.
   std::optional<std::string> k;
 
+  // Creates a key with only the members that every exported key has. The key type specific
+  // members are set afterwards.
+  JsonWebKey(std::string kty, std::vector<std::string> key_ops, bool ext)
+      : kty{std::move(kty)}, key_ops{std::move(key_ops)}, ext{ext} {}
+
   JsonWebKey(std::string kty, std::vector<std::string> key_ops, std::optional<bool> ext,
              std::optional<std::string> n, std::optional<std::string> e)
       : kty{std::move(kty)}, key_ops{std::move(key_ops)}, ext{ext}, n{std::move(n)}, e{std::move(e)} {}
@@ -198,6 +203,9 @@ public:
 
   static std::unique_ptr<JsonWebKey> parse(JSContext *cx, JS::HandleValue value,
                                            std::string_view required_kty_value);
+
+  // Converts the key to a JsonWebKey dictionary, containing only the members that are present.
+  JSObject *toObject(JSContext *cx) const;
 };
 } // namespace builtins::web::crypto
 
@@ -3,10 +3,354 @@
 #include "builtin.h"
 #include "encode.h"
 
+#include <fmt/format.h>
+#include <openssl/crypto.h>
+
 namespace builtins::web::crypto {
 
 using dom_exception::DOMException;
 
+namespace {
+
+// Implements the steps shared by encrypt() and decrypt():
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-encrypt
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-decrypt
+bool encrypt_or_decrypt(JSContext *cx, const JS::CallArgs &args, bool encrypt) {
+  const char *method = encrypt ? "SubtleCrypto.encrypt" : "SubtleCrypto.decrypt";
+  if (!args.requireAtLeast(cx, method, 3)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!SubtleCrypto::check_receiver(cx, args.thisv(), method)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 1. Let algorithm and key be the algorithm and key parameters passed to the method,
+  // respectively.
+  auto algorithm = args.get(0);
+  auto key_arg = args.get(1);
+  if (!CryptoKey::is_instance(key_arg)) {
+    api::throw_error(cx, api::Errors::TypeError, method, "key", "be a CryptoKey object");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject key(cx, &key_arg.toObject());
+
+  // 2. Let data be the result of getting a copy of the bytes held by the data parameter passed
+  // to the method.
+  // This has to be an actual copy: normalizing the algorithm below runs script, which can detach
+  // or resize the buffer.
+  auto description = std::string(method) + ": data";
+  std::optional<std::span<uint8_t>> buffer =
+      value_to_buffer(cx, args.get(2), description.c_str());
+  if (!buffer.has_value()) {
+    // value_to_buffer would have already created a JS exception so we don't need to create one
+    // ourselves.
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  std::vector<uint8_t> data(buffer->begin(), buffer->end());
+
+  // 3. Let normalizedAlgorithm be the result of normalizing an algorithm, with alg set to
+  // algorithm and op set to "encrypt" or "decrypt".
+  // 4. If an error occurred, return a Promise rejected with normalizedAlgorithm.
+  auto normalizedAlgorithm = CryptoAlgorithmEncryptDecrypt::normalize(cx, algorithm);
+  if (!normalizedAlgorithm) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 5. Let promise be a new Promise.
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 6. Return promise and perform the remaining steps in parallel.
+  args.rval().setObject(*promise);
+
+  // 7. If the following steps or referenced procedures say to throw an error, reject promise with
+  // the returned error and then terminate the algorithm.
+  // 8. If the name member of normalizedAlgorithm is not equal to the name attribute of the
+  // [[algorithm]] internal slot of key then throw an InvalidAccessError.
+  auto identifier = normalizedAlgorithm->identifier();
+  if (!CryptoKey::is_algorithm(key, identifier)) {
+    DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 9. If the [[usages]] internal slot of key does not contain an entry that is "encrypt" or
+  // "decrypt", respectively, then throw an InvalidAccessError.
+  if (encrypt ? !CryptoKey::canEncrypt(key) : !CryptoKey::canDecrypt(key)) {
+    DOMException::raise(cx,
+                        encrypt ? "CryptoKey doesn't support encryption"
+                                : "CryptoKey doesn't support decryption",
+                        "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 10. Let result be the result of performing the encrypt or decrypt operation specified by
+  // normalizedAlgorithm using algorithm and key and with data as plaintext or ciphertext.
+  auto *result = encrypt ? normalizedAlgorithm->encrypt(cx, key, data)
+                         : normalizedAlgorithm->decrypt(cx, key, data);
+  if (!result) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 11. Resolve promise with result.
+  JS::RootedValue result_val(cx, JS::ObjectValue(*result));
+  JS::ResolvePromise(cx, promise, result_val);
+  return true;
+}
+
+// Converts `value` to a KeyFormat, https://w3c.github.io/webcrypto/#dfn-KeyFormat.
+std::optional<CryptoKeyFormat> toKeyFormat(JSContext *cx, JS::HandleValue value,
+                                           const char *method) {
+  // Convert into a String following https://tc39.es/ecma262/#sec-tostring
+  auto format_chars = core::encode(cx, value);
+  if (!format_chars.ptr) {
+    return std::nullopt;
+  }
+  std::string_view format_string = format_chars;
+  if (format_string == "spki") {
+    return CryptoKeyFormat::Spki;
+  }
+  if (format_string == "pkcs8") {
+    return CryptoKeyFormat::Pkcs8;
+  }
+  if (format_string == "jwk") {
+    return CryptoKeyFormat::Jwk;
+  }
+  if (format_string == "raw") {
+    return CryptoKeyFormat::Raw;
+  }
+  auto message = fmt::format("{}: Provided format parameter is not supported. Supported formats "
+                             "are: 'spki', 'pkcs8', 'jwk', and 'raw'",
+                             method);
+  DOMException::raise(cx, message, "NotSupportedError");
+  return std::nullopt;
+}
+
+} // namespace
+
+// Promise<ArrayBuffer> decrypt(AlgorithmIdentifier algorithm,
+//                              CryptoKey key,
+//                              BufferSource data);
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-decrypt
+bool SubtleCrypto::decrypt(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  return encrypt_or_decrypt(cx, args, false);
+}
+
+// Promise<ArrayBuffer> deriveBits(AlgorithmIdentifier algorithm,
+//                                 CryptoKey baseKey,
+//                                 optional unsigned long? length = null);
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-deriveBits
+bool SubtleCrypto::deriveBits(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.requireAtLeast(cx, "SubtleCrypto.deriveBits", 2)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!check_receiver(cx, args.thisv(), "SubtleCrypto.deriveBits")) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 1. Let algorithm, baseKey and length, be the algorithm, baseKey and length parameters passed
+  // to the deriveBits() method, respectively.
+  auto algorithm = args.get(0);
+  auto key_arg = args.get(1);
+  if (!CryptoKey::is_instance(key_arg)) {
+    api::throw_error(cx, api::Errors::TypeError, "SubtleCrypto.deriveBits", "baseKey",
+                     "be a CryptoKey object");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject key(cx, &key_arg.toObject());
+  std::optional<size_t> length;
+  if (!args.get(2).isNullOrUndefined()) {
+    uint32_t length_bits = 0;
+    if (!JS::ToUint32(cx, args.get(2), &length_bits)) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    length = length_bits;
+  }
+
+  // 2. Let normalizedAlgorithm be the result of normalizing an algorithm, with alg set to
+  // algorithm and op set to "deriveBits".
+  // 3. If an error occurred, return a Promise rejected with normalizedAlgorithm.
+  auto normalizedAlgorithm = CryptoAlgorithmDeriveBits::normalize(cx, algorithm);
+  if (!normalizedAlgorithm) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 4. Let promise be a new Promise.
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 5. Return promise and perform the remaining steps in parallel.
+  args.rval().setObject(*promise);
+
+  // 6. If the following steps or referenced procedures say to throw an error, reject promise with
+  // the returned error and then terminate the algorithm.
+  // 7. If the name member of normalizedAlgorithm is not equal to the name attribute of the
+  // [[algorithm]] internal slot of baseKey then throw an InvalidAccessError.
+  if (!CryptoKey::is_algorithm(key, normalizedAlgorithm->identifier())) {
+    DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 8. If the [[usages]] internal slot of baseKey does not contain an entry that is
+  // "deriveBits", then throw an InvalidAccessError.
+  if (!CryptoKey::canDeriveBits(key)) {
+    DOMException::raise(cx, "CryptoKey doesn't support bits derivation", "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 9. Let result be the result of creating an ArrayBuffer containing the result of performing
+  // the derive bits operation specified by normalizedAlgorithm using baseKey, algorithm and
+  // length.
+  auto *bits = normalizedAlgorithm->deriveBits(cx, key, length);
+  if (!bits) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 10. Resolve promise with result.
+  JS::RootedValue result(cx, JS::ObjectValue(*bits));
+  JS::ResolvePromise(cx, promise, result);
+  return true;
+}
+
+// Promise<CryptoKey> deriveKey(AlgorithmIdentifier algorithm,
+//                              CryptoKey baseKey,
+//                              AlgorithmIdentifier derivedKeyType,
+//                              boolean extractable,
+//                              sequence<KeyUsage> keyUsages );
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-deriveKey
+bool SubtleCrypto::deriveKey(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.requireAtLeast(cx, "SubtleCrypto.deriveKey", 5)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!check_receiver(cx, args.thisv(), "SubtleCrypto.deriveKey")) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 1. Let algorithm, baseKey, derivedKeyType, extractable and usages be the algorithm, baseKey,
+  // derivedKeyType, extractable and keyUsages parameters passed to the deriveKey() method,
+  // respectively.
+  auto algorithm = args.get(0);
+  auto key_arg = args.get(1);
+  if (!CryptoKey::is_instance(key_arg)) {
+    api::throw_error(cx, api::Errors::TypeError, "SubtleCrypto.deriveKey", "baseKey",
+                     "be a CryptoKey object");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject key(cx, &key_arg.toObject());
+  auto derived_key_type = args.get(2);
+  bool extractable = JS::ToBoolean(args.get(3));
+  auto usages_result = CryptoKeyUsages::from(cx, args.get(4));
+  if (usages_result.isErr()) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  auto usages = usages_result.unwrap();
+
+  // 2. Let normalizedAlgorithm be the result of normalizing an algorithm, with alg set to
+  // algorithm and op set to "deriveBits".
+  // 3. If an error occurred, return a Promise rejected with normalizedAlgorithm.
+  auto normalizedAlgorithm = CryptoAlgorithmDeriveBits::normalize(cx, algorithm);
+  if (!normalizedAlgorithm) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 4. Let normalizedDerivedKeyAlgorithmImport be the result of normalizing an algorithm, with
+  // alg set to derivedKeyType and op set to "importKey".
+  // 5. If an error occurred, return a Promise rejected with
+  // normalizedDerivedKeyAlgorithmImport.
+  auto normalizedDerivedKeyAlgorithmImport =
+      CryptoAlgorithmImportKey::normalize(cx, derived_key_type);
+  if (!normalizedDerivedKeyAlgorithmImport) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 6. Let normalizedDerivedKeyAlgorithmLength be the result of normalizing an algorithm, with
+  // alg set to derivedKeyType and op set to "get key length".
+  // 7. If an error occurred, return a Promise rejected with
+  // normalizedDerivedKeyAlgorithmLength.
+  auto normalizedDerivedKeyAlgorithmLength =
+      CryptoAlgorithmGetKeyLength::normalize(cx, derived_key_type);
+  if (!normalizedDerivedKeyAlgorithmLength) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 8. Let promise be a new Promise.
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 9. Return promise and perform the remaining steps in parallel.
+  args.rval().setObject(*promise);
+
+  // 10. If the following steps or referenced procedures say to throw an error, reject promise
+  // with the returned error and then terminate the algorithm.
+  // 11. If the name member of normalizedAlgorithm is not equal to the name attribute of the
+  // [[algorithm]] internal slot of baseKey then throw an InvalidAccessError.
+  if (!CryptoKey::is_algorithm(key, normalizedAlgorithm->identifier())) {
+    DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 12. If the [[usages]] internal slot of baseKey does not contain an entry that is
+  // "deriveKey", then throw an InvalidAccessError.
+  if (!CryptoKey::canDeriveKey(key)) {
+    DOMException::raise(cx, "CryptoKey doesn't support key derivation", "InvalidAccessError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 13. Let length be the result of performing the get key length algorithm specified by
+  // normalizedDerivedKeyAlgorithmLength using derivedKeyType.
+  auto length = normalizedDerivedKeyAlgorithmLength->keyLength(cx);
+  if (length.isErr()) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 14. Let secret be the result of performing the derive bits operation specified by
+  // normalizedAlgorithm using key, algorithm and length.
+  JS::RootedObject secret(cx, normalizedAlgorithm->deriveBits(cx, key, length.unwrap()));
+  if (!secret) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 15. Let result be the result of performing the import key operation specified by
+  // normalizedDerivedKeyAlgorithmImport using "raw" as format, secret as keyData,
+  // derivedKeyType as algorithm and using extractable and usages.
+  size_t secret_length = 0;
+  bool is_shared = false;
+  uint8_t *secret_data = nullptr;
+  JS::GetArrayBufferLengthAndData(secret, &secret_length, &is_shared, &secret_data);
+  KeyData key_data = std::span<uint8_t>(secret_data, secret_length);
+  JS::RootedObject result(cx, normalizedDerivedKeyAlgorithmImport->importKey(
+                                  cx, CryptoKeyFormat::Raw, key_data, extractable, usages));
+  // The key copies the secret, so the derived bits can be wiped right away.
+  OPENSSL_cleanse(secret_data, secret_length);
+  if (!result) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 16. If the [[type]] internal slot of result is "secret" or "private" and usages is empty,
+  // then throw a SyntaxError.
+  if (CryptoKey::type(result) != CryptoKeyType::Public && usages.isEmpty()) {
+    DOMException::raise(cx, "Secret keys must be given at least one usage", "SyntaxError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 17. Set the [[extractable]] internal slot of result to extractable.
+  // 18. Set the [[usages]] internal slot of result to the normalized value of usages.
+  // Both are done by the import key operation.
+
+  // 19. Resolve promise with result.
+  JS::RootedValue result_val(cx, JS::ObjectValue(*result));
+  JS::ResolvePromise(cx, promise, result_val);
+  return true;
+}
+
 // digest(algorithm, data)
 // https://w3c.github.io/webcrypto/#SubtleCrypto-method-digest
 bool SubtleCrypto::digest(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -65,6 +409,137 @@ bool SubtleCrypto::digest(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+// Promise<ArrayBuffer> encrypt(AlgorithmIdentifier algorithm,
+//                              CryptoKey key,
+//                              BufferSource data);
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-encrypt
+bool SubtleCrypto::encrypt(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  return encrypt_or_decrypt(cx, args, true);
+}
+
+// Promise<any> exportKey(KeyFormat format, CryptoKey key);
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-exportKey
+bool SubtleCrypto::exportKey(JSContext *cx, unsigned argc, JS::Value *vp) {
+  MOZ_ASSERT(cx);
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+
+  if (!args.requireAtLeast(cx, "SubtleCrypto.exportKey", 2)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!check_receiver(cx, args.thisv(), "SubtleCrypto.exportKey")) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 1. Let format and key be the format and key parameters passed to the exportKey() method,
+  // respectively.
+  auto format = toKeyFormat(cx, args.get(0), "crypto.subtle.exportKey");
+  if (!format.has_value()) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  auto key_arg = args.get(1);
+  if (!CryptoKey::is_instance(key_arg)) {
+    api::throw_error(cx, api::Errors::TypeError, "crypto.subtle.exportKey", "key",
+                     "be a CryptoKey object");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject key(cx, &key_arg.toObject());
+
+  // 2. Let promise be a new Promise.
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 3. Return promise and perform the remaining steps in parallel.
+  args.rval().setObject(*promise);
+
+  // 4. - 6. are done by `exportKey`.
+  JS::RootedObject result(cx, crypto::exportKey(cx, format.value(), key));
+  if (!result) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 7. Resolve promise with result.
+  JS::RootedValue result_val(cx, JS::ObjectValue(*result));
+  JS::ResolvePromise(cx, promise, result_val);
+  return true;
+}
+
+// Promise<(CryptoKey or CryptoKeyPair)> generateKey(AlgorithmIdentifier algorithm,
+//                                                   boolean extractable,
+//                                                   sequence<KeyUsage> keyUsages);
+// https://w3c.github.io/webcrypto/#SubtleCrypto-method-generateKey
+bool SubtleCrypto::generateKey(JSContext *cx, unsigned argc, JS::Value *vp) {
+  MOZ_ASSERT(cx);
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+
+  if (!args.requireAtLeast(cx, "SubtleCrypto.generateKey", 3)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!check_receiver(cx, args.thisv(), "SubtleCrypto.generateKey")) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 1. Let algorithm, extractable and usages be the algorithm, extractable and keyUsages
+  // parameters passed to the generateKey() method, respectively.
+  auto algorithm = args.get(0);
+  bool extractable = JS::ToBoolean(args.get(1));
+  auto usagesResult = CryptoKeyUsages::from(cx, args.get(2));
+  if (usagesResult.isErr()) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  auto usages = usagesResult.unwrap();
+
+  // 2. Let normalizedAlgorithm be the result of normalizing an algorithm, with alg set to
+  // algorithm and op set to "generateKey".
+  // 3. If an error occurred, return a Promise rejected with normalizedAlgorithm.
+  auto normalizedAlgorithm = CryptoAlgorithmGenerateKey::normalize(cx, algorithm);
+  if (!normalizedAlgorithm) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 4. Let promise be a new Promise.
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  // 5. Return promise and perform the remaining steps in parallel.
+  args.rval().setObject(*promise);
+
+  // 6. If the following steps or referenced procedures say to throw an error, reject promise
+  // with the returned error and then terminate the algorithm.
+  // 7. Let result be the result of performing the generate key operation specified by
+  // normalizedAlgorithm using algorithm, extractable and usages.
+  JS::RootedObject result(cx, normalizedAlgorithm->generateKey(cx, extractable, usages));
+  if (!result) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 8. If result is a CryptoKey object:
+  //   If the [[type]] internal slot of result is "secret" or "private" and usages is empty, then
+  //   throw a SyntaxError.
+  // If result is a CryptoKeyPair object:
+  //   If the [[usages]] internal slot of the privateKey attribute of result is the empty
+  //   sequence, then throw a SyntaxError.
+  // The private keys of the supported algorithms get the "sign" entry of usages, so they're
+  // without usages exactly if usages doesn't contain "sign".
+  bool is_pair = !CryptoKey::is_instance(result);
+  if (is_pair ? !usages.canSign() : usages.isEmpty()) {
+    DOMException::raise(cx,
+                        is_pair ? "Private keys must be given at least one usage"
+                                : "Secret keys must be given at least one usage",
+                        "SyntaxError");
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  // 9. Resolve promise with result.
+  JS::RootedValue result_val(cx, JS::ObjectValue(*result));
+  JS::ResolvePromise(cx, promise, result_val);
+  return true;
+}
+
 //  Promise<CryptoKey> importKey(KeyFormat format,
 //                         (BufferSource or JsonWebKey) keyData,
 //                         AlgorithmIdentifier algorithm,
@@ -84,30 +559,9 @@ bool SubtleCrypto::importKey(JSContext *cx, unsigned argc, JS::Value *vp) {
 
   // 1. Let format, algorithm, extractable and usages, be the format, algorithm,
   // extractable and keyUsages parameters passed to the importKey() method, respectively.
-  CryptoKeyFormat format;
-  {
-    auto format_arg = args.get(0);
-    // Convert into a String following https://tc39.es/ecma262/#sec-tostring
-    auto format_chars = core::encode(cx, format_arg);
-    if (!format_chars.ptr) {
-      return ReturnPromiseRejectedWithPendingError(cx, args);
-    }
-    std::string_view format_string = format_chars;
-    if (format_string == "spki") {
-      format = CryptoKeyFormat::Spki;
-    } else if (format_string == "pkcs8") {
-      format = CryptoKeyFormat::Pkcs8;
-    } else if (format_string == "jwk") {
-      format = CryptoKeyFormat::Jwk;
-    } else if (format_string == "raw") {
-      format = CryptoKeyFormat::Raw;
-    } else {
-      DOMException::raise(cx,
-        "crypto.subtle.importkey: Provided format parameter is not supported. "
-          "Supported formats are: 'spki', 'pkcs8', 'jwk', and 'raw'",
-        "NotSupportedError");
-      return ReturnPromiseRejectedWithPendingError(cx, args);
-    }
+  auto format = toKeyFormat(cx, args.get(0), "crypto.subtle.importKey");
+  if (!format.has_value()) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
   }
   auto key_data = args.get(1);
   auto algorithm = args.get(2);
@@ -153,7 +607,8 @@ bool SubtleCrypto::importKey(JSContext *cx, unsigned argc, JS::Value *vp) {
   // 11. Set the [[usages]] internal slot of result to the normalized value of
   // usages.
   JS::RootedObject result(cx);
-  JSObject *key = normalizedAlgorithm->importKey(cx, format, key_data, extractable, usages);
+  JSObject *key =
+      normalizedAlgorithm->importKey(cx, format.value(), key_data, extractable, usages);
   if (!key) {
     return RejectPromiseWithPendingError(cx, promise);
   }
@@ -224,13 +679,7 @@ bool SubtleCrypto::sign(JSContext *cx, unsigned argc, JS::Value *vp) {
   // 8. If the name member of normalizedAlgorithm is not equal to the name attribute of the
   // [[algorithm]] internal slot of key then throw an InvalidAccessError.
   auto identifier = normalizedAlgorithm->identifier();
-  auto match_result = CryptoKey::is_algorithm(cx, key, identifier);
-  if (match_result.isErr()) {
-    DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
-    return RejectPromiseWithPendingError(cx, promise);
-  }
-
-  if (match_result.unwrap() == false) {
+  if (!CryptoKey::is_algorithm(key, identifier)) {
     DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
     return RejectPromiseWithPendingError(cx, promise);
   }
@@ -322,8 +771,7 @@ bool SubtleCrypto::verify(JSContext *cx, unsigned argc, JS::Value *vp) {
   // 9. If the name member of normalizedAlgorithm is not equal to the name attribute of the
   // [[algorithm]] internal slot of key then throw an InvalidAccessError.
   auto identifier = normalizedAlgorithm->identifier();
-  auto match_result = CryptoKey::is_algorithm(cx, key, identifier);
-  if (match_result.isErr() || match_result.unwrap() == false) {
+  if (!CryptoKey::is_algorithm(key, identifier)) {
     DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier", "InvalidAccessError");
     return RejectPromiseWithPendingError(cx, promise);
   }
@@ -348,6 +796,136 @@ bool SubtleCrypto::verify(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+// Promise<sequence<boolean>> verifyBatch(AlgorithmIdentifier algorithm,
+//                                        sequence<VerifyBatchEntry> entries);
+// dictionary VerifyBatchEntry {
+//   required CryptoKey key;
+//   required BufferSource signature;
+//   required BufferSource data;
+// };
+//
+// A StarlingMonkey extension, not part of the Web Crypto API: verifies several signatures made with
+// the same algorithm in a single call, returning a promise for an array with the result of each
+// verification. The algorithm is only normalized once, and the same checks as in `verify()` are
+// performed for every entry, rejecting the promise if any of them fails.
+//
+// The method is non-enumerable, so that enumerating `crypto.subtle` only yields the standard
+// members.
+bool SubtleCrypto::verifyBatch(JSContext *cx, unsigned argc, JS::Value *vp) {
+  JS::CallArgs args = CallArgsFromVp(argc, vp);
+  if (!args.requireAtLeast(cx, "SubtleCrypto.verifyBatch", 2)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!check_receiver(cx, args.thisv(), "SubtleCrypto.verifyBatch")) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  bool entries_is_array = false;
+  if (!JS::IsArrayObject(cx, args.get(1), &entries_is_array)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  if (!entries_is_array) {
+    api::throw_error(cx, api::Errors::TypeError, "SubtleCrypto.verifyBatch", "entries",
+                     "be an Array");
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  JS::RootedObject entries(cx, &args.get(1).toObject());
+  uint32_t length = 0;
+  if (!JS::GetArrayLength(cx, entries, &length)) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+
+  auto normalizedAlgorithm = CryptoAlgorithmSignVerify::normalize(cx, args.get(0));
+  if (!normalizedAlgorithm) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  auto identifier = normalizedAlgorithm->identifier();
+
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return ReturnPromiseRejectedWithPendingError(cx, args);
+  }
+  args.rval().setObject(*promise);
+
+  JS::RootedObject results(cx, JS::NewArrayObject(cx, length));
+  if (!results) {
+    return RejectPromiseWithPendingError(cx, promise);
+  }
+
+  JS::RootedValue entry_val(cx);
+  JS::RootedObject entry(cx);
+  JS::RootedValue key_val(cx);
+  JS::RootedObject key(cx);
+  JS::RootedValue signature_val(cx);
+  JS::RootedValue data_val(cx);
+  JS::RootedValue result_val(cx);
+  // Entries often share a key, which then only needs to be checked once.
+  JS::RootedObject checked_key(cx);
+  for (uint32_t i = 0; i < length; i++) {
+    if (!JS_GetElement(cx, entries, i, &entry_val)) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    if (!entry_val.isObject()) {
+      api::throw_error(cx, api::Errors::TypeError, "SubtleCrypto.verifyBatch", "entries",
+                       "only contain objects");
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    entry = &entry_val.toObject();
+
+    if (!JS_GetProperty(cx, entry, "key", &key_val)) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    if (!CryptoKey::is_instance(key_val)) {
+      api::throw_error(cx, api::Errors::TypeError, "SubtleCrypto.verifyBatch", "entry key",
+                       "be a CryptoKey object");
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    key = &key_val.toObject();
+
+    if (key.get() != checked_key.get()) {
+      if (!CryptoKey::is_algorithm(key, identifier)) {
+        DOMException::raise(cx, "CryptoKey doesn't match AlgorithmIdentifier",
+                            "InvalidAccessError");
+        return RejectPromiseWithPendingError(cx, promise);
+      }
+      if (!CryptoKey::canVerify(key)) {
+        DOMException::raise(cx, "CryptoKey doesn't support verification", "InvalidAccessError");
+        return RejectPromiseWithPendingError(cx, promise);
+      }
+      checked_key = key;
+    }
+
+    if (!JS_GetProperty(cx, entry, "signature", &signature_val) ||
+        !JS_GetProperty(cx, entry, "data", &data_val)) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    // Both are live views into their buffers, which is fine because no content can run between
+    // getting them and verifying the signature.
+    auto signature =
+        value_to_buffer(cx, signature_val, "SubtleCrypto.verifyBatch: entry signature");
+    if (!signature) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    auto data = value_to_buffer(cx, data_val, "SubtleCrypto.verifyBatch: entry data");
+    if (!data) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+
+    auto matchResult = normalizedAlgorithm->verify(cx, key, signature.value(), data.value());
+    if (matchResult.isErr()) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+    result_val.setBoolean(matchResult.unwrap());
+    if (!JS_SetElement(cx, results, i, result_val)) {
+      return RejectPromiseWithPendingError(cx, promise);
+    }
+  }
+
+  JS::RootedValue result(cx, JS::ObjectValue(*results));
+  JS::ResolvePromise(cx, promise, result);
+  return true;
+}
+
 const JSFunctionSpec SubtleCrypto::static_methods[] = {
     JS_FS_END,
 };
@@ -357,14 +935,21 @@ const JSPropertySpec SubtleCrypto::static_properties[] = {
 };
 
 const JSFunctionSpec SubtleCrypto::methods[] = {
+    JS_FN("decrypt", decrypt, 3, JSPROP_ENUMERATE),
+    JS_FN("deriveBits", deriveBits, 2, JSPROP_ENUMERATE),
+    JS_FN("deriveKey", deriveKey, 5, JSPROP_ENUMERATE),
     JS_FN("digest", digest, 2, JSPROP_ENUMERATE),
+    JS_FN("encrypt", encrypt, 3, JSPROP_ENUMERATE),
+    JS_FN("exportKey", exportKey, 2, JSPROP_ENUMERATE),
+    JS_FN("generateKey", generateKey, 3, JSPROP_ENUMERATE),
     JS_FN("importKey", importKey, 5, JSPROP_ENUMERATE), JS_FN("sign", sign, 3, JSPROP_ENUMERATE),
-    JS_FN("verify", verify, 4, JSPROP_ENUMERATE), JS_FS_END};
+    JS_FN("verify", verify, 4, JSPROP_ENUMERATE),
+    JS_FN("verifyBatch", verifyBatch, 2, 0), JS_FS_END};
 
 const JSPropertySpec SubtleCrypto::properties[] = {
     JS_STRING_SYM_PS(toStringTag, "SubtleCrypto", JSPROP_READONLY), JS_PS_END};
 
 bool SubtleCrypto::init_class(JSContext *cx, JS::HandleObject global) {
-  return init_class_impl(cx, global);
+  return init_class_impl(cx, global) && initAlgorithmNames(cx);
 }
 } // namespace builtins::web::crypto
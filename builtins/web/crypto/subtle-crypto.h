@@ -33,10 +33,17 @@ public:
   static const JSPropertySpec static_properties[];
   static const JSFunctionSpec methods[];
   static const JSPropertySpec properties[];
+  static bool decrypt(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool deriveBits(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool deriveKey(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool digest(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool encrypt(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool exportKey(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool generateKey(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool importKey(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool sign(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool verify(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool verifyBatch(JSContext *cx, unsigned argc, JS::Value *vp);
 
   static bool init_class(JSContext *cx, JS::HandleObject global);
 };
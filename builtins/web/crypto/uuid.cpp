@@ -66,15 +66,10 @@ struct UUID {
 std::optional<std::string> random_uuid_v4(JSContext *cx) {
   UUID id{};
 
-  {
-    auto res = host_api::Random::get_bytes(sizeof(id));
-    if (const auto *err = res.to_err()) {
-      HANDLE_ERROR(cx, *err);
-      return std::nullopt;
-    }
-
-    auto bytes = std::move(res.unwrap());
-    std::copy_n(bytes.begin(), sizeof(id), reinterpret_cast<uint8_t *>(&id));
+  auto res = host_api::Random::fill({reinterpret_cast<uint8_t *>(&id), sizeof(id)});
+  if (const auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return std::nullopt;
   }
 
   // Set the two most significant bits (bits 6 and 7) of the clock_seq_hi_and_reserved to zero and
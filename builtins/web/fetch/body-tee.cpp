@@ -0,0 +1,233 @@
+#include "body-tee.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace builtins::web::fetch {
+
+namespace {
+
+constexpr size_t TEE_READ_CHUNK_SIZE = 8192;
+
+/// Reads a single chunk from a tee's incoming body, and then wakes up all branches waiting for it.
+class BodyTeeReadTask final : public api::AsyncTask {
+  RefPtr<BodyTee> tee_;
+
+public:
+  explicit BodyTeeReadTask(BodyTee *tee) : tee_(tee) {
+    auto res = tee->source()->subscribe();
+    MOZ_ASSERT(!res.is_err(), "Subscribing to a future should never fail");
+    handle_ = res.unwrap();
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    if (!tee_->read_from_source()) {
+      engine->queue_async_task(this);
+      return true;
+    }
+
+    tee_->wake_waiters(engine);
+    return true;
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    handle_ = INVALID_POLLABLE_HANDLE;
+    return true;
+  }
+
+  // The tasks waiting for this read aren't queued themselves, so they're kept alive from here.
+  void trace(JSTracer *trc) override { tee_->trace(trc); }
+};
+
+} // namespace
+
+BodyTee::Branch::Branch(BodyTee *tee, const size_t index) : tee_(tee), index_(index) {}
+
+BodyTee::Branch::~Branch() { tee_->detach(index_); }
+
+BodyTee::Branch *BodyTee::Branch::clone() {
+  // Copied out, as adding a branch can reallocate `branches_`.
+  const size_t cursor = tee_->branches_[index_].cursor;
+  const bool attached = tee_->branches_[index_].attached;
+  auto index = tee_->add_branch(cursor);
+  if (!attached) {
+    tee_->detach(index);
+  }
+  return js_new<Branch>(tee_.get(), index);
+}
+
+BodyTee::ReadResult BodyTee::Branch::read(host_api::HostBytes *chunk) {
+  auto &tee = *tee_;
+  auto &state = tee.branches_[index_];
+  if (!state.attached) {
+    return ReadResult::Done;
+  }
+
+  if (state.cursor == tee.chunks_base_ + tee.chunks_.size()) {
+    switch (tee.state_) {
+    case State::Open:
+      return ReadResult::Pending;
+    case State::Errored:
+      tee.detach(index_);
+      return ReadResult::Error;
+    case State::Done:
+    case State::Taken:
+      tee.detach(index_);
+      return ReadResult::Done;
+    }
+  }
+
+  // If any other branch still has to consume this chunk, hand out a copy. Otherwise, this is the
+  // chunk's last consumer, so it can take the buffer itself.
+  auto &buffered = tee.chunks_[state.cursor - tee.chunks_base_];
+  bool needed_elsewhere = false;
+  for (size_t i = 0; i < tee.branches_.size(); i++) {
+    const auto &other = tee.branches_[i];
+    if (i != index_ && other.attached && other.cursor <= state.cursor) {
+      needed_elsewhere = true;
+      break;
+    }
+  }
+
+  if (needed_elsewhere) {
+    auto copy = std::make_unique_for_overwrite<uint8_t[]>(buffered.len);
+    memcpy(copy.get(), buffered.ptr.get(), buffered.len);
+    *chunk = host_api::HostBytes(std::move(copy), buffered.len);
+  } else {
+    *chunk = std::move(buffered);
+  }
+
+  state.cursor++;
+  tee.drop_consumed_chunks();
+  return ReadResult::Chunk;
+}
+
+void BodyTee::Branch::wait(api::Engine *engine, api::AsyncTask *task) {
+  auto &state = tee_->branches_[index_];
+  MOZ_ASSERT(state.attached);
+  MOZ_ASSERT(tee_->state_ == State::Open);
+  if (state.waiter) {
+    return;
+  }
+
+  state.waiter = task;
+  if (!tee_->reading_) {
+    tee_->reading_ = true;
+    engine->queue_async_task(js_new<BodyTeeReadTask>(tee_.get()));
+  }
+}
+
+bool BodyTee::Branch::waiting() const { return tee_->branches_[index_].waiter != nullptr; }
+
+void BodyTee::Branch::cancel() { tee_->detach(index_); }
+
+bool BodyTee::Branch::attached() const { return tee_->branches_[index_].attached; }
+
+host_api::HttpIncomingBody *BodyTee::Branch::take_source() {
+  auto &tee = *tee_;
+  const auto &state = tee.branches_[index_];
+  if (!state.attached || tee.state_ != State::Open ||
+      state.cursor != tee.chunks_base_ + tee.chunks_.size()) {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < tee.branches_.size(); i++) {
+    if (i != index_ && tee.branches_[i].attached) {
+      return nullptr;
+    }
+  }
+
+  tee.state_ = State::Taken;
+  tee.detach(index_);
+  return tee.source_.release();
+}
+
+BodyTee::Branch *BodyTee::create(std::unique_ptr<host_api::HttpIncomingBody> source) {
+  auto *tee = js_new<BodyTee>(std::move(source));
+  return js_new<Branch>(tee, tee->add_branch(0));
+}
+
+bool BodyTee::read_from_source() {
+  MOZ_ASSERT(reading_);
+  // Nobody is interested in the body anymore, or it has been handed out wholesale.
+  if (state_ != State::Open || !has_attached_branches()) {
+    reading_ = false;
+    return true;
+  }
+
+  auto res = source_->read(TEE_READ_CHUNK_SIZE);
+  if (res.is_err()) {
+    state_ = State::Errored;
+    reading_ = false;
+    return true;
+  }
+
+  auto &chunk = res.unwrap();
+  if (!chunk.done && chunk.bytes.len == 0) {
+    return false;
+  }
+
+  if (chunk.bytes.len > 0) {
+    chunks_.push_back(std::move(chunk.bytes));
+  }
+  if (chunk.done) {
+    state_ = State::Done;
+  }
+
+  reading_ = false;
+  return true;
+}
+
+void BodyTee::wake_waiters(api::Engine *engine) {
+  for (auto &branch : branches_) {
+    if (branch.waiter) {
+      engine->queue_async_task(branch.waiter);
+      branch.waiter = nullptr;
+    }
+  }
+}
+
+void BodyTee::trace(JSTracer *trc) {
+  for (auto &branch : branches_) {
+    if (branch.waiter) {
+      branch.waiter->trace(trc);
+    }
+  }
+}
+
+bool BodyTee::has_attached_branches() const {
+  return std::ranges::any_of(branches_, [](const auto &branch) { return branch.attached; });
+}
+
+size_t BodyTee::add_branch(const size_t cursor) {
+  branches_.emplace_back().cursor = cursor;
+  return branches_.size() - 1;
+}
+
+void BodyTee::detach(const size_t index) {
+  auto &branch = branches_[index];
+  if (!branch.attached) {
+    return;
+  }
+
+  branch.attached = false;
+  branch.waiter = nullptr;
+  drop_consumed_chunks();
+}
+
+void BodyTee::drop_consumed_chunks() {
+  size_t min_cursor = chunks_base_ + chunks_.size();
+  for (const auto &branch : branches_) {
+    if (branch.attached) {
+      min_cursor = std::min(min_cursor, branch.cursor);
+    }
+  }
+
+  while (chunks_base_ < min_cursor) {
+    chunks_.pop_front();
+    chunks_base_++;
+  }
+}
+
+} // namespace builtins::web::fetch
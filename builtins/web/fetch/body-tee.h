@@ -0,0 +1,119 @@
+#ifndef BUILTINS_WEB_FETCH_BODY_TEE_H
+#define BUILTINS_WEB_FETCH_BODY_TEE_H
+
+#include "extension-api.h"
+#include "host_api.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace builtins::web::fetch {
+
+/// Shares a single incoming body between a Request or Response and its clones, without reifying
+/// any of them as a JS ReadableStream.
+///
+/// Chunks read from the host are appended to a list shared by all branches, each of which
+/// consumes it through its own cursor. A chunk is freed as soon as every branch still attached
+/// to the tee has moved past it: the last branch to consume a chunk takes ownership of its
+/// bytes, all others receive a copy.
+///
+/// Reads from the host are only issued when a branch runs out of buffered chunks, so the fastest
+/// consumer drives the body, and slower ones catch up on the buffered chunks later.
+class BodyTee final : public js::RefCounted<BodyTee> {
+public:
+  enum class ReadResult : uint8_t {
+    // A chunk was returned.
+    Chunk,
+    // No chunk is buffered for the branch yet. Use `Branch::wait` to be notified.
+    Pending,
+    // The body has been fully consumed by the branch, or the branch was canceled.
+    Done,
+    // Reading from the incoming body failed.
+    Error,
+  };
+
+  /// A single consumer of a teed body, owned by the Request or Response reading from it.
+  ///
+  /// Destroying a branch detaches it from the tee, releasing all chunks only it still needed.
+  class Branch final {
+    RefPtr<BodyTee> tee_;
+    size_t index_;
+
+  public:
+    Branch(BodyTee *tee, size_t index);
+    ~Branch();
+
+    Branch(const Branch &) = delete;
+    Branch &operator=(const Branch &) = delete;
+
+    /// Creates a new branch that will observe the same chunks as this one, starting from this
+    /// branch's current position.
+    Branch *clone();
+
+    /// Takes the next chunk for this branch, if one is available.
+    ReadResult read(host_api::HostBytes *chunk);
+
+    /// Queues `task` once the next call to `read` will not return `ReadResult::Pending`, issuing
+    /// a read from the incoming body if none is in flight yet.
+    ///
+    /// A branch has at most one waiter at a time; calling this while a waiter is registered
+    /// has no effect, and `task` isn't retained, so callers check `waiting` before creating one.
+    void wait(api::Engine *engine, api::AsyncTask *task);
+
+    /// Returns true if a task is registered to be queued once this branch can be read again.
+    [[nodiscard]] bool waiting() const;
+
+    /// Detaches this branch from the tee. All subsequent reads return `ReadResult::Done`.
+    void cancel();
+
+    /// Returns true if this branch hasn't been canceled or fully read yet.
+    [[nodiscard]] bool attached() const;
+
+    /// Hands out the incoming body itself if this branch is its only remaining consumer and has
+    /// no chunks buffered, so it can be forwarded with host-side operations instead of being
+    /// read chunk-by-chunk. On success, the branch is detached. Returns nullptr otherwise.
+    host_api::HttpIncomingBody *take_source();
+  };
+
+  /// Creates a tee reading from `source`, returning its initial branch. The tee owns `source` until
+  /// it's handed out by `Branch::take_source`.
+  static Branch *create(std::unique_ptr<host_api::HttpIncomingBody> source);
+
+  explicit BodyTee(std::unique_ptr<host_api::HttpIncomingBody> source)
+      : source_(std::move(source)) {}
+
+  /// Reads a chunk from the incoming body. Returns false if no data was available yet.
+  bool read_from_source();
+  void wake_waiters(api::Engine *engine);
+  void trace(JSTracer *trc);
+
+  [[nodiscard]] host_api::HttpIncomingBody *source() const { return source_.get(); }
+  [[nodiscard]] bool has_attached_branches() const;
+
+private:
+  enum class State : uint8_t { Open, Done, Errored, Taken };
+
+  struct BranchState {
+    size_t cursor = 0;
+    bool attached = true;
+    RefPtr<api::AsyncTask> waiter;
+  };
+
+  std::unique_ptr<host_api::HttpIncomingBody> source_;
+  // Buffered chunks. `chunks_base_` is the absolute index of the first entry, so that branch
+  // cursors stay valid when consumed chunks are dropped from the front.
+  std::deque<host_api::HostBytes> chunks_;
+  size_t chunks_base_ = 0;
+  std::vector<BranchState> branches_;
+  State state_ = State::Open;
+  bool reading_ = false;
+
+  size_t add_branch(size_t cursor);
+  void detach(size_t index);
+  void drop_consumed_chunks();
+};
+
+} // namespace builtins::web::fetch
+
+#endif // BUILTINS_WEB_FETCH_BODY_TEE_H
@@ -12,6 +12,7 @@
 #include "../blob.h"
 #include "../url.h"
 
+#include <charconv>
 #include <fmt/format.h>
 
 namespace builtins::web::fetch {
@@ -28,7 +29,9 @@ enum class FetchScheme : uint8_t {
   About,
   Blob,
   Data,
+#ifdef ENABLE_FETCH_FILE_SCHEME
   File,
+#endif
   Http,
   Https,
 };
@@ -56,9 +59,11 @@ std::optional<FetchScheme> scheme_from_url(const std::string_view &url) {
   if (url.starts_with("data:")) {
     return FetchScheme::Data;
   }
+#ifdef ENABLE_FETCH_FILE_SCHEME
   if (url.starts_with("file:")) {
     return FetchScheme::File;
   }
+#endif
   if (url.starts_with("http")) {
     return FetchScheme::Http;
   }
@@ -144,34 +149,10 @@ bool fetch_https(JSContext *cx, HandleObject request_obj, HandleObject response_
   return true;
 }
 
-/// https://fetch.spec.whatwg.org/#scheme-fetch
-bool fetch_blob(JSContext *cx, HandleObject request_obj, HandleObject response_promise,
-                HostString method, HostString url, MutableHandleValue rval) {
-  // 1. Let blobURLEntry be request's current URL's blob URL entry.
-  RootedString blob_url(cx);
-
-  // 2. If request's method is not `GET` or blobURLEntry is null, then return a network error.
-  if (std::memcmp(method.ptr.get(), "GET", method.len) != 0) {
-    return network_error(cx, response_promise, rval);
-  }
-
-  // 3. Let requestEnvironment be the result of determining the environment given request.
-  // 4. Let isTopLevelNavigation be true if request's destination is "document"; otherwise, false.
-  // 5. If isTopLevelNavigation is false and requestEnvironment is null, then return a network
-  // error.
-  // 6. Let navigationOrEnvironment be the string "navigation" if isTopLevelNavigation is true;
-  //  otherwise, requestEnvironment.
-  //  N/A
-  // 7. Let blob be the result of obtaining a blob object given blobURLEntry and
-  // navigationOrEnvironment.
-  std::string url_key(url.ptr.get());
-  RootedObject blob(cx, url::URL::getObjectURL(url_key));
-
-  // 8. If blob is not a Blob object, then return a network error.
-  if (!blob || !Blob::is_instance(blob)) {
-    return network_error(cx, response_promise, rval);
-  }
-
+// Steps 9-15 of the blob URL case of https://fetch.spec.whatwg.org/#scheme-fetch: creates the
+// response for a GET request for `blob`, honoring the request's `Range` header.
+bool respond_with_blob(JSContext *cx, HandleObject request_obj, HandleObject response_promise,
+                       HandleObject blob, MutableHandleValue rval) {
   // 9. Let response be a new response.
   RootedObject response_obj(cx, Response::create(cx));
   if (!response_obj) {
@@ -303,6 +284,111 @@ bool fetch_blob(JSContext *cx, HandleObject request_obj, HandleObject response_p
   return true;
 }
 
+/// https://fetch.spec.whatwg.org/#scheme-fetch
+bool fetch_blob(JSContext *cx, HandleObject request_obj, HandleObject response_promise,
+                HostString method, HostString url, MutableHandleValue rval) {
+  // 1. Let blobURLEntry be request's current URL's blob URL entry.
+  RootedString blob_url(cx);
+
+  // 2. If request's method is not `GET` or blobURLEntry is null, then return a network error.
+  if (std::memcmp(method.ptr.get(), "GET", method.len) != 0) {
+    return network_error(cx, response_promise, rval);
+  }
+
+  // 3. Let requestEnvironment be the result of determining the environment given request.
+  // 4. Let isTopLevelNavigation be true if request's destination is "document"; otherwise, false.
+  // 5. If isTopLevelNavigation is false and requestEnvironment is null, then return a network
+  // error.
+  // 6. Let navigationOrEnvironment be the string "navigation" if isTopLevelNavigation is true;
+  //  otherwise, requestEnvironment.
+  //  N/A
+  // 7. Let blob be the result of obtaining a blob object given blobURLEntry and
+  // navigationOrEnvironment.
+  std::string url_key(url.ptr.get());
+  RootedObject blob(cx, url::URL::getObjectURL(url_key));
+
+  // 8. If blob is not a Blob object, then return a network error.
+  if (!blob || !Blob::is_instance(blob)) {
+    return network_error(cx, response_promise, rval);
+  }
+
+  return respond_with_blob(cx, request_obj, response_promise, blob, rval);
+}
+
+#ifdef ENABLE_FETCH_FILE_SCHEME
+// Returns the path of the file a `file:` URL refers to, or std::nullopt if it refers to a
+// non-local host or contains an invalid percent-encoded byte.
+std::optional<std::string> file_url_to_path(std::string_view url) {
+  MOZ_ASSERT(url.starts_with("file://"));
+  url.remove_prefix(strlen("file://"));
+  url = url.substr(0, url.find_first_of("?#"));
+
+  auto path_start = url.find('/');
+  if (path_start == std::string_view::npos) {
+    return std::nullopt;
+  }
+
+  auto host = url.substr(0, path_start);
+  if (!host.empty() && host != "localhost") {
+    return std::nullopt;
+  }
+
+  auto encoded = url.substr(path_start);
+  std::string path;
+  path.reserve(encoded.size());
+  for (size_t i = 0; i < encoded.size(); i++) {
+    if (encoded[i] != '%') {
+      path.push_back(encoded[i]);
+      continue;
+    }
+
+    uint8_t byte = 0;
+    auto hex = encoded.substr(i + 1, 2);
+    auto [end, ec] = std::from_chars(hex.data(), hex.data() + hex.size(), byte, 16);
+    if (hex.size() != 2 || ec != std::errc() || end != hex.data() + 2 || byte == 0) {
+      return std::nullopt;
+    }
+    path.push_back(static_cast<char>(byte));
+    i += 2;
+  }
+
+  return path;
+}
+
+/// The `file` case of https://fetch.spec.whatwg.org/#scheme-fetch, which the spec leaves to
+/// implementations. Only available when built with `ENABLE_FETCH_FILE_SCHEME`, as it exposes all
+/// directories the host preopened to anything that can influence a fetched URL.
+///
+/// GET requests for files in directories the host has made available are answered like requests
+/// for blob URLs, using a Blob that is backed by the file. The file's contents are only read
+/// as the response body is consumed, so serving large files doesn't require holding them in
+/// memory.
+bool fetch_file(JSContext *cx, HandleObject request_obj, HandleObject response_promise,
+                HostString method, HostString url, MutableHandleValue rval) {
+  if (std::string_view(method) != "GET") {
+    return network_error(cx, response_promise, rval);
+  }
+
+  auto path = file_url_to_path(url);
+  if (!path) {
+    return network_error(cx, response_promise, rval);
+  }
+
+  js::UniquePtr<blob::BlobData> data(blob::BlobData::create_for_file(path->c_str()));
+  if (!data) {
+    return network_error(cx, response_promise, rval);
+  }
+
+  RootedString type(cx, JS_GetEmptyString(cx));
+  RootedObject blob(cx, Blob::create(cx, std::move(data), type));
+  if (!blob) {
+    return false;
+  }
+
+  return respond_with_blob(cx, request_obj, response_promise, blob, rval);
+}
+#endif // ENABLE_FETCH_FILE_SCHEME
+
 // TODO: throw in all Request methods/getters that rely on host calls once a
 // request has been sent. The host won't let us act on them anymore anyway.
 /**
@@ -372,6 +458,16 @@ bool fetch(JSContext *cx, unsigned argc, Value *vp) {
     }
     break;
   }
+#ifdef ENABLE_FETCH_FILE_SCHEME
+  case FetchScheme::File: {
+    auto res = fetch_file(cx, request_obj, response_promise, std::move(method), std::move(url),
+                          args.rval());
+    if (!res) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    break;
+  }
+#endif
   case FetchScheme::Http:
   case FetchScheme::Https:
   default: {
@@ -172,8 +172,9 @@ bool FetchEvent::init_incoming_request(JSContext *cx, JS::HandleObject self,
     return false;
   }
 
-  auto *uri_bytes = new uint8_t[uri_str.size() + 1];
-  std::copy(uri_str.begin(), uri_str.end(), uri_bytes);
+  // The URL is only read while parsing, so it's passed without a copy. Parsing it also adds it to
+  // the URL cache, so handlers parsing their request's URL again don't have to.
+  auto *uri_bytes = reinterpret_cast<uint8_t *>(const_cast<char *>(uri_str.data()));
   jsurl::SpecString spec(uri_bytes, uri_str.size(), uri_str.size());
 
   worker_location::WorkerLocation::url = url::URL::create(cx, url_instance, spec);
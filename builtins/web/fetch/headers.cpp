@@ -3,36 +3,111 @@
 #include "decode.h"
 #include "encode.h"
 #include "fetch-errors.h"
+#include "header-name-set.h"
 #include "sequence.hpp"
 
 #include "js/Conversions.h"
 #include <numeric>
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 namespace builtins::web::fetch {
 namespace {
 
-const std::array<char, 128> VALID_NAME_CHARS = {
-    0, 0, 0, 0, 0, 0, 0, 0, //   0
-    0, 0, 0, 0, 0, 0, 0, 0, //   8
-    0, 0, 0, 0, 0, 0, 0, 0, //  16
-    0, 0, 0, 0, 0, 0, 0, 0, //  24
-
-    0, 1, 0, 1, 1, 1, 1, 1, //  32
-    0, 0, 1, 1, 0, 1, 1, 0, //  40
-    1, 1, 1, 1, 1, 1, 1, 1, //  48
-    1, 1, 0, 0, 0, 0, 0, 0, //  56
-
-    0, 1, 1, 1, 1, 1, 1, 1, //  64
-    1, 1, 1, 1, 1, 1, 1, 1, //  72
-    1, 1, 1, 1, 1, 1, 1, 1, //  80
-    1, 1, 1, 0, 0, 0, 1, 1, //  88
-
-    1, 1, 1, 1, 1, 1, 1, 1, //  96
-    1, 1, 1, 1, 1, 1, 1, 1, // 104
-    1, 1, 1, 1, 1, 1, 1, 1, // 112
-    1, 1, 1, 0, 1, 0, 1, 0  // 120
+// Character classes used for header name and value validation.
+//
+// All checks are done via lookups into a 256-entry table instead of chains of comparisons,
+// so that validation of each byte is a single load and mask.
+enum CharClass : uint8_t {
+  // Valid in a header name: a `tchar` as defined in RFC 9110.
+  HEADER_NAME_CHAR = 1 << 0,
+  // HTTP whitespace, stripped from the start and end of header values.
+  HEADER_VALUE_WHITESPACE = 1 << 1,
+  // Invalid anywhere within a (trimmed) header value.
+  HEADER_VALUE_FORBIDDEN = 1 << 2,
 };
 
+constexpr bool is_token_char(const unsigned char ch) {
+  if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')) {
+    return true;
+  }
+  constexpr std::string_view token_punctuation = "!#$%&'*+-.^_`|~";
+  return token_punctuation.find(static_cast<char>(ch)) != std::string_view::npos;
+}
+
+constexpr std::array<uint8_t, 256> make_char_classes() {
+  std::array<uint8_t, 256> table{};
+  for (size_t ch = 0; ch < table.size(); ch++) {
+    uint8_t cls = 0;
+    if (is_token_char(ch)) {
+      cls |= HEADER_NAME_CHAR;
+    }
+    if (ch == '\t' || ch == ' ' || ch == '\r' || ch == '\n') {
+      cls |= HEADER_VALUE_WHITESPACE;
+    }
+    if (ch == '\r' || ch == '\n' || ch == '\0') {
+      cls |= HEADER_VALUE_FORBIDDEN;
+    }
+    table.at(ch) = cls;
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = make_char_classes();
+constexpr const std::array<char, 256> &LOWERCASE = host_api::ASCII_LOWERCASE;
+
+static_assert(CHAR_CLASSES['a'] & HEADER_NAME_CHAR);
+static_assert(!(CHAR_CLASSES[':'] & HEADER_NAME_CHAR));
+static_assert(!(CHAR_CLASSES[0x80] & HEADER_NAME_CHAR));
+static_assert(LOWERCASE['Q'] == 'q' && LOWERCASE['-'] == '-');
+
+inline bool has_char_class(const unsigned char ch, const CharClass cls) {
+  return (CHAR_CLASSES[ch] & cls) != 0;
+}
+
+/**
+ * Returns true if all of the given bytes are valid header name characters.
+ *
+ * The classes of all bytes are combined before checking, so the loop doesn't branch per byte.
+ */
+bool all_header_name_chars(const unsigned char *chars, size_t len) {
+  uint8_t combined = HEADER_NAME_CHAR;
+  for (size_t i = 0; i < len; i++) {
+    combined &= CHAR_CLASSES[chars[i]];
+  }
+  return (combined & HEADER_NAME_CHAR) != 0;
+}
+
+/**
+ * Returns true if any of the given bytes is forbidden in a header value.
+ *
+ * Long values such as cookies or CSP headers are scanned 16 bytes at a time when SIMD is
+ * available, with the table-driven scalar loop handling the tail.
+ */
+bool any_forbidden_value_char(const unsigned char *chars, size_t len) {
+  size_t i = 0;
+#ifdef __wasm_simd128__
+  const v128_t cr = wasm_i8x16_splat('\r');
+  const v128_t lf = wasm_i8x16_splat('\n');
+  const v128_t nul = wasm_i8x16_splat(0);
+  for (; i + 16 <= len; i += 16) {
+    const v128_t block = wasm_v128_load(chars + i);
+    const v128_t hits = wasm_v128_or(wasm_v128_or(wasm_i8x16_eq(block, cr), wasm_i8x16_eq(block, lf)),
+                                     wasm_i8x16_eq(block, nul));
+    if (wasm_v128_any_true(hits)) {
+      return true;
+    }
+  }
+#endif
+  uint8_t combined = 0;
+  for (; i < len; i++) {
+    combined |= CHAR_CLASSES[chars[i]];
+  }
+  return (combined & HEADER_VALUE_FORBIDDEN) != 0;
+}
+
 host_api::HostString set_cookie_str;
 
 host_api::HttpHeadersReadOnly *get_handle(JSObject *self) {
@@ -55,34 +130,21 @@ host_api::HttpHeadersReadOnly *get_handle(JSObject *self) {
  * For details on validation.
  */
 bool normalize_header_value(host_api::HostString &value) {
-  auto *value_chars = value.begin();
+  auto *value_chars = reinterpret_cast<unsigned char *>(value.begin());
 
   size_t start = 0;
   size_t end = value.len;
 
-  while (start < end) {
-    unsigned char ch = value_chars[start];
-    if (ch == '\t' || ch == ' ' || ch == '\r' || ch == '\n') {
-      start++;
-    } else {
-      break;
-    }
+  while (start < end && has_char_class(value_chars[start], HEADER_VALUE_WHITESPACE)) {
+    start++;
   }
 
-  while (end > start) {
-    unsigned char ch = value_chars[end - 1];
-    if (ch == '\t' || ch == ' ' || ch == '\r' || ch == '\n') {
-      end--;
-    } else {
-      break;
-    }
+  while (end > start && has_char_class(value_chars[end - 1], HEADER_VALUE_WHITESPACE)) {
+    end--;
   }
 
-  for (size_t i = start; i < end; i++) {
-    unsigned char ch = value_chars[i];
-    if (ch == '\r' || ch == '\n' || ch == '\0') {
-      return false;
-    }
+  if (any_forbidden_value_char(value_chars + start, end - start)) {
+    return false;
   }
 
   if (start != 0 || end != value.len) {
@@ -115,12 +177,9 @@ host_api::HostString normalize_and_validate_header_value(JSContext *cx, HandleVa
   return value;
 }
 
-const std::vector<const char *> *forbidden_request_headers;
-const std::vector<const char *> *forbidden_response_headers;
-
 enum class Ordering : uint8_t { Less, Equal, Greater };
 
-inline char header_lowercase(const char c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+inline char header_lowercase(const char c) { return LOWERCASE[static_cast<unsigned char>(c)]; }
 
 inline Ordering header_compare(const std::string_view a, const std::string_view b) {
   auto it_a = a.begin();
@@ -143,12 +202,6 @@ inline Ordering header_compare(const std::string_view a, const std::string_view
   return Ordering::Greater;
 }
 
-struct HeaderCompare {
-  bool operator()(const std::string_view a, const std::string_view b) {
-    return header_compare(a, b) == Ordering::Less;
-  }
-};
-
 class HeadersSortListCompare {
   const Headers::HeadersList *headers_;
 
@@ -363,22 +416,10 @@ bool validate_guard(JSContext *cx, HandleObject self, string_view header_name, c
   case Headers::HeadersGuard::Immutable:
     return api::throw_error(cx, FetchErrors::HeadersImmutable, fun_name);
   case Headers::HeadersGuard::Request:
-    for (const auto *forbidden_header_name : *forbidden_request_headers) {
-      if (header_compare(header_name, forbidden_header_name) == Ordering::Equal) {
-        *is_valid = false;
-        return true;
-      }
-    }
-    *is_valid = true;
+    *is_valid = !host_api::HttpHeaders::is_forbidden_request_header(header_name);
     return true;
   case Headers::HeadersGuard::Response:
-    for (const auto *forbidden_header_name : *forbidden_response_headers) {
-      if (header_compare(header_name, forbidden_header_name) == Ordering::Equal) {
-        *is_valid = false;
-        return true;
-      }
-    }
-    *is_valid = true;
+    *is_valid = !host_api::HttpHeaders::is_forbidden_response_header(header_name);
     return true;
   default:
     MOZ_ASSERT_UNREACHABLE();
@@ -590,12 +631,9 @@ host_api::HostString Headers::validate_header_name(JSContext *cx, HandleValue na
   }
 
   char *name_chars = name.begin();
-  for (size_t i = 0; i < name.len; i++) {
-    const unsigned char ch = name_chars[i];
-    if (ch > 127 || (VALID_NAME_CHARS.at(ch) == 0)) {
-      api::throw_error(cx, FetchErrors::InvalidHeaderName, fun_name, name_chars);
-      return host_api::HostString{};
-    }
+  if (!all_header_name_chars(reinterpret_cast<unsigned char *>(name_chars), name.len)) {
+    api::throw_error(cx, FetchErrors::InvalidHeaderName, fun_name, name_chars);
+    return host_api::HostString{};
   }
 
   return name;
@@ -1114,18 +1152,6 @@ void Headers::finalize(JS::GCContext *gcx, JSObject *self) {
 }
 
 bool Headers::init_class(JSContext *cx, JS::HandleObject global) {
-  // get the host forbidden headers for guard checks
-  forbidden_request_headers = &host_api::HttpHeaders::get_forbidden_request_headers();
-  forbidden_response_headers = &host_api::HttpHeaders::get_forbidden_response_headers();
-
-  // sort the forbidden headers with the lowercase-invariant comparator
-  MOZ_RELEASE_ASSERT(std::is_sorted(forbidden_request_headers->begin(),
-                                    forbidden_request_headers->end(), HeaderCompare()),
-                     "Forbidden request headers must be sorted");
-  MOZ_RELEASE_ASSERT(std::is_sorted(forbidden_response_headers->begin(),
-                                    forbidden_response_headers->end(), HeaderCompare()),
-                     "Forbidden response headers must be sorted");
-
   if (!init_class_impl(cx, global)) {
     return false;
   }
@@ -1298,13 +1324,9 @@ bool HeadersIterator::next(JSContext *cx, unsigned argc, Value *vp) {
     for (size_t i = 0; i < len; ++i) {
       const unsigned char ch = key->ptr[i];
       // headers should already be validated by here
-      MOZ_ASSERT(ch <= 127 && VALID_NAME_CHARS.at(ch));
+      MOZ_ASSERT(has_char_class(ch, HEADER_NAME_CHAR));
       // we store header keys with casing, so getter itself lowercases
-      if (ch >= 'A' && ch <= 'Z') {
-        chars[i] = ch - 'A' + 'a';
-      } else {
-        chars[i] = ch;
-      }
+      chars[i] = LOWERCASE[ch];
     }
     key_val = JS::StringValue(JS_NewLatin1String(cx, std::move(chars), len));
   }
@@ -7,6 +7,7 @@
 #include "../form-data/form-data.h"
 #include "../form-data/form-data-encoder.h"
 #include "../form-data/form-data-parser.h"
+#include "../streams/buf-reader.h"
 #include "../streams/native-stream-source.h"
 #include "../streams/transform-stream.h"
 #include "../url.h"
@@ -51,6 +52,71 @@ using namespace std::literals;
 
 static api::Engine *ENGINE;
 
+namespace {
+
+// Byte body streams are only ever driven through the original controller and BYOB request
+// methods, so that reading a body can't be observed or broken by patching the streams globals.
+JS::PersistentRooted<JS::Value> original_enqueue;
+JS::PersistentRooted<JS::Value> original_byobRequest_getter;
+JS::PersistentRooted<JS::Value> original_view_getter;
+JS::PersistentRooted<JS::Value> original_respond;
+
+bool get_original_getter(JSContext *cx, HandleObject proto, const char *name,
+                         JS::PersistentRooted<JS::Value> &getter) {
+  JS::Rooted<mozilla::Maybe<JS::PropertyDescriptor>> desc(cx);
+  if (!JS_GetOwnPropertyDescriptor(cx, proto, name, &desc)) {
+    return false;
+  }
+  MOZ_ASSERT(desc.isSome() && desc->hasGetter() && desc->getter());
+  getter.setObject(*desc->getter());
+  return true;
+}
+
+bool get_builtin_prototype(JSContext *cx, HandleObject global, const char *name,
+                           JS::MutableHandleObject proto) {
+  RootedValue val(cx);
+  if (!JS_GetProperty(cx, global, name, &val)) {
+    return false;
+  }
+  RootedObject builtin(cx, &val.toObject());
+  if (!JS_GetProperty(cx, builtin, "prototype", &val)) {
+    return false;
+  }
+  proto.set(&val.toObject());
+  return true;
+}
+
+bool init_byte_stream_methods(JSContext *cx, HandleObject global) {
+  RootedObject controller_proto(cx);
+  if (!get_builtin_prototype(cx, global, "ReadableByteStreamController", &controller_proto)) {
+    return false;
+  }
+  RootedObject request_proto(cx);
+  if (!get_builtin_prototype(cx, global, "ReadableStreamBYOBRequest", &request_proto)) {
+    return false;
+  }
+
+  original_enqueue.init(cx);
+  original_byobRequest_getter.init(cx);
+  original_view_getter.init(cx);
+  original_respond.init(cx);
+  if (!JS_GetProperty(cx, controller_proto, "enqueue", &original_enqueue)) {
+    return false;
+  }
+  MOZ_ASSERT(JS::IsCallable(&original_enqueue.toObject()));
+  if (!get_original_getter(cx, controller_proto, "byobRequest", original_byobRequest_getter) ||
+      !get_original_getter(cx, request_proto, "view", original_view_getter)) {
+    return false;
+  }
+  if (!JS_GetProperty(cx, request_proto, "respond", &original_respond)) {
+    return false;
+  }
+  MOZ_ASSERT(JS::IsCallable(&original_respond.toObject()));
+  return true;
+}
+
+} // namespace
+
 bool error_stream_controller_with_pending_exception(JSContext *cx, HandleObject stream) {
   RootedValue exn(cx);
   if (!JS_GetPendingException(cx, &exn)) {
@@ -65,6 +131,35 @@ bool error_stream_controller_with_pending_exception(JSContext *cx, HandleObject
 
 constexpr size_t HANDLE_READ_CHUNK_SIZE = 8192;
 
+// Enqueues the given bytes into a body stream as a Uint8Array, transferring ownership of them.
+bool enqueue_body_chunk(JSContext *cx, HandleObject stream, host_api::HostBytes &bytes) {
+  // We don't release control of the chunk's data until after we've checked that
+  // the array buffer allocation has been successful, as that ensures that the
+  // return path frees chunk automatically when necessary.
+  RootedObject buffer(
+      cx, JS::NewArrayBufferWithContents(cx, bytes.len, bytes.ptr.get(),
+                                         JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+  if (!buffer) {
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  // At this point `buffer` has taken full ownership of the chunk's data.
+  std::ignore = bytes.ptr.release();
+
+  RootedObject byte_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, bytes.len));
+  if (!byte_array) {
+    return false;
+  }
+
+  RootedValue enqueue_val(cx);
+  enqueue_val.setObject(*byte_array);
+  if (!JS::ReadableStreamEnqueue(cx, stream, enqueue_val)) {
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  return true;
+}
+
 class BodyFutureTask final : public api::AsyncTask {
   Heap<JSObject *> body_source_;
   host_api::HttpIncomingBody *incoming_body_;
@@ -85,11 +180,30 @@ public:
     RootedObject stream(cx, streams::NativeStreamSource::stream(body_source_));
     auto *body = RequestOrResponse::incoming_body_handle(owner);
 
+    JS::ReadableStreamMode mode;
+    if (!JS::ReadableStreamGetMode(cx, stream, &mode)) {
+      return false;
+    }
+
+    RootedObject controller(cx);
+    RootedValue byob_request(cx);
+    if (mode == JS::ReadableStreamMode::Byte) {
+      controller = JS::ReadableStreamGetController(cx, stream);
+      RootedValue controller_val(cx, ObjectValue(*controller));
+      if (!JS::Call(cx, controller_val, original_byobRequest_getter, JS::HandleValueArray::empty(),
+                    &byob_request)) {
+        return error_stream_controller_with_pending_exception(cx, stream);
+      }
+    }
+
+    if (byob_request.isObject()) {
+      RootedObject request(cx, &byob_request.toObject());
+      return read_into_byob_request(engine, stream, request);
+    }
+
     auto read_res = body->read(HANDLE_READ_CHUNK_SIZE);
     if (read_res.to_err()) {
-      const auto *receiver = Request::is_instance(owner) ? "request" : "response";
-      api::throw_error(cx, FetchErrors::IncomingBodyStreamError, receiver);
-      return error_stream_controller_with_pending_exception(cx, stream);
+      return error_stream_with_read_error(cx, owner, stream);
     }
 
     auto &chunk = read_res.unwrap();
@@ -97,41 +211,113 @@ public:
       return JS::ReadableStreamClose(cx, stream);
     }
 
-    // We don't release control of chunk's data until after we've checked that
-    // the array buffer allocation has been successful, as that ensures that the
-    // return path frees chunk automatically when necessary.
-    auto &bytes = chunk.bytes;
+    if (mode == JS::ReadableStreamMode::Byte) {
+      // Byte streams reject empty chunks, so wait for more data instead.
+      if (chunk.bytes.len == 0) {
+        engine->queue_async_task(this);
+        return true;
+      }
+      if (!enqueue_byte_chunk(cx, controller, stream, chunk.bytes)) {
+        return false;
+      }
+    } else if (!enqueue_body_chunk(cx, stream, chunk.bytes)) {
+      return false;
+    }
+
+    return cancel(engine);
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    // TODO(TS): implement
+    handle_ = -1;
+    return true;
+  }
+
+  void trace(JSTracer *trc) override { TraceEdge(trc, &body_source_, "body source for future"); }
+
+private:
+  static bool error_stream_with_read_error(JSContext *cx, HandleObject owner,
+                                           HandleObject stream) {
+    const auto *receiver = Request::is_instance(owner) ? "request" : "response";
+    api::throw_error(cx, FetchErrors::IncomingBodyStreamError, receiver);
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  // Enqueues the given bytes into a byte stream, transferring ownership of them.
+  //
+  // `JS::ReadableStreamEnqueue` only supports default streams, so this goes through the
+  // controller's original `enqueue` method instead.
+  static bool enqueue_byte_chunk(JSContext *cx, HandleObject controller, HandleObject stream,
+                                 host_api::HostBytes &bytes) {
     RootedObject buffer(
         cx, JS::NewArrayBufferWithContents(cx, bytes.len, bytes.ptr.get(),
                                            JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
     if (!buffer) {
       return error_stream_controller_with_pending_exception(cx, stream);
     }
-
-    // At this point `buffer` has taken full ownership of the chunk's data.
     std::ignore = bytes.ptr.release();
 
-    RootedObject byte_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, bytes.len));
-    if (!byte_array) {
+    RootedValueArray<1> args(cx);
+    args[0].setObjectOrNull(JS_NewUint8ArrayWithBuffer(cx, buffer, 0, bytes.len));
+    if (args[0].isNull()) {
       return false;
     }
 
-    RootedValue enqueue_val(cx);
-    enqueue_val.setObject(*byte_array);
-    if (!JS::ReadableStreamEnqueue(cx, stream, enqueue_val)) {
+    RootedValue controller_val(cx, ObjectValue(*controller));
+    RootedValue rval(cx);
+    if (!JS::Call(cx, controller_val, original_enqueue, args, &rval)) {
       return error_stream_controller_with_pending_exception(cx, stream);
     }
-
-    return cancel(engine);
-  }
-
-  [[nodiscard]] bool cancel(api::Engine *engine) override {
-    // TODO(TS): implement
-    handle_ = -1;
     return true;
   }
 
-  void trace(JSTracer *trc) override { TraceEdge(trc, &body_source_, "body source for future"); }
+  // Reads directly into the view of a BYOB reader's pending request, without allocating a chunk.
+  bool read_into_byob_request(api::Engine *engine, HandleObject stream, HandleObject request) {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, streams::NativeStreamSource::owner(body_source_));
+    auto *body = RequestOrResponse::incoming_body_handle(owner);
+
+    RootedValue request_val(cx, ObjectValue(*request));
+    RootedValue view_val(cx);
+    if (!JS::Call(cx, request_val, original_view_getter, JS::HandleValueArray::empty(),
+                  &view_val)) {
+      return error_stream_controller_with_pending_exception(cx, stream);
+    }
+    MOZ_ASSERT(view_val.isObject() && JS_IsUint8Array(&view_val.toObject()));
+    RootedObject view(cx, &view_val.toObject());
+
+    auto read_res = [&] {
+      JS::AutoCheckCannotGC nogc;
+      bool is_shared;
+      auto *data = JS_GetUint8ArrayData(view, &is_shared, nogc);
+      auto len = std::min(JS_GetTypedArrayLength(view), size_t(UINT32_MAX));
+      return body->read_into(data, static_cast<uint32_t>(len));
+    }();
+    if (read_res.is_err()) {
+      return error_stream_with_read_error(cx, owner, stream);
+    }
+
+    auto result = read_res.unwrap();
+    if (!result.done && result.len == 0) {
+      engine->queue_async_task(this);
+      return true;
+    }
+
+    // Once the body is done, the stream has to be closed before the pending read can be
+    // fulfilled with an empty view.
+    if (result.done && !JS::ReadableStreamClose(cx, stream)) {
+      return false;
+    }
+
+    RootedValueArray<1> args(cx);
+    args[0].setNumber(static_cast<double>(result.len));
+    RootedValue rval(cx);
+    if (!JS::Call(cx, request_val, original_respond, args, &rval)) {
+      return error_stream_controller_with_pending_exception(cx, stream);
+    }
+
+    return cancel(engine);
+  }
 };
 
 namespace {
@@ -201,6 +387,8 @@ bool RequestOrResponse::has_body(JSObject *obj) {
 
 host_api::HttpIncomingBody *RequestOrResponse::incoming_body_handle(JSObject *obj) {
   MOZ_ASSERT(is_incoming(obj));
+  // Bodies shared with clones are owned by their BodyTee, and only read through its branches.
+  MOZ_ASSERT(!body_tee_branch(obj));
   auto *handle = RequestOrResponse::handle(obj);
   return handle->is_request() ?
     reinterpret_cast<host_api::HttpIncomingRequest *>(handle)->body().unwrap() :
@@ -220,6 +408,53 @@ JSObject *RequestOrResponse::body_stream(JSObject *obj) {
   return JS::GetReservedSlot(obj, std::to_underlying(Slots::BodyStream)).toObjectOrNull();
 }
 
+BodyTee::Branch *RequestOrResponse::body_tee_branch(JSObject *obj) {
+  MOZ_ASSERT(is_instance(obj));
+  return static_cast<BodyTee::Branch *>(
+      JS::GetReservedSlot(obj, std::to_underlying(Slots::BodyTee)).toPrivate());
+}
+
+bool RequestOrResponse::maybe_tee_body_natively(JSObject *self, JSObject *clone) {
+  MOZ_ASSERT(has_body(self));
+  MOZ_ASSERT(!body_used(self));
+  if (body_stream(self)) {
+    return false;
+  }
+
+  auto *branch = body_tee_branch(self);
+  if (!branch) {
+    if (!is_incoming(self)) {
+      return false;
+    }
+    // The tee takes over the body, so that the handle doesn't keep referring to it once the tee
+    // frees it.
+    auto *handle = RequestOrResponse::handle(self);
+    auto body = handle->is_request()
+                    ? static_cast<host_api::HttpIncomingRequest *>(handle)->take_body()
+                    : static_cast<host_api::HttpIncomingResponse *>(handle)->take_body();
+    if (body.is_err()) {
+      return false;
+    }
+    branch = BodyTee::create(std::move(body.unwrap()));
+    JS::SetReservedSlot(self, std::to_underlying(Slots::BodyTee), JS::PrivateValue(branch));
+  }
+
+  JS::SetReservedSlot(clone, std::to_underlying(Slots::BodyTee), JS::PrivateValue(branch->clone()));
+  JS::SetReservedSlot(clone, std::to_underlying(Slots::HasBody), JS::TrueValue());
+  return true;
+}
+
+void RequestOrResponse::finalize(JS::GCContext *gcx, JSObject *self) {
+  auto slot = JS::GetReservedSlot(self, std::to_underlying(Slots::BodyTee));
+  if (slot.isUndefined()) {
+    return;
+  }
+  auto *branch = static_cast<BodyTee::Branch *>(slot.toPrivate());
+  if (branch) {
+    js_delete(branch);
+  }
+}
+
 JSObject *RequestOrResponse::body_all_promise(JSObject *obj) {
   MOZ_ASSERT(is_instance(obj));
   return JS::GetReservedSlot(obj, std::to_underlying(Slots::BodyAllPromise)).toObjectOrNull();
@@ -344,7 +579,13 @@ bool RequestOrResponse::extract_body(JSContext *cx, JS::HandleObject self,
       return false;
     }
 
-    RootedObject stream(cx, MultipartFormData::encode_stream(cx, encoder));
+    // All entries' sizes are known up front, so the body always gets an exact Content-Length.
+    auto length = MultipartFormData::query_length(cx, encoder);
+    if (length.isErr()) {
+      return false;
+    }
+
+    RootedObject stream(cx, MultipartFormData::encode_stream(cx, encoder, length.unwrap()));
     if (!stream) {
       return false;
     }
@@ -353,11 +594,6 @@ bool RequestOrResponse::extract_body(JSContext *cx, JS::HandleObject self,
     auto type = "multipart/form-data; boundary=" + boundary;
     host_type_str = string_view(type);
 
-    auto length = MultipartFormData::query_length(cx, encoder);
-    if (length.isErr()) {
-      return false;
-    }
-
     content_length = mozilla::Some(length.unwrap());
     content_type = host_type_str;
 
@@ -540,6 +776,30 @@ bool finish_outgoing_body_streaming(JSContext *cx, HandleObject body_owner) {
   return true;
 }
 
+// Stops streaming the outgoing body `body` after reading its source or writing to it failed with
+// the pending exception. The body is dropped without being finished, so the receiver sees that
+// it's incomplete instead of getting a truncated body that looks complete.
+//
+// For requests, the response promise is rejected with the exception. Responses have already been
+// sent at this point, so the exception is reported instead.
+bool abort_outgoing_body_streaming(JSContext *cx, HandleObject body_owner,
+                                   host_api::HttpOutgoingBody *body) {
+  MOZ_ASSERT(JS_IsExceptionPending(cx));
+  body->abort();
+
+  if (body_owner && Request::is_instance(body_owner)) {
+    SetReservedSlot(body_owner, static_cast<uint32_t>(Request::Slots::PendingResponseHandle),
+                    PrivateValue(nullptr));
+    RootedObject response_promise(cx, Request::response_promise(body_owner));
+    return RejectPromiseWithPendingError(cx, response_promise);
+  }
+
+  ENGINE->dump_pending_exception("streaming the response body");
+  fetch_event::FetchEvent::set_state(fetch_event::FetchEvent::instance(),
+                                     fetch_event::FetchEvent::State::responseDone);
+  return true;
+}
+
 bool RequestOrResponse::append_body(JSContext *cx, JS::HandleObject self, JS::HandleObject source,
   api::TaskCompletionCallback callback, HandleObject callback_receiver) {
   MOZ_ASSERT(!body_used(source));
@@ -564,6 +824,512 @@ bool RequestOrResponse::append_body(JSContext *cx, JS::HandleObject self, JS::Ha
   return true;
 }
 
+// Bodies shared between a Request or Response and its clones via a BodyTee are consumed by
+// the tasks below. As long as content doesn't access a branch's body as a ReadableStream,
+// the body is read, buffered, and forwarded entirely natively, without any JS promise turns.
+
+bool body_tee_pull(JSContext *cx, HandleObject source, api::AsyncTask *task);
+
+// Feeds the ReadableStream reified for a branch of a teed body.
+class BodyTeePullTask final : public api::AsyncTask {
+  Heap<JSObject *> source_;
+
+public:
+  explicit BodyTeePullTask(const HandleObject source) : source_(source) {
+    handle_ = IMMEDIATE_TASK_HANDLE;
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    RootedObject source(engine->cx(), source_);
+    return body_tee_pull(engine->cx(), source, this);
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    handle_ = INVALID_POLLABLE_HANDLE;
+    return true;
+  }
+
+  void trace(JSTracer *trc) override { TraceEdge(trc, &source_, "body tee stream source"); }
+};
+
+bool body_tee_pull(JSContext *cx, HandleObject source, api::AsyncTask *task) {
+  RootedObject owner(cx, streams::NativeStreamSource::owner(source));
+  RootedObject stream(cx, streams::NativeStreamSource::stream(source));
+  auto *branch = RequestOrResponse::body_tee_branch(owner);
+
+  // The stream was canceled while this pull was pending.
+  if (!branch->attached()) {
+    return true;
+  }
+
+  host_api::HostBytes bytes;
+  switch (branch->read(&bytes)) {
+  case BodyTee::ReadResult::Chunk:
+    return enqueue_body_chunk(cx, stream, bytes);
+  case BodyTee::ReadResult::Pending:
+    // Pulls issued while a read is pending are satisfied by the waiting task.
+    if (!task && branch->waiting()) {
+      return true;
+    }
+    branch->wait(ENGINE, task ? task : js_new<BodyTeePullTask>(source));
+    return true;
+  case BodyTee::ReadResult::Done:
+    return JS::ReadableStreamClose(cx, stream);
+  case BodyTee::ReadResult::Error:
+    api::throw_error(cx, FetchErrors::IncomingBodyStreamError,
+                     Request::is_instance(owner) ? "request" : "response");
+    return error_stream_controller_with_pending_exception(cx, stream);
+  }
+
+  MOZ_ASSERT_UNREACHABLE("Invalid BodyTee::ReadResult");
+  return false;
+}
+
+bool body_tee_pull_algorithm(JSContext *cx, CallArgs args, HandleObject source,
+                             HandleObject /*body_owner*/, HandleObject /*controller*/) {
+  if (!body_tee_pull(cx, source, nullptr)) {
+    return false;
+  }
+
+  args.rval().setUndefined();
+  return true;
+}
+
+bool body_tee_cancel_algorithm(JSContext *cx, CallArgs args, HandleObject /*source*/,
+                               HandleObject body_owner, HandleValue /*reason*/) {
+  RequestOrResponse::body_tee_branch(body_owner)->cancel();
+  args.rval().setUndefined();
+  return true;
+}
+
+// Reads a branch of a teed body in full, and then hands it to a `bodyAll` parser.
+class BodyTeeConsumeTask final : public api::AsyncTask {
+  Heap<JSObject *> owner_;
+  RequestOrResponse::ParseBodyCB *parse_body_;
+  std::vector<host_api::HostBytes> chunks_;
+  size_t length_ = 0;
+
+public:
+  BodyTeeConsumeTask(const HandleObject owner, RequestOrResponse::ParseBodyCB *parse_body)
+      : owner_(owner), parse_body_(parse_body) {
+    handle_ = IMMEDIATE_TASK_HANDLE;
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, owner_);
+    auto *branch = RequestOrResponse::body_tee_branch(owner);
+
+    while (true) {
+      host_api::HostBytes bytes;
+      switch (branch->read(&bytes)) {
+      case BodyTee::ReadResult::Chunk:
+        length_ += bytes.len;
+        chunks_.push_back(std::move(bytes));
+        continue;
+      case BodyTee::ReadResult::Pending:
+        branch->wait(engine, this);
+        return true;
+      case BodyTee::ReadResult::Done:
+        return finish(cx, owner);
+      case BodyTee::ReadResult::Error: {
+        api::throw_error(cx, FetchErrors::IncomingBodyStreamError,
+                         Request::is_instance(owner) ? "request" : "response");
+        RootedObject result_promise(cx, RequestOrResponse::take_body_all_promise(owner));
+        return RejectPromiseWithPendingError(cx, result_promise);
+      }
+      }
+    }
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    handle_ = INVALID_POLLABLE_HANDLE;
+    return true;
+  }
+
+  void trace(JSTracer *trc) override { TraceEdge(trc, &owner_, "body tee consumer"); }
+
+private:
+  bool finish(JSContext *cx, HandleObject owner) {
+    JS::UniqueChars buf{static_cast<char *>(JS_malloc(cx, length_))};
+    if (!buf && length_ > 0) {
+      RootedObject result_promise(cx, RequestOrResponse::take_body_all_promise(owner));
+      return RejectPromiseWithPendingError(cx, result_promise);
+    }
+
+    size_t offset = 0;
+    for (auto &chunk : chunks_) {
+      memcpy(buf.get() + offset, chunk.ptr.get(), chunk.len);
+      offset += chunk.len;
+    }
+    chunks_.clear();
+
+    return parse_body_(cx, owner, std::move(buf), length_);
+  }
+};
+
+constexpr size_t FORM_DATA_READ_CHUNK_SIZE = 64 * 1024;
+
+// Returns the MIME type of a Request's or Response's `Content-Type` header, or std::nullopt if it
+// doesn't have a valid one.
+std::optional<std::string> content_mime_type(JSContext *cx, HandleObject self) {
+  RootedObject headers(cx, RequestOrResponse::headers(cx, self));
+  if (!headers) {
+    return std::nullopt;
+  }
+
+  auto content_type_str = host_api::HostString("Content-Type");
+  auto idx = Headers::lookup(cx, headers, content_type_str);
+  if (!idx) {
+    return std::nullopt;
+  }
+
+  auto *values = Headers::get_index(cx, headers, idx.value());
+  auto maybe_mime = extract_mime_type(std::get<1>(*values));
+  if (maybe_mime.isErr()) {
+    return std::nullopt;
+  }
+
+  return maybe_mime.unwrap().to_string();
+}
+
+// Reads an incoming multipart/form-data body for `formData()`, handing each chunk to a streaming
+// parser as soon as it arrives, so that the body is never buffered in full.
+class FormDataStreamTask final : public api::AsyncTask {
+  Heap<JSObject *> owner_;
+  Heap<JSObject *> form_data_;
+  std::unique_ptr<form_data::MultipartStreamParser> parser_;
+  host_api::HttpIncomingBody *body_;
+
+public:
+  FormDataStreamTask(const HandleObject owner, const HandleObject form_data,
+                     std::unique_ptr<form_data::MultipartStreamParser> parser)
+      : owner_(owner), form_data_(form_data), parser_(std::move(parser)) {
+    body_ = RequestOrResponse::incoming_body_handle(owner);
+    auto res = body_->subscribe();
+    MOZ_ASSERT(!res.is_err(), "Subscribing to a future should never fail");
+    handle_ = res.unwrap();
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, owner_);
+    RootedObject form_data(cx, form_data_);
+
+    while (true) {
+      auto res = body_->read(FORM_DATA_READ_CHUNK_SIZE);
+      if (res.is_err()) {
+        api::throw_error(cx, FetchErrors::IncomingBodyStreamError,
+                         Request::is_instance(owner) ? "request" : "response");
+        return reject(cx, owner);
+      }
+
+      auto &chunk = res.unwrap();
+      bool empty = chunk.bytes.len == 0;
+      if (!empty) {
+        // Files parsed from the body share the chunks' data instead of copying it.
+        mozilla::UniquePtr<uint8_t[], JS::FreePolicy> data(chunk.bytes.ptr.release());
+        RefPtr<blob::BlobSegment> segment = js_new<blob::BlobSegment>(std::move(data),
+                                                                      chunk.bytes.len);
+        if (!segment) {
+          JS_ReportOutOfMemory(cx);
+          return reject(cx, owner);
+        }
+        if (!parser_->feed(cx, form_data, segment)) {
+          return reject_invalid(cx, owner);
+        }
+      }
+
+      if (chunk.done) {
+        if (!parser_->finish()) {
+          return reject_invalid(cx, owner);
+        }
+        RootedObject result_promise(cx, RequestOrResponse::take_body_all_promise(owner));
+        RootedValue result(cx, ObjectValue(*form_data));
+        return JS::ResolvePromise(cx, result_promise, result);
+      }
+
+      if (empty) {
+        engine->queue_async_task(this);
+        return true;
+      }
+    }
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    handle_ = INVALID_POLLABLE_HANDLE;
+    return true;
+  }
+
+  void trace(JSTracer *trc) override {
+    TraceEdge(trc, &owner_, "form data body owner");
+    TraceEdge(trc, &form_data_, "form data being parsed");
+  }
+
+private:
+  static bool reject(JSContext *cx, HandleObject owner) {
+    RootedObject result_promise(cx, RequestOrResponse::take_body_all_promise(owner));
+    return RejectPromiseWithPendingError(cx, result_promise);
+  }
+
+  // The parser only leaves an exception pending if an allocation failed.
+  static bool reject_invalid(JSContext *cx, HandleObject owner) {
+    if (!JS_IsExceptionPending(cx)) {
+      api::throw_error(cx, FetchErrors::InvalidFormData);
+    }
+    return reject(cx, owner);
+  }
+};
+
+// Writes a branch of a teed body to an outgoing body.
+//
+// Once all other branches are done with the body, the remainder is forwarded using a single
+// host-side append operation instead.
+class BodyTeeStreamTask final : public api::AsyncTask {
+  Heap<JSObject *> owner_;
+  host_api::HttpOutgoingBody *destination_;
+  PollableHandle destination_pollable_;
+  host_api::HostBytes chunk_;
+  size_t offset_ = 0;
+
+public:
+  BodyTeeStreamTask(const HandleObject owner, host_api::HttpOutgoingBody *destination)
+      : owner_(owner), destination_(destination) {
+    destination_pollable_ = destination_->subscribe().unwrap();
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, owner_);
+    auto *branch = RequestOrResponse::body_tee_branch(owner);
+
+    while (true) {
+      if (chunk_.ptr) {
+        auto res = destination_->capacity();
+        if (const auto *err = res.to_err()) {
+          HANDLE_ERROR(cx, *err);
+          return abort_outgoing_body_streaming(cx, owner, destination_);
+        }
+        uint64_t capacity = res.unwrap();
+        if (capacity == 0) {
+          engine->queue_async_task(this);
+          return true;
+        }
+
+        auto bytes_to_write = std::min(chunk_.len - offset_, static_cast<size_t>(capacity));
+        auto write_res = destination_->write(chunk_.ptr.get() + offset_, bytes_to_write);
+        if (const auto *err = write_res.to_err()) {
+          HANDLE_ERROR(cx, *err);
+          return abort_outgoing_body_streaming(cx, owner, destination_);
+        }
+        offset_ += bytes_to_write;
+        if (offset_ < chunk_.len) {
+          continue;
+        }
+        chunk_ = nullptr;
+        offset_ = 0;
+      }
+
+      if (auto *source = branch->take_source()) {
+        auto res = destination_->append(engine, source, finish_outgoing_body_streaming, owner);
+        if (const auto *err = res.to_err()) {
+          HANDLE_ERROR(cx, *err);
+          return false;
+        }
+        return true;
+      }
+
+      switch (branch->read(&chunk_)) {
+      case BodyTee::ReadResult::Chunk:
+        continue;
+      case BodyTee::ReadResult::Pending:
+        branch->wait(engine, this);
+        return true;
+      case BodyTee::ReadResult::Done:
+        return finish_outgoing_body_streaming(cx, owner);
+      case BodyTee::ReadResult::Error:
+        api::throw_error(cx, FetchErrors::IncomingBodyStreamError,
+                         Request::is_instance(owner) ? "request" : "response");
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+    }
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    MOZ_ASSERT_UNREACHABLE("BodyTeeStreamTask's semantics don't allow for cancellation");
+    return true;
+  }
+
+  [[nodiscard]] PollableHandle id() override {
+    return chunk_.ptr ? destination_pollable_ : IMMEDIATE_TASK_HANDLE;
+  }
+
+  void trace(JSTracer *trc) override { TraceEdge(trc, &owner_, "body tee streaming owner"); }
+};
+
+/// Writes a Blob used as an outgoing body to the host straight from the Blob's storage, without
+/// copying it into chunks for the body's ReadableStream.
+class BlobStreamTask final : public api::AsyncTask {
+  Heap<JSObject *> owner_;
+  Heap<JSObject *> blob_;
+  host_api::HttpOutgoingBody *destination_;
+  PollableHandle destination_pollable_;
+  size_t position_ = 0;
+  bool waiting_ = false;
+
+public:
+  BlobStreamTask(const HandleObject owner, const HandleObject blob,
+                 host_api::HttpOutgoingBody *destination)
+      : owner_(owner), blob_(blob), destination_(destination) {
+    destination_pollable_ = destination_->subscribe().unwrap();
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, owner_);
+    const auto *data = Blob::blob(blob_);
+    waiting_ = false;
+
+    while (position_ < data->length()) {
+      auto res = destination_->capacity();
+      if (const auto *err = res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+      uint64_t capacity = res.unwrap();
+      if (capacity == 0) {
+        waiting_ = true;
+        engine->queue_async_task(this);
+        return true;
+      }
+
+      // In-memory segments are written without any intermediate copies. File-backed ones are
+      // read in chunks that fit into the destination's capacity.
+      auto to_write = std::min(data->length() - position_, static_cast<size_t>(capacity));
+      std::optional<host_api::APIError> write_err;
+      bool ok = data->for_each_span(position_, to_write, [&](std::span<const uint8_t> span) {
+        auto write_res = destination_->write(span.data(), span.size());
+        if (const auto *err = write_res.to_err()) {
+          write_err = *err;
+          return false;
+        }
+        position_ += span.size();
+        return true;
+      });
+      if (write_err) {
+        HANDLE_ERROR(cx, *write_err);
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+      if (!ok) {
+        Blob::report_read_error(cx);
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+    }
+
+    return finish_outgoing_body_streaming(cx, owner);
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    MOZ_ASSERT_UNREACHABLE("BlobStreamTask's semantics don't allow for cancellation");
+    return true;
+  }
+
+  [[nodiscard]] PollableHandle id() override {
+    return waiting_ ? destination_pollable_ : IMMEDIATE_TASK_HANDLE;
+  }
+
+  void trace(JSTracer *trc) override {
+    TraceEdge(trc, &owner_, "Blob body streaming owner");
+    TraceEdge(trc, &blob_, "Blob body streaming source");
+  }
+};
+
+/// Writes a FormData used as an outgoing body to the host as it's being encoded, with File
+/// contents written straight from their Blob storage.
+class FormDataEncodeStreamTask final : public api::AsyncTask {
+  Heap<JSObject *> owner_;
+  Heap<JSObject *> encoder_;
+  host_api::HttpOutgoingBody *destination_;
+  PollableHandle destination_pollable_;
+  bool waiting_ = false;
+
+public:
+  FormDataEncodeStreamTask(const HandleObject owner, const HandleObject encoder,
+                           host_api::HttpOutgoingBody *destination)
+      : owner_(owner), encoder_(encoder), destination_(destination) {
+    destination_pollable_ = destination_->subscribe().unwrap();
+  }
+
+  [[nodiscard]] bool run(api::Engine *engine) override {
+    JSContext *cx = engine->cx();
+    RootedObject owner(cx, owner_);
+    RootedObject encoder(cx, encoder_);
+    waiting_ = false;
+
+    bool done = false;
+    while (!done) {
+      auto res = destination_->capacity();
+      if (const auto *err = res.to_err()) {
+        HANDLE_ERROR(cx, *err);
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+      uint64_t capacity = res.unwrap();
+      if (capacity == 0) {
+        waiting_ = true;
+        engine->queue_async_task(this);
+        return true;
+      }
+
+      if (!MultipartFormData::write_to(cx, encoder, destination_, capacity, &done)) {
+        return abort_outgoing_body_streaming(cx, owner, destination_);
+      }
+    }
+
+    return finish_outgoing_body_streaming(cx, owner);
+  }
+
+  [[nodiscard]] bool cancel(api::Engine *engine) override {
+    MOZ_ASSERT_UNREACHABLE("FormDataEncodeStreamTask's semantics don't allow for cancellation");
+    return true;
+  }
+
+  [[nodiscard]] PollableHandle id() override {
+    return waiting_ ? destination_pollable_ : IMMEDIATE_TASK_HANDLE;
+  }
+
+  void trace(JSTracer *trc) override {
+    TraceEdge(trc, &owner_, "FormData body streaming owner");
+    TraceEdge(trc, &encoder_, "FormData body streaming encoder");
+  }
+};
+
+/// Returns the Blob or FormData encoder a body stream was created for, if the stream is still
+/// untouched.
+JSObject *unread_native_body(JSContext *cx, HandleObject stream) {
+  if (!streams::NativeStreamSource::stream_has_native_source(cx, stream)) {
+    return nullptr;
+  }
+
+  RootedObject source(cx, streams::NativeStreamSource::get_stream_source(cx, stream));
+  JSObject *reader = streams::NativeStreamSource::owner(source);
+  if (!streams::BufReader::is_instance(reader)) {
+    return nullptr;
+  }
+
+  JSObject *user = streams::BufReader::user(reader);
+  if (!Blob::is_instance(user) && !MultipartFormData::is_instance(user)) {
+    return nullptr;
+  }
+
+  // The stream can have pulled chunks into its queue without being read from, e.g. to fill it up
+  // to its high water mark. Those chunks have to be sent first, so such bodies go through the
+  // stream.
+  if (streams::BufReader::position(reader) != 0) {
+    return nullptr;
+  }
+  return user;
+}
+
 JSObject *RequestOrResponse::headers(JSContext *cx, JS::HandleObject obj) {
   JSObject *headers = maybe_headers(obj);
   if (headers == nullptr) {
@@ -650,30 +1416,17 @@ bool RequestOrResponse::parse_body(JSContext *cx, JS::HandleObject self, JS::Uni
       return RejectPromiseWithPendingError(cx, result_promise);
     };
 
-    RootedObject headers(cx, RequestOrResponse::headers(cx, self));
-    if (!headers) {
-      return throw_invalid_header();
-    }
-
-    auto content_type_str = host_api::HostString("Content-Type");
-    auto idx = Headers::lookup(cx, headers, content_type_str);
-    if (!idx) {
-      return throw_invalid_header();
-    }
-
-    auto *values = Headers::get_index(cx, headers, idx.value());
-    auto maybe_mime = extract_mime_type(std::get<1>(*values));
-    if (maybe_mime.isErr()) {
+    auto mime_type = content_mime_type(cx, self);
+    if (!mime_type) {
       return throw_invalid_header();
     }
 
-    auto parser = FormDataParser::create(maybe_mime.unwrap().to_string());
+    auto parser = FormDataParser::create(*mime_type);
     if (!parser) {
       return throw_invalid_header();
     }
 
-    std::string_view body(buf.get(), len);
-    RootedObject form_data(cx, parser->parse(cx, body));
+    RootedObject form_data(cx, parser->parse(cx, std::move(buf), len));
     if (!form_data) {
       api::throw_error(cx, FetchErrors::InvalidFormData);
       return RejectPromiseWithPendingError(cx, result_promise);
@@ -973,6 +1726,38 @@ bool RequestOrResponse::bodyAll(JSContext *cx, JS::CallArgs args, JS::HandleObje
     return true;
   }
 
+  // Multipart bodies received from the host are parsed as they arrive, without reifying a
+  // ReadableStream or buffering them in full.
+  if constexpr (result_type == RequestOrResponse::BodyReadResult::FormData) {
+    if (!body_stream(self) && !body_tee_branch(self) && is_incoming(self)) {
+      auto mime_type = content_mime_type(cx, self);
+      if (JS_IsExceptionPending(cx)) {
+        return ReturnPromiseRejectedWithPendingError(cx, args);
+      }
+
+      auto parser = mime_type ? form_data::MultipartStreamParser::create(*mime_type) : nullptr;
+      if (parser) {
+        RootedObject form_data(cx, FormData::create(cx));
+        if (!form_data) {
+          return ReturnPromiseRejectedWithPendingError(cx, args);
+        }
+
+        SetReservedSlot(self, std::to_underlying(Slots::BodyUsed), JS::BooleanValue(true));
+        ENGINE->queue_async_task(js_new<FormDataStreamTask>(self, form_data, std::move(parser)));
+        args.rval().setObject(*bodyAll_promise);
+        return true;
+      }
+    }
+  }
+
+  // Bodies shared with a clone are read natively, without reifying a ReadableStream.
+  if (!body_stream(self) && body_tee_branch(self)) {
+    SetReservedSlot(self, std::to_underlying(Slots::BodyUsed), JS::BooleanValue(true));
+    ENGINE->queue_async_task(js_new<BodyTeeConsumeTask>(self, parse_body<result_type>));
+    args.rval().setObject(*bodyAll_promise);
+    return true;
+  }
+
   JS::RootedValue body_parser(cx, JS::PrivateValue((void *)parse_body<result_type>));
 
   // TODO(performance): don't reify a ReadableStream for body handles—use an AsyncTask instead
@@ -1228,6 +2013,18 @@ bool RequestOrResponse::maybe_stream_body(JSContext *cx, JS::HandleObject body_o
   // a tee branch into this object's `BodyStream`; if we forwarded the raw incoming
   // handle here we would bypass that branch and double-read the single host body
   // (the other tee branch reads the same handle), corrupting both consumers.
+  //
+  // Bodies shared with a clone without being reified are streamed from their
+  // BodyTee branch instead, which still doesn't involve JS streams.
+  if (!body_stream(body_owner) && body_tee_branch(body_owner)) {
+    auto *dest_body = destination->body().unwrap();
+    ENGINE->queue_async_task(js_new<BodyTeeStreamTask>(body_owner, dest_body));
+    MOZ_RELEASE_ASSERT(RequestOrResponse::mark_body_used(cx, body_owner));
+
+    *requires_streaming = true;
+    return true;
+  }
+
   if (is_incoming(body_owner) && !body_stream(body_owner)) {
     auto *source_body = incoming_body_handle(body_owner);
     auto *dest_body = destination->body().unwrap();
@@ -1251,6 +2048,26 @@ bool RequestOrResponse::maybe_stream_body(JSContext *cx, JS::HandleObject body_o
     return api::throw_error(cx, FetchErrors::BodyStreamUnusable);
   }
 
+  // Blob and FormData bodies whose stream hasn't been read from can be written from the Blobs'
+  // storage directly. The stream is locked, so content can't read from it afterwards.
+  JS::RootedObject source(cx, unread_native_body(cx, stream));
+  if (source) {
+    if (!streams::NativeStreamSource::lock_stream(cx, stream)) {
+      return false;
+    }
+
+    auto *dest_body = destination->body().unwrap();
+    if (Blob::is_instance(source)) {
+      ENGINE->queue_async_task(js_new<BlobStreamTask>(body_owner, source, dest_body));
+    } else {
+      ENGINE->queue_async_task(js_new<FormDataEncodeStreamTask>(body_owner, source, dest_body));
+    }
+    MOZ_RELEASE_ASSERT(RequestOrResponse::mark_body_used(cx, body_owner));
+
+    *requires_streaming = true;
+    return true;
+  }
+
   JS::RootedObject reader(
       cx, JS::ReadableStreamGetReader(cx, stream, JS::ReadableStreamReaderMode::Default));
   if (!reader) {
@@ -1296,9 +2113,21 @@ JSObject *RequestOrResponse::create_body_stream(JSContext *cx, JS::HandleObject
   MOZ_ASSERT(!body_stream(owner));
   MOZ_ASSERT(has_body(owner));
 
-  JS::RootedObject source(cx, streams::NativeStreamSource::create(
-                                  cx, owner, JS::UndefinedHandleValue, body_source_pull_algorithm,
-                                  body_source_cancel_algorithm));
+  JS::RootedObject source(cx);
+  if (body_tee_branch(owner)) {
+    source = streams::NativeStreamSource::create(cx, owner, JS::UndefinedHandleValue,
+                                                 body_tee_pull_algorithm,
+                                                 body_tee_cancel_algorithm);
+  } else if (is_incoming(owner)) {
+    // Incoming bodies are exposed as byte streams, so content can read them into its own buffers
+    // using a BYOB reader.
+    source = streams::NativeStreamSource::create_byte_source(cx, owner, body_source_pull_algorithm,
+                                                             body_source_cancel_algorithm);
+  } else {
+    source = streams::NativeStreamSource::create(cx, owner, JS::UndefinedHandleValue,
+                                                 body_source_pull_algorithm,
+                                                 body_source_cancel_algorithm);
+  }
   if (!source) {
     return nullptr;
   }
@@ -1389,7 +2218,9 @@ bool Request::bodyAll(JSContext *cx, unsigned argc, JS::Value *vp) {
 
 bool Request::body_get(JSContext *cx, unsigned argc, JS::Value *vp) {
   METHOD_HEADER(0)
-  return RequestOrResponse::body_get(cx, args, self, RequestOrResponse::is_incoming(self));
+  return RequestOrResponse::body_get(cx, args, self,
+                                     RequestOrResponse::is_incoming(self) ||
+                                         RequestOrResponse::body_tee_branch(self));
 }
 
 bool Request::bodyUsed_get(JSContext *cx, unsigned argc, JS::Value *vp) {
@@ -1484,6 +2315,16 @@ bool Request::clone(JSContext *cx, unsigned argc, JS::Value *vp) {
     return true;
   }
 
+  if (RequestOrResponse::body_used(self)) {
+    return api::throw_error(cx, FetchErrors::BodyStreamUnusable);
+  }
+
+  // If content hasn't accessed the body as a stream yet, share it with the clone natively.
+  if (RequestOrResponse::maybe_tee_body_natively(self, new_request)) {
+    args.rval().setObject(*new_request);
+    return true;
+  }
+
   // Here we get the current request's body stream and call ReadableStream.prototype.tee to
   // get two streams for the same content.
   // One of these is then used to replace the current request's body, the other is used as
@@ -1560,6 +2401,7 @@ void Request::init_slots(JSObject *requestInstance) {
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::Headers), JS::NullValue());
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::BodyStream), JS::NullValue());
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::BodyAllPromise), JS::NullValue());
+  JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::BodyTee), JS::PrivateValue(nullptr));
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::Signal), JS::NullValue());
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::HasBody), JS::FalseValue());
   JS::SetReservedSlot(requestInstance, std::to_underlying(Slots::BodyUsed), JS::FalseValue());
@@ -1567,6 +2409,10 @@ void Request::init_slots(JSObject *requestInstance) {
                       JS::StringValue(GET_atom));
 }
 
+void Request::finalize(JS::GCContext *gcx, JSObject *self) {
+  RequestOrResponse::finalize(gcx, self);
+}
+
 /**
  * Create a new Request object, roughly according to
  * https://fetch.spec.whatwg.org/#dom-request
@@ -1656,27 +2502,13 @@ bool Request::initialize(JSContext *cx, JS::HandleObject request, JS::HandleValu
   // 5.  If `input` is a string, then:
   else {
     // 1.  Let `parsedURL` be the result of parsing `input` with `baseURL`.
-    JS::RootedObject url_instance(
-        cx, JS_NewObjectWithGivenProto(cx, &url::URL::class_, url::URL::proto_obj));
-    if (!url_instance) {
-      return false;
-    }
-
-    JS::RootedObject parsedURL(
-        cx, url::URL::create(cx, url_instance, input, worker_location::WorkerLocation::url));
-
     // 2.  If `parsedURL` is failure, then throw a `TypeError`.
-    if (!parsedURL) {
-      return false;
-    }
-
     // 3.  If `parsedURL` includes credentials, then throw a `TypeError`.
     // (N/A)
-
     // 4.  Set `request` to a new request whose URL is `parsedURL`.
-    // Instead, we store `url_str` to apply below.
-    JS::RootedValue url_val(cx, JS::ObjectValue(*parsedURL));
-    url_str = JS::ToString(cx, url_val);
+    // Instead, we store the serialized `parsedURL` in `url_str` to apply below. Parsed URLs are
+    // cached, so this doesn't have to create a URL object, or parse the same URLs repeatedly.
+    url_str = url::URL::parse_and_serialize(cx, input, worker_location::WorkerLocation::url);
     if (!url_str) {
       return false;
     }
@@ -1972,7 +2804,19 @@ bool Request::initialize(JSContext *cx, JS::HandleObject request, JS::HandleValu
       return false;
     }
 
-    if (!inputBody) {
+    auto *input_tee_branch = RequestOrResponse::body_tee_branch(input_request);
+    if (!inputBody && input_tee_branch) {
+      // The input body is shared with a clone, so it can't be appended on the host side.
+      // Since content can't have accessed it either, we just transfer the input request's
+      // branch over to the new request.
+      JS::SetReservedSlot(input_request, std::to_underlying(Slots::BodyTee),
+                          JS::PrivateValue(nullptr));
+      JS::SetReservedSlot(request, std::to_underlying(Slots::BodyTee),
+                          JS::PrivateValue(input_tee_branch));
+      if (!RequestOrResponse::mark_body_used(cx, input_request)) {
+        return false;
+      }
+    } else if (!inputBody) {
       // If `inputBody` is null, that means that it was never created, and hence
       // content can't have access to it. Instead of reifying it here to pass it
       // into a TransformStream, we just append the body on the host side and
@@ -2704,6 +3548,14 @@ bool Response::clone(JSContext *cx, unsigned argc, JS::Value *vp) {
     return true;
   }
 
+  // If content hasn't accessed the body as a stream yet, share it with the clone natively:
+  // both responses read from a single buffered copy of the body, and neither needs a
+  // ReadableStream unless content asks for one.
+  if (RequestOrResponse::maybe_tee_body_natively(self, new_response)) {
+    args.rval().setObject(*new_response);
+    return true;
+  }
+
   JS::RootedObject body_stream(cx, RequestOrResponse::body_stream(self));
   if (!body_stream) {
     body_stream = RequestOrResponse::create_body_stream(cx, self);
@@ -2803,10 +3655,8 @@ bool Response::redirect(JSContext *cx, unsigned argc, Value *vp) {
     return false;
   }
 
-  auto deleter = [&](auto *url) { jsurl::free_jsurl(url); };
-  std::unique_ptr<jsurl::JSUrl, decltype(deleter)> parsedURL(
-      new_jsurl_with_base(&url_str, url::URL::url(worker_location::WorkerLocation::url)), deleter);
-
+  const auto *parsedURL =
+      url::URLCache::parse(url_str, url::URL::url(worker_location::WorkerLocation::url));
   if (!parsedURL) {
     return api::throw_error(cx, api::Errors::TypeError, "Response.redirect", "url",
                             "be a valid URL");
@@ -3180,6 +4030,7 @@ JSObject *Response::init_slots(HandleObject response) {
   JS::SetReservedSlot(response, std::to_underlying(Slots::Headers), JS::NullValue());
   JS::SetReservedSlot(response, std::to_underlying(Slots::BodyStream), JS::NullValue());
   JS::SetReservedSlot(response, std::to_underlying(Slots::BodyAllPromise), JS::NullValue());
+  JS::SetReservedSlot(response, std::to_underlying(Slots::BodyTee), JS::PrivateValue(nullptr));
   JS::SetReservedSlot(response, std::to_underlying(Slots::HasBody), JS::FalseValue());
   JS::SetReservedSlot(response, std::to_underlying(Slots::BodyUsed), JS::FalseValue());
   JS::SetReservedSlot(response, std::to_underlying(Slots::Redirected), JS::FalseValue());
@@ -3211,6 +4062,10 @@ JSObject *Response::create_incoming(JSContext *cx, host_api::HttpIncomingRespons
   return self;
 }
 
+void Response::finalize(JS::GCContext *gcx, JSObject *self) {
+  RequestOrResponse::finalize(gcx, self);
+}
+
 struct ResponseAborter : abort::AbortAlgorithm {
   Heap<JSObject *> promise;
   Heap<JSObject *> response;
@@ -3314,6 +4169,9 @@ bool install(api::Engine *engine) {
   if (!Response::init_class(engine->cx(), engine->global())) {
     return false;
   }
+  if (!init_byte_stream_methods(engine->cx(), engine->global())) {
+    return false;
+  }
   return true;
 }
 
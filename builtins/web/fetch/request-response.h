@@ -1,6 +1,7 @@
 #ifndef BUILTINS_WEB_FETCH_REQUEST_RESPONSE
 #define BUILTINS_WEB_FETCH_REQUEST_RESPONSE
 
+#include "body-tee.h"
 #include "fetch-errors.h"
 #include "headers.h"
 #include "host_api.h"
@@ -26,6 +27,7 @@ public:
     BodyUsed,
     Headers,
     URL,
+    BodyTee,
     Count,
   };
 
@@ -46,6 +48,22 @@ public:
   static JS::Value url(JSObject *obj);
   static void set_url(JSObject *obj, JS::Value url);
   static bool body_unusable(JSContext *cx, JS::HandleObject body);
+
+  /**
+   * Returns the branch of a natively teed body this Request or Response reads its
+   * body from, or nullptr if its body isn't shared with a clone.
+   */
+  static BodyTee::Branch *body_tee_branch(JSObject *obj);
+
+  /**
+   * Shares the body of `self` with `clone` without reifying either of them as a
+   * ReadableStream, if the body is an incoming body that content hasn't accessed yet.
+   *
+   * Returns false if that isn't possible, in which case the body has to be teed
+   * using JS streams instead.
+   */
+  static bool maybe_tee_body_natively(JSObject *self, JSObject *clone);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
   static bool extract_body(JSContext *cx, JS::HandleObject self, JS::HandleValue body_val);
 
   /**
@@ -117,7 +135,7 @@ public:
                        bool create_if_undefined);
 };
 
-class Request final : public BuiltinImpl<Request> {
+class Request final : public BuiltinImpl<Request, FinalizableClassPolicy> {
   static bool method_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool headers_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool url_get(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -142,11 +160,12 @@ public:
     BodyUsed = static_cast<int>(RequestOrResponse::Slots::BodyUsed),
     Headers = static_cast<int>(RequestOrResponse::Slots::Headers),
     URL = static_cast<int>(RequestOrResponse::Slots::URL),
+    BodyTee = static_cast<int>(RequestOrResponse::Slots::BodyTee),
     Method = static_cast<int>(RequestOrResponse::Slots::Count),
-    ResponsePromise = 8,
-    PendingResponseHandle = 9,
-    Signal = 10,
-    Count = 11,
+    ResponsePromise,
+    PendingResponseHandle,
+    Signal,
+    Count,
   };
 
   static JSObject *response_promise(JSObject *obj);
@@ -168,9 +187,10 @@ public:
                          JS::HandleValue init_val, Headers::HeadersGuard guard);
 
   static void init_slots(JSObject *requestInstance);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
 };
 
-class Response final : public BuiltinImpl<Response> {
+class Response final : public BuiltinImpl<Response, FinalizableClassPolicy> {
   static bool waitUntil(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool ok_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool status_get(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -199,12 +219,13 @@ public:
     HasBody = static_cast<int>(RequestOrResponse::Slots::HasBody),
     BodyUsed = static_cast<int>(RequestOrResponse::Slots::BodyUsed),
     Headers = static_cast<int>(RequestOrResponse::Slots::Headers),
+    BodyTee = static_cast<int>(RequestOrResponse::Slots::BodyTee),
     Status = static_cast<int>(RequestOrResponse::Slots::Count),
-    StatusMessage = 8,
-    Redirected = 9,
-    Type = 10,
-    Aborted = 11,
-    Count = 12,
+    StatusMessage,
+    Redirected,
+    Type,
+    Aborted,
+    Count,
   };
 
   enum class Type : uint8_t { Basic, Cors, Default, Error, Opaque, OpaqueRedirect };
@@ -226,6 +247,7 @@ public:
 
   static JSObject *init_slots(HandleObject response);
   static JSObject *create_incoming(JSContext *cx, host_api::HttpIncomingResponse *response);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
 
   static host_api::HttpResponse *maybe_response_handle(JSObject *obj);
   static Type type(JSObject *obj);
@@ -132,6 +132,20 @@ JSObject* File::create(JSContext *cx, HandleValue fileBits, HandleValue fileName
   return self;
 }
 
+JSObject *File::create(JSContext *cx, js::UniquePtr<blob::BlobData> data, HandleString name,
+                       HandleString type) {
+  JSObject *self = JS_NewObjectWithGivenProto(cx, &class_, proto_obj);
+  if (!self) {
+    return nullptr;
+  }
+
+  Blob::init_slots(self, std::move(data), type);
+  SetReservedSlot(self, std::to_underlying(Slots::Name), JS::StringValue(name));
+  SetReservedSlot(self, std::to_underlying(Slots::LastModified),
+                  JS::NumberValue(static_cast<double>(JS_Now() / 1000LL)));
+  return self;
+}
+
 bool File::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
   CTOR_HEADER("File", 2);
 
@@ -152,6 +166,8 @@ bool File::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
   return true;
 }
 
+void File::finalize(JS::GCContext *gcx, JSObject *self) { Blob::finalize(gcx, self); }
+
 bool File::init_class(JSContext *cx, JS::HandleObject global) {
   Blob::register_subclass(&class_);
   return init_class_impl(cx, global, Blob::proto_obj);
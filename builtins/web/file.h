@@ -7,7 +7,7 @@
 
 
 namespace builtins::web::file {
-class File : public BuiltinImpl<File> {
+class File : public BuiltinImpl<File, FinalizableClassPolicy> {
   static bool name_get(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool lastModified_get(JSContext *cx, unsigned argc, JS::Value *vp);
 
@@ -26,9 +26,13 @@ public:
   static JSString *name(JSObject *self);
 
   static JSObject *create(JSContext *cx, HandleValue fileBits, HandleValue fileName, HandleValue opts);
+  /// Creates a File taking ownership of `data`, last modified at the current time.
+  static JSObject *create(JSContext *cx, js::UniquePtr<blob::BlobData> data, HandleString name,
+                          HandleString type);
   static bool init(JSContext *cx, HandleObject self, HandleValue fileBits, HandleValue fileName, HandleValue opts);
   static bool init_class(JSContext *cx, HandleObject global);
   static bool constructor(JSContext *cx, unsigned argc, Value *vp);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
 };
 
 bool install(api::Engine *engine);
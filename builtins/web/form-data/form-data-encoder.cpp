@@ -12,6 +12,8 @@
 #include "mozilla/Assertions.h"
 #include "mozilla/ResultVariant.h"
 
+#include <algorithm>
+#include <array>
 #include <fmt/format.h>
 #include <string>
 
@@ -173,18 +175,45 @@ using streams::NativeStreamSource;
 
 using EntryList = JS::GCVector<FormDataEntry, 0, js::SystemAllocPolicy>;
 
+// The maximum size of the chunks enqueued by the encoded body's stream.
+constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+// Writes the encoded data gathered in `pending` to `dest`, reporting an error if that fails.
+bool write_pending(JSContext *cx, host_api::HttpOutgoingBody *dest, std::string &pending) {
+  if (pending.empty()) {
+    return true;
+  }
+
+  auto res = dest->write(reinterpret_cast<const uint8_t *>(pending.data()), pending.size());
+  pending.clear();
+  if (const auto *err = res.to_err()) {
+    HANDLE_ERROR(cx, *err);
+    return false;
+  }
+  return true;
+}
+
 struct StreamContext {
   StreamContext(const EntryList *entries, std::span<uint8_t> outbuf)
-      : entries(entries), outbuf(outbuf) {}
+      : entries(entries), outbuf(outbuf), limit(outbuf.size()) {}
+  StreamContext(const EntryList *entries, host_api::HttpOutgoingBody *dest, std::string *pending,
+                size_t limit)
+      : entries(entries), dest(dest), pending(pending), limit(limit) {}
   const EntryList *entries;
 
+  // Encoded data is either copied into `outbuf`, or written to `dest`. For the latter, everything
+  // but File contents is gathered in `pending` first, so that the headers, values and delimiters
+  // between Files go out in a single write.
   std::span<uint8_t> outbuf;
+  host_api::HttpOutgoingBody *dest{nullptr};
+  std::string *pending{nullptr};
+  size_t limit;
   size_t read{0};
   bool done{false};
 
   [[nodiscard]] size_t remaining() const {
-    MOZ_ASSERT(outbuf.size() >= read);
-    return outbuf.size() - read;
+    MOZ_ASSERT(limit >= read);
+    return limit - read;
   }
 
  // Writes as many elements from the range [first, last) into the underlying buffer as possible.
@@ -203,14 +232,63 @@ struct StreamContext {
     }
 
     size_t to_write = std::min(data_size, buf_size);
-    auto dest = outbuf.begin() + read;
-
-    std::copy_n(first, to_write, dest);
+    if (dest) {
+      pending->append(std::to_address(first), to_write);
+    } else {
+      std::copy_n(first, to_write, outbuf.begin() + read);
+    }
     read += to_write;
     return to_write;
   }
 };
 
+// Writes as much of `blob`'s data, starting at `offset`, into the stream as possible, and stores
+// the number of bytes written in `written`. Fails if the Blob's backing file couldn't be read.
+bool write_blob(JSContext *cx, StreamContext &stream, const blob::BlobData *blob, size_t offset,
+                size_t *written) {
+  *written = 0;
+  if (!stream.dest) {
+    if (!blob->read(offset, stream.outbuf.subspan(stream.read), written)) {
+      return Blob::report_read_error(cx);
+    }
+
+    stream.read += *written;
+    return true;
+  }
+
+  if (offset >= blob->length()) {
+    return true;
+  }
+
+  // Everything encoded before the File's contents has to go out first.
+  if (!write_pending(cx, stream.dest, *stream.pending)) {
+    return false;
+  }
+
+  // In-memory segments are written to the destination without any intermediate copies.
+  auto to_write = std::min(stream.remaining(), blob->length() - offset);
+  std::optional<host_api::APIError> write_err;
+  bool ok = blob->for_each_span(offset, to_write, [&](std::span<const uint8_t> span) {
+    auto res = stream.dest->write(span.data(), span.size());
+    if (const auto *err = res.to_err()) {
+      write_err = *err;
+      return false;
+    }
+    *written += span.size();
+    return true;
+  });
+  stream.read += *written;
+  if (write_err) {
+    HANDLE_ERROR(cx, *write_err);
+    return false;
+  }
+  if (!ok) {
+    return Blob::report_read_error(cx);
+  }
+
+  return true;
+}
+
 // `MultipartFormDataImpl` encodes `FormData` into a multipart/form-data body,
 // following the specification in https://datatracker.ietf.org/doc/html/rfc7578.
 //
@@ -244,7 +322,7 @@ class MultipartFormDataImpl {
   template <typename I> void write_and_store_remainder(StreamContext &stream, I first, I last);
 
   State next_state(StreamContext &stream);
-  void maybe_drain_leftovers(JSContext *cx, StreamContext &stream);
+  bool maybe_drain_leftovers(JSContext *cx, StreamContext &stream);
   bool handle_entry_header(JSContext *cx, StreamContext &stream);
   bool handle_entry_body(JSContext *cx, StreamContext &stream);
   bool handle_entry_footer(JSContext *cx, StreamContext &stream);
@@ -291,7 +369,7 @@ MultipartFormDataImpl::State MultipartFormDataImpl::next_state(StreamContext &st
 // - Entry value leftovers: Tracked by `file_leftovers_`, this represents the number of
 //   bytes from a blob that still need to be written to the output buffer to complete
 //   the entry's value.
-void MultipartFormDataImpl::maybe_drain_leftovers(JSContext *cx, StreamContext &stream) {
+bool MultipartFormDataImpl::maybe_drain_leftovers(JSContext *cx, StreamContext &stream) {
   if (!remainder_view_.empty()) {
     auto written = stream.write(remainder_view_.begin(), remainder_view_.end());
     remainder_view_.remove_prefix(written);
@@ -310,8 +388,14 @@ void MultipartFormDataImpl::maybe_drain_leftovers(JSContext *cx, StreamContext &
     RootedObject obj(cx, &entry.value.toObject());
     auto *blob = Blob::blob(obj);
     auto offset = blob->length() - file_leftovers_;
-    file_leftovers_ -= stream.write(blob->begin() + offset, blob->end());
+    size_t written = 0;
+    if (!write_blob(cx, stream, blob, offset, &written)) {
+      return false;
+    }
+    file_leftovers_ -= written;
   }
+
+  return true;
 }
 
 // Writes data from the range [first, last) to the stream. If the stream cannot
@@ -419,7 +503,10 @@ bool MultipartFormDataImpl::handle_entry_body(JSContext *cx, StreamContext &stre
 
     auto *blob = Blob::blob(obj);
     auto to_write = blob->length();
-    auto written = stream.write(blob->begin(), blob->end());
+    size_t written = 0;
+    if (!write_blob(cx, stream, blob, 0, &written)) {
+      return false;
+    }
     MOZ_ASSERT(written <= to_write);
     file_leftovers_ = to_write - written;
   }
@@ -454,7 +541,9 @@ bool MultipartFormDataImpl::handle_close(JSContext *cx, StreamContext &stream) {
 }
 
 bool MultipartFormDataImpl::read_next(JSContext *cx, StreamContext &stream) {
-  maybe_drain_leftovers(cx, stream);
+  if (!maybe_drain_leftovers(cx, stream)) {
+    return false;
+  }
   if (is_draining()) {
     return true;
   }
@@ -607,6 +696,37 @@ bool MultipartFormData::read(JSContext *cx, HandleObject self, std::span<uint8_t
   return true;
 }
 
+bool MultipartFormData::write_to(JSContext *cx, HandleObject self, host_api::HttpOutgoingBody *dest,
+                                 size_t max, bool *done) {
+  MOZ_ASSERT(is_instance(self));
+
+  size_t total = 0;
+  bool finished = false;
+  RootedObject obj(cx, form_data(self));
+
+  auto *entries = FormData::entry_list(obj);
+  auto *impl = as_impl(self);
+
+  std::string pending;
+  while (total < max && !finished) {
+    auto stream = StreamContext(entries, dest, &pending, max - total);
+
+    if (!impl->read_next(cx, stream)) {
+      return false;
+    }
+
+    total += stream.read;
+    finished = stream.done;
+  }
+
+  if (!write_pending(cx, dest, pending)) {
+    return false;
+  }
+
+  *done = finished;
+  return true;
+}
+
 std::string MultipartFormData::boundary(JSObject *self) {
   MOZ_ASSERT(is_instance(self));
   auto *impl = as_impl(self);
@@ -635,8 +755,11 @@ mozilla::Result<size_t, OutOfMemory> MultipartFormData::query_length(JSContext *
   return impl->query_length(cx, entries);
 }
 
-JSObject *MultipartFormData::encode_stream(JSContext *cx, HandleObject self) {
-  RootedObject reader(cx, BufReader::create(cx, self, read));
+JSObject *MultipartFormData::encode_stream(JSContext *cx, HandleObject self, size_t length) {
+  // Like Blobs, encoded bodies have a known size, so they can be read in large chunks without
+  // over-allocating for small ones.
+  auto chunk_size = std::clamp(length, size_t(1), STREAM_CHUNK_SIZE);
+  RootedObject reader(cx, BufReader::create(cx, self, read, chunk_size));
   if (!reader) {
     return nullptr;
   }
@@ -657,8 +780,8 @@ JSObject *MultipartFormData::create(JSContext *cx, HandleObject form_data) {
     return nullptr;
   }
 
-  auto res = host_api::Random::get_bytes(12);
-  if (res.to_err()) {
+  std::array<uint8_t, 12> bytes{};
+  if (host_api::Random::fill(bytes).to_err()) {
     return nullptr;
   }
 
@@ -673,8 +796,7 @@ JSObject *MultipartFormData::create(JSContext *cx, HandleObject form_data) {
   // This implementation: --BoundaryjXo5N4HEAXWcKrw7
   // WebKit: ----WebKitFormBoundaryhpShnP1JqrBTVTnC
   // Gecko:  ----geckoformboundary8c79e61efa53dc5d441481912ad86113
-  auto bytes = std::move(res.unwrap());
-  auto bytes_str = std::string_view((char *)(bytes.ptr.get()), bytes.size());
+  auto bytes_str = std::string_view((char *)(bytes.data()), bytes.size());
   auto base64_str = base64::forgivingBase64Encode(bytes_str, base64::base64EncodeTable);
 
   auto boundary = fmt::format("--StarlingMonkeyFormBoundary{}", base64_str);
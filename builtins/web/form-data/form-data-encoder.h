@@ -2,6 +2,7 @@
 #define BUILTINS_WEB_FORM_DATA_ENCODER_
 
 #include "builtin.h"
+#include "host_api.h"
 
 
 
@@ -31,7 +32,18 @@ public:
   static std::string boundary(JSObject *self);
 
   static mozilla::Result<size_t, OutOfMemory> query_length(JSContext *cx, HandleObject self);
-  static JSObject *encode_stream(JSContext *cx, HandleObject self);
+
+  /// Returns a ReadableStream of the encoded body. `length` is the body's length as returned by
+  /// `query_length`, and only used to size the stream's chunks.
+  static JSObject *encode_stream(JSContext *cx, HandleObject self, size_t length);
+
+  /// Writes up to `max` bytes of the encoded body to `dest`, and sets `done` once all of it has
+  /// been written. Unlike reading from the body's stream, this writes File contents straight from
+  /// their Blob storage, without copying them into chunks first. Everything else is gathered and
+  /// written in as few writes as possible. Fails with an exception pending if reading a File or
+  /// writing to `dest` failed.
+  static bool write_to(JSContext *cx, HandleObject self, host_api::HttpOutgoingBody *dest,
+                       size_t max, bool *done);
   static JSObject *create(JSContext *cx, HandleObject form_data);
 
   static bool init_class(JSContext *cx, HandleObject global);
@@ -10,39 +10,10 @@
 
 namespace {
 
-JSString *to_owned_string(JSContext *cx, jsmultipart::Slice src) {
-  const auto *chars = reinterpret_cast<const char *>(src.data);
-
-  std::string_view sv(chars, src.len);
-  return core::decode(cx, sv);
-}
-
-JSObject *to_owned_buffer(JSContext *cx, jsmultipart::Slice src) {
-  auto buf = mozilla::MakeUnique<uint8_t[]>(src.len);
-  if (!buf) {
-    JS_ReportOutOfMemory(cx);
-    return nullptr;
-  }
-
-  std::copy_n(src.data, src.len, buf.get());
-
-  JS::RootedObject buffer(cx, JS::NewArrayBufferWithContents(
-      cx, src.len, buf.get(), JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
-  if (!buffer) {
-    JS_ReportOutOfMemory(cx);
-    return nullptr;
-  }
-
-  // `array_buffer` now owns `buf`
-  std::ignore = (buf.release());
-
-  JS::RootedObject byte_array(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, src.len));
-  if (!byte_array) {
-    JS_ReportOutOfMemory(cx);
-    return nullptr;
-  }
-
-  return byte_array;
+const jsencoding::Encoding *utf8_encoding() {
+  const char *utf8_label = "UTF-8";
+  return jsencoding::encoding_for_label_no_replacement(
+      reinterpret_cast<const uint8_t *>(utf8_label), 5);
 }
 
 } // namespace
@@ -51,178 +22,267 @@ JSObject *to_owned_buffer(JSContext *cx, jsmultipart::Slice src) {
 
 namespace builtins::web::form_data {
 
+using blob::Blob;
+using blob::BlobData;
+using blob::BlobSegment;
 using file::File;
 using form_data::FormData;
 using jsmultipart::RetCode;
+using jsmultipart::StreamEvent;
 
-class MultipartParser : public FormDataParser {
-  std::string boundary_;
+MultipartStreamParser::~MultipartStreamParser() {
+  jsmultipart::multipart_stream_free(state_);
+  if (decoder_) {
+    jsencoding::decoder_free(decoder_);
+  }
+}
 
-public:
-  MultipartParser(std::string_view boundary) : boundary_(boundary) {}
+std::unique_ptr<MultipartStreamParser>
+MultipartStreamParser::create(std::string_view content_type) {
+  if (!content_type.starts_with("multipart/form-data")) {
+    return nullptr;
+  }
 
-  JSObject *parse(JSContext *cx, std::string_view body) override;
-};
+  jsmultipart::Slice content_slice{.data=(uint8_t *)(content_type.data()), .len=content_type.size()};
+  jsmultipart::Slice boundary_slice{.data=nullptr, .len=0};
 
-JSObject *MultipartParser::parse(JSContext *cx, std::string_view body) {
-  RootedObject formdata(cx, FormData::create(cx));
-  if (!formdata) {
+  jsmultipart::boundary_from_content_type(&content_slice, &boundary_slice);
+  if (boundary_slice.data == nullptr) {
     return nullptr;
   }
 
-  if (body.empty()) {
-    return formdata;
+  auto *state = jsmultipart::multipart_stream_new(&boundary_slice);
+  if (!state) {
+    return nullptr;
   }
 
-  auto done = false;
-  const auto *data = reinterpret_cast<const uint8_t *>(body.data());
+  return std::make_unique<MultipartStreamParser>(state);
+}
 
-  jsmultipart::Slice input{.data=data, .len=body.size()};
+bool MultipartStreamParser::feed(JSContext *cx, HandleObject form_data, BlobSegment *chunk) {
+  auto bytes = chunk->span();
+  jsmultipart::Slice input{.data=bytes.data(), .len=bytes.size()};
   jsmultipart::Entry entry{};
 
-  const char* utf8_label = "UTF-8";
-  const auto *encoding = jsencoding::encoding_for_label_no_replacement(
-      reinterpret_cast<const uint8_t *>(utf8_label), 5);
+  while (true) {
+    switch (jsmultipart::multipart_stream_next(state_, &input, &entry)) {
+    case StreamEvent::NeedMore:
+    case StreamEvent::End:
+      return true;
+    case StreamEvent::Error:
+      return false;
+    case StreamEvent::Part:
+      if (!start_part(cx, entry)) {
+        return false;
+      }
+      break;
+    case StreamEvent::Data:
+      if (!append_to_part(cx, chunk, {entry.value.data, entry.value.len})) {
+        return false;
+      }
+      break;
+    case StreamEvent::PartEnd:
+      if (!finish_part(cx, form_data)) {
+        return false;
+      }
+      break;
+    }
+  }
+}
+
+bool MultipartStreamParser::finish() {
+  return jsmultipart::multipart_stream_finish(state_) == RetCode::Eos;
+}
 
-  auto deleter1 = [&](auto *state) { jsmultipart::multipart_parser_free(state); };
-  std::unique_ptr<jsmultipart::State, decltype(deleter1)> parser(
-      jsmultipart::multipart_parser_new(&input, boundary_.c_str()), deleter1);
+bool MultipartStreamParser::start_part(JSContext *cx, const jsmultipart::Entry &entry) {
+  MOZ_ASSERT(entry.name.data != nullptr);
+  name_.assign(reinterpret_cast<const char *>(entry.name.data), entry.name.len);
+
+  /// https://fetch.spec.whatwg.org/#body-mixin
+  if (entry.filename.data == nullptr) {
+    // Each part whose `Content-Disposition` header does not contain a `filename`
+    // parameter must be parsed into an entry whose value is the UTF-8 decoded without
+    // BOM content of the part.
+    MOZ_ASSERT(!decoder_);
+    decoder_ = jsencoding::encoding_new_decoder_with_bom_removal(utf8_encoding());
+    if (!decoder_) {
+      JS_ReportOutOfMemory(cx);
+      return false;
+    }
+    return true;
+  }
 
-  if (!parser) {
+  // Each part whose `Content-Disposition` header contains a `filename` parameter
+  // must be parsed into an entry whose value is a File object whose contents are
+  // the contents of the part. The name attribute of the File object must have the
+  // value of the `filename` parameter of the part. The type attribute of the File
+  // object must have the value of the `Content-Type` header of the part if the part
+  // has such header, and `text/plain` otherwise.
+  filename_.assign(reinterpret_cast<const char *>(entry.filename.data), entry.filename.len);
+  if (entry.content_type.data && (entry.content_type.len != 0U)) {
+    content_type_.assign(reinterpret_cast<const char *>(entry.content_type.data),
+                         entry.content_type.len);
+  } else {
+    content_type_ = "text/plain";
+  }
+
+  file_.reset(BlobData::create());
+  if (!file_) {
     JS_ReportOutOfMemory(cx);
-    return nullptr;
+    return false;
   }
+  return true;
+}
 
-  auto deleter2 = [&](auto *dec) { jsencoding::decoder_free(dec); };
-  std::unique_ptr<jsencoding::Decoder, decltype(deleter2)> decoder(
-      jsencoding::encoding_new_decoder_with_bom_removal(encoding), deleter2);
+bool MultipartStreamParser::append_to_part(JSContext *cx, BlobSegment *chunk,
+                                           std::span<const uint8_t> bytes) {
+  bool ok = true;
+  if (!file_) {
+    ok = decode_text(bytes, false);
+  } else if (auto data = chunk->span();
+             bytes.data() >= data.data() && bytes.data() < data.data() + data.size()) {
+    // The content points into the chunk itself, so the File can share the chunk's data.
+    ok = file_->append_segment(chunk, bytes.data() - data.data(), bytes.size());
+  } else {
+    // The content was carried over from a previous chunk by the parser, and has to be copied.
+    ok = file_->append_bytes(bytes);
+  }
 
-  if (!decoder) {
+  if (!ok) {
     JS_ReportOutOfMemory(cx);
-    return nullptr;
   }
+  return ok;
+}
 
-  while (!done) {
-    auto ret = jsmultipart::multipart_parser_next(parser.get(), &entry);
+bool MultipartStreamParser::decode_text(std::span<const uint8_t> bytes, bool last) {
+  MOZ_ASSERT(decoder_);
+  size_t written = text_.length();
+  size_t max_len = jsencoding::decoder_max_utf16_buffer_length(decoder_, bytes.size());
+  if (!text_.growByUninitialized(max_len)) {
+    return false;
+  }
 
-    switch (ret) {
-    case RetCode::Error: {
-      return nullptr;
-    }
-    case RetCode::Eos: {
-      done = true;
-      break;
+  // The decoder carries sequences split across chunks over to the next call.
+  bool had_replacements = false;
+  size_t src_len = bytes.size();
+  size_t dst_len = max_len;
+  auto *dst = reinterpret_cast<uint16_t *>(text_.begin() + written);
+  jsencoding::decoder_decode_to_utf16(decoder_, bytes.data(), &src_len, dst, &dst_len, last,
+                                      &had_replacements);
+  MOZ_ASSERT(src_len == bytes.size());
+  text_.shrinkTo(written + dst_len);
+  return true;
+}
+
+bool MultipartStreamParser::finish_part(JSContext *cx, HandleObject form_data) {
+  RootedValue value_val(cx);
+
+  if (!file_) {
+    bool ok = decode_text({}, true);
+    jsencoding::decoder_free(decoder_);
+    decoder_ = nullptr;
+    if (!ok) {
+      JS_ReportOutOfMemory(cx);
+      return false;
     }
-    case RetCode::Ok: {
-      MOZ_ASSERT(entry.name.data != nullptr);
-      MOZ_ASSERT(entry.value.data != nullptr);
-
-      std::string_view name((char *)entry.name.data, entry.name.len);
-
-      /// https://fetch.spec.whatwg.org/#body-mixin
-      if (entry.filename.data == nullptr) {
-        // Each part whose `Content-Disposition` header does not contain a `filename`
-        // parameter must be parsed into an entry whose value is the UTF-8 decoded without
-        // BOM content of the part.
-        auto src_size = entry.value.len;
-        auto dst_size = jsencoding::decoder_max_utf16_buffer_length(decoder.get(), src_size);
-
-        JS::UniqueTwoByteChars data(new char16_t[dst_size + 1]);
-        if (!data) {
-          JS_ReportOutOfMemory(cx);
-          return nullptr;
-        }
-
-        bool ignore = false;
-        auto *dst = reinterpret_cast<uint16_t *>(data.get());
-        const auto *src = entry.value.data;
-
-        jsencoding::decoder_decode_to_utf16(decoder.get(), src, &src_size, dst, &dst_size, false, &ignore);
-
-        JS::RootedString value(cx, JS_NewUCString(cx, std::move(data), dst_size));
-        if (!value) {
-          return nullptr;
-        }
-
-        RootedValue value_val(cx, JS::StringValue(value));
-        auto res = FormData::append(cx, formdata, name, value_val, UndefinedHandleValue);
-        if (!res) {
-          return nullptr;
-        }
-      } else {
-        // Each part whose `Content-Disposition` header contains a `filename` parameter
-        // must be parsed into an entry whose value is a File object whose contents are
-        // the contents of the part. The name attribute of the File object must have the
-        // value of the `filename` parameter of the part. The type attribute of the File
-        // object must have the value of the `Content-Type` header of the part if the part
-        // has such header, and `text/plain` otherwise.
-        RootedObject filebits(cx, to_owned_buffer(cx, entry.value));
-        if (!filebits) {
-          return nullptr;
-        }
-
-        RootedString filename(cx, to_owned_string(cx, entry.filename));
-        if (!filename) {
-          return nullptr;
-        }
-
-        RootedValue content_type_val(cx);
-        if (entry.content_type.data && (entry.content_type.len != 0U)) {
-          RootedString content_type(cx, to_owned_string(cx, entry.content_type));
-          if (!content_type) {
-            return nullptr;
-          }
-
-          content_type_val = JS::StringValue(content_type);
-        } else {
-          RootedString content_type(cx, JS_NewStringCopyN(cx, "text/plain", 10));
-          if (!content_type) {
-            return nullptr;
-          }
-
-          content_type_val = JS::StringValue(content_type);
-        }
-
-        RootedObject opts(cx, JS_NewPlainObject(cx));
-        if (!opts) {
-          return nullptr;
-        }
-
-        if (!JS_DefineProperty(cx, opts, "type", content_type_val, JSPROP_ENUMERATE)) {
-          return nullptr;
-        }
-
-        RootedValue filebits_val(cx, JS::ObjectValue(*filebits));
-        RootedValue filename_val(cx, JS::StringValue(filename));
-        RootedValue opts_val(cx, JS::ObjectValue(*opts));
-
-        RootedObject file(cx, File::create(cx, filebits_val, filename_val, opts_val));
-        if (!file) {
-          return nullptr;
-        }
-
-        RootedValue value_val(cx, JS::ObjectValue(*file));
-        auto res = FormData::append(cx, formdata, name, value_val, UndefinedHandleValue);
-        if (!res) {
-          return nullptr;
-        }
+
+    size_t len = text_.length();
+    JSString *value = nullptr;
+    if (len == 0) {
+      value = JS_GetEmptyString(cx);
+    } else {
+      JS::UniqueTwoByteChars chars(text_.extractOrCopyRawBuffer());
+      if (!chars) {
+        JS_ReportOutOfMemory(cx);
+        return false;
       }
+      value = JS_NewUCString(cx, std::move(chars), len);
+    }
+    text_.clear();
+    if (!value) {
+      return false;
+    }
 
-      break;
+    value_val.setString(value);
+  } else {
+    if (!file_->finish()) {
+      JS_ReportOutOfMemory(cx);
+      return false;
+    }
+
+    RootedString filename(cx, core::decode(cx, filename_));
+    if (!filename) {
+      return false;
     }
+
+    RootedValue content_type_val(cx);
+    RootedString content_type(cx, JS_NewStringCopyN(cx, content_type_.data(), content_type_.size()));
+    if (!content_type) {
+      return false;
+    }
+    content_type_val.setString(content_type);
+    content_type = Blob::normalize_type(cx, content_type_val);
+    if (!content_type) {
+      return false;
+    }
+
+    RootedObject file(cx, File::create(cx, std::move(file_), filename, content_type));
+    if (!file) {
+      return false;
     }
+
+    value_val.setObject(*file);
   }
 
   // Return a new FormData object, appending each entry, resulting from the parsing
   // operation, to its entry list.
+  return FormData::append(cx, form_data, name_, value_val, UndefinedHandleValue);
+}
+
+class MultipartParser : public FormDataParser {
+  std::unique_ptr<MultipartStreamParser> parser_;
+
+public:
+  explicit MultipartParser(std::unique_ptr<MultipartStreamParser> parser)
+      : parser_(std::move(parser)) {}
+
+  JSObject *parse(JSContext *cx, JS::UniqueChars body, size_t len) override;
+};
+
+JSObject *MultipartParser::parse(JSContext *cx, JS::UniqueChars body, size_t len) {
+  RootedObject formdata(cx, FormData::create(cx));
+  if (!formdata) {
+    return nullptr;
+  }
+
+  // The whole body is available, so it's handed to the streaming parser as a single chunk. As
+  // the parser doesn't have to carry anything over to a later chunk, nothing is copied: all
+  // Files share the body's buffer, which is freed once the last of them is.
+  if (len != 0) {
+    mozilla::UniquePtr<uint8_t[], JS::FreePolicy> bytes(reinterpret_cast<uint8_t *>(body.release()));
+    RefPtr<BlobSegment> chunk = js_new<BlobSegment>(std::move(bytes), len);
+    if (!chunk) {
+      JS_ReportOutOfMemory(cx);
+      return nullptr;
+    }
+    if (!parser_->feed(cx, formdata, chunk)) {
+      return nullptr;
+    }
+  }
+
+  if (!parser_->finish()) {
+    return nullptr;
+  }
+
   return formdata;
 }
 
 class UrlParser : public FormDataParser {
-  JSObject *parse(JSContext *cx, std::string_view body) override;
+  JSObject *parse(JSContext *cx, JS::UniqueChars body_buf, size_t len) override;
 };
 
-JSObject *UrlParser::parse(JSContext *cx, std::string_view body) {
+JSObject *UrlParser::parse(JSContext *cx, JS::UniqueChars body_buf, size_t len) {
+  std::string_view body(body_buf.get(), len);
   RootedObject formdata(cx, FormData::create(cx));
   if (!formdata) {
     return nullptr;
@@ -275,16 +335,12 @@ JSObject *UrlParser::parse(JSContext *cx, std::string_view body) {
 
 std::unique_ptr<FormDataParser> FormDataParser::create(std::string_view content_type) {
   if (content_type.starts_with("multipart/form-data")) {
-    jsmultipart::Slice content_slice{.data=(uint8_t *)(content_type.data()), .len=content_type.size()};
-    jsmultipart::Slice boundary_slice{.data=nullptr, .len=0};
-
-    jsmultipart::boundary_from_content_type(&content_slice, &boundary_slice);
-    if (boundary_slice.data == nullptr) {
+    auto parser = MultipartStreamParser::create(content_type);
+    if (!parser) {
       return nullptr;
     }
 
-    std::string_view boundary((char *)boundary_slice.data, boundary_slice.len);
-    return std::make_unique<MultipartParser>(boundary);
+    return std::make_unique<MultipartParser>(std::move(parser));
   }
 
   if (content_type.starts_with("application/x-www-form-urlencoded")) {
@@ -299,5 +355,3 @@ std::unique_ptr<FormDataParser> FormDataParser::create(std::string_view content_
 }
 
 } // namespace builtins::web::form_data
-
-
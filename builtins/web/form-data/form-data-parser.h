@@ -3,12 +3,23 @@
 
 #include "builtin.h"
 #include "form-data.h"
+#include "../blob.h"
+
+namespace jsencoding {
+struct Decoder;
+} // namespace jsencoding
+
+namespace jsmultipart {
+struct Entry;
+struct StreamState;
+} // namespace jsmultipart
 
 namespace builtins::web::form_data {
 
 class FormDataParser {
 public:
-  virtual JSObject *parse(JSContext *cx, std::string_view body) = 0;
+  /// Parses `body`, taking ownership of it, as entries may keep referring to its data.
+  virtual JSObject *parse(JSContext *cx, JS::UniqueChars body, size_t len) = 0;
 
   FormDataParser() = default;
   virtual ~FormDataParser() = default;
@@ -22,6 +33,53 @@ public:
   static std::unique_ptr<FormDataParser> create(std::string_view content_type);
 };
 
+/// Parses a multipart/form-data body incrementally, as its chunks become available.
+///
+/// Each entry is appended to the FormData as soon as its part is complete. Only input that can't
+/// be attributed yet, i.e. an incomplete header block or a potential boundary at the end of a
+/// chunk, is buffered by the parser. The contents of file parts are collected into Blob data
+/// segment by segment, and those of other parts are decoded as they arrive, so the body never
+/// has to be held in memory in full.
+///
+/// Input is fed as Blob segments, so that the contents of file parts can be shared with the
+/// resulting Files instead of being copied: only content the parser had to carry over from one
+/// chunk to the next is copied. Note that a File keeps all chunks its contents span alive.
+class MultipartStreamParser final {
+  jsmultipart::StreamState *state_;
+  jsencoding::Decoder *decoder_ = nullptr;
+
+  // The part currently being parsed.
+  std::string name_;
+  std::string filename_;
+  std::string content_type_;
+  js::UniquePtr<blob::BlobData> file_;
+  js::Vector<char16_t, 0, js::SystemAllocPolicy> text_;
+
+  bool start_part(JSContext *cx, const jsmultipart::Entry &entry);
+  bool append_to_part(JSContext *cx, blob::BlobSegment *chunk, std::span<const uint8_t> bytes);
+  bool decode_text(std::span<const uint8_t> bytes, bool last);
+  bool finish_part(JSContext *cx, HandleObject form_data);
+
+public:
+  explicit MultipartStreamParser(jsmultipart::StreamState *state) : state_(state) {}
+  ~MultipartStreamParser();
+
+  MultipartStreamParser(const MultipartStreamParser &) = delete;
+  MultipartStreamParser &operator=(const MultipartStreamParser &) = delete;
+
+  /// Returns a parser if `content_type` is multipart/form-data with a valid boundary.
+  static std::unique_ptr<MultipartStreamParser> create(std::string_view content_type);
+
+  /// Parses the in-memory segment `chunk`, appending all entries it completes to `form_data`.
+  ///
+  /// Returns false if the body is malformed, or with an exception pending if an allocation
+  /// failed.
+  bool feed(JSContext *cx, HandleObject form_data, blob::BlobSegment *chunk);
+
+  /// Signals the end of the body. Returns false if it ended in the middle of a part.
+  bool finish();
+};
+
 } // namespace builtins::web::form_data
 
 #endif // BUILTINS_WEB_FORM_DATA_PARSER_
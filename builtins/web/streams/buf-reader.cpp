@@ -5,14 +5,6 @@
 #include "js/Stream.h"
 #include "mozilla/Assertions.h"
 
-namespace {
-
-constexpr size_t CHUNK_SIZE = 8192;
-
-} // namespace
-
-
-
 namespace builtins::web::streams {
 
 class StreamTask final : public api::AsyncTask {
@@ -33,26 +25,23 @@ public:
     size_t read_size = 0;
     bool done = false;
 
-    RootedObject buffer(cx, JS::NewArrayBuffer(cx, CHUNK_SIZE));
-    if (!buffer) {
-      return false;
-    }
-
-    RootedValue buffer_val(cx, JS::ObjectValue(*buffer));
-    auto span = value_to_buffer(cx, buffer_val, "BufReader: buffer");
-    if (!span) {
+    // Read into uninitialized memory that's then handed to the chunk's ArrayBuffer, instead of
+    // zero-filling a new ArrayBuffer first.
+    auto chunk_size = BufReader::chunk_size(reader_);
+    mozilla::UniquePtr<uint8_t[], JS::FreePolicy> bytes(js_pod_malloc<uint8_t>(chunk_size));
+    if (!bytes) {
+      JS_ReportOutOfMemory(cx);
       return false;
     }
 
     auto read = BufReader::read_fn(reader_);
     auto start = BufReader::position(reader_);
-    auto buf = span.value();
 
-    if (!read(cx, user, buf, start, &read_size, &done)) {
+    if (!read(cx, user, {bytes.get(), chunk_size}, start, &read_size, &done)) {
       return false;
     }
 
-    MOZ_ASSERT(read_size <= buf.size());
+    MOZ_ASSERT(read_size <= chunk_size);
 
     if (done) {
       if (!JS::ReadableStreamClose(cx, stream)) {
@@ -62,6 +51,25 @@ public:
       return cancel(engine);
     }
 
+    // Don't keep a partially filled chunk's unused capacity alive.
+    if (read_size > 0 && read_size < chunk_size) {
+      auto *shrunk = static_cast<uint8_t *>(js_realloc(bytes.get(), read_size));
+      if (shrunk) {
+        std::ignore = bytes.release();
+        bytes.reset(shrunk);
+      }
+    }
+
+    RootedObject buffer(cx, JS::NewArrayBufferWithContents(
+                                cx, read_size, bytes.get(),
+                                JS::NewArrayBufferOutOfMemory::CallerMustFreeMemory));
+    if (!buffer) {
+      return false;
+    }
+
+    // `buffer` now owns `bytes`
+    std::ignore = bytes.release();
+
     RootedObject bytes_buffer(cx, JS_NewUint8ArrayWithBuffer(cx, buffer, 0, read_size));
     if (!bytes_buffer) {
       return false;
@@ -127,7 +135,13 @@ void BufReader::set_position(JSObject *self, size_t pos) {
   JS::SetReservedSlot(self, std::to_underlying(Slots::Position), JS::PrivateValue(reinterpret_cast<void *>(pos)));
 }
 
-JSObject *BufReader::create(JSContext *cx, JS::HandleObject user, BufReader::ReadFn *read) {
+size_t BufReader::chunk_size(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  return static_cast<size_t>(JS::GetReservedSlot(self, std::to_underlying(Slots::ChunkSize)).toNumber());
+}
+
+JSObject *BufReader::create(JSContext *cx, JS::HandleObject user, BufReader::ReadFn *read,
+                            size_t chunk_size) {
   JS::RootedObject self(cx, JS_NewObjectWithGivenProto(cx, &class_, proto_obj));
   if (!self) {
     return nullptr;
@@ -143,6 +157,7 @@ JSObject *BufReader::create(JSContext *cx, JS::HandleObject user, BufReader::Rea
   JS::SetReservedSlot(self, std::to_underlying(Slots::Stream), JS::ObjectValue(*stream));
   JS::SetReservedSlot(self, std::to_underlying(Slots::Read), JS::PrivateValue(reinterpret_cast<void *>(read)));
   JS::SetReservedSlot(self, std::to_underlying(Slots::Position), JS::PrivateValue(reinterpret_cast<void *>(0)));
+  JS::SetReservedSlot(self, std::to_underlying(Slots::ChunkSize), JS::NumberValue(static_cast<double>(chunk_size)));
 
   return self;
 }
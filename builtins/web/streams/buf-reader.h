@@ -16,7 +16,9 @@ public:
 
   static constexpr const char *class_name = "NativeBufReader";
 
-  enum class Slots : uint8_t { User, Stream, Read, Position, Count };
+  enum class Slots : uint8_t { User, Stream, Read, Position, ChunkSize, Count };
+
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 8192;
 
   using Buffer = std::span<uint8_t>;
 
@@ -33,8 +35,11 @@ public:
   static ReadFn *read_fn(JSObject *self);
   static size_t position(JSObject *self);
   static void set_position(JSObject *self, size_t pos);
+  static size_t chunk_size(JSObject *self);
 
-  static JSObject *create(JSContext *cx, HandleObject user, ReadFn *read);
+  // Creates a reader whose stream enqueues chunks of up to `chunk_size` bytes.
+  static JSObject *create(JSContext *cx, HandleObject user, ReadFn *read,
+                          size_t chunk_size = DEFAULT_CHUNK_SIZE);
 };
 
 } // namespace builtins::web::streams
@@ -0,0 +1,594 @@
+#include "js/experimental/TypedData.h" // used within "js/Stream.h"
+#include "js/Stream.h"
+
+#include "native-pipe.h"
+#include "native-stream-source.h"
+#include "transform-stream-default-controller.h"
+#include "transform-stream.h"
+
+#include "../abort/abort-signal.h"
+
+// All algorithm names and steps refer to spec algorithms defined at
+// https://streams.spec.whatwg.org/#readable-stream-pipe-to
+
+namespace builtins::web::streams {
+
+using abort::AbortAlgorithm;
+using abort::AbortSignal;
+
+namespace {
+
+// The destination is only ever locked through a writer created with the
+// original methods, so that the pipe can't be observed by patching globals.
+JS::PersistentRooted<JS::Value> original_getWriter;
+JS::PersistentRooted<JS::Value> writer_close;
+JS::PersistentRooted<JS::Value> writer_abort;
+JS::PersistentRooted<JS::Value> writer_releaseLock;
+
+JSObject *reader(JSObject *self) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Reader)).toObject();
+}
+
+JSObject *writer(JSObject *self) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Writer)).toObject();
+}
+
+JSObject *transform(JSObject *self) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Transform)).toObject();
+}
+
+JSObject *promise(JSObject *self) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  return &JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Promise)).toObject();
+}
+
+bool has_flag(JSObject *self, int32_t flag) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  return (JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Flags)).toInt32() & flag) != 0;
+}
+
+void set_flag(JSObject *self, int32_t flag, bool value = true) {
+  MOZ_ASSERT(NativePipe::is_instance(self));
+  int32_t flags = JS::GetReservedSlot(self, std::to_underlying(NativePipe::Slots::Flags)).toInt32();
+  flags = value ? flags | flag : flags & ~flag;
+  JS::SetReservedSlot(self, std::to_underlying(NativePipe::Slots::Flags), JS::Int32Value(flags));
+}
+
+bool call_writer_method(JSContext *cx, JS::HandleObject self, JS::HandleValue method,
+                        JS::HandleValueArray args, JS::MutableHandleValue rval) {
+  JS::RootedValue thisv(cx, JS::ObjectValue(*writer(self)));
+  return JS::Call(cx, thisv, method, args, rval);
+}
+
+/**
+ * Finalize, with the optional error.
+ */
+bool finalize(JSContext *cx, JS::HandleObject self, JS::HandleValue error, bool errored) {
+  MOZ_ASSERT(has_flag(self, NativePipe::ShuttingDown));
+  MOZ_ASSERT(!has_flag(self, NativePipe::Finalized));
+  set_flag(self, NativePipe::Finalized);
+
+  // 1.  Perform ! WritableStreamDefaultWriterRelease(writer).
+  JS::RootedValue rval(cx);
+  if (!call_writer_method(cx, self, writer_releaseLock, JS::HandleValueArray::empty(), &rval)) {
+    return false;
+  }
+
+  // 2.  Perform ! ReadableStreamDefaultReaderRelease(reader).
+  // If a read is still in flight, the reader is released once it completes
+  // instead, see `read_then_handler` and `read_catch_handler`.
+  if (!has_flag(self, NativePipe::ReadPending)) {
+    JS::RootedObject reader_obj(cx, reader(self));
+    if (!JS::ReadableStreamReaderReleaseLock(cx, reader_obj)) {
+      return false;
+    }
+  }
+
+  // 3.  If signal is not undefined, remove abortAlgorithm from signal.
+  // AbortSignal doesn't support removing algorithms, so instead the algorithm
+  // checks whether the pipe has already been shut down.
+
+  // 4.  If error was given, reject promise with error.
+  // 5.  Otherwise, resolve promise with undefined.
+  JS::RootedObject promise_obj(cx, promise(self));
+  if (errored) {
+    return JS::RejectPromise(cx, promise_obj, error);
+  }
+  return JS::ResolvePromise(cx, promise_obj, JS::UndefinedHandleValue);
+}
+
+bool close_then_handler(JSContext *cx, JS::HandleObject self, JS::HandleValue extra,
+                        JS::CallArgs args) {
+  args.rval().setUndefined();
+  return finalize(cx, self, JS::UndefinedHandleValue, false);
+}
+
+bool abort_then_handler(JSContext *cx, JS::HandleObject self, JS::HandleValue extra,
+                        JS::CallArgs args) {
+  args.rval().setUndefined();
+  return finalize(cx, self, extra, true);
+}
+
+bool action_catch_handler(JSContext *cx, JS::HandleObject self, JS::HandleValue extra,
+                          JS::CallArgs args) {
+  args.rval().setUndefined();
+  return finalize(cx, self, args.get(0), true);
+}
+
+/**
+ * Shutdown with an action, for all cases in which the pipe is shut down
+ * because of an error: `abort_dest` and `cancel_source` determine which of the
+ * actions to perform.
+ *
+ * Writes are performed synchronously, so there are never any pending writes
+ * to wait for before performing the actions.
+ */
+bool shutdown_with_error(JSContext *cx, JS::HandleObject self, JS::HandleValue error,
+                         bool abort_dest, bool cancel_source) {
+  MOZ_ASSERT(!has_flag(self, NativePipe::ShuttingDown));
+  set_flag(self, NativePipe::ShuttingDown);
+
+  if (cancel_source) {
+    JS::RootedObject reader_obj(cx, reader(self));
+    if (!JS::ReadableStreamReaderCancel(cx, reader_obj, error)) {
+      return false;
+    }
+  }
+
+  JS::RootedObject writable(cx, TransformStream::writable(transform(self)));
+  if (abort_dest && JS::WritableStreamGetState(cx, writable) == JS::WritableStreamState::Writable) {
+    JS::RootedValueArray<1> abortArgs(cx);
+    abortArgs[0].set(error);
+    JS::RootedValue rval(cx);
+    if (!call_writer_method(cx, self, writer_abort, abortArgs, &rval)) {
+      return false;
+    }
+
+    JS::RootedObject abort_promise(cx, &rval.toObject());
+    JS::RootedObject then_handler(cx, create_internal_method<abort_then_handler>(cx, self, error));
+    if (!then_handler) {
+      return false;
+    }
+    JS::RootedObject catch_handler(cx, create_internal_method<action_catch_handler>(cx, self));
+    if (!catch_handler) {
+      return false;
+    }
+    return JS::AddPromiseReactions(cx, abort_promise, then_handler, catch_handler);
+  }
+
+  return finalize(cx, self, error, true);
+}
+
+/**
+ * Closing must be propagated forward: the source has been closed.
+ */
+bool close_dest(JSContext *cx, JS::HandleObject self) {
+  MOZ_ASSERT(!has_flag(self, NativePipe::ShuttingDown));
+  set_flag(self, NativePipe::ShuttingDown);
+
+  if (has_flag(self, NativePipe::PreventClose)) {
+    return finalize(cx, self, JS::UndefinedHandleValue, false);
+  }
+
+  JS::RootedValue rval(cx);
+  if (!call_writer_method(cx, self, writer_close, JS::HandleValueArray::empty(), &rval)) {
+    return false;
+  }
+
+  JS::RootedObject close_promise(cx, &rval.toObject());
+  JS::RootedObject then_handler(cx, create_internal_method<close_then_handler>(cx, self));
+  if (!then_handler) {
+    return false;
+  }
+  JS::RootedObject catch_handler(cx, create_internal_method<action_catch_handler>(cx, self));
+  if (!catch_handler) {
+    return false;
+  }
+  return JS::AddPromiseReactions(cx, close_promise, then_handler, catch_handler);
+}
+
+/**
+ * Hands a chunk read from the source to the destination's transform, or
+ * closes the destination if the source is done.
+ */
+bool handle_read_result(JSContext *cx, JS::HandleObject self, JS::HandleValue result) {
+  // We're guaranteed to work with a native ReadableStreamDefaultReader here,
+  // which in turn is guaranteed to vend {done: bool, value: any} objects.
+  JS::RootedObject result_obj(cx, &result.toObject());
+  JS::RootedValue done_val(cx);
+  if (!JS_GetProperty(cx, result_obj, "done", &done_val)) {
+    return false;
+  }
+
+  if (done_val.toBoolean()) {
+    return close_dest(cx, self);
+  }
+
+  JS::RootedValue chunk(cx);
+  if (!JS_GetProperty(cx, result_obj, "value", &chunk)) {
+    return false;
+  }
+
+  JS::RootedObject controller(cx, TransformStream::controller(transform(self)));
+  if (TransformStreamDefaultController::PerformTransformSync(cx, controller, chunk)) {
+    return true;
+  }
+
+  // Errors must be propagated backward: the transform failed, which errored
+  // the destination.
+  JS::RootedValue error(cx);
+  if (!JS_GetPendingException(cx, &error)) {
+    return false;
+  }
+  JS_ClearPendingException(cx);
+  return shutdown_with_error(cx, self, error, false, !has_flag(self, NativePipe::PreventCancel));
+}
+
+bool pump(JSContext *cx, JS::HandleObject self);
+
+bool backpressure_change_then_handler(JSContext *cx, JS::HandleObject self,
+                                      JS::HandleValue extra, JS::CallArgs args) {
+  args.rval().setUndefined();
+  if (has_flag(self, NativePipe::ShuttingDown)) {
+    return true;
+  }
+  return pump(cx, self);
+}
+
+/**
+ * Releases the source's reader if the pipe was finalized while a read was in
+ * flight. Returns true if the read's result should be ignored.
+ */
+bool read_completed(JSContext *cx, JS::HandleObject self, bool *ignore) {
+  set_flag(self, NativePipe::ReadPending, false);
+  *ignore = has_flag(self, NativePipe::ShuttingDown);
+  if (!has_flag(self, NativePipe::Finalized)) {
+    return true;
+  }
+
+  JS::RootedObject reader_obj(cx, reader(self));
+  return JS::ReadableStreamReaderReleaseLock(cx, reader_obj);
+}
+
+bool read_then_handler(JSContext *cx, JS::HandleObject self, JS::HandleValue extra,
+                       JS::CallArgs args) {
+  args.rval().setUndefined();
+  bool ignore = false;
+  if (!read_completed(cx, self, &ignore)) {
+    return false;
+  }
+  if (ignore) {
+    return true;
+  }
+
+  if (!handle_read_result(cx, self, args.get(0))) {
+    return false;
+  }
+
+  return pump(cx, self);
+}
+
+bool read_catch_handler(JSContext *cx, JS::HandleObject self, JS::HandleValue extra,
+                        JS::CallArgs args) {
+  args.rval().setUndefined();
+  bool ignore = false;
+  if (!read_completed(cx, self, &ignore)) {
+    return false;
+  }
+  if (ignore) {
+    return true;
+  }
+
+  // Errors must be propagated forward: the source has been errored.
+  return shutdown_with_error(cx, self, args.get(0), !has_flag(self, NativePipe::PreventAbort),
+                             false);
+}
+
+/**
+ * The pipe loop: transfers chunks from the source to the destination until
+ * either end is closed or errored, or the destination applies backpressure.
+ */
+bool pump(JSContext *cx, JS::HandleObject self) {
+  JS::RootedObject ts(cx, transform(self));
+  JS::RootedObject writable(cx, TransformStream::writable(ts));
+  JS::RootedObject reader_obj(cx, reader(self));
+  JS::RootedObject read_promise(cx);
+  JS::RootedValue result(cx);
+
+  while (!has_flag(self, NativePipe::ShuttingDown)) {
+    // Errors must be propagated backward: the destination has been errored,
+    // e.g. because its readable end was canceled.
+    auto state = JS::WritableStreamGetState(cx, writable);
+    if (state != JS::WritableStreamState::Writable) {
+      MOZ_ASSERT(state == JS::WritableStreamState::Erroring ||
+                 state == JS::WritableStreamState::Errored);
+      JS::RootedValue error(cx, JS::WritableStreamGetStoredError(cx, writable));
+      return shutdown_with_error(cx, self, error, false,
+                                 !has_flag(self, NativePipe::PreventCancel));
+    }
+
+    // Only read from the source once the destination's readable end wants
+    // more data, so that chunks don't pile up in its queue.
+    if (TransformStream::backpressure(ts)) {
+      JS::RootedObject change_promise(cx, TransformStream::backpressureChangePromise(ts));
+      JS::RootedObject then_handler(cx);
+      then_handler = create_internal_method<backpressure_change_then_handler>(cx, self);
+      if (!then_handler) {
+        return false;
+      }
+      return JS::AddPromiseReactionsIgnoringUnhandledRejection(cx, change_promise, then_handler,
+                                                               nullptr);
+    }
+
+    read_promise = JS::ReadableStreamDefaultReaderRead(cx, reader_obj);
+    if (!read_promise) {
+      return false;
+    }
+
+    // If the source already had a chunk queued, the read is fulfilled
+    // immediately, and its result can be used without waiting for a reaction.
+    if (JS::GetPromiseState(read_promise) != JS::PromiseState::Fulfilled) {
+      set_flag(self, NativePipe::ReadPending);
+      JS::RootedObject then_handler(cx, create_internal_method<read_then_handler>(cx, self));
+      if (!then_handler) {
+        return false;
+      }
+      JS::RootedObject catch_handler(cx, create_internal_method<read_catch_handler>(cx, self));
+      if (!catch_handler) {
+        return false;
+      }
+      return JS::AddPromiseReactions(cx, read_promise, then_handler, catch_handler);
+    }
+
+    result = JS::GetPromiseResult(read_promise);
+    if (!handle_read_result(cx, self, result)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * The abort algorithm for pipes with a signal.
+ */
+bool abort_pipe(JSContext *cx, JS::HandleObject self, JS::HandleValue error) {
+  if (has_flag(self, NativePipe::ShuttingDown)) {
+    return true;
+  }
+
+  return shutdown_with_error(cx, self, error, !has_flag(self, NativePipe::PreventAbort),
+                             !has_flag(self, NativePipe::PreventCancel));
+}
+
+struct NativePipeAborter : AbortAlgorithm {
+  JS::Heap<JSObject *> pipe;
+  JS::Heap<JSObject *> signal;
+
+  NativePipeAborter(JS::HandleObject pipe, JS::HandleObject signal) : pipe(pipe), signal(signal) {}
+
+  bool run(JSContext *cx) override {
+    JS::RootedObject pipe_obj(cx, pipe);
+    JS::RootedValue error(cx, AbortSignal::reason(signal));
+    return abort_pipe(cx, pipe_obj, error);
+  }
+
+  void trace(JSTracer *trc) override {
+    JS::TraceEdge(trc, &pipe, "NativePipeAborter pipe");
+    JS::TraceEdge(trc, &signal, "NativePipeAborter signal");
+  }
+};
+
+bool init_writer_methods(JSContext *cx, JS::HandleObject writer) {
+  if (!writer_close.isUndefined()) {
+    return true;
+  }
+
+  JS::RootedObject proto(cx);
+  if (!JS_GetPrototype(cx, writer, &proto)) {
+    return false;
+  }
+
+  return JS_GetProperty(cx, proto, "close", &writer_close) &&
+         JS_GetProperty(cx, proto, "abort", &writer_abort) &&
+         JS_GetProperty(cx, proto, "releaseLock", &writer_releaseLock);
+}
+
+bool get_option(JSContext *cx, JS::HandleObject options, const char *name, bool *value) {
+  JS::RootedValue val(cx);
+  if (!JS_GetProperty(cx, options, name, &val)) {
+    return false;
+  }
+  *value = JS::ToBoolean(val);
+  return true;
+}
+
+// Returns a new object holding the already converted members of a `StreamPipeOptions` dictionary,
+// which can be converted again without running any content code.
+JSObject *converted_options(JSContext *cx, bool prevent_abort, bool prevent_cancel,
+                            bool prevent_close, JS::HandleValue signal) {
+  JS::RootedObject options(cx, JS_NewPlainObject(cx));
+  if (!options ||
+      !JS_DefineProperty(cx, options, "preventAbort", prevent_abort ? JS::TrueHandleValue
+                                                                    : JS::FalseHandleValue,
+                         JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, options, "preventCancel", prevent_cancel ? JS::TrueHandleValue
+                                                                      : JS::FalseHandleValue,
+                         JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, options, "preventClose", prevent_close ? JS::TrueHandleValue
+                                                                    : JS::FalseHandleValue,
+                         JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, options, "signal", signal, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+  return options;
+}
+
+} // namespace
+
+bool NativePipe::can_pipe(JSContext *cx, JS::HandleObject source, JS::HandleObject dest) {
+  if (!JS::IsReadableStream(source) || !JS::IsWritableStream(dest)) {
+    return false;
+  }
+
+  if (!NativeStreamSource::stream_has_native_source(cx, source) ||
+      !TransformStream::is_ts_writable(cx, dest)) {
+    return false;
+  }
+
+  // Let the builtin implementation report errors for locked or already
+  // closed or errored streams.
+  bool locked = false;
+  if (!JS::ReadableStreamIsLocked(cx, source, &locked) || locked) {
+    return false;
+  }
+  if (JS::WritableStreamIsLocked(cx, dest) ||
+      JS::WritableStreamGetState(cx, dest) != JS::WritableStreamState::Writable) {
+    return false;
+  }
+
+  // The transform mustn't run user code, since the order in which chunks are
+  // read and written differs from the spec'd pipe loop in observable ways.
+  JSObject *ts = TransformStream::ts_from_writable(cx, dest);
+  if (TransformStream::used_as_mixin(ts)) {
+    return true;
+  }
+  auto has_transformer =
+      JS::GetReservedSlot(ts, std::to_underlying(TransformStream::Slots::HasTransformer));
+  return !has_transformer.isBoolean() || !has_transformer.toBoolean();
+}
+
+/**
+ * ReadableStreamPipeTo, for streams for which `can_pipe` returns true.
+ */
+bool NativePipe::pipe_to(JSContext *cx, JS::HandleObject source, JS::HandleObject dest,
+                         JS::MutableHandleValue options, JS::MutableHandleValue rval) {
+  bool prevent_abort = false;
+  bool prevent_cancel = false;
+  bool prevent_close = false;
+  JS::RootedValue signal_val(cx);
+  JS::RootedObject signal(cx);
+
+  if (!options.isUndefined()) {
+    if (!options.isObject()) {
+      return true;
+    }
+
+    // Dictionary members are converted in lexicographical order.
+    JS::RootedObject options_obj(cx, &options.toObject());
+    if (!get_option(cx, options_obj, "preventAbort", &prevent_abort) ||
+        !get_option(cx, options_obj, "preventCancel", &prevent_cancel) ||
+        !get_option(cx, options_obj, "preventClose", &prevent_close) ||
+        !JS_GetProperty(cx, options_obj, "signal", &signal_val)) {
+      return false;
+    }
+
+    // The getters on `options` could have run arbitrary code, including code locking either
+    // stream. If the pipe can't be performed natively anymore, the builtin `pipeTo` receives the
+    // converted values, so that it doesn't run the getters a second time.
+    bool native_signal = signal_val.isUndefined() || AbortSignal::is_instance(signal_val);
+    if (!native_signal || !can_pipe(cx, source, dest)) {
+      JSObject *converted =
+          converted_options(cx, prevent_abort, prevent_cancel, prevent_close, signal_val);
+      if (!converted) {
+        return false;
+      }
+      options.setObject(*converted);
+      return true;
+    }
+    if (!signal_val.isUndefined()) {
+      signal = &signal_val.toObject();
+    }
+  }
+
+  JS::RootedObject self(cx, JS_NewObjectWithGivenProto(cx, &class_, proto_obj));
+  if (!self) {
+    return false;
+  }
+
+  JS::RootedObject reader(cx, JS::ReadableStreamGetReader(cx, source,
+                                                          JS::ReadableStreamReaderMode::Default));
+  if (!reader) {
+    return false;
+  }
+
+  JS::RootedValue dest_val(cx, JS::ObjectValue(*dest));
+  JS::RootedValue writer(cx);
+  if (!JS::Call(cx, dest_val, original_getWriter, JS::HandleValueArray::empty(), &writer)) {
+    return false;
+  }
+  JS::RootedObject writer_obj(cx, &writer.toObject());
+  if (!init_writer_methods(cx, writer_obj)) {
+    return false;
+  }
+
+  JS::RootedObject promise(cx, JS::NewPromiseObject(cx, nullptr));
+  if (!promise) {
+    return false;
+  }
+
+  int32_t flags = (prevent_close ? PreventClose : 0) | (prevent_abort ? PreventAbort : 0) |
+                  (prevent_cancel ? PreventCancel : 0);
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Reader), JS::ObjectValue(*reader));
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Writer), writer);
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Transform),
+                      JS::ObjectValue(*TransformStream::ts_from_writable(cx, dest)));
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Promise), JS::ObjectValue(*promise));
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Flags), JS::Int32Value(flags));
+
+  rval.setObject(*promise);
+
+  if (signal) {
+    if (AbortSignal::is_aborted(signal)) {
+      JS::RootedValue error(cx, AbortSignal::reason(signal));
+      return abort_pipe(cx, self, error);
+    }
+
+    AbortSignal::add_algorithm(signal, js::MakeUnique<NativePipeAborter>(self, signal));
+  }
+
+  return pump(cx, self);
+}
+
+const JSFunctionSpec NativePipe::static_methods[] = {
+    JS_FS_END,
+};
+
+const JSPropertySpec NativePipe::static_properties[] = {
+    JS_PS_END,
+};
+
+const JSFunctionSpec NativePipe::methods[] = {JS_FS_END};
+
+const JSPropertySpec NativePipe::properties[] = {JS_PS_END};
+
+bool NativePipe::init_class(JSContext *cx, JS::HandleObject global) {
+  if (!BuiltinNoConstructor<NativePipe>::init_class(cx, global)) {
+    return false;
+  }
+
+  JS::RootedValue val(cx);
+  if (!JS_GetProperty(cx, global, "WritableStream", &val)) {
+    return false;
+  }
+  JS::RootedObject writableStream_builtin(cx, &val.toObject());
+  if (!JS_GetProperty(cx, writableStream_builtin, "prototype", &val)) {
+    return false;
+  }
+  JS::RootedObject writableStream_proto(cx, &val.toObject());
+
+  original_getWriter.init(cx);
+  writer_close.init(cx);
+  writer_abort.init(cx);
+  writer_releaseLock.init(cx);
+  if (!JS_GetProperty(cx, writableStream_proto, "getWriter", &original_getWriter)) {
+    return false;
+  }
+  MOZ_ASSERT(JS::IsCallable(&original_getWriter.toObject()));
+  return true;
+}
+
+} // namespace builtins::web::streams
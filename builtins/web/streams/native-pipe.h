@@ -0,0 +1,73 @@
+#ifndef BUILTINS_WEB_STREAMS_NATIVE_PIPE_H
+#define BUILTINS_WEB_STREAMS_NATIVE_PIPE_H
+
+#include "builtin.h"
+
+namespace builtins::web::streams {
+
+/**
+ * Implementation of ReadableStreamPipeTo for the case where both ends of the
+ * pipe are implemented natively: the source is backed by a `NativeStreamSource`
+ * (e.g. a Request or Response body, or the readable end of another
+ * TransformStream), and the destination is the writable end of a
+ * TransformStream whose transform doesn't run any user code, i.e. an identity
+ * stream or a builtin such as CompressionStream.
+ *
+ * Instead of going through the WritableStream's write queue and the promise
+ * reactions of the spec'd pipe loop, chunks are handed to the destination's
+ * transform algorithm directly. Chunks already queued in the source are
+ * consumed synchronously, so promise reactions are only used to wait for the
+ * source to produce data, or for the destination's backpressure to be relieved.
+ *
+ * All other combinations of streams are handled by the builtin `pipeTo`.
+ */
+class NativePipe : public BuiltinNoConstructor<NativePipe> {
+public:
+  static constexpr const char *class_name = "NativePipe";
+
+  enum class Slots : uint8_t {
+    Reader,    // The ReadableStreamDefaultReader locking the source.
+    Writer,    // The WritableStreamDefaultWriter locking the destination.
+    Transform, // The TransformStream the destination is the writable end of.
+    Promise,   // The promise returned from `pipeTo`.
+    Flags,
+    Count
+  };
+
+  enum Flags : int32_t {
+    PreventClose = 1 << 0,
+    PreventAbort = 1 << 1,
+    PreventCancel = 1 << 2,
+    ReadPending = 1 << 3,  // A read from the source is in flight.
+    ShuttingDown = 1 << 4, // No more chunks are transferred.
+    Finalized = 1 << 5,    // The promise has been settled, and the locks released.
+  };
+
+  static const JSFunctionSpec static_methods[];
+  static const JSPropertySpec static_properties[];
+  static const JSFunctionSpec methods[];
+  static const JSPropertySpec properties[];
+
+  /**
+   * Returns true if piping `source` into `dest` can be handled natively.
+   */
+  static bool can_pipe(JSContext *cx, JS::HandleObject source, JS::HandleObject dest);
+
+  /**
+   * Starts piping `source` into `dest` and sets `rval` to the resulting promise.
+   *
+   * If `options` contains values the native implementation doesn't support,
+   * `rval` is left untouched, and the pipe has to be performed by the builtin
+   * `pipeTo` instead. In that case, `options` is replaced by an object holding
+   * the values already read from it, which the builtin has to be called with,
+   * so that content getters don't run twice.
+   */
+  static bool pipe_to(JSContext *cx, JS::HandleObject source, JS::HandleObject dest,
+                      JS::MutableHandleValue options, JS::MutableHandleValue rval);
+
+  static bool init_class(JSContext *cx, JS::HandleObject global);
+};
+
+} // namespace builtins::web::streams
+
+#endif
@@ -12,6 +12,14 @@
 
 namespace builtins::web::streams {
 
+namespace {
+
+// Byte streams can only be created through the ReadableStream constructor, so the original one
+// is kept around in case content replaces the global.
+JS::PersistentRooted<JS::Value> original_ReadableStream;
+
+} // namespace
+
 JSObject *NativeStreamSource::owner(JSObject *self) {
   MOZ_ASSERT(is_instance(self));
   return &JS::GetReservedSlot(self, std::to_underlying(Slots::Owner)).toObject();
@@ -154,20 +162,36 @@ const JSPropertySpec NativeStreamSource::properties[] = {
     JS_PS_END
 };
 
-JSObject *NativeStreamSource::create(JSContext *cx, JS::HandleObject owner, JS::HandleValue startPromise,
-                                     PullAlgorithmImplementation *pull, CancelAlgorithmImplementation *cancel,
-                                     JS::HandleFunction size, double highWaterMark) {
-  JS::RootedObject source(cx, JS_NewObjectWithGivenProto(cx, &class_, proto_obj));
+namespace {
+
+JSObject *create_source_object(JSContext *cx, JS::HandleObject owner, JS::HandleValue startPromise,
+                               NativeStreamSource::PullAlgorithmImplementation *pull,
+                               NativeStreamSource::CancelAlgorithmImplementation *cancel) {
+  using Slots = NativeStreamSource::Slots;
+  JS::RootedObject source(cx, JS_NewObjectWithGivenProto(cx, &NativeStreamSource::class_,
+                                                         NativeStreamSource::proto_obj));
   if (!source) {
     return nullptr;
   }
 
-  // Initialize source slots before creating `ReadableDefaultStreamObject`.
+  // Initialize source slots before creating the stream.
   JS::SetReservedSlot(source, std::to_underlying(Slots::Owner), JS::ObjectValue(*owner));
   JS::SetReservedSlot(source, std::to_underlying(Slots::StartPromise), startPromise);
   JS::SetReservedSlot(source, std::to_underlying(Slots::PullAlgorithm), JS::PrivateValue((void *)pull));
   JS::SetReservedSlot(source, std::to_underlying(Slots::CancelAlgorithm), JS::PrivateValue((void *)cancel));
   JS::SetReservedSlot(source, std::to_underlying(Slots::PipedToTransformStream), JS::NullValue());
+  return source;
+}
+
+} // namespace
+
+JSObject *NativeStreamSource::create(JSContext *cx, JS::HandleObject owner, JS::HandleValue startPromise,
+                                     PullAlgorithmImplementation *pull, CancelAlgorithmImplementation *cancel,
+                                     JS::HandleFunction size, double highWaterMark) {
+  JS::RootedObject source(cx, create_source_object(cx, owner, startPromise, pull, cancel));
+  if (!source) {
+    return nullptr;
+  }
 
   JS::RootedObject stream(cx, JS::NewReadableDefaultStreamObject(cx, source, size, highWaterMark));
   if (!stream) {
@@ -177,6 +201,51 @@ JSObject *NativeStreamSource::create(JSContext *cx, JS::HandleObject owner, JS::
   JS::SetReservedSlot(source, std::to_underlying(Slots::Stream), JS::ObjectValue(*stream));
   return source;
 }
+
+JSObject *NativeStreamSource::create_byte_source(JSContext *cx, JS::HandleObject owner,
+                                                 PullAlgorithmImplementation *pull,
+                                                 CancelAlgorithmImplementation *cancel) {
+  JS::RootedObject source(cx,
+                          create_source_object(cx, owner, JS::UndefinedHandleValue, pull, cancel));
+  if (!source) {
+    return nullptr;
+  }
+
+  JS::RootedString type(cx, JS_NewStringCopyZ(cx, "bytes"));
+  if (!type || !JS_DefineProperty(cx, source, "type", type, JSPROP_READONLY)) {
+    return nullptr;
+  }
+
+  // See `create` for why the `highWaterMark` is 0.
+  JS::RootedObject strategy(cx, JS_NewPlainObject(cx));
+  if (!strategy || !JS_DefineProperty(cx, strategy, "highWaterMark", 0, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+
+  JS::RootedValueArray<2> args(cx);
+  args[0].setObject(*source);
+  args[1].setObject(*strategy);
+  JS::RootedObject stream(cx);
+  if (!JS::Construct(cx, original_ReadableStream, args, &stream)) {
+    return nullptr;
+  }
+
+  JS::SetReservedSlot(source, std::to_underlying(Slots::Stream), JS::ObjectValue(*stream));
+  return source;
+}
+
+bool NativeStreamSource::init_class(JSContext *cx, JS::HandleObject global) {
+  if (!BuiltinNoConstructor<NativeStreamSource>::init_class(cx, global)) {
+    return false;
+  }
+
+  original_ReadableStream.init(cx);
+  if (!JS_GetProperty(cx, global, "ReadableStream", &original_ReadableStream)) {
+    return false;
+  }
+  MOZ_ASSERT(JS::IsConstructor(&original_ReadableStream.toObject()));
+  return true;
+}
 } // namespace builtins::web::streams
 
 
@@ -56,6 +56,18 @@ public:
   static JSObject *create(JSContext *cx, JS::HandleObject owner, JS::HandleValue startPromise,
                           PullAlgorithmImplementation *pull, CancelAlgorithmImplementation *cancel,
                           JS::HandleFunction size = nullptr, double highWaterMark = 0.0);
+
+  // Create an instance of `NativeStreamSource` backing a readable byte stream.
+  //
+  // In contrast to the streams created by `create`, byte streams support BYOB readers, for which
+  // the pull algorithm can fill the view returned by the controller's `byobRequest` in place. As
+  // no `autoAllocateChunkSize` is set, reads from default readers are still fulfilled with the
+  // chunks the pull algorithm enqueues.
+  static JSObject *create_byte_source(JSContext *cx, JS::HandleObject owner,
+                                      PullAlgorithmImplementation *pull,
+                                      CancelAlgorithmImplementation *cancel);
+
+  static bool init_class(JSContext *cx, JS::HandleObject global);
 };
 } // namespace builtins::web::streams
 
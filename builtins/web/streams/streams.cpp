@@ -2,6 +2,7 @@
 #include "buf-reader.h"
 #include "compression-stream.h"
 #include "decompression-stream.h"
+#include "native-pipe.h"
 #include "native-stream-sink.h"
 #include "native-stream-source.h"
 #include "transform-stream-default-controller.h"
@@ -16,6 +17,9 @@ bool install(api::Engine *engine) {
   if (!NativeStreamSink::init_class(engine->cx(), engine->global())) {
     return false;
   }
+  if (!NativePipe::init_class(engine->cx(), engine->global())) {
+    return false;
+  }
   if (!TransformStreamDefaultController::init_class(engine->cx(), engine->global())) {
     return false;
   }
@@ -160,10 +160,12 @@ JSObject *TransformStreamDefaultController::create(
 
 void TransformStreamDefaultController::set_transformer(JSObject *controller, JS::Value transformer,
                                                        JSObject *transformFunction,
-                                                       JSObject *flushFunction) {
+                                                       JSObject *flushFunction,
+                                                       JSObject *cancelFunction) {
   JS::SetReservedSlot(controller, std::to_underlying(Slots::Transformer), transformer);
   JS::SetReservedSlot(controller, std::to_underlying(Slots::TransformInput), JS::ObjectOrNullValue(transformFunction));
   JS::SetReservedSlot(controller, std::to_underlying(Slots::FlushInput), JS::ObjectOrNullValue(flushFunction));
+  JS::SetReservedSlot(controller, std::to_underlying(Slots::CancelInput), JS::ObjectOrNullValue(cancelFunction));
 }
 
 /**
@@ -359,6 +361,36 @@ TransformStreamDefaultController::flush_algorithm_transformer(JSContext *cx,
   return InvokePromiseReturningCallback(cx, transformer, flushFunction, newArgs);
 }
 
+/**
+ * The cancelAlgorithm of SetUpTransformStreamDefaultControllerFromTransformer,
+ * as added to the spec in https://github.com/whatwg/streams/pull/1283.
+ *
+ * Transformers passed to the JS constructor don't get to supply a `cancel`
+ * method yet, so this only invokes cancel functions supplied by other builtins.
+ */
+JSObject *
+TransformStreamDefaultController::cancel_algorithm_transformer(JSContext *cx,
+                                                               JS::HandleObject controller,
+                                                               JS::HandleValue reason) {
+  MOZ_ASSERT(is_instance(controller));
+
+  // Let cancelAlgorithm be an algorithm which returns a promise resolved with
+  // undefined.
+  JS::RootedValue cancelFunction(cx, JS::GetReservedSlot(controller, std::to_underlying(Slots::CancelInput)));
+  if (!cancelFunction.isObject()) {
+    return JS::CallOriginalPromiseResolve(cx, JS::UndefinedHandleValue);
+  }
+
+  // If transformerDict[cancel] exists, set cancelAlgorithm to an algorithm
+  // which takes an argument reason and returns the result of invoking
+  // transformerDict[cancel] with argument list « reason » and callback this
+  // value transformer.
+  JS::RootedValue transformer(cx, JS::GetReservedSlot(controller, std::to_underlying(Slots::Transformer)));
+  JS::RootedValueArray<1> newArgs(cx);
+  newArgs[0].set(reason);
+  return InvokePromiseReturningCallback(cx, transformer, cancelFunction, newArgs);
+}
+
 /**
  * SetUpTransformStreamDefaultController
  * https://streams.spec.whatwg.org/#set-up-transform-stream-default-controller
@@ -383,7 +415,8 @@ JSObject *TransformStreamDefaultController::SetUpFromTransformer(JSContext *cx,
                                                                  JS::HandleObject stream,
                                                                  JS::HandleValue transformer,
                                                                  JS::HandleObject transformFunction,
-                                                                 JS::HandleObject flushFunction) {
+                                                                 JS::HandleObject flushFunction,
+                                                                 JS::HandleObject cancelFunction) {
   MOZ_ASSERT(TransformStream::is_instance(stream));
 
   // Step 1, moved into SetUpTransformStreamDefaultController.
@@ -397,7 +430,7 @@ JSObject *TransformStreamDefaultController::SetUpFromTransformer(JSContext *cx,
 
   // Set the additional bits required to execute the transformer-based transform
   // and flush algorithms.
-  set_transformer(controller, transformer, transformFunction, flushFunction);
+  set_transformer(controller, transformer, transformFunction, flushFunction, cancelFunction);
 
   // Steps 2-5 implemented in dedicated functions above.
   return controller;
@@ -449,6 +482,56 @@ JSObject *TransformStreamDefaultController::PerformTransform(JSContext *cx,
   return JS::CallOriginalPromiseThen(cx, transformPromise, nullptr, catch_handler);
 }
 
+/**
+ * Variant of PerformTransform that runs the transform algorithm synchronously, without wrapping
+ * its result in a promise.
+ *
+ * Only valid for identity streams and for streams whose transformer is a builtin, such as
+ * CompressionStream, since those never return a pending promise from their transform function.
+ * If the transform fails, the stream is errored and the error is left pending on `cx`.
+ */
+bool TransformStreamDefaultController::PerformTransformSync(JSContext *cx,
+                                                            JS::HandleObject controller,
+                                                            JS::HandleValue chunk) {
+  MOZ_ASSERT(is_instance(controller));
+  MOZ_ASSERT(transformAlgorithm(controller) == transform_algorithm_transformer);
+
+  // Steps 2.* and 4 of SetUpTransformStreamDefaultControllerFromTransformer,
+  // as in transform_algorithm_transformer.
+  JS::RootedValue transformFunction(cx);
+  transformFunction = JS::GetReservedSlot(controller, std::to_underlying(Slots::TransformInput));
+  bool ok = false;
+  if (!transformFunction.isObject()) {
+    ok = Enqueue(cx, controller, chunk);
+  } else {
+    JS::RootedValue transformer(cx, JS::GetReservedSlot(controller, std::to_underlying(Slots::Transformer)));
+    JS::RootedValueArray<2> newArgs(cx);
+    newArgs[0].set(chunk);
+    newArgs[1].setObject(*controller);
+    JS::RootedValue rval(cx);
+    ok = JS::Call(cx, transformer, transformFunction, newArgs, &rval);
+  }
+
+  if (ok) {
+    return true;
+  }
+
+  // Steps 2.* of PerformTransform, applied to the synchronous failure.
+  JS::RootedValue r(cx);
+  if (!JS_GetPendingException(cx, &r)) {
+    return false;
+  }
+  JS_ClearPendingException(cx);
+
+  JS::RootedObject streamObj(cx, stream(controller));
+  if (!TransformStream::Error(cx, streamObj, r)) {
+    return false;
+  }
+
+  JS_SetPendingException(cx, r);
+  return false;
+}
+
 /**
  * TransformStreamDefaultControllerClearAlgorithms
  */
@@ -462,5 +545,8 @@ void TransformStreamDefaultController::ClearAlgorithms(JSObject *controller) {
   // 2.  Set controller.[flushAlgorithm] to undefined.
   JS::SetReservedSlot(controller, std::to_underlying(Slots::FlushAlgorithm), JS::PrivateValue(nullptr));
   JS::SetReservedSlot(controller, std::to_underlying(Slots::FlushInput), JS::UndefinedValue());
+
+  // 3.  Set controller.[cancelAlgorithm] to undefined.
+  JS::SetReservedSlot(controller, std::to_underlying(Slots::CancelInput), JS::UndefinedValue());
 }
 } // namespace builtins::web::streams
@@ -22,6 +22,8 @@ public:
     FlushAlgorithm,
     FlushInput, // JS::Value to be used by FlushAlgorithm, e.g. a JSFunction to
                 // call.
+    CancelInput, // JSFunction to call when the stream is canceled or aborted. Only set for
+                 // TransformStreams created by other builtins.
     Count
   };
 
@@ -47,24 +49,30 @@ public:
                           TransformAlgorithmImplementation *transformAlgo,
                           FlushAlgorithmImplementation *flushAlgo);
   static void set_transformer(JSObject *controller, JS::Value transformer,
-                              JSObject *transformFunction, JSObject *flushFunction);
+                              JSObject *transformFunction, JSObject *flushFunction,
+                              JSObject *cancelFunction);
   static JSObject *InvokePromiseReturningCallback(JSContext *cx, JS::HandleValue receiver,
                                                   JS::HandleValue callback,
                                                   JS::HandleValueArray args);
   static JSObject *transform_algorithm_transformer(JSContext *cx, JS::HandleObject controller,
                                                    JS::HandleValue chunk);
   static JSObject *flush_algorithm_transformer(JSContext *cx, JS::HandleObject controller);
+  static JSObject *cancel_algorithm_transformer(JSContext *cx, JS::HandleObject controller,
+                                                JS::HandleValue reason);
   static JSObject *SetUp(JSContext *cx, JS::HandleObject stream,
                          TransformAlgorithmImplementation *transformAlgo,
                          FlushAlgorithmImplementation *flushAlgo);
   static JSObject *SetUpFromTransformer(JSContext *cx, JS::HandleObject stream,
                                         JS::HandleValue transformer,
                                         JS::HandleObject transformFunction,
-                                        JS::HandleObject flushFunction);
+                                        JS::HandleObject flushFunction,
+                                        JS::HandleObject cancelFunction);
   static bool transformPromise_catch_handler(JSContext *cx, JS::HandleObject controller,
                                              JS::HandleValue extra, JS::CallArgs args);
   static JSObject *PerformTransform(JSContext *cx, JS::HandleObject controller,
                                     JS::HandleValue chunk);
+  static bool PerformTransformSync(JSContext *cx, JS::HandleObject controller,
+                                   JS::HandleValue chunk);
   static void ClearAlgorithms(JSObject *controller);
 };
 
@@ -2,6 +2,7 @@
 #include "js/Conversions.h"
 #include "js/Stream.h"
 
+#include "native-pipe.h"
 #include "native-stream-sink.h"
 #include "native-stream-source.h"
 #include "transform-stream-default-controller.h"
@@ -52,6 +53,23 @@ bool pipeTo(JSContext *cx, unsigned argc, JS::Value *vp) {
     }
   }
 
+  // If neither end of the pipe runs user code, chunks can be moved between
+  // them directly, without going through the WritableStream's write queue.
+  if (target && NativePipe::can_pipe(cx, self, target)) {
+    JS::RootedValue options(cx, args.get(1));
+    if (!NativePipe::pipe_to(cx, self, target, &options, args.rval())) {
+      return ReturnPromiseRejectedWithPendingError(cx, args);
+    }
+    if (args.rval().isObject()) {
+      return true;
+    }
+
+    JS::RootedValueArray<2> pipe_args(cx);
+    pipe_args[0].set(args[0]);
+    pipe_args[1].set(options);
+    return JS::Call(cx, args.thisv(), original_pipeTo, pipe_args, args.rval());
+  }
+
   return JS::Call(cx, args.thisv(), original_pipeTo, JS::HandleValueArray(args), args.rval());
 }
 
@@ -556,6 +574,13 @@ bool TransformStream::DefaultSourceCancelAlgorithm(JSContext *cx, JS::CallArgs a
                                                    JS::HandleValue reason) {
   MOZ_ASSERT(is_instance(stream));
 
+  // Perform controller.[cancelAlgorithm], passing reason. The returned promise
+  // isn't waited for, as it's only used by builtins, which cancel synchronously.
+  JS::RootedObject controller(cx, TransformStream::controller(stream));
+  if (!TransformStreamDefaultController::cancel_algorithm_transformer(cx, controller, reason)) {
+    return false;
+  }
+
   // 1.  Perform ! [TransformStreamErrorWritableAndUnblockWrite](stream,
   // reason).
   if (!ErrorWritableAndUnblockWrite(cx, stream, reason)) {
@@ -662,6 +687,13 @@ bool TransformStream::DefaultSinkAbortAlgorithm(JSContext *cx, JS::CallArgs args
                                                 JS::HandleObject stream, JS::HandleValue reason) {
   MOZ_ASSERT(is_instance(stream));
 
+  // Perform controller.[cancelAlgorithm], passing reason. See
+  // DefaultSourceCancelAlgorithm.
+  JS::RootedObject controller(cx, TransformStream::controller(stream));
+  if (!TransformStreamDefaultController::cancel_algorithm_transformer(cx, controller, reason)) {
+    return false;
+  }
+
   // 1.  Perform ! [TransformStreamError](stream, reason).
   if (!Error(cx, stream, reason)) {
     return false;
@@ -937,7 +969,7 @@ TransformStream::create(JSContext *cx, JS::HandleObject self, double writableHig
                         JS::HandleFunction writableSizeAlgorithm, double readableHighWaterMark,
                         JS::HandleFunction readableSizeAlgorithm, JS::HandleValue transformer,
                         JS::HandleObject startFunction, JS::HandleObject transformFunction,
-                        JS::HandleObject flushFunction) {
+                        JS::HandleObject flushFunction, JS::HandleObject cancelFunction) {
 
   // Step 9.
   JS::RootedObject startPromise(cx, JS::NewPromiseObject(cx, nullptr));
@@ -954,7 +986,7 @@ TransformStream::create(JSContext *cx, JS::HandleObject self, double writableHig
   // Step 11.
   JS::RootedObject controller(cx);
   controller = TransformStreamDefaultController::SetUpFromTransformer(
-      cx, self, transformer, transformFunction, flushFunction);
+      cx, self, transformer, transformFunction, flushFunction, cancelFunction);
   if (!controller) {
     return nullptr;
   }
@@ -988,7 +1020,8 @@ JSObject *TransformStream::create(JSContext *cx, double writableHighWaterMark,
                                   JS::HandleFunction readableSizeAlgorithm,
                                   JS::HandleValue transformer, JS::HandleObject startFunction,
                                   JS::HandleObject transformFunction,
-                                  JS::HandleObject flushFunction) {
+                                  JS::HandleObject flushFunction,
+                                  JS::HandleObject cancelFunction) {
   JS::RootedObject self(cx, JS_NewObjectWithGivenProto(cx, &class_, proto_obj));
   if (!self) {
     return nullptr;
@@ -996,7 +1029,7 @@ JSObject *TransformStream::create(JSContext *cx, double writableHighWaterMark,
 
   return TransformStream::create(cx, self, writableHighWaterMark, writableSizeAlgorithm,
                                  readableHighWaterMark, readableSizeAlgorithm, transformer,
-                                 startFunction, transformFunction, flushFunction);
+                                 startFunction, transformFunction, flushFunction, cancelFunction);
 }
 
 /**
@@ -84,12 +84,12 @@ public:
                           JS::HandleFunction writableSizeAlgorithm, double readableHighWaterMark,
                           JS::HandleFunction readableSizeAlgorithm, JS::HandleValue transformer,
                           JS::HandleObject startFunction, JS::HandleObject transformFunction,
-                          JS::HandleObject flushFunction);
+                          JS::HandleObject flushFunction, JS::HandleObject cancelFunction = nullptr);
   static JSObject *create(JSContext *cx, double writableHighWaterMark,
                           JS::HandleFunction writableSizeAlgorithm, double readableHighWaterMark,
                           JS::HandleFunction readableSizeAlgorithm, JS::HandleValue transformer,
                           JS::HandleObject startFunction, JS::HandleObject transformFunction,
-                          JS::HandleObject flushFunction);
+                          JS::HandleObject flushFunction, JS::HandleObject cancelFunction = nullptr);
   static JSObject *create_rs_proxy(JSContext *cx, JS::HandleObject input_readable);
 };
 
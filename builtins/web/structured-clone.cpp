@@ -82,8 +82,18 @@ bool WriteStructuredClone(JSContext *cx, JSStructuredCloneWriter *w, JS::HandleO
     }
   } else if (blob::Blob::is_instance(obj)) {
     auto *data = blob::Blob::blob(obj);
-    if (!JS_WriteUint32Pair(w, SCTAG_DOM_BLOB, data->length()) ||
-        !JS_WriteBytes(w, (void *)data->begin(), data->length())) {
+    if (!JS_WriteUint32Pair(w, SCTAG_DOM_BLOB, data->length())) {
+      return false;
+    }
+
+    bool ok = true;
+    if (!data->for_each_span(0, [&](std::span<const uint8_t> span) {
+          ok = JS_WriteBytes(w, span.data(), span.size());
+          return ok;
+        })) {
+      return blob::Blob::report_read_error(cx);
+    }
+    if (!ok) {
       return false;
     }
   } else {
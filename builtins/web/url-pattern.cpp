@@ -0,0 +1,606 @@
+#include "url-pattern.h"
+#include "encode.h"
+#include "url.h"
+
+#include "js/Array.h"
+#include "js/CharacterEncoding.h"
+#include "js/RegExp.h"
+#include "js/RegExpFlags.h"
+#include "js/Vector.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <unordered_map>
+
+namespace builtins::web::url_pattern {
+
+DEF_ERR(InvalidPatternError, JSEXN_TYPEERR, "URLPattern constructor: {0}", 1);
+DEF_ERR(InvalidRegExpError, JSEXN_TYPEERR,
+        "URLPattern constructor: invalid regular expression in the {0} component", 1);
+DEF_ERR(BaseURLWithInitError, JSEXN_TYPEERR,
+        "{0}: a base URL can't be combined with a URLPatternInit dictionary", 1);
+
+namespace {
+
+using jsurl::UrlPatternComponent;
+using jsurl::UrlPatternComponentKind;
+
+constexpr size_t COMPONENT_COUNT = URLPattern::COMPONENT_COUNT;
+
+constexpr std::array<const char *, COMPONENT_COUNT> COMPONENT_NAMES = {
+    "protocol", "username", "password", "hostname", "port", "pathname", "search", "hash"};
+
+constexpr std::array<std::u16string_view, 6> SPECIAL_SCHEMES = {u"ftp",   u"file", u"http",
+                                                                 u"https", u"ws",   u"wss"};
+
+// The members of the URLPatternInit dictionary, in the order WebIDL reads them in. The base URL
+// isn't a component, and is marked with `COMPONENT_COUNT`.
+constexpr std::array<std::pair<const char *, size_t>, COMPONENT_COUNT + 1> INIT_MEMBERS = {{
+    {"baseURL", COMPONENT_COUNT},
+    {"hash", std::to_underlying(UrlPatternComponent::Hash)},
+    {"hostname", std::to_underlying(UrlPatternComponent::Hostname)},
+    {"password", std::to_underlying(UrlPatternComponent::Password)},
+    {"pathname", std::to_underlying(UrlPatternComponent::Pathname)},
+    {"port", std::to_underlying(UrlPatternComponent::Port)},
+    {"protocol", std::to_underlying(UrlPatternComponent::Protocol)},
+    {"search", std::to_underlying(UrlPatternComponent::Search)},
+    {"username", std::to_underlying(UrlPatternComponent::Username)},
+}};
+
+struct UrlPatternDeleter {
+  void operator()(const jsurl::JSUrlPattern *pattern) const { jsurl::free_url_pattern(pattern); }
+};
+using UniqueUrlPattern = std::unique_ptr<const jsurl::JSUrlPattern, UrlPatternDeleter>;
+
+struct UrlPatternInputDeleter {
+  void operator()(jsurl::JSUrlPatternInput *input) const { jsurl::free_url_pattern_input(input); }
+};
+using UniqueUrlPatternInput = std::unique_ptr<jsurl::JSUrlPatternInput, UrlPatternInputDeleter>;
+
+// Compiled patterns, keyed by a serialization of the arguments they were created from. Once full,
+// the cache is cleared: patterns are typically created from a fixed set of routes, so it only
+// fills up if they're created from arbitrary strings, in which case caching doesn't help anyway.
+constexpr size_t PATTERN_CACHE_CAPACITY = 256;
+std::unordered_map<std::string, UniqueUrlPattern> PATTERN_CACHE;
+
+std::string_view view(jsurl::SpecSlice slice) {
+  return {reinterpret_cast<const char *>(slice.data), slice.len};
+}
+
+jsurl::SpecSlice slice(const host_api::HostString &str) {
+  return {reinterpret_cast<const uint8_t *>(str.ptr.get()), str.len};
+}
+
+void append_key(std::string &key, jsurl::SpecSlice member) {
+  if (!member.data) {
+    key += '-';
+    return;
+  }
+  key += std::to_string(member.len);
+  key += ':';
+  key += view(member);
+}
+
+// A URLPatternInit dictionary, along with the strings its members point to.
+struct Init {
+  std::array<host_api::HostString, COMPONENT_COUNT + 1> strings;
+  jsurl::UrlPatternInit init{};
+
+  bool read(JSContext *cx, JS::HandleValue val) {
+    // `null` and `undefined` are converted to an empty dictionary.
+    if (val.isNullOrUndefined()) {
+      return true;
+    }
+
+    JS::RootedObject obj(cx, &val.toObject());
+    JS::RootedValue member(cx);
+    for (auto [name, index] : INIT_MEMBERS) {
+      if (!JS_GetProperty(cx, obj, name, &member)) {
+        return false;
+      }
+      if (member.isUndefined()) {
+        continue;
+      }
+      strings[index] = core::encode(cx, member);
+      if (!strings[index]) {
+        return false;
+      }
+      (index == COMPONENT_COUNT ? init.base_url : init.components[index]) = slice(strings[index]);
+    }
+
+    return true;
+  }
+
+  void append_to_key(std::string &key) const {
+    for (const auto &component : init.components) {
+      append_key(key, component);
+    }
+    append_key(key, init.base_url);
+  }
+};
+
+bool is_dictionary(JS::HandleValue val) { return val.isNullOrUndefined() || val.isObject(); }
+
+JS::RegExpFlags regexp_flags(bool ignore_case) {
+  return ignore_case ? JS::RegExpFlags(JS::RegExpFlag::UnicodeSets | JS::RegExpFlag::IgnoreCase)
+                     : JS::RegExpFlags(JS::RegExpFlag::UnicodeSets);
+}
+
+jsurl::SpecialSchemeMatch matches_special_scheme(void *data, const uint16_t *regexp, size_t len) {
+  auto *cx = static_cast<JSContext *>(data);
+  JS::RootedObject re(cx, JS::NewUCRegExpObject(cx, reinterpret_cast<const char16_t *>(regexp),
+                                                len, regexp_flags(false)));
+  if (!re) {
+    JS_ClearPendingException(cx);
+    return jsurl::SpecialSchemeMatch::Error;
+  }
+
+  JS::RootedValue rval(cx);
+  for (auto scheme : SPECIAL_SCHEMES) {
+    size_t index = 0;
+    if (!JS::ExecuteRegExpNoStatics(cx, re, scheme.data(), scheme.size(), &index, true, &rval)) {
+      JS_ClearPendingException(cx);
+      return jsurl::SpecialSchemeMatch::Error;
+    }
+    if (!rval.isNull()) {
+      return jsurl::SpecialSchemeMatch::Match;
+    }
+  }
+
+  return jsurl::SpecialSchemeMatch::NoMatch;
+}
+
+jsurl::UrlPatternComponentInfo component_info(const jsurl::JSUrlPattern *pattern, size_t index) {
+  jsurl::UrlPatternComponentInfo info;
+  jsurl::url_pattern_component(pattern, static_cast<UrlPatternComponent>(index), &info);
+  return info;
+}
+
+uint32_t regexp_slot(size_t index) {
+  return std::to_underlying(URLPattern::Slots::ProtocolRegExp) + index;
+}
+
+// The components of the input being matched, as UTF-8.
+using Components = std::array<std::string_view, COMPONENT_COUNT>;
+
+void url_components(const jsurl::JSUrl *url, Components &components) {
+  auto set = [&](UrlPatternComponent component, jsurl::SpecSlice value) {
+    components[std::to_underlying(component)] = view(value);
+  };
+  set(UrlPatternComponent::Protocol, jsurl::protocol(url));
+  set(UrlPatternComponent::Username, jsurl::username(url));
+  set(UrlPatternComponent::Password, jsurl::password(url));
+  set(UrlPatternComponent::Hostname, jsurl::hostname(url));
+  set(UrlPatternComponent::Port, jsurl::port(url));
+  set(UrlPatternComponent::Pathname, jsurl::pathname(url));
+  set(UrlPatternComponent::Search, jsurl::search(url));
+  set(UrlPatternComponent::Hash, jsurl::hash(url));
+
+  // The URL setters' representation includes delimiters the URL Pattern Standard leaves out.
+  auto &protocol = components[std::to_underlying(UrlPatternComponent::Protocol)];
+  protocol.remove_suffix(protocol.ends_with(':') ? 1 : 0);
+  auto &search = components[std::to_underlying(UrlPatternComponent::Search)];
+  search.remove_prefix(search.starts_with('?') ? 1 : 0);
+  auto &hash = components[std::to_underlying(UrlPatternComponent::Hash)];
+  hash.remove_prefix(hash.starts_with('#') ? 1 : 0);
+}
+
+bool exec_regexp(JSContext *cx, JS::HandleObject regexp, std::string_view input, bool test_only,
+                 JS::MutableHandleValue rval) {
+  size_t index = 0;
+
+  // Components are percent-encoded, so they're almost always ASCII, and can just be widened.
+  if (std::all_of(input.begin(), input.end(), [](char c) { return (c & 0x80) == 0; })) {
+    js::Vector<char16_t, 256, js::SystemAllocPolicy> chars;
+    if (!chars.resize(input.size())) {
+      JS_ReportOutOfMemory(cx);
+      return false;
+    }
+    std::copy(input.begin(), input.end(), chars.begin());
+    return JS::ExecuteRegExpNoStatics(cx, regexp, chars.begin(), chars.length(), &index,
+                                      test_only, rval);
+  }
+
+  size_t len = 0;
+  JS::UniqueTwoByteChars chars(
+      JS::UTF8CharsToNewTwoByteCharsZ(cx, JS::UTF8Chars(input.data(), input.size()), &len,
+                                      js::MallocArena)
+          .get());
+  if (!chars) {
+    return false;
+  }
+  return JS::ExecuteRegExpNoStatics(cx, regexp, chars.get(), len, &index, test_only, rval);
+}
+
+JSString *new_string(JSContext *cx, std::string_view str) {
+  return JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(str.data(), str.size()));
+}
+
+bool define_group(JSContext *cx, JS::HandleObject groups, jsurl::SpecSlice name,
+                  JS::HandleValue value) {
+  JS::RootedString name_str(cx, new_string(cx, view(name)));
+  if (!name_str) {
+    return false;
+  }
+  JS::RootedId id(cx);
+  if (!JS_StringToId(cx, name_str, &id)) {
+    return false;
+  }
+  return JS_DefinePropertyById(cx, groups, id, value, JSPROP_ENUMERATE);
+}
+
+// https://urlpattern.spec.whatwg.org/#create-a-component-match-result
+JSObject *component_result(JSContext *cx, const jsurl::JSUrlPattern *pattern, size_t index,
+                           std::string_view input, JS::HandleValue exec_result) {
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  JS::RootedObject groups(cx, JS_NewPlainObject(cx));
+  JS::RootedString input_str(cx, new_string(cx, input));
+  if (!result || !groups || !input_str) {
+    return nullptr;
+  }
+  JS::RootedValue input_val(cx, JS::StringValue(input_str));
+
+  auto component = static_cast<UrlPatternComponent>(index);
+  auto info = component_info(pattern, index);
+  JS::RootedValue value(cx);
+  for (size_t i = 0; i < info.group_count; i++) {
+    if (info.kind == UrlPatternComponentKind::Wildcard) {
+      value = input_val;
+    } else {
+      JS::RootedObject array(cx, &exec_result.toObject());
+      if (!JS_GetElement(cx, array, i + 1, &value)) {
+        return nullptr;
+      }
+    }
+    if (!define_group(cx, groups, jsurl::url_pattern_group_name(pattern, component, i), value)) {
+      return nullptr;
+    }
+  }
+
+  if (!JS_DefineProperty(cx, result, "input", input_val, JSPROP_ENUMERATE) ||
+      !JS_DefineProperty(cx, result, "groups", groups, JSPROP_ENUMERATE)) {
+    return nullptr;
+  }
+  return result;
+}
+
+} // namespace
+
+const jsurl::JSUrlPattern *URLPattern::pattern(JSObject *self) {
+  MOZ_ASSERT(is_instance(self));
+  return static_cast<const jsurl::JSUrlPattern *>(
+      JS::GetReservedSlot(self, std::to_underlying(Slots::Pattern)).toPrivate());
+}
+
+// https://urlpattern.spec.whatwg.org/#url-pattern-match
+bool URLPattern::match(JSContext *cx, JS::HandleObject self, JS::HandleValue input,
+                       JS::HandleValue base_url, bool test_only, JS::MutableHandleValue rval) {
+  auto no_match = [&]() {
+    test_only ? rval.setBoolean(false) : rval.setNull();
+    return true;
+  };
+
+  Components components;
+  UniqueUrlPatternInput processed;
+  if (is_dictionary(input)) {
+    if (!base_url.isUndefined()) {
+      return api::throw_error(cx, BaseURLWithInitError,
+                              test_only ? "URLPattern.test" : "URLPattern.exec");
+    }
+    Init init;
+    if (!init.read(cx, input)) {
+      return false;
+    }
+    processed.reset(jsurl::new_url_pattern_input(&init.init));
+    if (!processed) {
+      return no_match();
+    }
+    for (size_t i = 0; i < COMPONENT_COUNT; i++) {
+      components[i] = view(
+          jsurl::url_pattern_input_component(processed.get(), static_cast<UrlPatternComponent>(i)));
+    }
+  } else {
+    auto input_str = core::encode(cx, input);
+    if (!input_str) {
+      return false;
+    }
+
+    // Both the base URL and the input are parsed through the URL cache, so matching the same
+    // request URL against many patterns only parses it once.
+    const jsurl::JSUrl *base = nullptr;
+    if (!base_url.isUndefined()) {
+      auto base_str = core::encode(cx, base_url);
+      if (!base_str) {
+        return false;
+      }
+      base = url::URLCache::parse(base_str, nullptr);
+      if (!base) {
+        return no_match();
+      }
+    }
+
+    // The parsed URL is owned by the cache, and stays valid until it's used again, which doesn't
+    // happen during matching.
+    const jsurl::JSUrl *url = url::URLCache::parse(input_str, base);
+    if (!url) {
+      return no_match();
+    }
+    url_components(url, components);
+  }
+
+  const auto *compiled = pattern(self);
+  JS::RootedValueVector exec_results(cx);
+  if (!exec_results.resize(COMPONENT_COUNT)) {
+    JS_ReportOutOfMemory(cx);
+    return false;
+  }
+  JS::RootedObject regexp(cx);
+  for (size_t i = 0; i < COMPONENT_COUNT; i++) {
+    auto info = component_info(compiled, i);
+    if (info.kind == UrlPatternComponentKind::Wildcard) {
+      continue;
+    }
+    if (info.kind == UrlPatternComponentKind::Literal) {
+      if (view(info.literal) != components[i]) {
+        return no_match();
+      }
+      continue;
+    }
+
+    regexp = &JS::GetReservedSlot(self, regexp_slot(i)).toObject();
+    if (!exec_regexp(cx, regexp, components[i], test_only, exec_results[i])) {
+      return false;
+    }
+    if (exec_results[i].isNull()) {
+      return no_match();
+    }
+  }
+
+  if (test_only) {
+    rval.setBoolean(true);
+    return true;
+  }
+
+  JS::RootedObject result(cx, JS_NewPlainObject(cx));
+  if (!result) {
+    return false;
+  }
+
+  JS::RootedValueVector inputs(cx);
+  JS::RootedValue input_val(cx, input);
+  if (input.isNullOrUndefined()) {
+    JSObject *empty = JS_NewPlainObject(cx);
+    if (!empty) {
+      return false;
+    }
+    input_val.setObject(*empty);
+  }
+  if (!inputs.append(input_val) || (!base_url.isUndefined() && !inputs.append(base_url))) {
+    JS_ReportOutOfMemory(cx);
+    return false;
+  }
+  JS::RootedObject inputs_array(cx, JS::NewArrayObject(cx, inputs));
+  if (!inputs_array || !JS_DefineProperty(cx, result, "inputs", inputs_array, JSPROP_ENUMERATE)) {
+    return false;
+  }
+
+  JS::RootedObject component(cx);
+  for (size_t i = 0; i < COMPONENT_COUNT; i++) {
+    component = component_result(cx, compiled, i, components[i], exec_results[i]);
+    if (!component ||
+        !JS_DefineProperty(cx, result, COMPONENT_NAMES[i], component, JSPROP_ENUMERATE)) {
+      return false;
+    }
+  }
+
+  rval.setObject(*result);
+  return true;
+}
+
+bool URLPattern::test(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+  if (self == proto_obj) {
+    return api::throw_error(cx, api::Errors::WrongReceiver, "test", class_name);
+  }
+  return match(cx, self, args.get(0), args.get(1), true, args.rval());
+}
+
+bool URLPattern::exec(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+  if (self == proto_obj) {
+    return api::throw_error(cx, api::Errors::WrongReceiver, "exec", class_name);
+  }
+  return match(cx, self, args.get(0), args.get(1), false, args.rval());
+}
+
+#define COMPONENT_GETTER(field, component)                                                         \
+  bool URLPattern::field##_get(JSContext *cx, unsigned argc, JS::Value *vp) {                      \
+    METHOD_HEADER(0)                                                                               \
+    if (self == proto_obj) {                                                                       \
+      return api::throw_error(cx, api::Errors::WrongReceiver, #field " get", class_name);          \
+    }                                                                                              \
+    auto info = component_info(pattern(self), std::to_underlying(UrlPatternComponent::component)); \
+    JSString *str = new_string(cx, view(info.pattern));                                            \
+    if (!str) {                                                                                    \
+      return false;                                                                                \
+    }                                                                                              \
+    args.rval().setString(str);                                                                    \
+    return true;                                                                                   \
+  }
+
+COMPONENT_GETTER(protocol, Protocol)
+COMPONENT_GETTER(username, Username)
+COMPONENT_GETTER(password, Password)
+COMPONENT_GETTER(hostname, Hostname)
+COMPONENT_GETTER(port, Port)
+COMPONENT_GETTER(pathname, Pathname)
+COMPONENT_GETTER(search, Search)
+COMPONENT_GETTER(hash, Hash)
+
+bool URLPattern::hasRegExpGroups_get(JSContext *cx, unsigned argc, JS::Value *vp) {
+  METHOD_HEADER(0)
+  if (self == proto_obj) {
+    return api::throw_error(cx, api::Errors::WrongReceiver, "hasRegExpGroups get", class_name);
+  }
+  bool has_regexp_groups = false;
+  for (size_t i = 0; i < COMPONENT_COUNT; i++) {
+    has_regexp_groups |= component_info(pattern(self), i).has_regexp_groups;
+  }
+  args.rval().setBoolean(has_regexp_groups);
+  return true;
+}
+
+const JSFunctionSpec URLPattern::static_methods[] = {
+    JS_FS_END,
+};
+
+const JSPropertySpec URLPattern::static_properties[] = {
+    JS_PS_END,
+};
+
+const JSFunctionSpec URLPattern::methods[] = {
+    JS_FN("test", test, 0, JSPROP_ENUMERATE),
+    JS_FN("exec", exec, 0, JSPROP_ENUMERATE),
+    JS_FS_END,
+};
+
+const JSPropertySpec URLPattern::properties[] = {
+    JS_PSG("protocol", protocol_get, JSPROP_ENUMERATE),
+    JS_PSG("username", username_get, JSPROP_ENUMERATE),
+    JS_PSG("password", password_get, JSPROP_ENUMERATE),
+    JS_PSG("hostname", hostname_get, JSPROP_ENUMERATE),
+    JS_PSG("port", port_get, JSPROP_ENUMERATE),
+    JS_PSG("pathname", pathname_get, JSPROP_ENUMERATE),
+    JS_PSG("search", search_get, JSPROP_ENUMERATE),
+    JS_PSG("hash", hash_get, JSPROP_ENUMERATE),
+    JS_PSG("hasRegExpGroups", hasRegExpGroups_get, JSPROP_ENUMERATE),
+    JS_STRING_SYM_PS(toStringTag, "URLPattern", JSPROP_READONLY),
+    JS_PS_END,
+};
+
+// constructor(URLPatternInput input, USVString baseURL, optional URLPatternOptions options = {});
+// constructor(optional URLPatternInput input = {}, optional URLPatternOptions options = {});
+bool URLPattern::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
+  CTOR_HEADER("URLPattern", 0);
+
+  JS::HandleValue input = args.get(0);
+  bool has_base_url = !is_dictionary(args.get(1));
+  JS::HandleValue options_val = args.get(has_base_url ? 2 : 1);
+
+  bool ignore_case = false;
+  if (options_val.isObject()) {
+    JS::RootedObject options(cx, &options_val.toObject());
+    JS::RootedValue ignore_case_val(cx);
+    if (!JS_GetProperty(cx, options, "ignoreCase", &ignore_case_val)) {
+      return false;
+    }
+    ignore_case = JS::ToBoolean(ignore_case_val);
+  } else if (!options_val.isNullOrUndefined()) {
+    return api::throw_error(cx, api::Errors::TypeError, "URLPattern constructor", "options",
+                            "be an object or undefined");
+  }
+
+  // The cache key starts with the argument types and options, followed by the arguments.
+  std::string key(1, ignore_case ? 'i' : 'c');
+  host_api::HostString input_str;
+  host_api::HostString base_url_str;
+  Init init;
+  if (is_dictionary(input)) {
+    if (has_base_url) {
+      return api::throw_error(cx, BaseURLWithInitError, "URLPattern constructor");
+    }
+    if (!init.read(cx, input)) {
+      return false;
+    }
+    key += 'd';
+    init.append_to_key(key);
+  } else {
+    input_str = core::encode(cx, input);
+    if (!input_str) {
+      return false;
+    }
+    if (has_base_url) {
+      base_url_str = core::encode(cx, args.get(1));
+      if (!base_url_str) {
+        return false;
+      }
+    }
+    key += 's';
+    append_key(key, slice(input_str));
+    append_key(key, has_base_url ? slice(base_url_str) : jsurl::SpecSlice());
+  }
+
+  UniqueUrlPattern compiled;
+  bool cached = false;
+  if (auto entry = PATTERN_CACHE.find(key); entry != PATTERN_CACHE.end()) {
+    compiled.reset(jsurl::clone_url_pattern(entry->second.get()));
+    cached = true;
+  } else {
+    jsurl::SpecSlice error;
+    if (input_str) {
+      jsurl::SpecString spec(reinterpret_cast<uint8_t *>(input_str.ptr.get()), input_str.len,
+                             input_str.len);
+      jsurl::SpecSlice base = has_base_url ? slice(base_url_str) : jsurl::SpecSlice();
+      compiled.reset(jsurl::new_url_pattern_from_string(&spec, &base, ignore_case,
+                                                        matches_special_scheme, cx, &error));
+    } else {
+      compiled.reset(jsurl::new_url_pattern_from_init(&init.init, ignore_case,
+                                                      matches_special_scheme, cx, &error));
+    }
+    if (!compiled) {
+      return api::throw_error(cx, InvalidPatternError, std::string(view(error)).c_str());
+    }
+  }
+
+  JS::RootedObject self(cx, JS_NewObjectForConstructor(cx, &class_, args));
+  if (!self) {
+    return false;
+  }
+
+  // Only components that can't be matched by comparing strings need a RegExp object. Creating
+  // them is cheap for cached patterns, as the engine shares compiled regular expressions.
+  for (size_t i = 0; i < COMPONENT_COUNT; i++) {
+    auto info = component_info(compiled.get(), i);
+    if (info.kind != UrlPatternComponentKind::Regexp) {
+      continue;
+    }
+    JSObject *regexp =
+        JS::NewUCRegExpObject(cx, reinterpret_cast<const char16_t *>(info.regexp),
+                              info.regexp_len, regexp_flags(info.ignore_case));
+    if (!regexp) {
+      JS_ClearPendingException(cx);
+      return api::throw_error(cx, InvalidRegExpError, COMPONENT_NAMES[i]);
+    }
+    JS::SetReservedSlot(self, regexp_slot(i), JS::ObjectValue(*regexp));
+  }
+
+  if (!cached) {
+    if (PATTERN_CACHE.size() >= PATTERN_CACHE_CAPACITY) {
+      PATTERN_CACHE.clear();
+    }
+    PATTERN_CACHE.emplace(std::move(key), jsurl::clone_url_pattern(compiled.get()));
+  }
+
+  JS::SetReservedSlot(self, std::to_underlying(Slots::Pattern),
+                      JS::PrivateValue(const_cast<jsurl::JSUrlPattern *>(compiled.release())));
+  args.rval().setObject(*self);
+  return true;
+}
+
+void URLPattern::finalize(JS::GCContext *gcx, JSObject *self) {
+  JS::Value pattern_val = JS::GetReservedSlot(self, std::to_underlying(Slots::Pattern));
+  if (!pattern_val.isUndefined()) {
+    jsurl::free_url_pattern(static_cast<const jsurl::JSUrlPattern *>(pattern_val.toPrivate()));
+  }
+}
+
+bool URLPattern::init_class(JSContext *cx, JS::HandleObject global) {
+  return init_class_impl(cx, global);
+}
+
+bool install(api::Engine *engine) {
+  return URLPattern::init_class(engine->cx(), engine->global());
+}
+
+} // namespace builtins::web::url_pattern
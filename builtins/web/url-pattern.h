@@ -0,0 +1,84 @@
+#ifndef BUILTINS_WEB_URL_PATTERN_H
+#define BUILTINS_WEB_URL_PATTERN_H
+
+#include "builtin.h"
+#include "rust-url.h"
+
+
+
+namespace builtins::web::url_pattern {
+
+/**
+ * Implementation of the URL Pattern Standard's `URLPattern` class,
+ * https://urlpattern.spec.whatwg.org/.
+ *
+ * Patterns are parsed and compiled by the `rust-url` crate, and compiled patterns are cached, so
+ * creating the same pattern repeatedly, e.g. for a route table set up on every request, only
+ * compiles it once. The regular expressions the standard compiles components to are only created
+ * for components that aren't plain wildcards or literal strings, and are executed directly on the
+ * components of the matched URL, without creating any `URL` objects.
+ */
+class URLPattern : public BuiltinImpl<URLPattern, FinalizableClassPolicy> {
+  static bool test(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool exec(JSContext *cx, unsigned argc, JS::Value *vp);
+
+  static bool protocol_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool username_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool password_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool hostname_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool port_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool pathname_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool search_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool hash_get(JSContext *cx, unsigned argc, JS::Value *vp);
+  static bool hasRegExpGroups_get(JSContext *cx, unsigned argc, JS::Value *vp);
+
+public:
+  static constexpr const char *class_name = "URLPattern";
+
+  static constexpr size_t COMPONENT_COUNT = 8;
+
+  enum class Slots : uint8_t {
+    Pattern,
+    // One slot per component, holding its RegExp object, or `undefined` for components that are
+    // matched without one.
+    ProtocolRegExp,
+    UsernameRegExp,
+    PasswordRegExp,
+    HostnameRegExp,
+    PortRegExp,
+    PathnameRegExp,
+    SearchRegExp,
+    HashRegExp,
+    Count
+  };
+
+  static const JSFunctionSpec static_methods[];
+  static const JSPropertySpec static_properties[];
+  static const JSFunctionSpec methods[];
+  static const JSPropertySpec properties[];
+
+  static const unsigned ctor_length = 0;
+
+  static const jsurl::JSUrlPattern *pattern(JSObject *self);
+
+  /**
+   * Matches `input`, which is either a URL string or a `URLPatternInit` dictionary, against the
+   * pattern, and sets `rval` to the `URLPatternResult`, or to `null` if it doesn't match.
+   *
+   * If `test_only` is true, `rval` is set to a boolean instead, and no result is created.
+   */
+  static bool match(JSContext *cx, JS::HandleObject self, JS::HandleValue input,
+                    JS::HandleValue base_url, bool test_only, JS::MutableHandleValue rval);
+
+  static bool init_class(JSContext *cx, JS::HandleObject global);
+  static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
+  static void finalize(JS::GCContext *gcx, JSObject *self);
+};
+
+bool install(api::Engine *engine);
+
+} // namespace builtins::web::url_pattern
+
+
+
+#endif
@@ -12,6 +12,7 @@
 #include "js/AllocPolicy.h"
 #include "js/GCHashTable.h"
 #include "js/TypeDecls.h"
+#include "js/Vector.h"
 
 
 
@@ -763,25 +764,114 @@ bool URL::constructor(JSContext *cx, unsigned argc, JS::Value *vp) {
 
 DEF_ERR(InvalidURLError, JSEXN_TYPEERR, "URL constructor: {0} is not a valid URL.", 1);
 
-JSObject *URL::create(JSContext *cx, JS::HandleObject self, jsurl::SpecString url_str,
-                      const jsurl::JSUrl *base) {
-  jsurl::JSUrl *url = nullptr;
-  if (base) {
-    url = jsurl::new_jsurl_with_base(&url_str, base);
-  } else {
-    url = jsurl::new_jsurl(&url_str);
+namespace {
+
+struct JSUrlDeleter {
+  void operator()(jsurl::JSUrl *url) const { jsurl::free_jsurl(url); }
+};
+using UniqueJSUrl = std::unique_ptr<jsurl::JSUrl, JSUrlDeleter>;
+
+struct URLCacheEntry {
+  std::string input;
+  // The serialization of the base URL `input` was parsed against, if any.
+  std::string base;
+  // Whether `input` is the URL's own serialization. Parsing such an input results in the same
+  // URL regardless of the base, so the entry matches any base.
+  bool absolute;
+  UniqueJSUrl url;
+};
+
+// Ordered from most to least recently used.
+js::Vector<URLCacheEntry, 0, js::SystemAllocPolicy> URL_CACHE;
+
+// The result of the last parse that wasn't cached, kept alive until the next one.
+UniqueJSUrl URL_CACHE_UNCACHED;
+
+std::string_view href_view(const jsurl::JSUrl *url) {
+  jsurl::SpecSlice slice = jsurl::href(url);
+  return {reinterpret_cast<const char *>(slice.data), slice.len};
+}
+
+} // namespace
+
+const jsurl::JSUrl *URLCache::parse(std::string_view input, const jsurl::JSUrl *base) {
+  // The previous uncached result may be passed as `base`, so it's only freed once this is done.
+  UniqueJSUrl previous = std::move(URL_CACHE_UNCACHED);
+  std::string_view base_href = base ? href_view(base) : std::string_view();
+
+  for (size_t i = 0; i < URL_CACHE.length(); i++) {
+    auto &entry = URL_CACHE[i];
+    if (entry.input == input && (entry.absolute || entry.base == base_href)) {
+      std::rotate(URL_CACHE.begin(), URL_CACHE.begin() + i, URL_CACHE.begin() + i + 1);
+      return URL_CACHE[0].url.get();
+    }
   }
 
+  // The parser only reads the input, so it can be passed without copying it.
+  jsurl::SpecString spec(reinterpret_cast<uint8_t *>(const_cast<char *>(input.data())),
+                         input.size(), input.size());
+  UniqueJSUrl url(base ? jsurl::new_jsurl_with_base(&spec, base) : jsurl::new_jsurl(&spec));
   if (!url) {
+    return nullptr;
+  }
+
+  if (input.size() > MAX_INPUT_LENGTH) {
+    URL_CACHE_UNCACHED = std::move(url);
+    return URL_CACHE_UNCACHED.get();
+  }
+
+  bool absolute = href_view(url.get()) == input;
+  URLCacheEntry entry{.input = std::string(input),
+                      .base = absolute ? std::string() : std::string(base_href),
+                      .absolute = absolute,
+                      .url = std::move(url)};
+
+  // `base` may be the most recently used entry, but never the least recently used one, as long
+  // as the cache holds more than one entry.
+  if (URL_CACHE.length() == CAPACITY) {
+    URL_CACHE.popBack();
+  }
+  if (!URL_CACHE.insert(URL_CACHE.begin(), std::move(entry))) {
+    URL_CACHE_UNCACHED = std::move(entry.url);
+    return URL_CACHE_UNCACHED.get();
+  }
+
+  return URL_CACHE[0].url.get();
+}
+
+JSObject *URL::create(JSContext *cx, JS::HandleObject self, jsurl::SpecString url_str,
+                      const jsurl::JSUrl *base) {
+  const jsurl::JSUrl *parsed = URLCache::parse(url_str, base);
+  if (!parsed) {
     api::throw_error(cx, InvalidURLError, (char *)url_str.data);
     return nullptr;
   }
 
+  // URL objects can be mutated, so they get their own copy of the cached URL.
+  jsurl::JSUrl *url = jsurl::clone_jsurl(parsed);
   JS::SetReservedSlot(self, std::to_underlying(Slots::Url), JS::PrivateValue(url));
 
   return self;
 }
 
+JSString *URL::parse_and_serialize(JSContext *cx, JS::HandleValue url_val,
+                                   JS::HandleObject base_obj) {
+  auto str = core::encode(cx, url_val);
+  if (!str) {
+    return nullptr;
+  }
+
+  const jsurl::JSUrl *base = base_obj && is_instance(base_obj) ? url(base_obj) : nullptr;
+  const jsurl::JSUrl *parsed = URLCache::parse(str, base);
+  if (!parsed) {
+    api::throw_error(cx, InvalidURLError, str.ptr.get());
+    return nullptr;
+  }
+
+  auto href = href_view(parsed);
+  return JS_NewStringCopyUTF8N(cx, JS::UTF8Chars(href.data(), href.size()));
+}
+
 JSObject *URL::create(JSContext *cx, JS::HandleObject self, JS::HandleValue url_val,
                       const jsurl::JSUrl *base) {
   auto str = core::encode_spec_string(cx, url_val);
@@ -815,17 +905,18 @@ JSObject *URL::create(JSContext *cx, JS::HandleObject self, JS::HandleValue url_
     return create(cx, self, url_val, base_obj);
   }
 
-  jsurl::JSUrl *base = nullptr;
+  const jsurl::JSUrl *base = nullptr;
 
   if (!base_val.isUndefined()) {
-    auto str = core::encode_spec_string(cx, base_val);
-    if (!str.data) {
+    auto str = core::encode(cx, base_val);
+    if (!str) {
       return nullptr;
     }
 
-    base = jsurl::new_jsurl(&str);
+    // The base is owned by the cache, and stays valid while the input is parsed against it.
+    base = URLCache::parse(str, nullptr);
     if (!base) {
-      api::throw_error(cx, InvalidURLError, (char *)str.data);
+      api::throw_error(cx, InvalidURLError, str.ptr.get());
       return nullptr;
     }
   }
@@ -65,6 +65,27 @@ public:
   static bool constructor(JSContext *cx, unsigned argc, JS::Value *vp);
 };
 
+/// A small LRU cache of parsed URLs, keyed by the input string and the serialized base URL.
+///
+/// Handlers tend to parse the same few URLs on every request: the request's own URL, and a
+/// handful of routes and backend URLs. Cached URLs are shared, so they must never be mutated:
+/// `URL` objects get their own copy.
+class URLCache {
+public:
+  static constexpr size_t CAPACITY = 32;
+
+  /// Inputs longer than this are parsed, but not cached, so that e.g. large `data:` URLs aren't
+  /// kept alive.
+  static constexpr size_t MAX_INPUT_LENGTH = 2048;
+
+  /// Returns the result of parsing `input` against the optional `base`, or nullptr if it isn't
+  /// a valid URL.
+  ///
+  /// The result is owned by the cache, and only valid until the next call. It can be passed as
+  /// the `base` of that call, though.
+  static const jsurl::JSUrl *parse(std::string_view input, const jsurl::JSUrl *base);
+};
+
 class URL : public BuiltinImpl<URL, FinalizableClassPolicy> {
   static bool hash_set(JSContext *cx, unsigned argc, JS::Value *vp);
   static bool host_set(JSContext *cx, unsigned argc, JS::Value *vp);
@@ -124,6 +145,13 @@ public:
 
   static JSObject *getObjectURL(std::string &url);
 
+  /// Returns the serialization of the result of parsing `url_val` against the optional URL object
+  /// `base_obj`, throwing the same error as the URL constructor if it isn't a valid URL.
+  ///
+  /// Unlike creating a URL object and serializing that, this doesn't copy the parsed URL.
+  static JSString *parse_and_serialize(JSContext *cx, JS::HandleValue url_val,
+                                       JS::HandleObject base_obj);
+
   static JSObject *create(JSContext *cx, JS::HandleObject self, jsurl::SpecString url_str,
                           const jsurl::JSUrl *base = nullptr);
 
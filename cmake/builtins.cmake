@@ -58,6 +58,13 @@ add_builtin(
     INCLUDE_DIRS
         runtime)
 
+add_builtin(
+    builtins::web::url_pattern
+    SRC
+        builtins/web/url-pattern.cpp
+    INCLUDE_DIRS
+        runtime)
+
 add_builtin(builtins/web/console.cpp)
 
 add_builtin(builtins/web/performance.cpp)
@@ -86,6 +93,7 @@ add_builtin(
         builtins/web/streams/buf-reader.cpp
         builtins/web/streams/compression-stream.cpp
         builtins/web/streams/decompression-stream.cpp
+        builtins/web/streams/native-pipe.cpp
         builtins/web/streams/native-stream-sink.cpp
         builtins/web/streams/native-stream-source.cpp
         builtins/web/streams/streams.cpp
@@ -97,6 +105,7 @@ add_builtin(
 add_builtin(
     builtins::web::fetch
     SRC
+        builtins/web/fetch/body-tee.cpp
         builtins/web/fetch/fetch-api.cpp
         builtins/web/fetch/fetch-utils.cpp
         builtins/web/fetch/headers.cpp
@@ -119,6 +128,7 @@ add_builtin(
         builtins/web/crypto/crypto-key.cpp
         builtins/web/crypto/crypto-key-ec-components.cpp
         builtins/web/crypto/crypto-key-rsa-components.cpp
+        builtins/web/crypto/digest-stream.cpp
         builtins/web/crypto/json-web-key.cpp
         builtins/web/crypto/subtle-crypto.cpp
         builtins/web/crypto/uuid.cpp
@@ -18,6 +18,14 @@ list(APPEND CMAKE_CXX_FLAGS
         -fPIC -fno-rtti -fno-exceptions -fno-math-errno -pipe
         -fno-omit-frame-pointer -funwind-tables -m32
 )
+
+# Enables vectorized fast paths guarded by `__wasm_simd128__`. Off by default, as the resulting
+# module can only be run by engines supporting the SIMD128 proposal; the scalar paths are used
+# otherwise.
+option(ENABLE_WASM_SIMD "Compile with support for the wasm SIMD128 proposal" OFF)
+if (ENABLE_WASM_SIMD)
+    list(APPEND CMAKE_CXX_FLAGS -msimd128)
+endif()
 list(JOIN CMAKE_CXX_FLAGS " " CMAKE_CXX_FLAGS)
 
 list(APPEND CMAKE_C_FLAGS
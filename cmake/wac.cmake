@@ -0,0 +1,18 @@
+set(WAC_VERSION 0.6.1)
+
+# wac is used to compose test components with the components providing their non-WASI imports. Like cbindgen, it's
+# installed via cargo-binstall, which we install first, too.
+find_program(WAC_BIN wac)
+if(NOT WAC_BIN)
+    find_program(CARGO_BINSTALL_EXECUTABLE cargo-binstall)
+    if(NOT CARGO_BINSTALL_EXECUTABLE)
+        execute_process(
+                COMMAND curl -L --tlsv1.2 -sSf https://raw.githubusercontent.com/cargo-bins/cargo-binstall/main/install-from-binstall-release.sh
+                COMMAND bash
+        )
+    endif()
+    execute_process(
+            COMMAND cargo binstall -y wac-cli@${WAC_VERSION}
+    )
+    find_program(WAC_BIN wac HINTS $ENV{CARGO_HOME}/bin $ENV{HOME}/.cargo/bin REQUIRED)
+endif()
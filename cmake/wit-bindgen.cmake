@@ -0,0 +1,25 @@
+set(WIT_BINDGEN_VERSION 0.30.0)
+
+# wit-bindgen generates the C bindings for WIT worlds that are added to the build depending on its configuration. The
+# version matches the one the committed WASI bindings in `host-apis/` were generated with. Like cbindgen, it's
+# installed via cargo-binstall, which we install first, too.
+find_program(WIT_BINDGEN_BIN wit-bindgen)
+if(WIT_BINDGEN_BIN)
+    execute_process(COMMAND ${WIT_BINDGEN_BIN} --version OUTPUT_VARIABLE WIT_BINDGEN_INSTALLED_VERSION)
+    if(NOT WIT_BINDGEN_INSTALLED_VERSION MATCHES "wit-bindgen-cli ${WIT_BINDGEN_VERSION}")
+        unset(WIT_BINDGEN_BIN CACHE)
+    endif()
+endif()
+if(NOT WIT_BINDGEN_BIN)
+    find_program(CARGO_BINSTALL_EXECUTABLE cargo-binstall)
+    if(NOT CARGO_BINSTALL_EXECUTABLE)
+        execute_process(
+                COMMAND curl -L --tlsv1.2 -sSf https://raw.githubusercontent.com/cargo-bins/cargo-binstall/main/install-from-binstall-release.sh
+                COMMAND bash
+        )
+    endif()
+    execute_process(
+            COMMAND cargo binstall -y --force wit-bindgen-cli@${WIT_BINDGEN_VERSION}
+    )
+    find_program(WIT_BINDGEN_BIN wit-bindgen HINTS $ENV{CARGO_HOME}/bin $ENV{HOME}/.cargo/bin NO_DEFAULT_PATH REQUIRED)
+endif()
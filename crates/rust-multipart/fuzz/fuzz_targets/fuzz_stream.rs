@@ -0,0 +1,60 @@
+#![no_main]
+
+use libfuzzer_sys::fuzz_target;
+use multipart::{Event, MultipartParser, StreamingParser};
+
+type Entry = (Vec<u8>, Vec<u8>, Option<Vec<u8>>, Option<Vec<u8>>);
+
+fn parse_buffered(data: &[u8]) -> Option<Vec<Entry>> {
+    let mut parser = MultipartParser::new(data, "X-BOUNDARY");
+    let mut entries = Vec::new();
+
+    loop {
+        match parser.parse_next() {
+            Some(Ok(e)) => entries.push((
+                e.name().to_vec(),
+                e.value().to_vec(),
+                e.filename().map(<[u8]>::to_vec),
+                e.content_type().map(<[u8]>::to_vec),
+            )),
+            Some(Err(_)) => return None,
+            None => return Some(entries),
+        }
+    }
+}
+
+fn parse_streaming(data: &[u8], chunk_size: usize) -> Option<Vec<Entry>> {
+    let mut parser = StreamingParser::new(b"X-BOUNDARY")?;
+    let mut entries: Vec<Entry> = Vec::new();
+
+    for chunk in data.chunks(chunk_size) {
+        let mut input = chunk;
+        loop {
+            match parser.next(&mut input).ok()? {
+                Event::NeedMore => break,
+                Event::Part(info) => entries.push((
+                    info.name().to_vec(),
+                    Vec::new(),
+                    info.filename().map(<[u8]>::to_vec),
+                    info.content_type().map(<[u8]>::to_vec),
+                )),
+                Event::Data(bytes) => entries.last_mut()?.1.extend_from_slice(bytes),
+                Event::PartEnd => (),
+                Event::End => return Some(entries),
+            }
+        }
+    }
+
+    parser.finish().ok()?;
+    Some(entries)
+}
+
+// The streaming parser has to agree with the buffered one, regardless of how the input is split.
+fuzz_target!(|input: &[u8]| {
+    let Some((&chunk_size, data)) = input.split_first() else {
+        return;
+    };
+
+    let chunk_size = usize::from(chunk_size).max(1);
+    assert_eq!(parse_buffered(data), parse_streaming(data, chunk_size));
+});
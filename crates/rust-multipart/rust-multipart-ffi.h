@@ -21,8 +21,25 @@ enum class RetCode : uint8_t {
   Error = 2,
 };
 
+/// The kind of event returned by `multipart_stream_next`.
+enum class StreamEvent : uint8_t {
+  /// All input has been consumed.
+  NeedMore = 0,
+  /// A new part starts. Its name, filename and content type are set on the entry.
+  Part = 1,
+  /// A piece of the current part's content is set as the entry's value.
+  Data = 2,
+  /// The current part is complete.
+  PartEnd = 3,
+  /// The closing boundary has been reached.
+  End = 4,
+  Error = 5,
+};
+
 struct State;
 
+struct StreamState;
+
 /// A slice of bytes as seen from C.
 struct Slice {
   const uint8_t *data;
@@ -62,6 +79,37 @@ void multipart_parser_free(State *state);
 /// The caller must ensure that the state and entry are valid pointers.
 RetCode multipart_parser_next(State *state, Entry *entry);
 
+/// Creates a new streaming parser for a body using the given boundary.
+///
+/// # Safety
+///
+/// The caller must ensure that boundary is a valid pointer.
+StreamState *multipart_stream_new(const Slice *boundary);
+
+/// Free parser created by `multipart_stream_new`.
+///
+/// # Safety
+///
+/// The caller must ensure that the state is a valid parser pointer.
+void multipart_stream_free(StreamState *state);
+
+/// Parses the next event from input, advancing it past all bytes the parser is done with.
+///
+/// Slices stored in the entry point into either the input or the parser's own buffer, and are
+/// only valid until the next call.
+///
+/// # Safety
+///
+/// The caller must ensure that the state, input and entry are valid pointers.
+StreamEvent multipart_stream_next(StreamState *state, Slice *input, Entry *entry);
+
+/// Signals the end of the input. Returns `Error` if it ended in the middle of a part.
+///
+/// # Safety
+///
+/// The caller must ensure that the state is a valid parser pointer.
+RetCode multipart_stream_finish(const StreamState *state);
+
 /// Retrieve the boundary from content-type header
 ///
 /// # Safety
@@ -1,7 +1,7 @@
 use std::ffi::CStr;
 use std::os::raw::c_char;
 
-use crate::MultipartParser;
+use crate::{Event, MultipartParser, StreamingParser};
 
 /// A slice of bytes as seen from C.
 #[repr(C)]
@@ -31,6 +31,27 @@ pub struct State {
     inner: MultipartParser<'static>,
 }
 
+/// The kind of event returned by `multipart_stream_next`.
+#[repr(u8)]
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub enum StreamEvent {
+    /// All input has been consumed.
+    NeedMore = 0,
+    /// A new part starts. Its name, filename and content type are set on the entry.
+    Part = 1,
+    /// A piece of the current part's content is set as the entry's value.
+    Data = 2,
+    /// The current part is complete.
+    PartEnd = 3,
+    /// The closing boundary has been reached.
+    End = 4,
+    Error = 5,
+}
+
+pub struct StreamState {
+    inner: StreamingParser,
+}
+
 /// Crates a new parser with data provided.
 ///
 /// # Safety
@@ -127,6 +148,116 @@ pub unsafe extern "C" fn multipart_parser_next(
     }
 }
 
+/// Creates a new streaming parser for a body using the given boundary.
+///
+/// # Safety
+///
+/// The caller must ensure that boundary is a valid pointer.
+#[no_mangle]
+pub unsafe extern "C" fn multipart_stream_new(boundary: *const Slice) -> *mut StreamState {
+    if boundary.is_null() || (*boundary).data.is_null() {
+        return std::ptr::null_mut();
+    }
+
+    let boundary = std::slice::from_raw_parts((*boundary).data, (*boundary).len);
+    match StreamingParser::new(boundary) {
+        Some(inner) => Box::into_raw(Box::new(StreamState { inner })),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Free parser created by `multipart_stream_new`.
+///
+/// # Safety
+///
+/// The caller must ensure that the state is a valid parser pointer.
+#[no_mangle]
+pub unsafe extern "C" fn multipart_stream_free(state: *mut StreamState) {
+    if state.is_null() {
+        return;
+    }
+
+    let _ = Box::from_raw(state);
+}
+
+/// Parses the next event from input, advancing it past all bytes the parser is done with.
+///
+/// Slices stored in the entry point into either the input or the parser's own buffer, and are
+/// only valid until the next call.
+///
+/// # Safety
+///
+/// The caller must ensure that the state, input and entry are valid pointers.
+#[no_mangle]
+pub unsafe extern "C" fn multipart_stream_next(
+    state: *mut StreamState,
+    input: *mut Slice,
+    entry: *mut Entry,
+) -> StreamEvent {
+    if state.is_null() || input.is_null() || entry.is_null() {
+        return StreamEvent::Error;
+    }
+
+    let state = &mut *state;
+    let mut data: &[u8] = if (*input).len == 0 {
+        &[]
+    } else {
+        std::slice::from_raw_parts((*input).data, (*input).len)
+    };
+
+    let event = match state.inner.next(&mut data) {
+        Ok(Event::NeedMore) => StreamEvent::NeedMore,
+        Ok(Event::Part(info)) => {
+            (*entry).name = to_slice(Some(info.name()));
+            (*entry).value = to_slice(None);
+            (*entry).filename = to_slice(info.filename());
+            (*entry).content_type = to_slice(info.content_type());
+            StreamEvent::Part
+        }
+        Ok(Event::Data(bytes)) => {
+            (*entry).value = to_slice(Some(bytes));
+            StreamEvent::Data
+        }
+        Ok(Event::PartEnd) => StreamEvent::PartEnd,
+        Ok(Event::End) => StreamEvent::End,
+        Err(_) => return StreamEvent::Error,
+    };
+
+    (*input).data = data.as_ptr();
+    (*input).len = data.len();
+    event
+}
+
+/// Signals the end of the input. Returns `Error` if it ended in the middle of a part.
+///
+/// # Safety
+///
+/// The caller must ensure that the state is a valid parser pointer.
+#[no_mangle]
+pub unsafe extern "C" fn multipart_stream_finish(state: *const StreamState) -> RetCode {
+    if state.is_null() {
+        return RetCode::Error;
+    }
+
+    match (*state).inner.finish() {
+        Ok(()) => RetCode::Eos,
+        Err(_) => RetCode::Error,
+    }
+}
+
+fn to_slice(bytes: Option<&[u8]>) -> Slice {
+    match bytes {
+        Some(b) => Slice {
+            data: b.as_ptr(),
+            len: b.len(),
+        },
+        None => Slice {
+            data: std::ptr::null(),
+            len: 0,
+        },
+    }
+}
+
 #[no_mangle]
 /// Retrieve the boundary from content-type header
 ///
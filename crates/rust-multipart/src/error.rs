@@ -1,10 +1,13 @@
 use std::fmt::Display;
 
-#[derive(Copy, Clone, Debug)]
-pub(crate) enum Error {
+#[derive(Copy, Clone, Debug, Eq, PartialEq)]
+pub enum Error {
     MissingName,
     InvalidBoundary,
     MissingContentDisposition,
+    InvalidHeaders,
+    HeadersTooLarge,
+    UnexpectedEnd,
 }
 
 impl Display for Error {
@@ -19,6 +22,15 @@ impl Display for Error {
             Error::MissingContentDisposition => {
                 write!(f, "content-disposition is missing from headers")
             }
+            Error::InvalidHeaders => {
+                write!(f, "Invalid part headers")
+            }
+            Error::HeadersTooLarge => {
+                write!(f, "Part headers exceed the maximum length")
+            }
+            Error::UnexpectedEnd => {
+                write!(f, "Body ended before the closing boundary")
+            }
         }
     }
 }
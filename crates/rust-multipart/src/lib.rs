@@ -4,8 +4,12 @@ use winnow::Stateful;
 
 mod error;
 mod parser;
+mod stream;
 mod trivia;
 
+pub use error::Error;
+pub use stream::{Event, PartInfo, StreamingParser, MAX_HEADER_BLOCK_LENGTH};
+
 #[cfg(feature = "capi")]
 pub mod capi;
 
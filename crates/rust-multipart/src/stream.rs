@@ -0,0 +1,300 @@
+use winnow::prelude::*;
+
+use crate::error::Error;
+use crate::parser::entry_info;
+use crate::{EntryInfo, Stream};
+
+/// The maximum length of a part's header block. Longer blocks are rejected, so that a body can't
+/// force the parser to buffer an unbounded amount of data.
+pub const MAX_HEADER_BLOCK_LENGTH: usize = 64 * 1024;
+
+/// An event produced by [`StreamingParser::next`].
+#[derive(Debug, Copy, Clone, Eq, PartialEq)]
+pub enum Event<'a> {
+    /// All input has been consumed. Feed more data, or call [`StreamingParser::finish`] if there
+    /// is none.
+    NeedMore,
+    /// The headers of a new part. The part's content follows as zero or more `Data` events.
+    Part(PartInfo<'a>),
+    /// A piece of the current part's content.
+    Data(&'a [u8]),
+    /// The end of the current part.
+    PartEnd,
+    /// The closing boundary. Any input following it is ignored.
+    End,
+}
+
+/// The headers of a part, as reported by [`Event::Part`].
+#[derive(Debug, Copy, Clone, Eq, PartialEq)]
+pub struct PartInfo<'a>(EntryInfo<'a>);
+
+impl PartInfo<'_> {
+    /// Returns the `name` attribute from the `Content-Disposition` header.
+    pub fn name(&self) -> &[u8] {
+        self.0.name
+    }
+
+    /// Returns the optional `filename` attribute from the `Content-Disposition` header.
+    pub fn filename(&self) -> Option<&[u8]> {
+        self.0.filename
+    }
+
+    /// Returns the optional `Content-Type` header value.
+    pub fn content_type(&self) -> Option<&[u8]> {
+        self.0.content_type
+    }
+}
+
+#[derive(Debug, Copy, Clone, Eq, PartialEq)]
+enum State {
+    /// Looking for the first boundary. Everything before it is ignored.
+    Preamble,
+    /// Right after a boundary: either the closing `--`, or the end of the boundary line.
+    Delimiter,
+    /// Reading a part's header block.
+    Headers,
+    /// Reading a part's content, up to the next boundary.
+    Body,
+    /// The closing boundary has been read.
+    Done,
+}
+
+/// What a single parsing step produced, with offsets relative to the parsed view.
+enum Step {
+    NeedMore,
+    Part(usize, usize),
+    Data(usize, usize),
+    PartEnd,
+    End,
+}
+
+/// A multipart/form-data parser that is fed its input in chunks, as it becomes available.
+///
+/// The parser accepts the same syntax as [`MultipartParser`](crate::MultipartParser), but only
+/// buffers input it can't make a decision on yet: an incomplete header block, or the end of a
+/// chunk that might be the start of a boundary. Part contents are otherwise returned as slices
+/// of the caller's input, without being copied, so memory use is bounded by the size of the
+/// largest header block instead of the size of the body.
+#[derive(Debug, Clone)]
+pub struct StreamingParser {
+    boundary: Vec<u8>,
+    state: State,
+    /// Input carried over from previous chunks.
+    buffer: Vec<u8>,
+    /// Length of the prefix of `buffer` that has been handed out by the previous event, and can
+    /// be dropped by the next call.
+    consumed: usize,
+}
+
+impl StreamingParser {
+    /// Creates a parser for a body using the given boundary, or `None` if it's empty.
+    pub fn new(boundary: &[u8]) -> Option<Self> {
+        if boundary.is_empty() {
+            return None;
+        }
+
+        Some(Self {
+            boundary: boundary.to_vec(),
+            state: State::Preamble,
+            buffer: Vec::new(),
+            consumed: 0,
+        })
+    }
+
+    /// Parses the next event from `input`, advancing it past all bytes the parser is done with.
+    ///
+    /// Slices contained in the returned event point into either `input` or the parser's own
+    /// buffer, and are only valid until the next call.
+    pub fn next<'a, 'i: 'a>(&'a mut self, input: &mut &'i [u8]) -> Result<Event<'a>, Error> {
+        self.buffer.drain(..self.consumed);
+        self.consumed = 0;
+
+        if self.buffer.is_empty() {
+            let view: &'i [u8] = input;
+            let (step, consumed) = advance(&mut self.state, &self.boundary, view)?;
+            if let Step::NeedMore = step {
+                check_header_length(self.state, view.len() - consumed)?;
+                self.buffer.extend_from_slice(&view[consumed..]);
+                *input = &[];
+            } else {
+                *input = &view[consumed..];
+            }
+            return self.event(step, view);
+        }
+
+        // Some input was carried over. Only append as much of the new input to it as is needed
+        // to find a boundary that might start in the buffered part. If the boundary turns out to
+        // start in the new input instead, all of the buffer is handed out, and the new input is
+        // read from directly once the buffer has been drained.
+        let buffered = self.buffer.len();
+        let lookahead = input.len().min(self.boundary.len() + 3);
+        self.buffer.extend_from_slice(&input[..lookahead]);
+
+        let (mut step, mut consumed) = advance(&mut self.state, &self.boundary, &self.buffer)?;
+        if let Step::NeedMore = step {
+            // More than the lookahead is needed to make progress, so take all of the input.
+            self.buffer.drain(..consumed);
+            consumed = 0;
+            if lookahead < input.len() {
+                self.buffer.extend_from_slice(&input[lookahead..]);
+                (step, consumed) = advance(&mut self.state, &self.boundary, &self.buffer)?;
+            }
+            *input = &[];
+            if let Step::NeedMore = step {
+                self.buffer.drain(..consumed);
+                check_header_length(self.state, self.buffer.len())?;
+                return Ok(Event::NeedMore);
+            }
+            self.consumed = consumed;
+        } else if consumed <= buffered {
+            self.buffer.truncate(buffered);
+            self.consumed = consumed;
+        } else {
+            self.buffer.truncate(consumed);
+            self.consumed = consumed;
+            *input = &input[consumed - buffered..];
+        }
+
+        self.event(step, &self.buffer)
+    }
+
+    /// Signals the end of the input. Fails if it ended in the middle of a part.
+    ///
+    /// A body without any boundary is treated as having no parts.
+    pub fn finish(&self) -> Result<(), Error> {
+        match self.state {
+            State::Preamble | State::Done => Ok(()),
+            _ => Err(Error::UnexpectedEnd),
+        }
+    }
+
+    fn event<'a>(&'a self, step: Step, view: &'a [u8]) -> Result<Event<'a>, Error> {
+        Ok(match step {
+            Step::NeedMore => Event::NeedMore,
+            Step::Part(start, end) => {
+                let mut stream = Stream {
+                    input: &view[start..end],
+                    state: self.boundary.as_slice().into(),
+                };
+                let info = entry_info
+                    .parse_next(&mut stream)
+                    .map_err(|_| Error::InvalidHeaders)?;
+                if !stream.input.is_empty() {
+                    return Err(Error::InvalidHeaders);
+                }
+                Event::Part(PartInfo(info))
+            }
+            Step::Data(start, end) => Event::Data(&view[start..end]),
+            Step::PartEnd => Event::PartEnd,
+            Step::End => Event::End,
+        })
+    }
+}
+
+/// Advances the state machine over `view`, returning the resulting step and the number of
+/// bytes of `view` it consumed.
+fn advance(state: &mut State, boundary: &[u8], view: &[u8]) -> Result<(Step, usize), Error> {
+    // Bytes held back at the end of a part's content, as they might be the start of a
+    // boundary, including the CRLF and optional `--` preceding it.
+    let hold_back = boundary.len() + 3;
+    let mut pos = 0;
+
+    loop {
+        let rest = &view[pos..];
+        match *state {
+            State::Preamble => match find(rest, boundary) {
+                Some(idx) => {
+                    pos += idx + boundary.len();
+                    *state = State::Delimiter;
+                }
+                None => {
+                    let skipped = rest.len().saturating_sub(boundary.len() - 1);
+                    return Ok((Step::NeedMore, pos + skipped));
+                }
+            },
+            State::Delimiter => {
+                if rest.len() < 2 {
+                    return Ok((Step::NeedMore, pos));
+                }
+                if rest.starts_with(b"--") {
+                    *state = State::Done;
+                    return Ok((Step::End, pos + 2));
+                }
+
+                let ws = rest
+                    .iter()
+                    .take_while(|&&c| c == b' ' || c == b'\t')
+                    .count();
+                match &rest[ws..] {
+                    [] | [b'\r'] => return Ok((Step::NeedMore, pos)),
+                    [b'\r', b'\n', ..] => {
+                        pos += ws + 2;
+                        *state = State::Headers;
+                    }
+                    _ => return Err(Error::InvalidBoundary),
+                }
+            }
+            State::Headers => {
+                return match header_block_length(rest) {
+                    Some(len) => {
+                        check_header_length(*state, len)?;
+                        *state = State::Body;
+                        Ok((Step::Part(pos, pos + len), pos + len))
+                    }
+                    None => Ok((Step::NeedMore, pos)),
+                };
+            }
+            State::Body => {
+                let Some(idx) = find(rest, boundary) else {
+                    let safe = rest.len().saturating_sub(hold_back);
+                    if safe == 0 {
+                        return Ok((Step::NeedMore, pos));
+                    }
+                    return Ok((Step::Data(pos, pos + safe), pos + safe));
+                };
+
+                // The content is followed by a CRLF, and optionally `--`, before the boundary.
+                let end = if rest[..idx].ends_with(b"\r\n--") {
+                    idx - 4
+                } else if rest[..idx].ends_with(b"\r\n") {
+                    idx - 2
+                } else {
+                    return Err(Error::InvalidBoundary);
+                };
+
+                if end > 0 {
+                    return Ok((Step::Data(pos, pos + end), pos + end));
+                }
+                *state = State::Delimiter;
+                return Ok((Step::PartEnd, pos + idx + boundary.len()));
+            }
+            State::Done => return Ok((Step::End, view.len())),
+        }
+    }
+}
+
+fn check_header_length(state: State, len: usize) -> Result<(), Error> {
+    if state == State::Headers && len > MAX_HEADER_BLOCK_LENGTH {
+        return Err(Error::HeadersTooLarge);
+    }
+    Ok(())
+}
+
+/// Returns the length of the header block at the start of `input`, including the terminating
+/// empty line, or `None` if it's incomplete.
+fn header_block_length(input: &[u8]) -> Option<usize> {
+    let mut pos = 0;
+    loop {
+        let line_len = find(&input[pos..], b"\r\n")?;
+        let line = &input[pos..pos + line_len];
+        pos += line_len + 2;
+        if line.iter().all(|&c| c == b' ' || c == b'\t') {
+            return Some(pos);
+        }
+    }
+}
+
+fn find(haystack: &[u8], needle: &[u8]) -> Option<usize> {
+    use winnow::stream::FindSlice;
+    haystack.find_slice(needle).map(|range| range.start)
+}
@@ -1,4 +1,39 @@
-use multipart::MultipartParser;
+use multipart::{Error, Event, MultipartParser, StreamingParser};
+
+#[derive(Debug, PartialEq)]
+struct ParsedEntry {
+    name: Vec<u8>,
+    body: Vec<u8>,
+    filename: Option<Vec<u8>>,
+    content_type: Option<Vec<u8>>,
+}
+
+/// Parses `data` with a `StreamingParser`, feeding it in chunks of `chunk_size` bytes.
+fn parse_streaming(data: &[u8], boundary: &str, chunk_size: usize) -> Result<Vec<ParsedEntry>, Error> {
+    let mut parser = StreamingParser::new(boundary.as_bytes()).expect("boundary is valid");
+    let mut entries: Vec<ParsedEntry> = Vec::new();
+
+    for chunk in data.chunks(chunk_size) {
+        let mut input = chunk;
+        loop {
+            match parser.next(&mut input)? {
+                Event::NeedMore => break,
+                Event::Part(info) => entries.push(ParsedEntry {
+                    name: info.name().to_vec(),
+                    body: Vec::new(),
+                    filename: info.filename().map(<[u8]>::to_vec),
+                    content_type: info.content_type().map(<[u8]>::to_vec),
+                }),
+                Event::Data(bytes) => entries.last_mut().unwrap().body.extend_from_slice(bytes),
+                Event::PartEnd => (),
+                Event::End => return Ok(entries),
+            }
+        }
+    }
+
+    parser.finish()?;
+    Ok(entries)
+}
 
 #[derive(Debug, PartialEq)]
 struct ExpectedEntry<'a> {
@@ -70,6 +105,23 @@ impl<'a> TestCase<'a> {
             self.expected_entries.len(),
             "Not all expected entries were parsed"
         );
+
+        // The streaming parser has to produce the same entries, regardless of how the input is
+        // split into chunks.
+        for chunk_size in 1..=self.data.len() {
+            let entries = parse_streaming(self.data, self.boundary, chunk_size)
+                .unwrap_or_else(|e| panic!("Streaming parse failed with chunk size {chunk_size}: {e}"));
+            let entries: Vec<_> = entries
+                .iter()
+                .map(|e| ExpectedEntry {
+                    name: &e.name,
+                    body: &e.body,
+                    filename: e.filename.as_deref(),
+                    content_type: e.content_type.as_deref(),
+                })
+                .collect();
+            assert_eq!(entries, self.expected_entries, "chunk size {chunk_size}");
+        }
     }
 }
 
@@ -180,3 +232,73 @@ fn test_malformed() {
     assert!(parser.parse_next().unwrap().is_ok());
     assert!(parser.parse_next().unwrap().is_err());
 }
+
+#[test]
+fn test_streaming_malformed() {
+    let data = b"--Boundary_with_capital_letters\r\nContent-Type: application/json\r\nContent-Disposition: form-data; name=\"does_this_work\"\r\n\r\nYES\r\n--Boundary_with_capital_letters-Random junk";
+
+    for chunk_size in 1..=data.len() {
+        assert_eq!(
+            parse_streaming(data, "--Boundary_with_capital_letters", chunk_size),
+            Err(Error::InvalidBoundary)
+        );
+    }
+}
+
+#[test]
+fn test_streaming_truncated() {
+    let data = b"--X-BOUNDARY\r\nContent-Disposition: form-data; name=\"my_text_field\"\r\n\r\nabcd\r\n--X-BOUND";
+
+    for chunk_size in 1..=data.len() {
+        assert_eq!(
+            parse_streaming(data, "X-BOUNDARY", chunk_size),
+            Err(Error::UnexpectedEnd)
+        );
+    }
+}
+
+#[test]
+fn test_streaming_headers_too_large() {
+    let mut data = b"--X-BOUNDARY\r\nContent-Disposition: form-data; name=a\r\nX-Padding: ".to_vec();
+    data.resize(data.len() + multipart::MAX_HEADER_BLOCK_LENGTH, b'a');
+
+    assert_eq!(
+        parse_streaming(&data, "X-BOUNDARY", 4096),
+        Err(Error::HeadersTooLarge)
+    );
+}
+
+#[test]
+fn test_streaming_large_part_is_not_copied() {
+    let content: Vec<u8> = (0..1024 * 1024).map(|i| b'a' + (i % 26) as u8).collect();
+    let mut data = b"--X-BOUNDARY\r\nContent-Disposition: form-data; name=file; filename=a.bin\r\n\r\n".to_vec();
+    data.extend_from_slice(&content);
+    data.extend_from_slice(b"\r\n--X-BOUNDARY--\r\n");
+
+    let mut parser = StreamingParser::new(b"X-BOUNDARY").unwrap();
+    let mut body = Vec::new();
+    let mut copied = 0;
+
+    for chunk in data.chunks(64 * 1024) {
+        let range = chunk.as_ptr_range();
+        let mut input = chunk;
+        loop {
+            match parser.next(&mut input).unwrap() {
+                Event::NeedMore | Event::End => break,
+                Event::Data(bytes) => {
+                    if !range.contains(&bytes.as_ptr()) {
+                        copied += bytes.len();
+                    }
+                    body.extend_from_slice(bytes);
+                }
+                Event::Part(_) | Event::PartEnd => (),
+            }
+        }
+    }
+
+    assert!(parser.finish().is_ok());
+    assert_eq!(body, content);
+    // Only the bytes held back at the end of each chunk, and the start of the body following the
+    // header block, are handed out from the parser's buffer.
+    assert!(copied < 17 * (64 * 1024 / 16), "{copied} bytes were copied");
+}
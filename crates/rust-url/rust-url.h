@@ -22,8 +22,45 @@
 
 namespace jsurl {
 
+/// The result of testing a regular expression against the special schemes.
+enum class SpecialSchemeMatch : uint8_t {
+  NoMatch,
+  Match,
+  /// The regular expression is invalid.
+  Error,
+};
+
+/// The components of a URL, in the order used by the URL Pattern Standard.
+enum class UrlPatternComponent : uint8_t {
+  Protocol,
+  Username,
+  Password,
+  Hostname,
+  Port,
+  Pathname,
+  Search,
+  Hash,
+};
+
+/// How a compiled component has to be matched.
+enum class UrlPatternComponentKind : uint8_t {
+  /// The component's regular expression has to be executed.
+  Regexp,
+  /// The component matches any input, which is its only group.
+  Wildcard,
+  /// The component only matches its literal string, and has no groups.
+  Literal,
+};
+
 struct JSUrl;
 
+/// A compiled URL pattern. Patterns are immutable and reference counted, so that compiled
+/// patterns can be cached and shared between `URLPattern` objects.
+struct JSUrlPattern;
+
+/// The components of a `URLPatternInit` that's being matched against a pattern.
+struct JSUrlPatternInput;
+
 struct JSUrlSearchParams;
 
 /// This type exists to transfer String-likes over FFI.
@@ -88,6 +125,34 @@ struct JSSearchParam {
 
 };
 
+/// Tests whether the given UTF-16 encoded regular expression matches any of the special schemes.
+///
+/// The URL Pattern Standard uses this to decide how pathnames are parsed, so the embedder's
+/// regular expression engine has to be called back during compilation.
+using SpecialSchemeMatcher = SpecialSchemeMatch(*)(void *data, const uint16_t *regexp, size_t len);
+
+/// A `URLPatternInit` dictionary. Members that aren't present have a null `data` pointer.
+struct UrlPatternInit {
+  SpecSlice components[8];
+  SpecSlice base_url;
+};
+
+/// Information about one of a pattern's components, borrowed from the pattern.
+struct UrlPatternComponentInfo {
+  UrlPatternComponentKind kind;
+  /// The normalized pattern string.
+  SpecSlice pattern;
+  /// The UTF-16 encoded regular expression, which has to be executed with the `v` flag, and
+  /// the `i` flag if `ignore_case` is set.
+  const uint16_t *regexp;
+  size_t regexp_len;
+  bool ignore_case;
+  /// For `Literal` components, the only string they match.
+  SpecSlice literal;
+  size_t group_count;
+  bool has_regexp_groups;
+};
+
 template<typename T>
 struct CVec {
   T *ptr;
@@ -111,6 +176,9 @@ JSUrl *new_jsurl(const SpecString *spec);
 
 JSUrl *new_jsurl_with_base(const SpecString *spec, const JSUrl *base);
 
+/// Returns a copy of `url`, without any associated search params object.
+JSUrl *clone_jsurl(const JSUrl *url);
+
 void free_jsurl(JSUrl *url);
 
 SpecSlice authority(const JSUrl *url);
@@ -191,6 +259,51 @@ void params_sort(JSUrlSearchParams *params);
 
 SpecSlice params_to_string(const JSUrlSearchParams *params);
 
+/// Compiles a pattern given as a string, relative to the optional `base_url`, which is absent if
+/// its `data` pointer is null.
+///
+/// Returns null and sets `error` to a description of the problem if the pattern is invalid.
+const JSUrlPattern *new_url_pattern_from_string(const SpecString *input,
+                                                const SpecSlice *base_url,
+                                                bool ignore_case,
+                                                SpecialSchemeMatcher matcher,
+                                                void *data,
+                                                SpecSlice *error);
+
+/// Compiles a pattern given as a `URLPatternInit` dictionary.
+///
+/// Returns null and sets `error` to a description of the problem if the pattern is invalid.
+const JSUrlPattern *new_url_pattern_from_init(const UrlPatternInit *init,
+                                              bool ignore_case,
+                                              SpecialSchemeMatcher matcher,
+                                              void *data,
+                                              SpecSlice *error);
+
+/// Returns a new reference to `pattern`.
+const JSUrlPattern *clone_url_pattern(const JSUrlPattern *pattern);
+
+void free_url_pattern(const JSUrlPattern *pattern);
+
+void url_pattern_component(const JSUrlPattern *pattern,
+                           UrlPatternComponent component,
+                           UrlPatternComponentInfo *info);
+
+/// Returns the name of the group with the given index in the component's regular expression.
+SpecSlice url_pattern_group_name(const JSUrlPattern *pattern,
+                                 UrlPatternComponent component,
+                                 size_t index);
+
+/// Processes a `URLPatternInit` dictionary so it can be matched against a pattern.
+///
+/// Returns null if the dictionary doesn't describe a valid URL, which means that it doesn't match
+/// any pattern.
+JSUrlPatternInput *new_url_pattern_input(const UrlPatternInit *init);
+
+SpecSlice url_pattern_input_component(const JSUrlPatternInput *input,
+                                      UrlPatternComponent component);
+
+void free_url_pattern_input(JSUrlPatternInput *input);
+
 }  // extern "C"
 
 }  // namespace jsurl
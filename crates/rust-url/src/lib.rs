@@ -6,6 +6,8 @@ use std::marker::PhantomData;
 use std::slice;
 use url::{form_urlencoded, quirks, Url};
 
+pub mod pattern;
+
 pub struct JSUrl {
     url: Url,
     params: *mut JSUrlSearchParams,
@@ -97,6 +99,15 @@ pub unsafe extern "C" fn new_jsurl_with_base(spec: &SpecString, base: &JSUrl) ->
     }
 }
 
+/// Returns a copy of `url`, without any associated search params object.
+#[no_mangle]
+pub extern "C" fn clone_jsurl(url: &JSUrl) -> *mut JSUrl {
+    Box::into_raw(Box::new(JSUrl {
+        url: url.url.clone(),
+        params: std::ptr::null_mut(),
+    }))
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn free_jsurl(url: *mut JSUrl) {
     if url.is_null() {
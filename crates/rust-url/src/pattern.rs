@@ -0,0 +1,1771 @@
+//! An implementation of the parsing and compilation algorithms of the URL Pattern Standard,
+//! https://urlpattern.spec.whatwg.org/.
+//!
+//! Patterns are compiled into ECMAScript regular expressions, as the standard requires, but those
+//! are executed by the embedder's regular expression engine. To avoid that where possible,
+//! components that are plain wildcards or literal strings are reported as such, so they can be
+//! matched without running a regular expression at all.
+
+use std::ffi::c_void;
+use std::rc::Rc;
+
+use url::{quirks, Url};
+
+use crate::{SpecSlice, SpecString};
+
+type Error = &'static str;
+
+/// The components of a URL, in the order used by the URL Pattern Standard.
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+pub enum UrlPatternComponent {
+    Protocol,
+    Username,
+    Password,
+    Hostname,
+    Port,
+    Pathname,
+    Search,
+    Hash,
+}
+
+use UrlPatternComponent::*;
+
+const COMPONENTS: [UrlPatternComponent; 8] = [
+    Protocol, Username, Password, Hostname, Port, Pathname, Search, Hash,
+];
+
+const SPECIAL_SCHEMES: [(&str, Option<&str>); 6] = [
+    ("ftp", Some("21")),
+    ("file", None),
+    ("http", Some("80")),
+    ("https", Some("443")),
+    ("ws", Some("80")),
+    ("wss", Some("443")),
+];
+
+fn is_special_scheme(scheme: &str) -> bool {
+    SPECIAL_SCHEMES.iter().any(|(s, _)| *s == scheme)
+}
+
+fn default_port(scheme: &str) -> Option<&'static str> {
+    SPECIAL_SCHEMES
+        .iter()
+        .find(|(s, _)| *s == scheme)
+        .and_then(|(_, port)| *port)
+}
+
+// Tokenizer, https://urlpattern.spec.whatwg.org/#tokenizing
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+enum TokenType {
+    Open,
+    Close,
+    Regexp,
+    Name,
+    Char,
+    EscapedChar,
+    OtherModifier,
+    Asterisk,
+    End,
+    InvalidChar,
+}
+
+#[derive(Clone, Debug)]
+struct Token {
+    ty: TokenType,
+    index: usize,
+    value: String,
+}
+
+#[derive(Clone, Copy, Eq, PartialEq)]
+enum TokenizePolicy {
+    Strict,
+    Lenient,
+}
+
+struct Tokenizer<'a> {
+    input: &'a [char],
+    policy: TokenizePolicy,
+    tokens: Vec<Token>,
+    index: usize,
+    next_index: usize,
+    code_point: char,
+}
+
+impl Tokenizer<'_> {
+    fn get_next_code_point(&mut self) {
+        self.code_point = self.input[self.next_index];
+        self.next_index += 1;
+    }
+
+    fn seek_and_get_next_code_point(&mut self, index: usize) {
+        self.next_index = index;
+        self.get_next_code_point();
+    }
+
+    fn add_token(&mut self, ty: TokenType, next: usize, value_pos: usize, value_len: usize) {
+        self.tokens.push(Token {
+            ty,
+            index: self.index,
+            value: self.input[value_pos..value_pos + value_len].iter().collect(),
+        });
+        self.index = next;
+    }
+
+    fn add_token_with_default_length(&mut self, ty: TokenType, next: usize, value_pos: usize) {
+        self.add_token(ty, next, value_pos, next - value_pos);
+    }
+
+    fn add_token_with_default_position_and_length(&mut self, ty: TokenType) {
+        self.add_token_with_default_length(ty, self.next_index, self.index);
+    }
+
+    fn process_tokenizing_error(&mut self, next: usize, value_pos: usize) -> Result<(), Error> {
+        if self.policy == TokenizePolicy::Strict {
+            return Err("invalid pattern syntax");
+        }
+        self.add_token_with_default_length(TokenType::InvalidChar, next, value_pos);
+        Ok(())
+    }
+
+    /// Tokenizes a regular expression group, with the tokenizer positioned at its opening `(`.
+    fn tokenize_regexp(&mut self) -> Result<(), Error> {
+        let len = self.input.len();
+        let mut depth = 1;
+        let mut position = self.next_index;
+        let start = position;
+        while position < len {
+            self.seek_and_get_next_code_point(position);
+            let invalid = !self.code_point.is_ascii()
+                || (position == start && self.code_point == '?')
+                || (self.code_point == '\\' && position == len - 1);
+            if invalid {
+                return self.process_tokenizing_error(start, self.index);
+            }
+            if self.code_point == '\\' {
+                self.get_next_code_point();
+                if !self.code_point.is_ascii() {
+                    return self.process_tokenizing_error(start, self.index);
+                }
+                position = self.next_index;
+                continue;
+            }
+            if self.code_point == ')' {
+                depth -= 1;
+                if depth == 0 {
+                    position = self.next_index;
+                    break;
+                }
+            } else if self.code_point == '(' {
+                depth += 1;
+                if position == len - 1 {
+                    return self.process_tokenizing_error(start, self.index);
+                }
+                let temporary_position = self.next_index;
+                self.get_next_code_point();
+                // Only non-capturing groups are allowed.
+                if self.code_point != '?' {
+                    return self.process_tokenizing_error(start, self.index);
+                }
+                self.next_index = temporary_position;
+            }
+            position = self.next_index;
+        }
+
+        if depth != 0 || position - start - 1 == 0 {
+            return self.process_tokenizing_error(start, self.index);
+        }
+        self.add_token(TokenType::Regexp, position, start, position - start - 1);
+        Ok(())
+    }
+}
+
+fn is_valid_name_code_point(c: char, first: bool) -> bool {
+    if first {
+        c == '$' || c == '_' || unicode_ident::is_xid_start(c)
+    } else {
+        c == '$' || c == '\u{200C}' || c == '\u{200D}' || unicode_ident::is_xid_continue(c)
+    }
+}
+
+fn tokenize(input: &[char], policy: TokenizePolicy) -> Result<Vec<Token>, Error> {
+    let mut tokenizer = Tokenizer {
+        input,
+        policy,
+        tokens: Vec::new(),
+        index: 0,
+        next_index: 0,
+        code_point: '\0',
+    };
+
+    while tokenizer.index < input.len() {
+        tokenizer.seek_and_get_next_code_point(tokenizer.index);
+        match tokenizer.code_point {
+            '*' => tokenizer.add_token_with_default_position_and_length(TokenType::Asterisk),
+            '+' | '?' => {
+                tokenizer.add_token_with_default_position_and_length(TokenType::OtherModifier)
+            }
+            '\\' => {
+                if tokenizer.index == input.len() - 1 {
+                    tokenizer.process_tokenizing_error(tokenizer.next_index, tokenizer.index)?;
+                    continue;
+                }
+                let escaped_index = tokenizer.next_index;
+                tokenizer.get_next_code_point();
+                tokenizer.add_token_with_default_length(
+                    TokenType::EscapedChar,
+                    tokenizer.next_index,
+                    escaped_index,
+                );
+            }
+            '{' => tokenizer.add_token_with_default_position_and_length(TokenType::Open),
+            '}' => tokenizer.add_token_with_default_position_and_length(TokenType::Close),
+            ':' => {
+                let name_start = tokenizer.next_index;
+                let mut name_position = name_start;
+                while name_position < input.len() {
+                    tokenizer.seek_and_get_next_code_point(name_position);
+                    let first = name_position == name_start;
+                    if !is_valid_name_code_point(tokenizer.code_point, first) {
+                        break;
+                    }
+                    name_position = tokenizer.next_index;
+                }
+                if name_position <= name_start {
+                    tokenizer.process_tokenizing_error(name_start, tokenizer.index)?;
+                    continue;
+                }
+                tokenizer.add_token_with_default_length(TokenType::Name, name_position, name_start);
+            }
+            '(' => tokenizer.tokenize_regexp()?,
+            _ => tokenizer.add_token_with_default_position_and_length(TokenType::Char),
+        }
+    }
+
+    let end = tokenizer.index;
+    tokenizer.add_token_with_default_length(TokenType::End, end, end);
+    Ok(tokenizer.tokens)
+}
+
+// Pattern parser, https://urlpattern.spec.whatwg.org/#parsing-patterns
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+enum PartType {
+    FixedText,
+    Regexp,
+    SegmentWildcard,
+    FullWildcard,
+}
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+enum PartModifier {
+    None,
+    Optional,
+    ZeroOrMore,
+    OneOrMore,
+}
+
+impl PartModifier {
+    fn as_str(self) -> &'static str {
+        match self {
+            PartModifier::None => "",
+            PartModifier::Optional => "?",
+            PartModifier::ZeroOrMore => "*",
+            PartModifier::OneOrMore => "+",
+        }
+    }
+}
+
+#[derive(Clone, Debug)]
+struct Part {
+    ty: PartType,
+    value: String,
+    modifier: PartModifier,
+    name: String,
+    prefix: String,
+    suffix: String,
+}
+
+#[derive(Clone, Copy)]
+struct Options {
+    delimiter: Option<char>,
+    prefix: Option<char>,
+    ignore_case: bool,
+}
+
+const DEFAULT_OPTIONS: Options = Options {
+    delimiter: None,
+    prefix: None,
+    ignore_case: false,
+};
+
+const HOSTNAME_OPTIONS: Options = Options {
+    delimiter: Some('.'),
+    prefix: None,
+    ignore_case: false,
+};
+
+const PATHNAME_OPTIONS: Options = Options {
+    delimiter: Some('/'),
+    prefix: Some('/'),
+    ignore_case: false,
+};
+
+const FULL_WILDCARD_REGEXP_VALUE: &str = ".*";
+
+type EncodingCallback = fn(&str) -> Result<String, Error>;
+
+fn escape_regexp_string(input: &str) -> String {
+    let mut result = String::with_capacity(input.len());
+    for c in input.chars() {
+        if matches!(
+            c,
+            '.' | '+' | '*' | '?' | '^' | '$' | '{' | '}' | '(' | ')' | '[' | ']' | '|' | '/' | '\\'
+        ) {
+            result.push('\\');
+        }
+        result.push(c);
+    }
+    result
+}
+
+fn escape_pattern_string(input: &str) -> String {
+    let mut result = String::with_capacity(input.len());
+    for c in input.chars() {
+        if matches!(c, '+' | '*' | '?' | ':' | '{' | '}' | '(' | ')' | '\\') {
+            result.push('\\');
+        }
+        result.push(c);
+    }
+    result
+}
+
+fn segment_wildcard_regexp(options: &Options) -> String {
+    let delimiter = options.delimiter.map(String::from).unwrap_or_default();
+    format!("[^{}]+?", escape_regexp_string(&delimiter))
+}
+
+struct PatternParser {
+    tokens: Vec<Token>,
+    encoding_callback: EncodingCallback,
+    segment_wildcard_regexp: String,
+    parts: Vec<Part>,
+    pending_fixed_value: String,
+    index: usize,
+    next_numeric_name: usize,
+}
+
+impl PatternParser {
+    fn try_consume_token(&mut self, ty: TokenType) -> Option<Token> {
+        let token = &self.tokens[self.index];
+        if token.ty != ty {
+            return None;
+        }
+        self.index += 1;
+        Some(token.clone())
+    }
+
+    fn try_consume_modifier_token(&mut self) -> Option<Token> {
+        self.try_consume_token(TokenType::OtherModifier)
+            .or_else(|| self.try_consume_token(TokenType::Asterisk))
+    }
+
+    fn try_consume_regexp_or_wildcard_token(&mut self, name: Option<&Token>) -> Option<Token> {
+        let token = self.try_consume_token(TokenType::Regexp);
+        if name.is_none() && token.is_none() {
+            return self.try_consume_token(TokenType::Asterisk);
+        }
+        token
+    }
+
+    fn consume_required_token(&mut self, ty: TokenType) -> Result<Token, Error> {
+        self.try_consume_token(ty).ok_or("invalid pattern syntax")
+    }
+
+    fn consume_text(&mut self) -> String {
+        let mut result = String::new();
+        while let Some(token) = self
+            .try_consume_token(TokenType::Char)
+            .or_else(|| self.try_consume_token(TokenType::EscapedChar))
+        {
+            result.push_str(&token.value);
+        }
+        result
+    }
+
+    fn maybe_add_part_from_pending_fixed_value(&mut self) -> Result<(), Error> {
+        if self.pending_fixed_value.is_empty() {
+            return Ok(());
+        }
+        let value = (self.encoding_callback)(&std::mem::take(&mut self.pending_fixed_value))?;
+        self.parts.push(Part {
+            ty: PartType::FixedText,
+            value,
+            modifier: PartModifier::None,
+            name: String::new(),
+            prefix: String::new(),
+            suffix: String::new(),
+        });
+        Ok(())
+    }
+
+    fn add_part(
+        &mut self,
+        prefix: &str,
+        name_token: Option<Token>,
+        regexp_or_wildcard_token: Option<Token>,
+        suffix: &str,
+        modifier_token: Option<Token>,
+    ) -> Result<(), Error> {
+        let modifier = match modifier_token.as_ref().map(|t| t.value.as_str()) {
+            Some("?") => PartModifier::Optional,
+            Some("*") => PartModifier::ZeroOrMore,
+            Some("+") => PartModifier::OneOrMore,
+            _ => PartModifier::None,
+        };
+
+        if name_token.is_none() && regexp_or_wildcard_token.is_none() {
+            if modifier == PartModifier::None {
+                self.pending_fixed_value.push_str(prefix);
+                return Ok(());
+            }
+            self.maybe_add_part_from_pending_fixed_value()?;
+            if prefix.is_empty() {
+                return Ok(());
+            }
+            self.parts.push(Part {
+                ty: PartType::FixedText,
+                value: (self.encoding_callback)(prefix)?,
+                modifier,
+                name: String::new(),
+                prefix: String::new(),
+                suffix: String::new(),
+            });
+            return Ok(());
+        }
+        self.maybe_add_part_from_pending_fixed_value()?;
+
+        let mut regexp_value = match &regexp_or_wildcard_token {
+            None => self.segment_wildcard_regexp.clone(),
+            Some(token) if token.ty == TokenType::Asterisk => FULL_WILDCARD_REGEXP_VALUE.into(),
+            Some(token) => token.value.clone(),
+        };
+        let mut ty = PartType::Regexp;
+        if regexp_value == self.segment_wildcard_regexp {
+            ty = PartType::SegmentWildcard;
+            regexp_value.clear();
+        } else if regexp_value == FULL_WILDCARD_REGEXP_VALUE {
+            ty = PartType::FullWildcard;
+            regexp_value.clear();
+        }
+
+        let name = match name_token {
+            Some(token) => token.value,
+            None => {
+                let name = self.next_numeric_name.to_string();
+                self.next_numeric_name += 1;
+                name
+            }
+        };
+        if self.parts.iter().any(|part| part.name == name) {
+            return Err("duplicate group name");
+        }
+
+        self.parts.push(Part {
+            ty,
+            value: regexp_value,
+            modifier,
+            name,
+            prefix: (self.encoding_callback)(prefix)?,
+            suffix: (self.encoding_callback)(suffix)?,
+        });
+        Ok(())
+    }
+}
+
+fn parse_pattern_string(
+    input: &str,
+    options: &Options,
+    encoding_callback: EncodingCallback,
+) -> Result<Vec<Part>, Error> {
+    let input: Vec<char> = input.chars().collect();
+    let mut parser = PatternParser {
+        tokens: tokenize(&input, TokenizePolicy::Strict)?,
+        encoding_callback,
+        segment_wildcard_regexp: segment_wildcard_regexp(options),
+        parts: Vec::new(),
+        pending_fixed_value: String::new(),
+        index: 0,
+        next_numeric_name: 0,
+    };
+
+    while parser.index < parser.tokens.len() {
+        let char_token = parser.try_consume_token(TokenType::Char);
+        let name_token = parser.try_consume_token(TokenType::Name);
+        let regexp_or_wildcard_token =
+            parser.try_consume_regexp_or_wildcard_token(name_token.as_ref());
+        if name_token.is_some() || regexp_or_wildcard_token.is_some() {
+            let mut prefix = char_token.map(|t| t.value).unwrap_or_default();
+            if !prefix.is_empty() && options.prefix.map(String::from) != Some(prefix.clone()) {
+                parser.pending_fixed_value.push_str(&prefix);
+                prefix.clear();
+            }
+            parser.maybe_add_part_from_pending_fixed_value()?;
+            let modifier_token = parser.try_consume_modifier_token();
+            parser.add_part(
+                &prefix,
+                name_token,
+                regexp_or_wildcard_token,
+                "",
+                modifier_token,
+            )?;
+            continue;
+        }
+
+        let fixed_token = char_token.or_else(|| parser.try_consume_token(TokenType::EscapedChar));
+        if let Some(token) = fixed_token {
+            parser.pending_fixed_value.push_str(&token.value);
+            continue;
+        }
+
+        if parser.try_consume_token(TokenType::Open).is_some() {
+            let prefix = parser.consume_text();
+            let name_token = parser.try_consume_token(TokenType::Name);
+            let regexp_or_wildcard_token =
+                parser.try_consume_regexp_or_wildcard_token(name_token.as_ref());
+            let suffix = parser.consume_text();
+            parser.consume_required_token(TokenType::Close)?;
+            let modifier_token = parser.try_consume_modifier_token();
+            parser.add_part(
+                &prefix,
+                name_token,
+                regexp_or_wildcard_token,
+                &suffix,
+                modifier_token,
+            )?;
+            continue;
+        }
+
+        parser.maybe_add_part_from_pending_fixed_value()?;
+        parser.consume_required_token(TokenType::End)?;
+    }
+
+    Ok(parser.parts)
+}
+
+fn generate_regexp_and_name_list(parts: &[Part], options: &Options) -> (String, Vec<String>) {
+    let mut result = String::from("^");
+    let mut names = Vec::new();
+    for part in parts {
+        let modifier = part.modifier.as_str();
+        if part.ty == PartType::FixedText {
+            if part.modifier == PartModifier::None {
+                result.push_str(&escape_regexp_string(&part.value));
+            } else {
+                result.push_str(&format!(
+                    "(?:{}){}",
+                    escape_regexp_string(&part.value),
+                    modifier
+                ));
+            }
+            continue;
+        }
+
+        names.push(part.name.clone());
+        let regexp_value = match part.ty {
+            PartType::SegmentWildcard => segment_wildcard_regexp(options),
+            PartType::FullWildcard => FULL_WILDCARD_REGEXP_VALUE.into(),
+            _ => part.value.clone(),
+        };
+        let single = matches!(part.modifier, PartModifier::None | PartModifier::Optional);
+
+        if part.prefix.is_empty() && part.suffix.is_empty() {
+            if single {
+                result.push_str(&format!("({}){}", regexp_value, modifier));
+            } else {
+                result.push_str(&format!("((?:{}){})", regexp_value, modifier));
+            }
+            continue;
+        }
+
+        let prefix = escape_regexp_string(&part.prefix);
+        let suffix = escape_regexp_string(&part.suffix);
+        if single {
+            result.push_str(&format!(
+                "(?:{}({}){}){}",
+                prefix, regexp_value, suffix, modifier
+            ));
+            continue;
+        }
+        result.push_str(&format!(
+            "(?:{prefix}((?:{regexp_value})(?:{suffix}{prefix}(?:{regexp_value}))*){suffix})"
+        ));
+        if part.modifier == PartModifier::ZeroOrMore {
+            result.push('?');
+        }
+    }
+    result.push('$');
+    (result, names)
+}
+
+fn starts_with_digit(name: &str) -> bool {
+    name.starts_with(|c: char| c.is_ascii_digit())
+}
+
+fn generate_pattern_string(parts: &[Part], options: &Options) -> String {
+    let mut result = String::new();
+    for (index, part) in parts.iter().enumerate() {
+        let previous = index.checked_sub(1).map(|i| &parts[i]);
+        let next = parts.get(index + 1);
+        if part.ty == PartType::FixedText {
+            if part.modifier == PartModifier::None {
+                result.push_str(&escape_pattern_string(&part.value));
+            } else {
+                result.push('{');
+                result.push_str(&escape_pattern_string(&part.value));
+                result.push('}');
+                result.push_str(part.modifier.as_str());
+            }
+            continue;
+        }
+
+        let custom_name = !starts_with_digit(&part.name);
+        let prefix_is_delimiter =
+            options.prefix.is_some_and(|p| part.prefix.chars().eq(std::iter::once(p)));
+        let mut needs_grouping =
+            !part.suffix.is_empty() || (!part.prefix.is_empty() && !prefix_is_delimiter);
+        if !needs_grouping
+            && custom_name
+            && part.ty == PartType::SegmentWildcard
+            && part.modifier == PartModifier::None
+        {
+            if let Some(next) = next.filter(|n| n.prefix.is_empty() && n.suffix.is_empty()) {
+                needs_grouping = if next.ty == PartType::FixedText {
+                    next.value
+                        .chars()
+                        .next()
+                        .is_some_and(|c| is_valid_name_code_point(c, false))
+                } else {
+                    starts_with_digit(&next.name)
+                };
+            }
+        }
+        if !needs_grouping && part.prefix.is_empty() {
+            if let Some(previous) = previous {
+                needs_grouping = previous.ty == PartType::FixedText
+                    && options.prefix.is_some()
+                    && previous.value.chars().last() == options.prefix;
+            }
+        }
+
+        if needs_grouping {
+            result.push('{');
+        }
+        result.push_str(&escape_pattern_string(&part.prefix));
+        if custom_name {
+            result.push(':');
+            result.push_str(&part.name);
+        }
+        match part.ty {
+            PartType::Regexp => result.push_str(&format!("({})", part.value)),
+            PartType::SegmentWildcard if !custom_name => {
+                result.push_str(&format!("({})", segment_wildcard_regexp(options)))
+            }
+            PartType::FullWildcard => {
+                let asterisk = !custom_name
+                    && (previous.is_none_or(|p| {
+                        p.ty == PartType::FixedText || p.modifier != PartModifier::None
+                    }) || needs_grouping
+                        || !part.prefix.is_empty());
+                if asterisk {
+                    result.push('*');
+                } else {
+                    result.push_str(&format!("({})", FULL_WILDCARD_REGEXP_VALUE));
+                }
+            }
+            _ => {}
+        }
+        if part.ty == PartType::SegmentWildcard
+            && custom_name
+            && part
+                .suffix
+                .chars()
+                .next()
+                .is_some_and(|c| is_valid_name_code_point(c, false))
+        {
+            result.push('\\');
+        }
+        result.push_str(&escape_pattern_string(&part.suffix));
+        if needs_grouping {
+            result.push('}');
+        }
+        result.push_str(part.modifier.as_str());
+    }
+    result
+}
+
+// Canonicalization, https://urlpattern.spec.whatwg.org/#canon-encoding-callbacks
+
+fn dummy_url() -> Url {
+    Url::parse("fake://dummy.test").unwrap()
+}
+
+fn canonicalize_protocol(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    match Url::parse(&format!("{value}://dummy.test")) {
+        Ok(url) => Ok(url.scheme().to_string()),
+        Err(_) => Err("invalid protocol"),
+    }
+}
+
+fn canonicalize_username(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = dummy_url();
+    url.set_username(value).map_err(|_| "invalid username")?;
+    Ok(url.username().to_string())
+}
+
+fn canonicalize_password(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = dummy_url();
+    url.set_password(Some(value)).map_err(|_| "invalid password")?;
+    Ok(url.password().unwrap_or("").to_string())
+}
+
+fn canonicalize_hostname(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = Url::parse("http://dummy.test").unwrap();
+    quirks::set_hostname(&mut url, value).map_err(|_| "invalid hostname")?;
+    Ok(quirks::hostname(&url).to_string())
+}
+
+fn canonicalize_ipv6_hostname(value: &str) -> Result<String, Error> {
+    value
+        .chars()
+        .map(|c| match c {
+            '[' | ']' | ':' => Ok(c),
+            c if c.is_ascii_hexdigit() => Ok(c.to_ascii_lowercase()),
+            _ => Err("invalid IPv6 hostname"),
+        })
+        .collect()
+}
+
+fn canonicalize_port_for_protocol(value: &str, protocol: Option<&str>) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    // The scheme is set so that default ports are recognized, and normalized to the empty string.
+    let mut url = protocol
+        .filter(|p| !p.is_empty())
+        .and_then(|p| Url::parse(&format!("{p}://dummy.test")).ok())
+        .unwrap_or_else(dummy_url);
+    quirks::set_port(&mut url, value).map_err(|_| "invalid port")?;
+    Ok(quirks::port(&url).to_string())
+}
+
+fn canonicalize_port(value: &str) -> Result<String, Error> {
+    canonicalize_port_for_protocol(value, None)
+}
+
+fn canonicalize_pathname(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    // Relative pathnames are canonicalized as if they were a segment of an absolute one, without
+    // resolving leading dot segments against it.
+    let leading_slash = value.starts_with('/');
+    let modified = if leading_slash {
+        value.to_string()
+    } else {
+        format!("/-{value}")
+    };
+    let mut url = Url::parse("http://dummy.test").unwrap();
+    url.set_path(&modified);
+    let path = url.path();
+    Ok(if leading_slash { path } else { &path[2..] }.to_string())
+}
+
+fn canonicalize_opaque_pathname(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = Url::parse("fake:dummy").unwrap();
+    url.set_path(value);
+    // Setting an opaque path escapes a leading slash, so that it doesn't turn into a hierarchical
+    // one, which the URL Pattern Standard doesn't do.
+    match url.path().strip_prefix("%2F") {
+        Some(rest) if value.starts_with('/') => Ok(format!("/{rest}")),
+        _ => Ok(url.path().to_string()),
+    }
+}
+
+fn canonicalize_search(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = dummy_url();
+    url.set_query(Some(value));
+    Ok(url.query().unwrap_or("").to_string())
+}
+
+fn canonicalize_hash(value: &str) -> Result<String, Error> {
+    if value.is_empty() {
+        return Ok(String::new());
+    }
+    let mut url = dummy_url();
+    url.set_fragment(Some(value));
+    Ok(url.fragment().unwrap_or("").to_string())
+}
+
+// URLPatternInit processing, https://urlpattern.spec.whatwg.org/#process-a-urlpatterninit
+
+#[derive(Clone, Default, Debug)]
+struct Init {
+    components: [Option<String>; 8],
+    base_url: Option<String>,
+}
+
+impl Init {
+    fn get(&self, component: UrlPatternComponent) -> Option<&str> {
+        self.components[component as usize].as_deref()
+    }
+
+    fn set(&mut self, component: UrlPatternComponent, value: String) {
+        self.components[component as usize] = Some(value);
+    }
+
+    fn has_any(&self, components: &[UrlPatternComponent]) -> bool {
+        components.iter().any(|c| self.get(*c).is_some())
+    }
+}
+
+#[derive(Clone, Copy, Eq, PartialEq)]
+enum InitType {
+    Pattern,
+    Url,
+}
+
+fn process_base_url_string(input: &str, ty: InitType) -> String {
+    match ty {
+        InitType::Pattern => escape_pattern_string(input),
+        InitType::Url => input.to_string(),
+    }
+}
+
+fn is_absolute_pathname(input: &str, ty: InitType) -> bool {
+    let mut chars = input.chars();
+    match (chars.next(), chars.next()) {
+        (Some('/'), _) => true,
+        _ if ty == InitType::Url => false,
+        (Some('\\'), Some('/')) | (Some('{'), Some('/')) => true,
+        _ => false,
+    }
+}
+
+fn process_init(init: &Init, ty: InitType) -> Result<Init, Error> {
+    let mut result = Init::default();
+    if ty == InitType::Url {
+        result.components = Default::default();
+        for component in COMPONENTS {
+            result.set(component, String::new());
+        }
+    }
+
+    let base_url = match &init.base_url {
+        Some(base) => Some(Url::parse(base).map_err(|_| "invalid base URL")?),
+        None => None,
+    };
+
+    if let Some(base) = &base_url {
+        let inherit = |result: &mut Init, component, value: &str, unless: &[UrlPatternComponent]| {
+            if !init.has_any(unless) {
+                result.set(component, process_base_url_string(value, ty));
+            }
+        };
+        inherit(&mut result, Protocol, base.scheme(), &[Protocol]);
+        if ty != InitType::Pattern {
+            inherit(
+                &mut result,
+                Username,
+                base.username(),
+                &[Protocol, Hostname, Port, Username],
+            );
+            inherit(
+                &mut result,
+                Password,
+                base.password().unwrap_or(""),
+                &[Protocol, Hostname, Port, Username, Password],
+            );
+        }
+        inherit(
+            &mut result,
+            Hostname,
+            base.host_str().unwrap_or(""),
+            &[Protocol, Hostname],
+        );
+        inherit(
+            &mut result,
+            Port,
+            quirks::port(base),
+            &[Protocol, Hostname, Port],
+        );
+        inherit(
+            &mut result,
+            Pathname,
+            base.path(),
+            &[Protocol, Hostname, Port, Pathname],
+        );
+        inherit(
+            &mut result,
+            Search,
+            base.query().unwrap_or(""),
+            &[Protocol, Hostname, Port, Pathname, Search],
+        );
+        inherit(
+            &mut result,
+            Hash,
+            base.fragment().unwrap_or(""),
+            &[Protocol, Hostname, Port, Pathname, Search, Hash],
+        );
+    }
+
+    let canonicalize = |callback: EncodingCallback, value: &str| match ty {
+        InitType::Pattern => Ok(value.to_string()),
+        InitType::Url => callback(value),
+    };
+
+    if let Some(protocol) = init.get(Protocol) {
+        let stripped = protocol.strip_suffix(':').unwrap_or(protocol);
+        result.set(Protocol, canonicalize(canonicalize_protocol, stripped)?);
+    }
+    if let Some(username) = init.get(Username) {
+        result.set(Username, canonicalize(canonicalize_username, username)?);
+    }
+    if let Some(password) = init.get(Password) {
+        result.set(Password, canonicalize(canonicalize_password, password)?);
+    }
+    if let Some(hostname) = init.get(Hostname) {
+        result.set(Hostname, canonicalize(canonicalize_hostname, hostname)?);
+    }
+    if let Some(port) = init.get(Port) {
+        let port = match ty {
+            InitType::Pattern => port.to_string(),
+            InitType::Url => canonicalize_port_for_protocol(port, result.get(Protocol))?,
+        };
+        result.set(Port, port);
+    }
+    if let Some(pathname) = init.get(Pathname) {
+        let mut pathname = pathname.to_string();
+        if let Some(base) = base_url.as_ref().filter(|b| !b.cannot_be_a_base()) {
+            if !is_absolute_pathname(&pathname, ty) {
+                let base_path = process_base_url_string(base.path(), ty);
+                if let Some(slash) = base_path.rfind('/') {
+                    pathname.insert_str(0, &base_path[..=slash]);
+                }
+            }
+        }
+        let protocol = result.get(Protocol).unwrap_or("");
+        let pathname = match ty {
+            InitType::Pattern => pathname,
+            InitType::Url if protocol.is_empty() || is_special_scheme(protocol) => {
+                canonicalize_pathname(&pathname)?
+            }
+            InitType::Url => canonicalize_opaque_pathname(&pathname)?,
+        };
+        result.set(Pathname, pathname);
+    }
+    if let Some(search) = init.get(Search) {
+        let stripped = search.strip_prefix('?').unwrap_or(search);
+        result.set(Search, canonicalize(canonicalize_search, stripped)?);
+    }
+    if let Some(hash) = init.get(Hash) {
+        let stripped = hash.strip_prefix('#').unwrap_or(hash);
+        result.set(Hash, canonicalize(canonicalize_hash, stripped)?);
+    }
+
+    Ok(result)
+}
+
+// Compiled components, https://urlpattern.spec.whatwg.org/#compile-a-component
+
+/// How a compiled component has to be matched.
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+pub enum UrlPatternComponentKind {
+    /// The component's regular expression has to be executed.
+    Regexp,
+    /// The component matches any input, which is its only group.
+    Wildcard,
+    /// The component only matches its literal string, and has no groups.
+    Literal,
+}
+
+struct Component {
+    kind: UrlPatternComponentKind,
+    pattern: String,
+    /// The regular expression, encoded as UTF-16 for the embedder's engine.
+    regexp: Vec<u16>,
+    group_names: Vec<String>,
+    literal: String,
+    has_regexp_groups: bool,
+}
+
+fn compile_component(
+    input: &str,
+    encoding_callback: EncodingCallback,
+    options: &Options,
+) -> Result<Component, Error> {
+    let parts = parse_pattern_string(input, options, encoding_callback)?;
+    let (regexp, group_names) = generate_regexp_and_name_list(&parts, options);
+
+    let mut kind = UrlPatternComponentKind::Regexp;
+    let mut literal = String::new();
+    match parts.as_slice() {
+        [] if !options.ignore_case => kind = UrlPatternComponentKind::Literal,
+        [part] if part.modifier == PartModifier::None => {
+            if part.ty == PartType::FixedText && !options.ignore_case {
+                kind = UrlPatternComponentKind::Literal;
+                literal = part.value.clone();
+            } else if part.ty == PartType::FullWildcard
+                && part.prefix.is_empty()
+                && part.suffix.is_empty()
+            {
+                kind = UrlPatternComponentKind::Wildcard;
+            }
+        }
+        _ => {}
+    }
+
+    Ok(Component {
+        kind,
+        pattern: generate_pattern_string(&parts, options),
+        regexp: regexp.encode_utf16().collect(),
+        group_names,
+        literal,
+        has_regexp_groups: parts.iter().any(|part| part.ty == PartType::Regexp),
+    })
+}
+
+/// The result of testing a regular expression against the special schemes.
+#[repr(u8)]
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+pub enum SpecialSchemeMatch {
+    NoMatch,
+    Match,
+    /// The regular expression is invalid.
+    Error,
+}
+
+/// Tests whether the given UTF-16 encoded regular expression matches any of the special schemes.
+///
+/// The URL Pattern Standard uses this to decide how pathnames are parsed, so the embedder's
+/// regular expression engine has to be called back during compilation.
+pub type SpecialSchemeMatcher =
+    extern "C" fn(data: *mut c_void, regexp: *const u16, len: usize) -> SpecialSchemeMatch;
+
+struct Matcher {
+    callback: SpecialSchemeMatcher,
+    data: *mut c_void,
+}
+
+impl Matcher {
+    fn matches_special_scheme(&self, protocol: &Component) -> Result<bool, Error> {
+        match protocol.kind {
+            UrlPatternComponentKind::Wildcard => return Ok(true),
+            UrlPatternComponentKind::Literal => return Ok(is_special_scheme(&protocol.literal)),
+            UrlPatternComponentKind::Regexp => {}
+        }
+        let regexp = &protocol.regexp;
+        match (self.callback)(self.data, regexp.as_ptr(), regexp.len()) {
+            SpecialSchemeMatch::NoMatch => Ok(false),
+            SpecialSchemeMatch::Match => Ok(true),
+            SpecialSchemeMatch::Error => Err("invalid regular expression in protocol"),
+        }
+    }
+}
+
+// Constructor string parser, https://urlpattern.spec.whatwg.org/#constructor-string-parsing
+
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+enum State {
+    Init,
+    Protocol,
+    Authority,
+    Username,
+    Password,
+    Hostname,
+    Port,
+    Pathname,
+    Search,
+    Hash,
+    Done,
+}
+
+impl State {
+    fn component(self) -> Option<UrlPatternComponent> {
+        Some(match self {
+            State::Protocol => Protocol,
+            State::Username => Username,
+            State::Password => Password,
+            State::Hostname => Hostname,
+            State::Port => Port,
+            State::Pathname => Pathname,
+            State::Search => Search,
+            State::Hash => Hash,
+            State::Init | State::Authority | State::Done => return None,
+        })
+    }
+}
+
+struct ConstructorStringParser<'a> {
+    input: &'a [char],
+    tokens: Vec<Token>,
+    result: Init,
+    component_start: usize,
+    token_index: usize,
+    token_increment: usize,
+    group_depth: usize,
+    hostname_ipv6_bracket_depth: usize,
+    protocol_matches_special_scheme: bool,
+    state: State,
+}
+
+impl ConstructorStringParser<'_> {
+    fn change_state(&mut self, new_state: State, skip: usize) {
+        if let Some(component) = self.state.component() {
+            let value = self.make_component_string();
+            self.result.set(component, value);
+        }
+
+        if self.state != State::Init && new_state != State::Done {
+            use State::*;
+            let from_authority = matches!(self.state, Protocol | Authority | Username | Password);
+            if from_authority
+                && matches!(new_state, Port | Pathname | Search | Hash)
+                && self.result.get(UrlPatternComponent::Hostname).is_none()
+            {
+                self.result.set(UrlPatternComponent::Hostname, String::new());
+            }
+            if (from_authority || matches!(self.state, Hostname | Port))
+                && matches!(new_state, Search | Hash)
+                && self.result.get(UrlPatternComponent::Pathname).is_none()
+            {
+                let pathname = if self.protocol_matches_special_scheme {
+                    "/"
+                } else {
+                    ""
+                };
+                self.result
+                    .set(UrlPatternComponent::Pathname, pathname.to_string());
+            }
+            if (from_authority || matches!(self.state, Hostname | Port | Pathname))
+                && new_state == Hash
+                && self.result.get(UrlPatternComponent::Search).is_none()
+            {
+                self.result.set(UrlPatternComponent::Search, String::new());
+            }
+        }
+
+        self.state = new_state;
+        self.token_index += skip;
+        self.component_start = self.token_index;
+        self.token_increment = 0;
+    }
+
+    fn rewind(&mut self) {
+        self.token_index = self.component_start;
+        self.token_increment = 0;
+    }
+
+    fn rewind_and_set_state(&mut self, state: State) {
+        self.rewind();
+        self.state = state;
+    }
+
+    fn safe_token(&self, index: usize) -> &Token {
+        self.tokens.get(index).unwrap_or_else(|| self.tokens.last().unwrap())
+    }
+
+    fn is_non_special_pattern_char(&self, index: usize, value: &str) -> bool {
+        let token = self.safe_token(index);
+        token.value == value
+            && matches!(
+                token.ty,
+                TokenType::Char | TokenType::EscapedChar | TokenType::InvalidChar
+            )
+    }
+
+    fn is_char(&self, value: &str) -> bool {
+        self.is_non_special_pattern_char(self.token_index, value)
+    }
+
+    fn next_is_authority_slashes(&self) -> bool {
+        self.is_non_special_pattern_char(self.token_index + 1, "/")
+            && self.is_non_special_pattern_char(self.token_index + 2, "/")
+    }
+
+    fn is_search_prefix(&self) -> bool {
+        if self.is_char("?") {
+            return true;
+        }
+        if self.tokens[self.token_index].value != "?" {
+            return false;
+        }
+        if self.token_index == 0 {
+            return true;
+        }
+        let previous = self.safe_token(self.token_index - 1);
+        !matches!(
+            previous.ty,
+            TokenType::Name | TokenType::Regexp | TokenType::Close | TokenType::Asterisk
+        )
+    }
+
+    fn make_component_string(&self) -> String {
+        let end = self.tokens[self.token_index].index;
+        let start = self.safe_token(self.component_start).index;
+        self.input[start..end].iter().collect()
+    }
+
+    fn compute_protocol_matches_special_scheme(&mut self, matcher: &Matcher) -> Result<(), Error> {
+        let protocol = self.make_component_string();
+        let component = compile_component(&protocol, canonicalize_protocol, &DEFAULT_OPTIONS)?;
+        self.protocol_matches_special_scheme = matcher.matches_special_scheme(&component)?;
+        Ok(())
+    }
+}
+
+fn parse_constructor_string(input: &str, matcher: &Matcher) -> Result<Init, Error> {
+    let input: Vec<char> = input.chars().collect();
+    let mut parser = ConstructorStringParser {
+        input: &input,
+        tokens: tokenize(&input, TokenizePolicy::Lenient)?,
+        result: Init::default(),
+        component_start: 0,
+        token_index: 0,
+        token_increment: 1,
+        group_depth: 0,
+        hostname_ipv6_bracket_depth: 0,
+        protocol_matches_special_scheme: false,
+        state: State::Init,
+    };
+
+    while parser.token_index < parser.tokens.len() {
+        parser.token_increment = 1;
+
+        if parser.tokens[parser.token_index].ty == TokenType::End {
+            if parser.state == State::Init {
+                parser.rewind();
+                if parser.is_char("#") {
+                    parser.change_state(State::Hash, 1);
+                } else if parser.is_search_prefix() {
+                    parser.change_state(State::Search, 1);
+                } else {
+                    parser.change_state(State::Pathname, 0);
+                }
+                parser.token_index += parser.token_increment;
+                continue;
+            }
+            if parser.state == State::Authority {
+                parser.rewind_and_set_state(State::Hostname);
+                parser.token_index += parser.token_increment;
+                continue;
+            }
+            parser.change_state(State::Done, 0);
+            break;
+        }
+
+        let ty = parser.tokens[parser.token_index].ty;
+        if ty == TokenType::Open {
+            parser.group_depth += 1;
+            parser.token_index += parser.token_increment;
+            continue;
+        }
+        if parser.group_depth > 0 {
+            if ty == TokenType::Close {
+                parser.group_depth -= 1;
+            } else {
+                parser.token_index += parser.token_increment;
+                continue;
+            }
+        }
+
+        match parser.state {
+            State::Init => {
+                if parser.is_char(":") {
+                    parser.rewind_and_set_state(State::Protocol);
+                }
+            }
+            State::Protocol => {
+                if parser.is_char(":") {
+                    parser.compute_protocol_matches_special_scheme(matcher)?;
+                    if parser.next_is_authority_slashes() {
+                        parser.change_state(State::Authority, 3);
+                    } else if parser.protocol_matches_special_scheme {
+                        parser.change_state(State::Authority, 1);
+                    } else {
+                        parser.change_state(State::Pathname, 1);
+                    }
+                }
+            }
+            State::Authority => {
+                if parser.is_char("@") {
+                    parser.rewind_and_set_state(State::Username);
+                } else if parser.is_char("/") || parser.is_search_prefix() || parser.is_char("#")
+                {
+                    parser.rewind_and_set_state(State::Hostname);
+                }
+            }
+            State::Username => {
+                if parser.is_char(":") {
+                    parser.change_state(State::Password, 1);
+                } else if parser.is_char("@") {
+                    parser.change_state(State::Hostname, 1);
+                }
+            }
+            State::Password => {
+                if parser.is_char("@") {
+                    parser.change_state(State::Hostname, 1);
+                }
+            }
+            State::Hostname => {
+                if parser.is_char("[") {
+                    parser.hostname_ipv6_bracket_depth += 1;
+                } else if parser.is_char("]") {
+                    parser.hostname_ipv6_bracket_depth =
+                        parser.hostname_ipv6_bracket_depth.saturating_sub(1);
+                } else if parser.is_char(":") && parser.hostname_ipv6_bracket_depth == 0 {
+                    parser.change_state(State::Port, 1);
+                } else if parser.is_char("/") {
+                    parser.change_state(State::Pathname, 0);
+                } else if parser.is_search_prefix() {
+                    parser.change_state(State::Search, 1);
+                } else if parser.is_char("#") {
+                    parser.change_state(State::Hash, 1);
+                }
+            }
+            State::Port => {
+                if parser.is_char("/") {
+                    parser.change_state(State::Pathname, 0);
+                } else if parser.is_search_prefix() {
+                    parser.change_state(State::Search, 1);
+                } else if parser.is_char("#") {
+                    parser.change_state(State::Hash, 1);
+                }
+            }
+            State::Pathname => {
+                if parser.is_search_prefix() {
+                    parser.change_state(State::Search, 1);
+                } else if parser.is_char("#") {
+                    parser.change_state(State::Hash, 1);
+                }
+            }
+            State::Search => {
+                if parser.is_char("#") {
+                    parser.change_state(State::Hash, 1);
+                }
+            }
+            State::Hash | State::Done => {}
+        }
+        parser.token_index += parser.token_increment;
+    }
+
+    if parser.result.get(Hostname).is_some() && parser.result.get(Port).is_none() {
+        parser.result.set(Port, String::new());
+    }
+    Ok(parser.result)
+}
+
+/// A compiled URL pattern. Patterns are immutable and reference counted, so that compiled
+/// patterns can be cached and shared between `URLPattern` objects.
+pub struct JSUrlPattern {
+    components: [Component; 8],
+    ignore_case: bool,
+}
+
+fn is_ipv6_hostname_pattern(input: &str) -> bool {
+    let mut chars = input.chars();
+    match (chars.next(), chars.next()) {
+        (Some('['), _) => true,
+        (Some('{' | '\\'), Some('[')) => true,
+        _ => false,
+    }
+}
+
+fn create_pattern(init: Init, ignore_case: bool, matcher: &Matcher) -> Result<JSUrlPattern, Error> {
+    let mut processed = process_init(&init, InitType::Pattern)?;
+    for component in COMPONENTS {
+        if processed.get(component).is_none() {
+            processed.set(component, "*".to_string());
+        }
+    }
+    let protocol = processed.get(Protocol).unwrap();
+    if is_special_scheme(protocol) && default_port(protocol) == processed.get(Port) {
+        processed.set(Port, String::new());
+    }
+    let value = |component| processed.get(component).unwrap();
+
+    let protocol = compile_component(value(Protocol), canonicalize_protocol, &DEFAULT_OPTIONS)?;
+    let username = compile_component(value(Username), canonicalize_username, &DEFAULT_OPTIONS)?;
+    let password = compile_component(value(Password), canonicalize_password, &DEFAULT_OPTIONS)?;
+    let hostname = if is_ipv6_hostname_pattern(value(Hostname)) {
+        compile_component(value(Hostname), canonicalize_ipv6_hostname, &HOSTNAME_OPTIONS)?
+    } else {
+        compile_component(value(Hostname), canonicalize_hostname, &HOSTNAME_OPTIONS)?
+    };
+    let port = compile_component(value(Port), canonicalize_port, &DEFAULT_OPTIONS)?;
+
+    let options = Options {
+        ignore_case,
+        ..DEFAULT_OPTIONS
+    };
+    let pathname = if matcher.matches_special_scheme(&protocol)? {
+        let options = Options {
+            ignore_case,
+            ..PATHNAME_OPTIONS
+        };
+        compile_component(value(Pathname), canonicalize_pathname, &options)?
+    } else {
+        compile_component(value(Pathname), canonicalize_opaque_pathname, &options)?
+    };
+    let search = compile_component(value(Search), canonicalize_search, &options)?;
+    let hash = compile_component(value(Hash), canonicalize_hash, &options)?;
+
+    Ok(JSUrlPattern {
+        components: [
+            protocol, username, password, hostname, port, pathname, search, hash,
+        ],
+        ignore_case,
+    })
+}
+
+fn create_pattern_from_string(
+    input: &str,
+    base_url: Option<String>,
+    ignore_case: bool,
+    matcher: &Matcher,
+) -> Result<JSUrlPattern, Error> {
+    let mut init = parse_constructor_string(input, matcher)?;
+    if base_url.is_none() && init.get(Protocol).is_none() {
+        return Err("relative patterns require a base URL");
+    }
+    init.base_url = base_url;
+    create_pattern(init, ignore_case, matcher)
+}
+
+/// A `URLPatternInit` dictionary. Members that aren't present have a null `data` pointer.
+#[repr(C)]
+pub struct UrlPatternInit<'a> {
+    components: [SpecSlice<'a>; 8],
+    base_url: SpecSlice<'a>,
+}
+
+fn optional_string(slice: &SpecSlice) -> Option<String> {
+    if slice.data.is_null() {
+        return None;
+    }
+    let str: &str = slice.into();
+    Some(str.to_string())
+}
+
+impl From<&UrlPatternInit<'_>> for Init {
+    fn from(init: &UrlPatternInit) -> Init {
+        Init {
+            components: init.components.each_ref().map(optional_string),
+            base_url: optional_string(&init.base_url),
+        }
+    }
+}
+
+fn into_raw_pattern(
+    pattern: Result<JSUrlPattern, Error>,
+    error: &mut SpecSlice<'static>,
+) -> *const JSUrlPattern {
+    match pattern {
+        Ok(pattern) => Rc::into_raw(Rc::new(pattern)),
+        Err(message) => {
+            *error = message.into();
+            std::ptr::null()
+        }
+    }
+}
+
+/// Compiles a pattern given as a string, relative to the optional `base_url`, which is absent if
+/// its `data` pointer is null.
+///
+/// Returns null and sets `error` to a description of the problem if the pattern is invalid.
+#[no_mangle]
+pub extern "C" fn new_url_pattern_from_string(
+    input: &SpecString,
+    base_url: &SpecSlice,
+    ignore_case: bool,
+    matcher: SpecialSchemeMatcher,
+    data: *mut c_void,
+    error: &mut SpecSlice<'static>,
+) -> *const JSUrlPattern {
+    let matcher = Matcher {
+        callback: matcher,
+        data,
+    };
+    let pattern = create_pattern_from_string(
+        input.into(),
+        optional_string(base_url),
+        ignore_case,
+        &matcher,
+    );
+    into_raw_pattern(pattern, error)
+}
+
+/// Compiles a pattern given as a `URLPatternInit` dictionary.
+///
+/// Returns null and sets `error` to a description of the problem if the pattern is invalid.
+#[no_mangle]
+pub extern "C" fn new_url_pattern_from_init(
+    init: &UrlPatternInit,
+    ignore_case: bool,
+    matcher: SpecialSchemeMatcher,
+    data: *mut c_void,
+    error: &mut SpecSlice<'static>,
+) -> *const JSUrlPattern {
+    let matcher = Matcher {
+        callback: matcher,
+        data,
+    };
+    into_raw_pattern(create_pattern(init.into(), ignore_case, &matcher), error)
+}
+
+/// Returns a new reference to `pattern`.
+#[no_mangle]
+pub unsafe extern "C" fn clone_url_pattern(pattern: *const JSUrlPattern) -> *const JSUrlPattern {
+    Rc::increment_strong_count(pattern);
+    pattern
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn free_url_pattern(pattern: *const JSUrlPattern) {
+    if !pattern.is_null() {
+        drop(Rc::from_raw(pattern));
+    }
+}
+
+/// Information about one of a pattern's components, borrowed from the pattern.
+#[repr(C)]
+pub struct UrlPatternComponentInfo<'a> {
+    kind: UrlPatternComponentKind,
+    /// The normalized pattern string.
+    pattern: SpecSlice<'a>,
+    /// The UTF-16 encoded regular expression, which has to be executed with the `v` flag, and
+    /// the `i` flag if `ignore_case` is set.
+    regexp: *const u16,
+    regexp_len: usize,
+    ignore_case: bool,
+    /// For `Literal` components, the only string they match.
+    literal: SpecSlice<'a>,
+    group_count: usize,
+    has_regexp_groups: bool,
+}
+
+#[no_mangle]
+pub extern "C" fn url_pattern_component<'a>(
+    pattern: &'a JSUrlPattern,
+    component: UrlPatternComponent,
+    info: &mut UrlPatternComponentInfo<'a>,
+) {
+    let c = &pattern.components[component as usize];
+    *info = UrlPatternComponentInfo {
+        kind: c.kind,
+        pattern: c.pattern.as_str().into(),
+        regexp: c.regexp.as_ptr(),
+        regexp_len: c.regexp.len(),
+        // Only the pathname, search and hash are compiled with the `ignoreCase` option.
+        ignore_case: pattern.ignore_case && matches!(component, Pathname | Search | Hash),
+        literal: c.literal.as_str().into(),
+        group_count: c.group_names.len(),
+        has_regexp_groups: c.has_regexp_groups,
+    };
+}
+
+/// Returns the name of the group with the given index in the component's regular expression.
+#[no_mangle]
+pub extern "C" fn url_pattern_group_name(
+    pattern: &JSUrlPattern,
+    component: UrlPatternComponent,
+    index: usize,
+) -> SpecSlice<'_> {
+    pattern.components[component as usize].group_names[index]
+        .as_str()
+        .into()
+}
+
+/// The components of a `URLPatternInit` that's being matched against a pattern.
+pub struct JSUrlPatternInput {
+    components: [String; 8],
+}
+
+/// Processes a `URLPatternInit` dictionary so it can be matched against a pattern.
+///
+/// Returns null if the dictionary doesn't describe a valid URL, which means that it doesn't match
+/// any pattern.
+#[no_mangle]
+pub extern "C" fn new_url_pattern_input(init: &UrlPatternInit) -> *mut JSUrlPatternInput {
+    match process_init(&init.into(), InitType::Url) {
+        Ok(result) => Box::into_raw(Box::new(JSUrlPatternInput {
+            components: result.components.map(Option::unwrap_or_default),
+        })),
+        Err(_) => std::ptr::null_mut(),
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn url_pattern_input_component(
+    input: &JSUrlPatternInput,
+    component: UrlPatternComponent,
+) -> SpecSlice<'_> {
+    input.components[component as usize].as_str().into()
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn free_url_pattern_input(input: *mut JSUrlPatternInput) {
+    if !input.is_null() {
+        drop(Box::from_raw(input));
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    extern "C" fn no_regexps(_: *mut c_void, _: *const u16, _: usize) -> SpecialSchemeMatch {
+        SpecialSchemeMatch::Error
+    }
+
+    fn compile(input: &str) -> Result<JSUrlPattern, Error> {
+        let matcher = Matcher {
+            callback: no_regexps,
+            data: std::ptr::null_mut(),
+        };
+        create_pattern_from_string(input, None, false, &matcher)
+    }
+
+    fn pattern(pattern: &JSUrlPattern, component: UrlPatternComponent) -> &str {
+        &pattern.components[component as usize].pattern
+    }
+
+    fn regexp(pattern: &JSUrlPattern, component: UrlPatternComponent) -> String {
+        String::from_utf16(&pattern.components[component as usize].regexp).unwrap()
+    }
+
+    #[test]
+    fn constructor_string() {
+        let p = compile("https://example.com/books/:id").unwrap();
+        assert_eq!(pattern(&p, Protocol), "https");
+        assert_eq!(pattern(&p, Username), "*");
+        assert_eq!(pattern(&p, Hostname), "example.com");
+        assert_eq!(pattern(&p, Port), "");
+        assert_eq!(pattern(&p, Pathname), "/books/:id");
+        assert_eq!(pattern(&p, Search), "*");
+        assert_eq!(regexp(&p, Pathname), "^\\/books(?:\\/([^\\/]+?))$");
+        assert_eq!(p.components[Pathname as usize].group_names, ["id"]);
+        assert_eq!(p.components[Protocol as usize].kind, UrlPatternComponentKind::Literal);
+        assert_eq!(p.components[Search as usize].kind, UrlPatternComponentKind::Wildcard);
+    }
+
+    #[test]
+    fn relative_string_requires_base() {
+        assert!(compile("/books/:id").is_err());
+    }
+
+    #[test]
+    fn pattern_strings_round_trip() {
+        let cases = [
+            ("/foo/:bar?", "/foo/:bar?"),
+            ("/foo/*", "/foo/*"),
+            ("/foo/(\\d+)", "/foo/(\\d+)"),
+            ("/foo{/bar}?", "/foo{/bar}?"),
+            ("/:a:b", "/:a:b"),
+            ("/foo/:bar*", "/foo/:bar*"),
+            ("/caf\u{e9}", "/caf%C3%A9"),
+        ];
+        for (input, expected) in cases {
+            let init = Init {
+                components: [
+                    None,
+                    None,
+                    None,
+                    None,
+                    None,
+                    Some(input.to_string()),
+                    None,
+                    None,
+                ],
+                base_url: None,
+            };
+            let matcher = Matcher {
+                callback: no_regexps,
+                data: std::ptr::null_mut(),
+            };
+            let p = create_pattern(init, false, &matcher).unwrap();
+            assert_eq!(pattern(&p, Pathname), expected, "{input}");
+        }
+    }
+
+    #[test]
+    fn modifiers_with_prefix() {
+        let parts =
+            parse_pattern_string("/foo/:bar+", &PATHNAME_OPTIONS, |s| Ok(s.to_string())).unwrap();
+        let (regexp, names) = generate_regexp_and_name_list(&parts, &PATHNAME_OPTIONS);
+        assert_eq!(
+            regexp,
+            "^\\/foo(?:\\/((?:[^\\/]+?)(?:\\/(?:[^\\/]+?))*))$"
+        );
+        assert_eq!(names, ["bar"]);
+    }
+
+    #[test]
+    fn invalid_patterns() {
+        let identity = |s: &str| Ok(s.to_string());
+        assert!(parse_pattern_string("/:id/:id", &PATHNAME_OPTIONS, identity).is_err());
+        assert!(parse_pattern_string("/(foo", &PATHNAME_OPTIONS, identity).is_err());
+        assert!(parse_pattern_string("/{foo", &PATHNAME_OPTIONS, identity).is_err());
+        assert!(parse_pattern_string("/(()", &PATHNAME_OPTIONS, identity).is_err());
+    }
+
+    #[test]
+    fn default_port_is_dropped() {
+        let p = compile("http://example.com:80/").unwrap();
+        assert_eq!(pattern(&p, Port), "");
+        let p = compile("http://example.com:8080/").unwrap();
+        assert_eq!(pattern(&p, Port), "8080");
+    }
+
+    #[test]
+    fn process_url_init() {
+        let init = Init {
+            components: [
+                None,
+                None,
+                None,
+                None,
+                None,
+                Some("b c".to_string()),
+                None,
+                None,
+            ],
+            base_url: Some("https://example.com/a/index.html?q#h".to_string()),
+        };
+        let result = process_init(&init, InitType::Url).unwrap();
+        assert_eq!(result.get(Protocol), Some("https"));
+        assert_eq!(result.get(Hostname), Some("example.com"));
+        assert_eq!(result.get(Pathname), Some("/a/b%20c"));
+        assert_eq!(result.get(Search), Some(""));
+    }
+}
@@ -0,0 +1,53 @@
+option(ENABLE_CRYPTO_OFFLOAD "Offload CPU-heavy crypto operations to a host implementing starlingmonkey:crypto-offload" OFF)
+
+set(CRYPTO_OFFLOAD_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+target_sources(host_api PRIVATE ${CRYPTO_OFFLOAD_DIR}/crypto_offload.cpp)
+
+# Generates the C bindings for `WORLD` into `${CMAKE_CURRENT_BINARY_DIR}/${WORLD}-bindings`, adds them to `TARGET`, and
+# makes their header available to it. The sources include the object holding the world's component type, which
+# `wasm-tools component new` adds to the imports and exports of the component created from `TARGET`.
+function(add_crypto_offload_bindings TARGET WORLD)
+    string(REPLACE "-" "_" FILE_NAME ${WORLD})
+    set(DIR ${CMAKE_CURRENT_BINARY_DIR}/${WORLD}-bindings)
+    set(SOURCES ${DIR}/${FILE_NAME}.c ${DIR}/${FILE_NAME}_component_type.o)
+    add_custom_command(
+            OUTPUT ${SOURCES} ${DIR}/${FILE_NAME}.h
+            COMMAND ${WIT_BINDGEN_BIN} c ${CRYPTO_OFFLOAD_DIR}/wit --world ${WORLD} --out-dir ${DIR}
+            DEPENDS ${CRYPTO_OFFLOAD_DIR}/wit/offload.wit
+            VERBATIM
+    )
+    target_sources(${TARGET} PRIVATE ${SOURCES})
+    target_include_directories(${TARGET} PRIVATE ${DIR})
+endfunction()
+
+if (NOT ENABLE_CRYPTO_OFFLOAD)
+    return()
+endif()
+
+include("wit-bindgen")
+include("wac")
+
+add_crypto_offload_bindings(host_api crypto-offload)
+target_compile_definitions(host_api PRIVATE ENABLE_CRYPTO_OFFLOAD)
+
+# Components built with offloading enabled can't be run by hosts that don't provide the interface, which includes the
+# wasmtime used by the tests. For those, a component implementing the interface with the same OpenSSL build the runtime
+# uses is built from `shim/`, which the tests plug into the components they run.
+add_executable(crypto-offload-shim-raw.wasm ${CRYPTO_OFFLOAD_DIR}/shim/shim.cpp)
+add_crypto_offload_bindings(crypto-offload-shim-raw.wasm crypto-offload-provider)
+target_link_libraries(crypto-offload-shim-raw.wasm PRIVATE OpenSSL::Crypto)
+
+# The wasi-0.2.0 host API doesn't need the preview1 adapter for the runtime itself, but OpenSSL's imports in the shim do.
+if (NOT DEFINED ADAPTER)
+    set(ADAPTER "${CMAKE_CURRENT_SOURCE_DIR}/host-apis/wasi-0.2.0/preview1-adapter-release/wasi_snapshot_preview1.wasm")
+endif()
+
+set(CRYPTO_OFFLOAD_SHIM ${CMAKE_CURRENT_BINARY_DIR}/crypto-offload-shim.wasm)
+add_custom_command(
+        OUTPUT ${CRYPTO_OFFLOAD_SHIM}
+        COMMAND ${WASM_TOOLS_BIN} component new $<TARGET_FILE:crypto-offload-shim-raw.wasm> --adapt wasi_snapshot_preview1=${ADAPTER} -o ${CRYPTO_OFFLOAD_SHIM}
+        DEPENDS crypto-offload-shim-raw.wasm
+        VERBATIM
+)
+add_custom_target(crypto-offload-shim ALL DEPENDS ${CRYPTO_OFFLOAD_SHIM})
@@ -0,0 +1,193 @@
+#include "host_api.h"
+
+#ifdef ENABLE_CRYPTO_OFFLOAD
+
+#include "crypto_offload.h"
+
+namespace host_api {
+
+namespace {
+
+using Error = starlingmonkey_crypto_offload_offload_error_t;
+
+// The bindings take lists by mutable pointer, but only read imported functions' arguments.
+crypto_offload_list_u8_t to_list(std::span<const uint8_t> bytes) {
+  return {const_cast<uint8_t *>(bytes.data()), bytes.size()};
+}
+
+starlingmonkey_crypto_offload_offload_hash_algorithm_t to_hash(CryptoOffload::Hash hash) {
+  switch (hash) {
+  case CryptoOffload::Hash::SHA1:
+    return STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA1;
+  case CryptoOffload::Hash::SHA256:
+    return STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA256;
+  case CryptoOffload::Hash::SHA384:
+    return STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA384;
+  case CryptoOffload::Hash::SHA512:
+    return STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA512;
+  }
+  MOZ_ASSERT_UNREACHABLE();
+  return STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA256;
+}
+
+// Takes ownership of the list returned by an offloaded operation, or returns `std::nullopt` if the
+// host declined the operation. The list is allocated with `cabi_realloc`, so it can be handed
+// over to an ArrayBuffer without copying it.
+std::optional<Result<HostBytes>> take_result(bool ok, crypto_offload_list_u8_t &ret, Error err) {
+  if (!ok) {
+    if (err == STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_ERROR_UNSUPPORTED) {
+      return std::nullopt;
+    }
+    return Result<HostBytes>::err(154);
+  }
+
+  // Empty lists aren't backed by an allocation, so there's nothing to take ownership of.
+  if (ret.len == 0) {
+    return Result<HostBytes>::ok();
+  }
+  return Result<HostBytes>::ok(std::unique_ptr<uint8_t[]>{ret.ptr}, ret.len);
+}
+
+} // namespace
+
+bool CryptoOffload::enabled() { return true; }
+
+std::optional<Result<HostBytes>> CryptoOffload::rsassa_pkcs1_sign(std::span<const uint8_t> pkcs8,
+                                                                  Hash hash,
+                                                                  std::span<const uint8_t> data) {
+  auto key_list = to_list(pkcs8);
+  auto data_list = to_list(data);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  bool ok = starlingmonkey_crypto_offload_offload_rsassa_pkcs1_sign(&key_list, to_hash(hash),
+                                                                    &data_list, &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::ecdsa_sign(std::span<const uint8_t> pkcs8,
+                                                           Hash hash,
+                                                           std::span<const uint8_t> data) {
+  auto key_list = to_list(pkcs8);
+  auto data_list = to_list(data);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  bool ok = starlingmonkey_crypto_offload_offload_ecdsa_sign(&key_list, to_hash(hash), &data_list,
+                                                             &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::pbkdf2(std::span<const uint8_t> password,
+                                                       std::span<const uint8_t> salt,
+                                                       uint32_t iterations, Hash hash,
+                                                       uint32_t length) {
+  auto password_list = to_list(password);
+  auto salt_list = to_list(salt);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  bool ok = starlingmonkey_crypto_offload_offload_pbkdf2(&password_list, &salt_list, iterations,
+                                                         to_hash(hash), length, &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::hkdf(std::span<const uint8_t> key,
+                                                     std::span<const uint8_t> salt,
+                                                     std::span<const uint8_t> info, Hash hash,
+                                                     uint32_t length) {
+  auto key_list = to_list(key);
+  auto salt_list = to_list(salt);
+  auto info_list = to_list(info);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  bool ok = starlingmonkey_crypto_offload_offload_hkdf(&key_list, &salt_list, &info_list,
+                                                       to_hash(hash), length, &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::aes_cbc(std::span<const uint8_t> key,
+                                                        std::span<const uint8_t> iv,
+                                                        std::span<const uint8_t> data,
+                                                        bool encrypt) {
+  auto key_list = to_list(key);
+  auto iv_list = to_list(iv);
+  auto data_list = to_list(data);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  auto *op = encrypt ? starlingmonkey_crypto_offload_offload_aes_cbc_encrypt
+                     : starlingmonkey_crypto_offload_offload_aes_cbc_decrypt;
+  bool ok = op(&key_list, &iv_list, &data_list, &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::aes_gcm(std::span<const uint8_t> key,
+                                                        std::span<const uint8_t> iv,
+                                                        std::span<const uint8_t> additional_data,
+                                                        uint8_t tag_length,
+                                                        std::span<const uint8_t> data,
+                                                        bool encrypt) {
+  auto key_list = to_list(key);
+  auto iv_list = to_list(iv);
+  auto additional_data_list = to_list(additional_data);
+  auto data_list = to_list(data);
+  crypto_offload_list_u8_t ret{};
+  Error err{};
+  auto *op = encrypt ? starlingmonkey_crypto_offload_offload_aes_gcm_encrypt
+                     : starlingmonkey_crypto_offload_offload_aes_gcm_decrypt;
+  bool ok = op(&key_list, &iv_list, &additional_data_list, tag_length, &data_list, &ret, &err);
+  return take_result(ok, ret, err);
+}
+
+} // namespace host_api
+
+#else // !ENABLE_CRYPTO_OFFLOAD
+
+// Stub implementations when offloading is disabled, which make all callers fall back to performing
+// the operations themselves.
+namespace host_api {
+
+bool CryptoOffload::enabled() { return false; }
+
+std::optional<Result<HostBytes>> CryptoOffload::rsassa_pkcs1_sign(std::span<const uint8_t> pkcs8,
+                                                                  Hash hash,
+                                                                  std::span<const uint8_t> data) {
+  return std::nullopt;
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::ecdsa_sign(std::span<const uint8_t> pkcs8,
+                                                           Hash hash,
+                                                           std::span<const uint8_t> data) {
+  return std::nullopt;
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::pbkdf2(std::span<const uint8_t> password,
+                                                       std::span<const uint8_t> salt,
+                                                       uint32_t iterations, Hash hash,
+                                                       uint32_t length) {
+  return std::nullopt;
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::hkdf(std::span<const uint8_t> key,
+                                                     std::span<const uint8_t> salt,
+                                                     std::span<const uint8_t> info, Hash hash,
+                                                     uint32_t length) {
+  return std::nullopt;
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::aes_cbc(std::span<const uint8_t> key,
+                                                        std::span<const uint8_t> iv,
+                                                        std::span<const uint8_t> data,
+                                                        bool encrypt) {
+  return std::nullopt;
+}
+
+std::optional<Result<HostBytes>> CryptoOffload::aes_gcm(std::span<const uint8_t> key,
+                                                        std::span<const uint8_t> iv,
+                                                        std::span<const uint8_t> additional_data,
+                                                        uint8_t tag_length,
+                                                        std::span<const uint8_t> data,
+                                                        bool encrypt) {
+  return std::nullopt;
+}
+
+} // namespace host_api
+
+#endif // ENABLE_CRYPTO_OFFLOAD
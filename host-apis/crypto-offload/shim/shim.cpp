@@ -0,0 +1,328 @@
+// A component implementing the `starlingmonkey:crypto-offload/offload` interface with the same
+// OpenSSL build the runtime uses.
+//
+// It's plugged into test components built with `ENABLE_CRYPTO_OFFLOAD`, so that the runtime's
+// imports of the interface are exercised by the regular test suites, running with a stock
+// wasmtime. Operations and parameters it doesn't handle return `error.unsupported`, which also
+// exercises the runtime's fallback path:
+//
+// - ECDSA signing with P-521 keys
+// - AES-GCM with IVs that aren't 96 bits long, or tags that aren't 128 bits long
+
+#include "crypto_offload_provider.h"
+
+#include <openssl/core_names.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/x509.h>
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <span>
+
+namespace {
+
+using List = crypto_offload_provider_list_u8_t;
+using Hash = exports_starlingmonkey_crypto_offload_offload_hash_algorithm_t;
+using Error = exports_starlingmonkey_crypto_offload_offload_error_t;
+
+constexpr Error UNSUPPORTED = EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_ERROR_UNSUPPORTED;
+constexpr Error FAILED = EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_ERROR_FAILED;
+
+template <typename T, void (*Free)(T *)> struct Deleter {
+  void operator()(T *ptr) const { Free(ptr); }
+};
+
+using EvpPkeyPtr = std::unique_ptr<EVP_PKEY, Deleter<EVP_PKEY, EVP_PKEY_free>>;
+using EvpMdCtxPtr = std::unique_ptr<EVP_MD_CTX, Deleter<EVP_MD_CTX, EVP_MD_CTX_free>>;
+using EvpCipherCtxPtr =
+    std::unique_ptr<EVP_CIPHER_CTX, Deleter<EVP_CIPHER_CTX, EVP_CIPHER_CTX_free>>;
+using EvpKdfCtxPtr = std::unique_ptr<EVP_KDF_CTX, Deleter<EVP_KDF_CTX, EVP_KDF_CTX_free>>;
+using EcdsaSigPtr = std::unique_ptr<ECDSA_SIG, Deleter<ECDSA_SIG, ECDSA_SIG_free>>;
+using Pkcs8Ptr =
+    std::unique_ptr<PKCS8_PRIV_KEY_INFO, Deleter<PKCS8_PRIV_KEY_INFO, PKCS8_PRIV_KEY_INFO_free>>;
+
+// The arguments of exported functions are owned by the callee, so every function takes them over
+// with this, which wipes and frees them once it returns.
+class Input final {
+  List list_;
+
+public:
+  explicit Input(List *list) : list_{*list} { *list = {nullptr, 0}; }
+  ~Input() {
+    OPENSSL_cleanse(list_.ptr, list_.len);
+    crypto_offload_provider_list_u8_free(&list_);
+  }
+
+  Input(const Input &) = delete;
+  Input &operator=(const Input &) = delete;
+
+  const uint8_t *data() const { return list_.ptr; }
+  size_t size() const { return list_.len; }
+};
+
+// A result list of up to `capacity` bytes, which is handed over to the caller by `finish`. The
+// generated bindings free it with `free` once it's been returned.
+class Output final {
+  List list_;
+
+public:
+  explicit Output(size_t capacity)
+      : list_{static_cast<uint8_t *>(malloc(capacity > 0 ? capacity : 1)), capacity} {}
+  ~Output() { free(list_.ptr); }
+
+  Output(const Output &) = delete;
+  Output &operator=(const Output &) = delete;
+
+  uint8_t *data() { return list_.ptr; }
+  explicit operator bool() const { return list_.ptr != nullptr; }
+
+  bool finish(size_t len, List *ret) {
+    *ret = {list_.ptr, len};
+    list_.ptr = nullptr;
+    return true;
+  }
+};
+
+const EVP_MD *digest(Hash hash) {
+  switch (hash) {
+  case EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA1:
+    return EVP_sha1();
+  case EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA256:
+    return EVP_sha256();
+  case EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA384:
+    return EVP_sha384();
+  case EXPORTS_STARLINGMONKEY_CRYPTO_OFFLOAD_OFFLOAD_HASH_ALGORITHM_SHA512:
+    return EVP_sha512();
+  default:
+    return nullptr;
+  }
+}
+
+EvpPkeyPtr private_key(const Input &pkcs8) {
+  const unsigned char *p = pkcs8.data();
+  Pkcs8Ptr info(d2i_PKCS8_PRIV_KEY_INFO(nullptr, &p, static_cast<long>(pkcs8.size())));
+  return EvpPkeyPtr(info ? EVP_PKCS82PKEY(info.get()) : nullptr);
+}
+
+// Signs `data` with `key`, writing the signature as OpenSSL produces it into `out`, and returns
+// its length, or 0 on failure.
+size_t sign(EVP_PKEY *key, const EVP_MD *md, const Input &data, std::span<uint8_t> out) {
+  EvpMdCtxPtr ctx(EVP_MD_CTX_new());
+  size_t len = out.size();
+  if (!ctx || EVP_DigestSignInit(ctx.get(), nullptr, md, nullptr, key) != 1 ||
+      EVP_DigestSign(ctx.get(), out.data(), &len, data.data(), data.size()) != 1) {
+    return 0;
+  }
+  return len;
+}
+
+const EVP_CIPHER *aes(size_t key_size, bool gcm) {
+  switch (key_size) {
+  case 16:
+    return gcm ? EVP_aes_128_gcm() : EVP_aes_128_cbc();
+  case 24:
+    return gcm ? EVP_aes_192_gcm() : EVP_aes_192_cbc();
+  case 32:
+    return gcm ? EVP_aes_256_gcm() : EVP_aes_256_cbc();
+  default:
+    return nullptr;
+  }
+}
+
+bool aes_cbc(List *key_list, List *iv_list, List *data_list, bool encrypt, List *ret, Error *err) {
+  Input key(key_list), iv(iv_list), data(data_list);
+  // Invalid key and IV lengths are rejected by the runtime itself.
+  const auto *cipher = aes(key.size(), false);
+  if (!cipher || iv.size() != 16) {
+    *err = UNSUPPORTED;
+    return false;
+  }
+
+  Output output(data.size() + 16);
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  int len = 0;
+  int final_len = 0;
+  if (!output || !ctx ||
+      EVP_CipherInit_ex2(ctx.get(), cipher, key.data(), iv.data(), encrypt ? 1 : 0, nullptr) != 1 ||
+      EVP_CipherUpdate(ctx.get(), output.data(), &len, data.data(), static_cast<int>(data.size())) !=
+          1 ||
+      EVP_CipherFinal_ex(ctx.get(), output.data() + len, &final_len) != 1) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(len + final_len, ret);
+}
+
+bool aes_gcm(List *key_list, List *iv_list, List *additional_data_list, uint8_t tag_length,
+             List *data_list, bool encrypt, List *ret, Error *err) {
+  Input key(key_list), iv(iv_list), additional_data(additional_data_list), data(data_list);
+  const auto *cipher = aes(key.size(), true);
+  if (!cipher || iv.size() != 12 || tag_length != 16) {
+    *err = UNSUPPORTED;
+    return false;
+  }
+  if (!encrypt && data.size() < tag_length) {
+    *err = FAILED;
+    return false;
+  }
+
+  // Decryption takes the tag from the end of `data`, and encryption appends it to the result.
+  size_t input_size = encrypt ? data.size() : data.size() - tag_length;
+  Output output(encrypt ? data.size() + tag_length : input_size);
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  int len = 0;
+  int final_len = 0;
+  if (!output || !ctx ||
+      EVP_CipherInit_ex2(ctx.get(), cipher, key.data(), iv.data(), encrypt ? 1 : 0, nullptr) != 1 ||
+      (additional_data.size() > 0 &&
+       EVP_CipherUpdate(ctx.get(), nullptr, &len, additional_data.data(),
+                        static_cast<int>(additional_data.size())) != 1) ||
+      (!encrypt &&
+       EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, tag_length,
+                           const_cast<uint8_t *>(data.data()) + input_size) != 1) ||
+      EVP_CipherUpdate(ctx.get(), output.data(), &len, data.data(), static_cast<int>(input_size)) !=
+          1 ||
+      EVP_CipherFinal_ex(ctx.get(), output.data() + len, &final_len) != 1 ||
+      (encrypt && EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, tag_length,
+                                      output.data() + len + final_len) != 1)) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(encrypt ? len + final_len + tag_length : len + final_len, ret);
+}
+
+} // namespace
+
+bool exports_starlingmonkey_crypto_offload_offload_rsassa_pkcs1_sign(List *pkcs8_list, Hash hash,
+                                                                     List *data_list, List *ret,
+                                                                     Error *err) {
+  Input pkcs8(pkcs8_list), data(data_list);
+  auto key = private_key(pkcs8);
+  const auto *md = digest(hash);
+  if (!key || !md || EVP_PKEY_get_base_id(key.get()) != EVP_PKEY_RSA) {
+    *err = FAILED;
+    return false;
+  }
+
+  // RSA keys default to PKCS #1 v1.5 padding.
+  Output output(EVP_PKEY_get_size(key.get()));
+  size_t len = output ? sign(key.get(), md, data,
+                             std::span<uint8_t>(output.data(), EVP_PKEY_get_size(key.get())))
+                      : 0;
+  if (len == 0) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(len, ret);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_ecdsa_sign(List *pkcs8_list, Hash hash,
+                                                              List *data_list, List *ret,
+                                                              Error *err) {
+  Input pkcs8(pkcs8_list), data(data_list);
+  auto key = private_key(pkcs8);
+  const auto *md = digest(hash);
+  if (!key || !md || EVP_PKEY_get_base_id(key.get()) != EVP_PKEY_EC) {
+    *err = FAILED;
+    return false;
+  }
+  int bits = EVP_PKEY_get_bits(key.get());
+  if (bits != 256 && bits != 384) {
+    *err = UNSUPPORTED;
+    return false;
+  }
+
+  // OpenSSL produces DER encoded signatures, which are converted to `r | s` with both padded to
+  // the size of the curve's order.
+  uint8_t der[160];
+  size_t der_len = sign(key.get(), md, data, der);
+  const unsigned char *p = der;
+  EcdsaSigPtr sig(der_len > 0 ? d2i_ECDSA_SIG(nullptr, &p, static_cast<long>(der_len)) : nullptr);
+  int coord_size = bits / 8;
+  Output output(coord_size * 2);
+  if (!sig || !output ||
+      BN_bn2binpad(ECDSA_SIG_get0_r(sig.get()), output.data(), coord_size) != coord_size ||
+      BN_bn2binpad(ECDSA_SIG_get0_s(sig.get()), output.data() + coord_size, coord_size) !=
+          coord_size) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(coord_size * 2, ret);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_pbkdf2(List *password_list, List *salt_list,
+                                                          uint32_t iterations, Hash hash,
+                                                          uint32_t length, List *ret, Error *err) {
+  Input password(password_list), salt(salt_list);
+  const auto *md = digest(hash);
+  Output output(length);
+  if (!md || !output || iterations > std::numeric_limits<int>::max() ||
+      length > std::numeric_limits<int>::max() ||
+      PKCS5_PBKDF2_HMAC(reinterpret_cast<const char *>(password.data()),
+                        static_cast<int>(password.size()), salt.data(),
+                        static_cast<int>(salt.size()), static_cast<int>(iterations), md,
+                        static_cast<int>(length), output.data()) != 1) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(length, ret);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_hkdf(List *key_list, List *salt_list,
+                                                        List *info_list, Hash hash,
+                                                        uint32_t length, List *ret, Error *err) {
+  Input key(key_list), salt(salt_list), info(info_list);
+  const auto *md = digest(hash);
+  std::unique_ptr<EVP_KDF, Deleter<EVP_KDF, EVP_KDF_free>> kdf(
+      EVP_KDF_fetch(nullptr, OSSL_KDF_NAME_HKDF, nullptr));
+  EvpKdfCtxPtr ctx(kdf ? EVP_KDF_CTX_new(kdf.get()) : nullptr);
+  Output output(length);
+  if (!md || !ctx || !output) {
+    *err = FAILED;
+    return false;
+  }
+
+  OSSL_PARAM params[] = {
+      OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST,
+                                       const_cast<char *>(EVP_MD_get0_name(md)), 0),
+      OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<uint8_t *>(key.data()),
+                                        key.size()),
+      OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, const_cast<uint8_t *>(salt.data()),
+                                        salt.size()),
+      OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, const_cast<uint8_t *>(info.data()),
+                                        info.size()),
+      OSSL_PARAM_construct_end(),
+  };
+  if (EVP_KDF_derive(ctx.get(), output.data(), length, params) != 1) {
+    *err = FAILED;
+    return false;
+  }
+  return output.finish(length, ret);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_aes_cbc_encrypt(List *key, List *iv, List *data,
+                                                                   List *ret, Error *err) {
+  return aes_cbc(key, iv, data, true, ret, err);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_aes_cbc_decrypt(List *key, List *iv, List *data,
+                                                                   List *ret, Error *err) {
+  return aes_cbc(key, iv, data, false, ret, err);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_aes_gcm_encrypt(List *key, List *iv,
+                                                                   List *additional_data,
+                                                                   uint8_t tag_length, List *data,
+                                                                   List *ret, Error *err) {
+  return aes_gcm(key, iv, additional_data, tag_length, data, true, ret, err);
+}
+
+bool exports_starlingmonkey_crypto_offload_offload_aes_gcm_decrypt(List *key, List *iv,
+                                                                   List *additional_data,
+                                                                   uint8_t tag_length, List *data,
+                                                                   List *ret, Error *err) {
+  return aes_gcm(key, iv, additional_data, tag_length, data, false, ret, err);
+}
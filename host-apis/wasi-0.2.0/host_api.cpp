@@ -1,6 +1,10 @@
 #include "host_api.h"
 #include "bindings/bindings.h"
 #include "handles.h"
+#include "header-name-set.h"
+
+#include <array>
+#include <cstring>
 
 static std::optional<wasi_clocks_monotonic_clock_own_pollable_t> immediately_ready;
 
@@ -107,6 +111,128 @@ Result<uint32_t> Random::get_u32() {
   return Result<uint32_t>::ok(wasi_random_random_get_random_u64());
 }
 
+namespace {
+
+// A ChaCha20-based generator with fast key erasure, as described in
+// https://blog.cr.yp.to/20170723-random.html: each refill of the pool generates a batch of
+// keystream blocks, the first 32 bytes of which immediately replace the key. Bytes are wiped from
+// the pool as they're handed out, so neither the key nor the pool reveal previous output.
+class ChaChaPool final {
+  static constexpr size_t BLOCK_SIZE = 64;
+  static constexpr size_t KEY_SIZE = 32;
+  static constexpr size_t POOL_SIZE = 16 * BLOCK_SIZE;
+  // The generator is reseeded from the host after this many bytes have been produced.
+  static constexpr size_t RESEED_INTERVAL = 1024 * 1024;
+
+  std::array<uint32_t, KEY_SIZE / 4> key_{};
+  std::array<uint8_t, POOL_SIZE> pool_{};
+  size_t available_ = 0;
+  size_t produced_ = 0;
+  bool seeded_ = false;
+
+  static uint32_t rotl(uint32_t v, int c) { return (v << c) | (v >> (32 - c)); }
+
+  static void quarter_round(uint32_t *x, int a, int b, int c, int d) {
+    x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+    x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+    x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 8);
+    x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 7);
+  }
+
+  // Writes ChaCha20 block `counter` for the current key and an all-zero nonce to `out`. The key
+  // changes with every refill, so the nonce never needs to.
+  void block(uint32_t counter, uint8_t *out) const {
+    std::array<uint32_t, 16> input = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    std::copy(key_.begin(), key_.end(), input.begin() + 4);
+    input[12] = counter;
+
+    auto state = input;
+    for (int i = 0; i < 10; i++) {
+      quarter_round(state.data(), 0, 4, 8, 12);
+      quarter_round(state.data(), 1, 5, 9, 13);
+      quarter_round(state.data(), 2, 6, 10, 14);
+      quarter_round(state.data(), 3, 7, 11, 15);
+      quarter_round(state.data(), 0, 5, 10, 15);
+      quarter_round(state.data(), 1, 6, 11, 12);
+      quarter_round(state.data(), 2, 7, 8, 13);
+      quarter_round(state.data(), 3, 4, 9, 14);
+    }
+    for (size_t i = 0; i < state.size(); i++) {
+      uint32_t word = state[i] + input[i];
+      out[i * 4] = word;
+      out[i * 4 + 1] = word >> 8;
+      out[i * 4 + 2] = word >> 16;
+      out[i * 4 + 3] = word >> 24;
+    }
+    wipe(state.data(), sizeof(state));
+  }
+
+  static void wipe(void *data, size_t len) {
+    auto *bytes = static_cast<volatile uint8_t *>(data);
+    for (size_t i = 0; i < len; i++) {
+      bytes[i] = 0;
+    }
+  }
+
+  void seed() {
+    bindings_list_u8_t list{};
+    wasi_random_random_get_random_bytes(KEY_SIZE, &list);
+    MOZ_RELEASE_ASSERT(list.len == KEY_SIZE);
+    std::memcpy(key_.data(), list.ptr, KEY_SIZE);
+    wipe(list.ptr, list.len);
+    free(list.ptr);
+    produced_ = 0;
+    seeded_ = true;
+  }
+
+  void refill() {
+    if (!seeded_ || produced_ >= RESEED_INTERVAL) {
+      seed();
+    }
+    for (size_t i = 0; i < POOL_SIZE / BLOCK_SIZE; i++) {
+      block(i, pool_.data() + i * BLOCK_SIZE);
+    }
+    std::memcpy(key_.data(), pool_.data(), KEY_SIZE);
+    wipe(pool_.data(), KEY_SIZE);
+    available_ = POOL_SIZE - KEY_SIZE;
+  }
+
+public:
+  void fill(std::span<uint8_t> out) {
+    while (!out.empty()) {
+      if (available_ == 0) {
+        refill();
+      }
+      size_t len = std::min(out.size(), available_);
+      uint8_t *start = pool_.data() + POOL_SIZE - available_;
+      std::memcpy(out.data(), start, len);
+      wipe(start, len);
+      available_ -= len;
+      produced_ += len;
+      out = out.subspan(len);
+    }
+  }
+
+  void reset() {
+    wipe(key_.data(), sizeof(key_));
+    wipe(pool_.data(), sizeof(pool_));
+    available_ = 0;
+    produced_ = 0;
+    seeded_ = false;
+  }
+};
+
+ChaChaPool random_pool;
+
+} // namespace
+
+Result<Void> Random::fill(std::span<uint8_t> out) {
+  random_pool.fill(out);
+  return Result<Void>::ok();
+}
+
+void Random::reseed() { random_pool.reset(); }
+
 uint64_t MonotonicClock::now() { return wasi_clocks_monotonic_clock_now(); }
 
 uint64_t MonotonicClock::resolution() { return wasi_clocks_monotonic_clock_resolution(); }
@@ -170,7 +296,7 @@ HttpHeaders::HttpHeaders(const HttpHeadersReadOnly &headers) : HttpHeadersReadOn
 
 // We guard against the list of forbidden headers Wasmtime uses:
 // https://github.com/bytecodealliance/wasmtime/blob/9afc64b4728d6e2067aa52331ff7b1d6f5275b5e/crates/wasi-http/src/types.rs#L273-L284
-static const std::vector forbidden_request_headers = {
+static constexpr HeaderNameSet forbidden_request_headers{std::array<std::string_view, 10>{
   "connection",
   "host",
   "http2-settings",
@@ -181,18 +307,18 @@ static const std::vector forbidden_request_headers = {
   "te",
   "transfer-encoding",
   "upgrade",
-};
+}};
 
 // WASI hosts don't currently make a difference between request and response headers
 // in their lists of forbidden headers.
-static const std::vector forbidden_response_headers = forbidden_request_headers;
+static constexpr auto forbidden_response_headers = forbidden_request_headers;
 
-const std::vector<const char *> &HttpHeaders::get_forbidden_request_headers() {
-  return forbidden_request_headers;
+bool HttpHeaders::is_forbidden_request_header(string_view name) {
+  return forbidden_request_headers.contains(name);
 }
 
-const std::vector<const char *> &HttpHeaders::get_forbidden_response_headers() {
-  return forbidden_response_headers;
+bool HttpHeaders::is_forbidden_response_header(string_view name) {
+  return forbidden_response_headers.contains(name);
 }
 
 HttpHeaders *HttpHeadersReadOnly::clone() { return new HttpHeaders(*this); }
@@ -381,12 +507,16 @@ Result<uint64_t> HttpOutgoingBody::capacity() {
   return Result<uint64_t>::ok(capacity);
 }
 
-void HttpOutgoingBody::write(const uint8_t *bytes, size_t len) {
+Result<Void> HttpOutgoingBody::write(const uint8_t *bytes, size_t len) {
   MOZ_ASSERT(capacity().unwrap() >= len);
 
   auto *state = static_cast<OutgoingBodyHandle *>(this->handle_state_.get());
   Borrow<OutputStream> borrow(state->stream_handle_);
-  MOZ_RELEASE_ASSERT(write_to_outgoing_body(borrow, bytes, len));
+  if (!write_to_outgoing_body(borrow, bytes, len)) {
+    // TODO: proper error handling for all 154 error codes.
+    return Result<Void>::err(154);
+  }
+  return {};
 }
 
 class BodyWriteAllTask final : public api::AsyncTask {
@@ -421,7 +551,9 @@ public:
       }
 
       auto bytes_to_write = std::min(bytes_.len - offset_, static_cast<size_t>(capacity));
-      outgoing_body_->write(bytes_.ptr.get() + offset_, bytes_to_write);
+      if (outgoing_body_->write(bytes_.ptr.get() + offset_, bytes_to_write).is_err()) {
+        return false;
+      }
       offset_ += bytes_to_write;
       MOZ_ASSERT(offset_ <= bytes_.len);
       if (offset_ == bytes_.len) {
@@ -542,8 +674,9 @@ public:
         return true;
       }
 
-      if (bytes.len > 0) {
-        outgoing_body_->write(bytes.ptr.get(), bytes.len);
+      if (bytes.len > 0 && outgoing_body_->write(bytes.ptr.get(), bytes.len).is_err()) {
+        // TODO: proper error handling.
+        return false;
       }
 
       if (done) {
@@ -620,6 +753,19 @@ Result<Void> HttpOutgoingBody::close() {
 
   return {};
 }
+
+void HttpOutgoingBody::abort() {
+  auto state = static_cast<OutgoingBodyHandle *>(handle_state_.get());
+  if (state->pollable_handle_ != INVALID_POLLABLE_HANDLE) {
+    wasi_io_poll_pollable_drop_own(own_pollable_t{state->pollable_handle_});
+    state->pollable_handle_ = INVALID_POLLABLE_HANDLE;
+  }
+  wasi_io_streams_output_stream_drop_own({state->stream_handle_});
+
+  // Dropping the body instead of passing it to `finish` makes the host treat it as corrupted.
+  wasi_http_types_outgoing_body_drop_own({state->take()});
+}
+
 Result<PollableHandle> HttpOutgoingBody::subscribe() {
   auto state = static_cast<OutgoingBodyHandle *>(handle_state_.get());
   if (state->pollable_handle_ == INVALID_POLLABLE_HANDLE) {
@@ -802,6 +948,32 @@ Result<HttpIncomingBody::ReadResult> HttpIncomingBody::read(uint32_t chunk_size)
   return Res::ok(ReadResult(false, unique_ptr<uint8_t[]>(ret.ptr), ret.len));
 }
 
+Result<HttpIncomingBody::ReadIntoResult> HttpIncomingBody::read_into(uint8_t *buffer,
+                                                                    uint32_t len) {
+  typedef Result<ReadIntoResult> Res;
+
+  bindings_list_u8_t ret{};
+  wasi_io_streams_stream_error_t err{};
+  auto body_handle = IncomingBodyHandle::cast(handle_state_.get());
+  auto borrow = Borrow<InputStream>(body_handle->stream_handle_);
+  bool success = wasi_io_streams_method_input_stream_read(borrow, len, &ret, &err);
+  if (!success) {
+    if (err.tag == WASI_IO_STREAMS_STREAM_ERROR_CLOSED) {
+      return Res::ok(ReadIntoResult{.done = true, .len = 0});
+    }
+    dump_io_error(err);
+    return Res::err(154);
+  }
+
+  // The host never returns more than was requested, so the list always fits into `buffer`. It's
+  // freed right away, instead of being handed out as a chunk that has to be wrapped in a new
+  // ArrayBuffer.
+  MOZ_ASSERT(ret.len <= len);
+  memcpy(buffer, ret.ptr, ret.len);
+  free(ret.ptr);
+  return Res::ok(ReadIntoResult{.done = false, .len = ret.len});
+}
+
 // TODO: implement
 Result<Void> HttpIncomingBody::close() { return {}; }
 
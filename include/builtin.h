@@ -294,7 +294,8 @@ static bool init_class_impl(JSContext *cx, const HandleObject global,
 template <typename Impl, typename ClassPolicy>
 PersistentRooted<JSObject *> BuiltinImpl<Impl, ClassPolicy>::proto_obj{};
 
-template <typename Impl> class BuiltinNoConstructor : public BuiltinImpl<Impl> {
+template <typename Impl, typename ClassPolicy = DefaultClassPolicy>
+class BuiltinNoConstructor : public BuiltinImpl<Impl, ClassPolicy> {
 public:
   static constexpr int ctor_length = 1;
 
@@ -304,8 +305,8 @@ public:
   }
 
   static bool init_class(JSContext *cx, HandleObject global) {
-    return BuiltinImpl<Impl>::init_class_impl(cx, global) &&
-           JS_DeleteProperty(cx, global, BuiltinImpl<Impl>::class_.name);
+    return BuiltinImpl<Impl, ClassPolicy>::init_class_impl(cx, global) &&
+           JS_DeleteProperty(cx, global, BuiltinImpl<Impl, ClassPolicy>::class_.name);
   }
 };
 
@@ -0,0 +1,116 @@
+#ifndef JS_RUNTIME_HEADER_NAME_SET_H
+#define JS_RUNTIME_HEADER_NAME_SET_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+namespace host_api {
+
+constexpr std::array<char, 256> make_ascii_lowercase_table() {
+  std::array<char, 256> table{};
+  for (size_t ch = 0; ch < table.size(); ch++) {
+    table.at(ch) = static_cast<char>(ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch);
+  }
+  return table;
+}
+
+/// Maps each byte to its ASCII-lowercased counterpart, leaving all other bytes untouched.
+inline constexpr std::array<char, 256> ASCII_LOWERCASE = make_ascii_lowercase_table();
+
+/// Called during constant evaluation if no perfect hash could be found, to fail compilation.
+void header_name_set_no_perfect_hash_found();
+
+/// An immutable set of header names, matched ASCII case-insensitively.
+///
+/// The set is backed by a perfect hash table that is computed at compile time: a lookup hashes
+/// the case-folded name once, and then compares it against at most a single candidate.
+///
+/// Usage:
+///   static constexpr HeaderNameSet forbidden{std::array<std::string_view, 2>{"host", "te"}};
+///   forbidden.contains("Host"); // true
+template <size_t N> class HeaderNameSet final {
+  static constexpr uint8_t EMPTY_SLOT = UINT8_MAX;
+  static_assert(N < EMPTY_SLOT, "HeaderNameSet supports at most 254 names");
+
+  // Keeping the load factor at or below 1/4 means a seed yielding no collisions is found
+  // within very few attempts.
+  static constexpr size_t TABLE_SIZE = std::bit_ceil(std::max<size_t>(N * 4, 1));
+  static constexpr uint32_t MAX_SEED_ATTEMPTS = 1 << 16;
+
+  std::array<std::string_view, N> names_;
+  std::array<uint8_t, TABLE_SIZE> slots_{};
+  uint32_t seed_ = 0;
+  size_t min_len_ = SIZE_MAX;
+  size_t max_len_ = 0;
+
+  // FNV-1a over the case-folded name, with a final avalanche step so that the low bits used for
+  // indexing depend on all input bytes.
+  static constexpr uint32_t hash(const std::string_view name, const uint32_t seed) {
+    uint32_t h = 2166136261U ^ seed;
+    for (const char ch : name) {
+      h ^= static_cast<uint8_t>(ASCII_LOWERCASE[static_cast<uint8_t>(ch)]);
+      h *= 16777619U;
+    }
+    return h ^ (h >> 16);
+  }
+
+  static constexpr bool equals_ignore_case(const std::string_view a, const std::string_view b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+      if (ASCII_LOWERCASE[static_cast<uint8_t>(a[i])] !=
+          ASCII_LOWERCASE[static_cast<uint8_t>(b[i])]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool try_seed(const uint32_t seed) {
+    slots_.fill(EMPTY_SLOT);
+    for (size_t i = 0; i < N; i++) {
+      auto &slot = slots_[hash(names_[i], seed) & (TABLE_SIZE - 1)];
+      if (slot != EMPTY_SLOT) {
+        return false;
+      }
+      slot = static_cast<uint8_t>(i);
+    }
+    seed_ = seed;
+    return true;
+  }
+
+public:
+  consteval explicit HeaderNameSet(const std::array<std::string_view, N> &names) : names_(names) {
+    for (const auto name : names_) {
+      min_len_ = std::min(min_len_, name.size());
+      max_len_ = std::max(max_len_, name.size());
+    }
+
+    for (uint32_t seed = 0; seed < MAX_SEED_ATTEMPTS; seed++) {
+      if (try_seed(seed)) {
+        return;
+      }
+    }
+    header_name_set_no_perfect_hash_found();
+  }
+
+  /// Returns true if `name` is ASCII case-insensitively equal to one of the names in this set.
+  [[nodiscard]] constexpr bool contains(const std::string_view name) const {
+    if (name.size() < min_len_ || name.size() > max_len_) {
+      return false;
+    }
+    const uint8_t slot = slots_[hash(name, seed_) & (TABLE_SIZE - 1)];
+    return slot != EMPTY_SLOT && equals_ignore_case(names_[slot], name);
+  }
+
+  [[nodiscard]] constexpr const std::array<std::string_view, N> &names() const { return names_; }
+  [[nodiscard]] constexpr size_t size() const { return N; }
+};
+
+} // namespace host_api
+
+#endif
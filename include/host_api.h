@@ -261,6 +261,16 @@ public:
   /// Might return an empty string if no data is available.
   Result<ReadResult> read(uint32_t chunk_size);
 
+  class ReadIntoResult final {
+  public:
+    bool done = false;
+    size_t len = 0;
+  };
+  /// Read up to `len` bytes from this handle into the caller-provided `buffer`.
+  ///
+  /// Might read 0 bytes if no data is available.
+  Result<ReadIntoResult> read_into(uint8_t *buffer, uint32_t len);
+
   /// Close this handle, and reset internal state to invalid.
   Result<Void> close();
 
@@ -281,8 +291,8 @@ public:
   ///
   /// Asserts that the receiver is ready to write the entire chunk, which the caller must ensure
   /// by calling `receiver->capacity()` first and not attempting to write more than the returned
-  /// value.
-  void write(const uint8_t *bytes, size_t len);
+  /// value. Returns an error if the receiver's stream failed, e.g. because it was closed.
+  Result<Void> write(const uint8_t *bytes, size_t len);
 
   /// Writes the given number of bytes from the given buffer to the given handle.
   ///
@@ -299,6 +309,10 @@ public:
   /// Close this handle, and reset internal state to invalid.
   Result<Void> close();
 
+  /// Drop this handle without finishing the body, which signals the receiver that the body is
+  /// incomplete, and reset internal state to invalid.
+  void abort();
+
   Result<PollableHandle> subscribe() override;
   void unsubscribe() override;
 };
@@ -385,8 +399,12 @@ public:
   Result<Void> append(string_view name, string_view value);
   Result<Void> remove(string_view name);
 
-  static const std::vector<const char *> &get_forbidden_request_headers();
-  static const std::vector<const char *> &get_forbidden_response_headers();
+  /// Returns true if the host forbids setting the header `name` on requests.
+  /// `name` is compared ASCII case-insensitively.
+  static bool is_forbidden_request_header(string_view name);
+  /// Returns true if the host forbids setting the header `name` on responses.
+  /// `name` is compared ASCII case-insensitively.
+  static bool is_forbidden_response_header(string_view name);
 };
 
 class HttpRequestResponseBase : public Resource {
@@ -416,6 +434,17 @@ public:
 
   virtual Result<HttpIncomingBody *> body() = 0;
   bool has_body() const { return body_ != nullptr; }
+
+  /// Transfers ownership of the body to the caller, creating it first if needed. A body can only
+  /// be consumed once, so `body()` returns an error afterwards.
+  Result<std::unique_ptr<HttpIncomingBody>> take_body() {
+    auto res = body();
+    if (const auto *err = res.to_err()) {
+      return Result<std::unique_ptr<HttpIncomingBody>>::err(*err);
+    }
+    body_ = nullptr;
+    return Result<std::unique_ptr<HttpIncomingBody>>::ok(res.unwrap());
+  }
 };
 
 class HttpOutgoingBodyOwner {
@@ -518,6 +547,70 @@ public:
   static Result<HostBytes> get_bytes(size_t num_bytes);
 
   static Result<uint32_t> get_u32();
+
+  /**
+   * Fills `out` with cryptographically secure random bytes.
+   *
+   * The bytes come from a ChaCha20-based generator that's seeded from the host and produces its
+   * output in large blocks, so that small requests, e.g. for UUIDs, don't require a host call each.
+   */
+  static Result<Void> fill(std::span<uint8_t> out);
+
+  /**
+   * Wipes the generator's state, so that it's seeded from the host again on its next use.
+   *
+   * Must be called when pre-initialization finishes, so that instances resumed from the same
+   * snapshot never share random bytes.
+   */
+  static void reseed();
+};
+
+/**
+ * CPU-heavy cryptographic operations performed natively by the host, through the
+ * `starlingmonkey:crypto-offload/offload` interface.
+ *
+ * Only builds with the `ENABLE_CRYPTO_OFFLOAD` CMake option import that interface. In all other
+ * builds, and for operations the host declines, these functions return `std::nullopt`, and the
+ * caller has to perform the operation itself. A contained error means that the host performed the
+ * operation, and it failed.
+ *
+ * Keys are passed as DER encoded PKCS #8 structures, and all results use the encodings Web Crypto
+ * specifies.
+ */
+class CryptoOffload final {
+public:
+  CryptoOffload() = delete;
+
+  enum class Hash : uint8_t { SHA1, SHA256, SHA384, SHA512 };
+
+  /**
+   * Whether the runtime was built with support for offloading. Host calls must not be made during
+   * pre-initialization, so callers also have to check the engine's state.
+   */
+  static bool enabled();
+
+  static std::optional<Result<HostBytes>> rsassa_pkcs1_sign(std::span<const uint8_t> pkcs8,
+                                                            Hash hash,
+                                                            std::span<const uint8_t> data);
+  static std::optional<Result<HostBytes>> ecdsa_sign(std::span<const uint8_t> pkcs8, Hash hash,
+                                                     std::span<const uint8_t> data);
+
+  static std::optional<Result<HostBytes>> pbkdf2(std::span<const uint8_t> password,
+                                                 std::span<const uint8_t> salt,
+                                                 uint32_t iterations, Hash hash, uint32_t length);
+  static std::optional<Result<HostBytes>> hkdf(std::span<const uint8_t> key,
+                                               std::span<const uint8_t> salt,
+                                               std::span<const uint8_t> info, Hash hash,
+                                               uint32_t length);
+
+  static std::optional<Result<HostBytes>> aes_cbc(std::span<const uint8_t> key,
+                                                  std::span<const uint8_t> iv,
+                                                  std::span<const uint8_t> data, bool encrypt);
+  static std::optional<Result<HostBytes>> aes_gcm(std::span<const uint8_t> key,
+                                                  std::span<const uint8_t> iv,
+                                                  std::span<const uint8_t> additional_data,
+                                                  uint8_t tag_length,
+                                                  std::span<const uint8_t> data, bool encrypt);
 };
 
 class MonotonicClock final {
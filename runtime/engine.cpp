@@ -525,6 +525,7 @@ const mozilla::Maybe<std::string> &Engine::init_location() const {
 void Engine::finish_pre_initialization() {
   MOZ_ASSERT(state_ == EngineState::ScriptPreInitializing);
   js::ResetMathRandomSeed(ENGINE->cx());
+  host_api::Random::reseed();
   state_ = EngineState::Initialized;
 }
 
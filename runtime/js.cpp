@@ -10,6 +10,7 @@
 #include "host_api.h"
 #include "wasi/api.h"
 #include "wasi/libc-environ.h"
+#include "wasi/libc.h"
 #include "wizer.h"
 #ifdef MEM_STATS
 #include <string>
@@ -72,6 +73,9 @@ void wizen() {
   MOZ_RELEASE_ASSERT(!__wasi_clock_time_get(__WASI_CLOCKID_MONOTONIC, 1, &t));
   mono_clock_offset = std::max(mono_clock_offset, t);
   __wasilibc_deinitialize_environ();
+  // Directories preopened for wizening aren't available to the resumed snapshot. Forget about
+  // them, so the ones given to the runtime are looked up on first use instead.
+  __wasilibc_reset_preopens();
 }
 
 WIZER_INIT(wizen);
@@ -0,0 +1,8 @@
+addEventListener('fetch', (event) => {
+  // Made up of several segments, one of which is shared by two parts, and larger than the chunk
+  // size used when streaming Blobs.
+  const part = new Blob(['abcdefghij'.repeat(7000)]);
+  const blob = new Blob([part, '|', part.slice(10, 30010)]);
+  console.log(`[blob-body]: size ${blob.size}`);
+  event.respondWith(new Response(blob));
+});
@@ -0,0 +1,35 @@
+addEventListener('fetch', async (event) => {
+  try {
+    if (event.request.url.endsWith('/nested')) {
+      event.respondWith(new Response('0123456789'.repeat(1000)));
+      return;
+    }
+
+    let resolve;
+    event.respondWith(new Promise((r) => resolve = r));
+
+    // Incoming bodies are byte streams, so they can be read into a single, reused buffer.
+    let response = await fetch(event.request.url + 'nested');
+    let reader = response.body.getReader({ mode: 'byob' });
+    let buffer = new ArrayBuffer(4096);
+    let text = '';
+    let decoder = new TextDecoder();
+    while (true) {
+      let { done, value } = await reader.read(new Uint8Array(buffer));
+      if (done) {
+        break;
+      }
+      text += decoder.decode(value, { stream: true });
+      buffer = value.buffer;
+    }
+    text += decoder.decode();
+    console.log(`[byob]: read ${text.length} bytes, buffer size ${buffer.byteLength}`);
+    console.log(`[byob]: content matches: ${text === '0123456789'.repeat(1000)}`);
+
+    // Default readers still receive the chunks as read from the host.
+    response = await fetch(event.request.url + 'nested');
+    resolve(new Response(await response.text()));
+  } catch (e) {
+    console.error(e);
+  }
+});
@@ -0,0 +1,24 @@
+addEventListener('fetch', async (event) => {
+  try {
+    if (event.request.url.endsWith('/nested')) {
+      let encoder = new TextEncoder();
+      let body = new TransformStream();
+      let writer = body.writable.getWriter();
+      event.respondWith(new Response(body.readable));
+      await writer.write(encoder.encode('hello\n'));
+      await writer.write(encoder.encode('world\n'));
+      writer.close();
+      return;
+    }
+
+    let resolve;
+    event.respondWith(new Promise((r) => resolve = r));
+    let response = await fetch(event.request.url + 'nested');
+    // Both the clone and the original are consumed without ever being reified as streams.
+    let copy = response.clone();
+    console.log(`[clone]: ${JSON.stringify(await copy.text())}`);
+    resolve(response);
+  } catch (e) {
+    console.error(e);
+  }
+});
@@ -0,0 +1,46 @@
+addEventListener('fetch', async (event) => {
+  try {
+    if (event.request.url.endsWith('/nested')) {
+      event.respondWith(new Response('This sentence will be compressed and decompressed.\n'.repeat(64)));
+      return;
+    }
+
+    let resolve;
+    event.respondWith(new Promise((r) => resolve = r));
+
+    // An aborted pipe rejects, and doesn't forward any chunks.
+    let controller = new AbortController();
+    let { writable } = new TransformStream();
+    let aborted = (await fetch(event.request.url + 'nested')).body.pipeTo(writable, {
+      signal: controller.signal,
+    });
+    controller.abort(new Error('pipe aborted'));
+    try {
+      await aborted;
+    } catch (e) {
+      console.log(`[abort]: ${e.message}`);
+    }
+
+    // Options the native pipe doesn't support are handed to the builtin pipeTo without running
+    // their getters a second time.
+    let getterCalls = 0;
+    let options = {
+      get preventAbort() { getterCalls++; return false; },
+      get signal() { getterCalls++; return {}; },
+    };
+    try {
+      await (await fetch(event.request.url + 'nested')).body.pipeTo(new TransformStream().writable,
+                                                                    options);
+    } catch (e) {
+      console.log(`[options]: ${e.constructor.name}, ${getterCalls} getter calls`);
+    }
+
+    // Body chunks are moved through both transforms without a user-defined transform in the chain.
+    let response = await fetch(event.request.url + 'nested');
+    resolve(new Response(response.body
+      .pipeThrough(new CompressionStream('gzip'))
+      .pipeThrough(new DecompressionStream('gzip'))));
+  } catch (e) {
+    console.error(e);
+  }
+});
@@ -0,0 +1,18 @@
+addEventListener('fetch', (event) => {
+  event.respondWith((async () => {
+    // Files are served from a Blob backed by the file, so they're only read as the body is consumed.
+    const response = await fetch('file:///public/fox.txt');
+    console.log(`[file]: status ${response.status}, length ${response.headers.get('content-length')}`);
+
+    const range = await fetch('file:///public/fox.txt', { headers: { Range: 'bytes=4-18' } });
+    console.log(`[file]: range status ${range.status}, content '${await range.text()}'`);
+
+    try {
+      await fetch('file:///public/missing.txt');
+    } catch (e) {
+      console.log(`[file]: missing file rejects with ${e.name}`);
+    }
+
+    return new Response(response.body);
+  })());
+});
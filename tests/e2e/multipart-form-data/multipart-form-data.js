@@ -0,0 +1,42 @@
+addEventListener('fetch', async (event) => {
+  try {
+    if (event.request.url.endsWith('/nested')) {
+      const form = new FormData();
+      form.append('text', 'héllo €');
+      form.append('file', new Blob(['abcdefghij'.repeat(20000)], { type: 'text/x-letters' }),
+                  'letters.txt');
+      form.append('empty', '');
+      // Outgoing FormData bodies are encoded straight into the host's body.
+      event.respondWith(new Response(form));
+      return;
+    }
+
+    let resolve;
+    event.respondWith(new Promise((r) => resolve = r));
+
+    // The body is larger than a single read from the host, so it's parsed in several chunks.
+    const response = await fetch(event.request.url + 'nested');
+    const form = await response.formData();
+    console.log(`[multipart]: text ${form.get('text') === 'héllo €'}`);
+    const file = form.get('file');
+    console.log(`[multipart]: file ${file.name} ${file.type} ${file.size}`);
+    const content = await file.text();
+    console.log(`[multipart]: content matches: ${content === 'abcdefghij'.repeat(20000)}`);
+    console.log(`[multipart]: empty ${JSON.stringify(form.get('empty'))}`);
+
+    // Bodies that aren't incoming are read in full first, with the parsed Files sharing the buffer.
+    const local = await new Response(form).formData();
+    const localFile = local.get('file');
+    const slice = await localFile.slice(5, 15).text();
+    console.log(`[multipart]: local ${localFile.name} ${localFile.size} ${slice}`);
+
+    // The encoded length is known up front, and matches the body read through its stream.
+    const encoded = new Response(local);
+    const length = Number(encoded.headers.get('content-length'));
+    const body = await encoded.arrayBuffer();
+    console.log(`[multipart]: content-length matches: ${length === body.byteLength}`);
+    resolve(new Response([...form.keys()].join(',')));
+  } catch (e) {
+    console.error(e);
+  }
+});
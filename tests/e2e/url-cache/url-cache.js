@@ -0,0 +1,23 @@
+addEventListener('fetch', (event) => {
+  // Parsed URLs are cached, so the same input has to be resolved against each base separately,
+  // and mutating a URL object must not affect later parses of the same input.
+  const first = new URL('/a/b?c', 'https://example.com/x/');
+  first.pathname = '/changed';
+  const second = new URL('/a/b?c', 'https://example.com/x/');
+  const other = new URL('/a/b?c', 'https://example.org/');
+  console.log(`[url-cache]: ${first.href} ${second.href} ${other.href}`);
+
+  // Requests resolve relative URLs against the request's own URL, which is cached as well.
+  const request = new Request('path?q', {});
+  const again = new Request(event.request.url);
+  console.log(`[url-cache]: ${request.url === new URL('path?q', event.request.url).href}`);
+  console.log(`[url-cache]: ${again.url === new URL(event.request.url).href}`);
+
+  try {
+    new URL('not a url');
+  } catch (e) {
+    console.log(`[url-cache]: ${e.message}`);
+  }
+
+  event.respondWith(new Response(second.pathname + second.search));
+});
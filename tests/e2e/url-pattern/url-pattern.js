@@ -0,0 +1,62 @@
+// A route table of the size real applications use, set up once and matched the way a router would.
+const routes = [];
+for (let i = 0; i < 100; i++) {
+  routes.push(new URLPattern({ pathname: `/api/v1/resource${i}/:id(\\d+)` }));
+  routes.push(new URLPattern({ pathname: `/static/section${i}/*` }));
+}
+
+function route(url) {
+  const index = routes.findIndex((route) => route.test(url));
+  return [index, routes[index].exec(url)];
+}
+
+function error(fn) {
+  try {
+    fn();
+  } catch (e) {
+    return `${e.name}: ${e.message}`;
+  }
+}
+
+addEventListener('fetch', (event) => {
+  const [api, apiResult] = route('https://example.com/api/v1/resource42/1234?x=1');
+  console.log(`[url-pattern]: ${api} ${apiResult.pathname.groups.id} ${apiResult.search.input}`);
+  const [asset, assetResult] = route('https://example.com/static/section7/css/app.css');
+  console.log(`[url-pattern]: ${asset} ${assetResult.pathname.groups[0]}`);
+  const unmatched = 'https://example.com/api/v1/resource42/abc';
+  console.log(`[url-pattern]: ${routes.findIndex((route) => route.test(unmatched))}`);
+
+  // Patterns created during request handling are compiled once, and behave the same.
+  const again = new URLPattern({ pathname: '/api/v1/resource42/:id(\\d+)' });
+  console.log(`[url-pattern]: ${again.test('https://example.com/api/v1/resource42/1')}`);
+
+  const books = new URLPattern('https://:sub.example.com/books/:id?');
+  console.log(
+    `[url-pattern]: ${books.protocol} ${books.hostname} ${books.port === ''} ${books.pathname}`,
+  );
+  const booksResult = books.exec('https://shop.example.com/books');
+  console.log(`[url-pattern]: ${booksResult.hostname.groups.sub} ${booksResult.pathname.groups.id}`);
+
+  const users = new URLPattern('/users/:name', 'https://example.com');
+  console.log(
+    `[url-pattern]: ${users.test('https://example.com/users/ada')} ` +
+      `${users.test('/users/ada', 'https://example.com')} ` +
+      `${users.test('https://example.org/users/ada')} ` +
+      `${users.test({ protocol: 'https', hostname: 'example.com', pathname: '/users/ada' })}`,
+  );
+
+  const about = { pathname: '/About' };
+  console.log(
+    `[url-pattern]: ${new URLPattern(about, { ignoreCase: true }).test('https://x.test/about')} ` +
+      `${new URLPattern(about).test('https://x.test/about')}`,
+  );
+  console.log(
+    `[url-pattern]: ${routes[0].hasRegExpGroups} ${new URLPattern({ pathname: '/a/:b' }).hasRegExpGroups}`,
+  );
+
+  console.log(`[url-pattern]: ${error(() => new URLPattern({ pathname: '/(' }))}`);
+  console.log(`[url-pattern]: ${error(() => new URLPattern({ pathname: '/:id([)' }))}`);
+  console.log(`[url-pattern]: ${error(() => new URLPattern('/relative'))}`);
+
+  event.respondWith(new Response('ok'));
+});
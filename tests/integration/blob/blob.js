@@ -31,8 +31,8 @@ async function readStream(stream) {
 
 export const handler = serveTest(async (t) => {
   await t.test("blob-multiple-streams", async () => {
-    // Native implementation uses 8192 chunks, make sure we use few of those.
-    const size = 3 * 8192;
+    // Native implementation uses chunks of up to 64 KiB, make sure we use few of those.
+    const size = 3 * 65536;
     const buffer = new Uint8Array(size);
     for (let i = 0; i < size; i++) {
       buffer[i] = i % 256;
@@ -53,4 +53,46 @@ export const handler = serveTest(async (t) => {
     deepStrictEqual(data1, buffer, "buffer content matches");
     deepStrictEqual(data2, buffer, "buffer content matches");
   });
+
+  await t.test("blob-segmented-parts", async () => {
+    const size = 1000;
+    const buffer = new Uint8Array(size);
+    for (let i = 0; i < size; i++) {
+      buffer[i] = i % 251;
+    }
+
+    // Large Blob parts share their data, small ones are copied. Mix both, and slices of them.
+    const large = new Blob([buffer]);
+    const small = new Blob([buffer.subarray(0, 10)]);
+    const blob = new Blob([large, "abc", small, large.slice(100, 900), buffer.subarray(990)]);
+
+    const expected = new Uint8Array(size + 3 + 10 + 800 + 10);
+    expected.set(buffer, 0);
+    expected.set([97, 98, 99], size);
+    expected.set(buffer.subarray(0, 10), size + 3);
+    expected.set(buffer.subarray(100, 900), size + 13);
+    expected.set(buffer.subarray(990), size + 813);
+
+    strictEqual(blob.size, expected.length, "size matches");
+    deepStrictEqual(await blob.bytes(), expected, "bytes match");
+    deepStrictEqual(new Uint8Array(await blob.arrayBuffer()), expected, "arrayBuffer matches");
+    deepStrictEqual(await readStream(blob.stream()), expected, "stream matches");
+    deepStrictEqual(await structuredClone(blob).bytes(), expected, "clone matches");
+
+    // Slices spanning segment boundaries, and slices of slices.
+    const slice = blob.slice(950, 1500);
+    deepStrictEqual(await slice.bytes(), expected.subarray(950, 1500), "slice matches");
+    const nested = slice.slice(40, -10);
+    deepStrictEqual(await nested.bytes(), expected.subarray(990, 1490), "nested slice matches");
+    strictEqual(blob.slice(-5, -10).size, 0, "empty slice");
+  });
+
+  await t.test("blob-segmented-text", async () => {
+    // Split a multi-byte UTF-8 sequence across two shared segments.
+    const text = "\u00e9".repeat(200) + "\u{1F600}" + "\u00e9".repeat(200);
+    const bytes = new TextEncoder().encode(text);
+    const split = 401;
+    const blob = new Blob([new Blob([bytes.subarray(0, split)]), new Blob([bytes.subarray(split)])]);
+    strictEqual(await blob.text(), text, "text matches");
+  });
 });
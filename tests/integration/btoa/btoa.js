@@ -375,4 +375,93 @@ export const handler = serveTest(async (t) => {
     throws(() => atob("--"));
     throws(() => atob("__"));
   });
+  t.test('long inputs', () => {
+    var everything = "";
+    for (var i = 0; i < 256; i++) {
+      everything += String.fromCharCode(i);
+    }
+    for (var length = 0; length < 100; length++) {
+      var data = everything.repeat(2).slice(length);
+      strictEqual(atob(btoa(data)), data, `roundtrip of ${data.length} chars`);
+    }
+
+    var encoded = btoa(everything.repeat(4));
+    var wrapped = encoded.match(/.{1,76}/g).join("\r\n");
+    strictEqual(atob(wrapped), everything.repeat(4), "atob of line-wrapped input");
+    throws(() => atob(encoded.slice(0, 100) + "-" + encoded.slice(101)));
+    throws(() => atob(encoded.slice(0, 100) + "=" + encoded.slice(101)));
+    throws(() => btoa(everything.repeat(4) + "\u0100"));
+  });
+  t.test('Uint8Array base64', () => {
+    var bytes = new Uint8Array(256);
+    for (var i = 0; i < 256; i++) {
+      bytes[i] = i;
+    }
+    var everything = String.fromCharCode(...bytes);
+    strictEqual(bytes.toBase64(), btoa(everything));
+    strictEqual(new Uint8Array([0xfb, 0xff]).toBase64(), "+/8=");
+    strictEqual(new Uint8Array([0xfb, 0xff]).toBase64({ alphabet: "base64url" }), "-_8=");
+    strictEqual(new Uint8Array([0xfb, 0xff]).toBase64({ omitPadding: true }), "+/8");
+    throws(() => bytes.toBase64({ alphabet: "other" }), TypeError);
+    throws(() => Uint8Array.prototype.toBase64.call([1, 2]), TypeError);
+
+    strictEqual(String.fromCharCode(...Uint8Array.fromBase64(btoa(everything))), everything);
+    strictEqual(Uint8Array.fromBase64(" +/8 = ").join(), "251,255");
+    strictEqual(Uint8Array.fromBase64("-_8", { alphabet: "base64url" }).join(), "251,255");
+    throws(() => Uint8Array.fromBase64("-_8="), SyntaxError);
+    throws(() => Uint8Array.fromBase64("+/9=", { lastChunkHandling: "strict" }), SyntaxError);
+    throws(() => Uint8Array.fromBase64("+/8", { lastChunkHandling: "strict" }), SyntaxError);
+    strictEqual(Uint8Array.fromBase64("AAAA+/8", { lastChunkHandling: "stop-before-partial" }).join(), "0,0,0");
+    throws(() => Uint8Array.fromBase64(42), TypeError);
+
+    var target = new Uint8Array(4);
+    var result = target.setFromBase64("AQIDBAUG");
+    strictEqual(result.read, 4);
+    strictEqual(result.written, 3);
+    strictEqual(target.join(), "1,2,3,0");
+    target = new Uint8Array(8);
+    throws(() => target.setFromBase64("AQIDBA!"), SyntaxError);
+    strictEqual(target.join(), "1,2,3,0,0,0,0,0");
+
+    var resizable = new ArrayBuffer(4, { maxByteLength: 8 });
+    var tracking = new Uint8Array(resizable);
+    var fixed = new Uint8Array(resizable, 0, 2);
+    tracking.set([0xfb, 0xff, 1, 2]);
+    resizable.resize(2);
+    strictEqual(tracking.toBase64(), "+/8=", "length-tracking array");
+    strictEqual(tracking.setFromHex("010203").written, 2, "length-tracking array");
+    resizable.resize(1);
+    throws(() => fixed.toBase64(), TypeError);
+    throws(() => fixed.toHex(), TypeError);
+    throws(() => fixed.setFromBase64("AA=="), TypeError);
+    throws(() => fixed.setFromHex("00"), TypeError);
+
+    // Converting the options can shrink or detach the buffer.
+    resizable.resize(4);
+    var shrink = { get alphabet() { resizable.resize(1); return "base64"; } };
+    strictEqual(tracking.toBase64(shrink), "AQ==", "array shrunk by options");
+    var detached = new Uint8Array(4);
+    var detach = { get alphabet() { detached.buffer.transfer(); return "base64"; } };
+    throws(() => detached.toBase64(detach), TypeError);
+    detached = new Uint8Array(4);
+    throws(() => detached.setFromBase64("AA==", detach), TypeError);
+  });
+  t.test('Uint8Array hex', () => {
+    var bytes = new Uint8Array(40);
+    for (var i = 0; i < bytes.length; i++) {
+      bytes[i] = i * 7;
+    }
+    var hex = Array.from(bytes, (b) => b.toString(16).padStart(2, "0")).join("");
+    strictEqual(bytes.toHex(), hex);
+    strictEqual(Uint8Array.fromHex(hex).join(), bytes.join());
+    strictEqual(Uint8Array.fromHex("CAFEbabe").join(), "202,254,186,190");
+    throws(() => Uint8Array.fromHex("abc"), SyntaxError);
+    throws(() => Uint8Array.fromHex("zz"), SyntaxError);
+
+    var target = new Uint8Array(2);
+    var result = target.setFromHex("010203");
+    strictEqual(result.read, 4);
+    strictEqual(result.written, 2);
+    strictEqual(target.join(), "1,2");
+  });
 });
@@ -2534,4 +2534,1381 @@ export const handler = serveTest(async (t) => {
       });
     }
   }
+
+  // encrypt and decrypt
+  {
+    const aesKeyBytes = new Uint8Array(16).map((_, i) => i);
+    const aes256KeyBytes = new Uint8Array(32).map((_, i) => 255 - i);
+    const gcmIv = new Uint8Array(12).map((_, i) => i + 1);
+    const cbcIv = new Uint8Array(16).map((_, i) => i * 3);
+    const plaintext = new TextEncoder().encode("session=0123456789abcdef");
+    const importAesKey = (name, keyBytes, usages = ["encrypt", "decrypt"]) =>
+      crypto.subtle.importKey("raw", keyBytes, name, false, usages);
+
+    for (const method of ["encrypt", "decrypt"]) {
+      await t.test(`subtle.${method}`, async () => {
+        strictEqual(
+          typeof crypto.subtle[method],
+          "function",
+          `typeof crypto.subtle.${method}`,
+        );
+        strictEqual(
+          crypto.subtle[method],
+          SubtleCrypto.prototype[method],
+          `crypto.subtle.${method} === SubtleCrypto.prototype.${method}`,
+        );
+        strictEqual(
+          crypto.subtle[method].length,
+          3,
+          `crypto.subtle.${method}.length === 3`,
+        );
+      });
+      await t.test(`subtle.${method}.called-with-no-arguments`, async () => {
+        await rejects(async () => {
+          await crypto.subtle[method]();
+        }, TypeError);
+      });
+    }
+
+    await t.test("subtle.importKey.aes", async () => {
+      const key = await importAesKey("aes-gcm", aes256KeyBytes);
+      strictEqual(key.type, "secret", "key.type");
+      strictEqual(key.algorithm.name, "AES-GCM", "key.algorithm.name");
+      strictEqual(key.algorithm.length, 256, "key.algorithm.length");
+      deepStrictEqual(key.usages, ["decrypt", "encrypt"], "key.usages");
+
+      const jwkKey = await crypto.subtle.importKey(
+        "jwk",
+        { kty: "oct", k: "AAECAwQFBgcICQoLDA0ODw", alg: "A128CBC", ext: true },
+        "AES-CBC",
+        true,
+        ["encrypt"],
+      );
+      strictEqual(jwkKey.algorithm.length, 128, "jwkKey.algorithm.length");
+    });
+    await t.test("subtle.importKey.aes-invalid-key", async () => {
+      await rejects(
+        async () => await importAesKey("AES-GCM", new Uint8Array(20)),
+        DOMException,
+        null,
+        "DataError",
+      );
+      await rejects(
+        async () => await importAesKey("AES-GCM", aesKeyBytes, ["sign"]),
+        DOMException,
+        null,
+        "SyntaxError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.importKey(
+            "jwk",
+            { kty: "oct", k: "AAECAwQFBgcICQoLDA0ODw", alg: "A128GCM" },
+            "AES-CBC",
+            false,
+            ["encrypt"],
+          ),
+        DOMException,
+        null,
+        "DataError",
+      );
+    });
+
+    await t.test("subtle.encrypt.aes-gcm", async () => {
+      const key = await importAesKey("AES-GCM", aesKeyBytes);
+      const algorithm = {
+        name: "AES-GCM",
+        iv: gcmIv,
+        additionalData: new Uint8Array([1, 2, 3]),
+      };
+      const ciphertext = await crypto.subtle.encrypt(algorithm, key, plaintext);
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          117, 96, 27, 85, 90, 154, 49, 248, 8, 109, 63, 118, 153, 237, 91, 2,
+          249, 242, 134, 63, 141, 197, 137, 10, 159, 166, 80, 169, 47, 134, 19,
+          109, 54, 207, 111, 220, 131, 127, 0, 167,
+        ]),
+        "ciphertext",
+      );
+      const decrypted = await crypto.subtle.decrypt(algorithm, key, ciphertext);
+      deepStrictEqual(new Uint8Array(decrypted), plaintext, "decrypted");
+
+      const tampered = new Uint8Array(ciphertext);
+      tampered[0] ^= 1;
+      await rejects(
+        async () => await crypto.subtle.decrypt(algorithm, key, tampered),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+    await t.test("subtle.encrypt.data-detached-during-normalization", async () => {
+      const key = await importAesKey("AES-GCM", aesKeyBytes);
+      const data = plaintext.slice();
+      const expected = await crypto.subtle.encrypt(
+        { name: "AES-GCM", iv: gcmIv },
+        key,
+        plaintext,
+      );
+      // The data is copied before the algorithm's getters run, so detaching its buffer in one of
+      // them doesn't affect the result.
+      const algorithm = {
+        name: "AES-GCM",
+        get iv() {
+          data.buffer.transfer();
+          return gcmIv;
+        },
+      };
+      const ciphertext = await crypto.subtle.encrypt(algorithm, key, data);
+      strictEqual(data.byteLength, 0, "data.byteLength");
+      deepStrictEqual(new Uint8Array(ciphertext), new Uint8Array(expected), "ciphertext");
+    });
+    await t.test("subtle.encrypt.aes-gcm-tag-length", async () => {
+      const key = await importAesKey("AES-GCM", aes256KeyBytes);
+      const algorithm = { name: "AES-GCM", iv: gcmIv, tagLength: 96 };
+      const ciphertext = await crypto.subtle.encrypt(algorithm, key, plaintext);
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          156, 155, 222, 175, 155, 87, 189, 30, 143, 133, 14, 41, 90, 52, 173,
+          77, 93, 228, 56, 21, 195, 119, 2, 50, 175, 232, 169, 221, 255, 228,
+          171, 191, 151, 81, 183, 184,
+        ]),
+        "ciphertext",
+      );
+      const decrypted = await crypto.subtle.decrypt(algorithm, key, ciphertext);
+      deepStrictEqual(new Uint8Array(decrypted), plaintext, "decrypted");
+
+      await rejects(
+        async () =>
+          await crypto.subtle.encrypt(
+            { name: "AES-GCM", iv: gcmIv, tagLength: 100 },
+            key,
+            plaintext,
+          ),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+
+    await t.test("subtle.encrypt.aes-cbc", async () => {
+      const key = await importAesKey("AES-CBC", aesKeyBytes);
+      const algorithm = { name: "AES-CBC", iv: cbcIv };
+      const ciphertext = await crypto.subtle.encrypt(algorithm, key, plaintext);
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          230, 139, 52, 71, 26, 156, 123, 22, 198, 222, 148, 81, 183, 198, 179,
+          191, 17, 36, 161, 163, 0, 89, 28, 188, 9, 49, 113, 107, 110, 134, 209,
+          233,
+        ]),
+        "ciphertext",
+      );
+      const decrypted = await crypto.subtle.decrypt(algorithm, key, ciphertext);
+      deepStrictEqual(new Uint8Array(decrypted), plaintext, "decrypted");
+
+      await rejects(
+        async () =>
+          await crypto.subtle.decrypt(algorithm, key, ciphertext.slice(0, 20)),
+        DOMException,
+        null,
+        "OperationError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.encrypt(
+            { name: "AES-CBC", iv: gcmIv },
+            key,
+            plaintext,
+          ),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+
+    await t.test("subtle.encrypt.aes-ctr", async () => {
+      const key = await importAesKey("AES-CTR", aes256KeyBytes);
+      const algorithm = { name: "AES-CTR", counter: cbcIv, length: 64 };
+      const ciphertext = await crypto.subtle.encrypt(algorithm, key, plaintext);
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          69, 127, 3, 221, 180, 171, 42, 57, 194, 184, 212, 189, 140, 103, 153,
+          97, 213, 253, 153, 10, 179, 8, 67, 6,
+        ]),
+        "ciphertext",
+      );
+      const decrypted = await crypto.subtle.decrypt(algorithm, key, ciphertext);
+      deepStrictEqual(new Uint8Array(decrypted), plaintext, "decrypted");
+    });
+    await t.test("subtle.encrypt.aes-ctr-counter-wraps", async () => {
+      const key = await importAesKey("AES-CTR", aesKeyBytes);
+      const counter = new Uint8Array(16).fill(0xaa);
+      counter[15] = 0xfe;
+      const data = new Uint8Array(48).map((_, i) => i);
+      // Only the rightmost 4 bits of the counter are incremented, so they wrap around to zero
+      // after the second block, without carrying into the rest of the counter.
+      const ciphertext = await crypto.subtle.encrypt(
+        { name: "AES-CTR", counter, length: 4 },
+        key,
+        data,
+      );
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          154, 108, 100, 116, 162, 177, 206, 91, 249, 207, 108, 181, 94, 253,
+          78, 142, 19, 41, 56, 160, 152, 127, 96, 17, 130, 42, 50, 50, 108, 81,
+          17, 67, 13, 147, 51, 62, 63, 95, 175, 118, 128, 7, 123, 240, 49, 238,
+          23, 243,
+        ]),
+        "ciphertext",
+      );
+      // With a single bit, the counter would repeat for the third block.
+      await rejects(
+        async () =>
+          await crypto.subtle.encrypt(
+            { name: "AES-CTR", counter, length: 1 },
+            key,
+            data,
+          ),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+
+    await t.test("subtle.encrypt.key-mismatch", async () => {
+      const key = await importAesKey("AES-CBC", aesKeyBytes, ["decrypt"]);
+      await rejects(
+        async () =>
+          await crypto.subtle.encrypt(
+            { name: "AES-CBC", iv: cbcIv },
+            key,
+            plaintext,
+          ),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.decrypt(
+            { name: "AES-GCM", iv: gcmIv },
+            key,
+            plaintext,
+          ),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+    });
+    await t.test("subtle.encrypt.missing-parameters", async () => {
+      const key = await importAesKey("AES-GCM", aesKeyBytes);
+      await rejects(
+        async () => await crypto.subtle.encrypt("AES-GCM", key, plaintext),
+        TypeError,
+      );
+    });
+  }
+  {
+    const encoder = new TextEncoder();
+    const password = encoder.encode("correct horse battery staple");
+    const salt = encoder.encode("NaCl-salt");
+    const info = encoder.encode("starling");
+    const ikm = new Uint8Array(22).fill(0x0b);
+    const pbkdf2 = { name: "PBKDF2", hash: "SHA-256", salt, iterations: 1000 };
+    const hkdf = { name: "HKDF", hash: "SHA-256", salt, info };
+    const importKdfKey = (name, bytes) =>
+      crypto.subtle.importKey("raw", bytes, name, false, [
+        "deriveBits",
+        "deriveKey",
+      ]);
+
+    await t.test("subtle.deriveBits.hkdf", async () => {
+      const key = await importKdfKey("HKDF", ikm);
+      deepStrictEqual(key.algorithm, { name: "HKDF" }, "key.algorithm");
+      deepStrictEqual(key.extractable, false, "key.extractable");
+      const bits = await crypto.subtle.deriveBits(hkdf, key, 256);
+      deepStrictEqual(
+        new Uint8Array(bits),
+        new Uint8Array([
+          247, 8, 165, 117, 168, 89, 101, 61, 213, 169, 108, 212, 215, 128, 42,
+          242, 147, 26, 81, 122, 254, 131, 169, 121, 136, 45, 246, 204, 176,
+          235, 219, 145,
+        ]),
+        "bits",
+      );
+      const unsalted = await crypto.subtle.deriveBits(
+        {
+          name: "HKDF",
+          hash: "SHA-256",
+          salt: new Uint8Array(),
+          info: new Uint8Array(),
+        },
+        key,
+        128,
+      );
+      deepStrictEqual(
+        new Uint8Array(unsalted),
+        new Uint8Array([
+          141, 164, 231, 117, 165, 99, 193, 143, 113, 95, 128, 42, 6, 60, 90,
+          49,
+        ]),
+        "unsalted bits",
+      );
+    });
+    await t.test("subtle.deriveBits.pbkdf2", async () => {
+      const key = await importKdfKey("PBKDF2", password);
+      const bits = await crypto.subtle.deriveBits(pbkdf2, key, 256);
+      deepStrictEqual(
+        new Uint8Array(bits),
+        new Uint8Array([
+          184, 136, 97, 215, 250, 17, 47, 34, 95, 164, 95, 231, 67, 88, 194, 7,
+          84, 242, 245, 35, 158, 55, 77, 86, 95, 72, 146, 189, 48, 32, 248, 163,
+        ]),
+        "bits",
+      );
+      const empty = await crypto.subtle.deriveBits(pbkdf2, key, 0);
+      deepStrictEqual(empty.byteLength, 0, "empty.byteLength");
+    });
+    await t.test("subtle.deriveKey.pbkdf2-aes-gcm", async () => {
+      const key = await importKdfKey("PBKDF2", password);
+      const aesKey = await crypto.subtle.deriveKey(
+        pbkdf2,
+        key,
+        { name: "AES-GCM", length: 128 },
+        false,
+        ["encrypt", "decrypt"],
+      );
+      deepStrictEqual(
+        aesKey.algorithm,
+        { name: "AES-GCM", length: 128 },
+        "aesKey.algorithm",
+      );
+      const ciphertext = await crypto.subtle.encrypt(
+        { name: "AES-GCM", iv: new Uint8Array(12) },
+        aesKey,
+        encoder.encode("hello"),
+      );
+      deepStrictEqual(
+        new Uint8Array(ciphertext),
+        new Uint8Array([
+          55, 18, 18, 17, 137, 149, 135, 9, 155, 235, 185, 8, 18, 101, 113, 137,
+          237, 159, 52, 79, 224,
+        ]),
+        "ciphertext",
+      );
+    });
+    await t.test("subtle.deriveKey.hkdf-hmac", async () => {
+      const key = await importKdfKey("HKDF", ikm);
+      const hmacKey = await crypto.subtle.deriveKey(
+        hkdf,
+        key,
+        { name: "HMAC", hash: "SHA-256" },
+        true,
+        ["sign"],
+      );
+      // Without a length, HMAC keys are as long as the block size of the hash.
+      deepStrictEqual(hmacKey.algorithm.length, 512, "hmacKey.algorithm.length");
+      const signature = await crypto.subtle.sign(
+        "HMAC",
+        hmacKey,
+        encoder.encode("hello"),
+      );
+      deepStrictEqual(
+        new Uint8Array(signature),
+        new Uint8Array([
+          172, 51, 23, 209, 135, 154, 174, 25, 163, 185, 167, 153, 168, 127, 107,
+          226, 248, 171, 238, 28, 137, 61, 154, 54, 171, 178, 220, 167, 140,
+          253, 21, 175,
+        ]),
+        "signature",
+      );
+    });
+    await t.test("subtle.deriveBits.errors", async () => {
+      await rejects(
+        async () =>
+          await crypto.subtle.importKey("raw", password, "PBKDF2", true, [
+            "deriveBits",
+          ]),
+        DOMException,
+        null,
+        "SyntaxError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.importKey(
+            "jwk",
+            { kty: "oct", k: "AAAA" },
+            "HKDF",
+            false,
+            ["deriveBits"],
+          ),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+      const key = await importKdfKey("PBKDF2", password);
+      await rejects(
+        async () => await crypto.subtle.deriveBits(pbkdf2, key),
+        DOMException,
+        null,
+        "OperationError",
+      );
+      await rejects(
+        async () => await crypto.subtle.deriveBits(pbkdf2, key, 12),
+        DOMException,
+        null,
+        "OperationError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.deriveBits({ ...pbkdf2, iterations: 0 }, key, 256),
+        DOMException,
+        null,
+        "OperationError",
+      );
+      await rejects(
+        async () => await crypto.subtle.deriveBits(hkdf, key, 256),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.deriveKey(
+            pbkdf2,
+            key,
+            { name: "AES-GCM", length: 100 },
+            false,
+            ["encrypt"],
+          ),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+  }
+  {
+    const hashedBody = new Uint8Array(4 * 1024 * 1024).map((_, i) => i & 0xff);
+    const chunked = (bytes, chunkSize) =>
+      new ReadableStream({
+        start(controller) {
+          for (let i = 0; i < bytes.length; i += chunkSize) {
+            controller.enqueue(bytes.subarray(i, i + chunkSize));
+          }
+          controller.close();
+        },
+      });
+
+    await t.test("DigestStream", async () => {
+      strictEqual(typeof crypto.DigestStream, "function", "typeof crypto.DigestStream");
+      const stream = new crypto.DigestStream("SHA-256");
+      strictEqual(
+        stream.readable instanceof ReadableStream,
+        true,
+        "stream.readable instanceof ReadableStream",
+      );
+      strictEqual(
+        stream.writable instanceof WritableStream,
+        true,
+        "stream.writable instanceof WritableStream",
+      );
+      strictEqual(stream.digest instanceof Promise, true, "stream.digest instanceof Promise");
+      throws(() => new crypto.DigestStream("AES-GCM"), DOMException);
+      throws(() => crypto.DigestStream("SHA-256"), TypeError);
+    });
+    await t.test("DigestStream.sha-1", async () => {
+      const stream = new crypto.DigestStream({ name: "SHA-1" });
+      const writer = stream.writable.getWriter();
+      const output = new Response(stream.readable).text();
+      await writer.write(new TextEncoder().encode("a"));
+      await writer.write(new TextEncoder().encode("bc"));
+      await writer.close();
+      strictEqual(await output, "abc", "output");
+      deepStrictEqual(
+        new Uint8Array(await stream.digest),
+        new Uint8Array([
+          169, 153, 62, 54, 71, 6, 129, 106, 186, 62, 37, 113, 120, 80, 194, 108,
+          156, 208, 216, 157,
+        ]),
+        "digest",
+      );
+    });
+    await t.test("DigestStream.pass-through", async () => {
+      const stream = new crypto.DigestStream("SHA-256");
+      const response = new Response(chunked(hashedBody, 65536).pipeThrough(stream));
+      deepStrictEqual(
+        new Uint8Array(await response.arrayBuffer()),
+        hashedBody,
+        "body",
+      );
+      deepStrictEqual(
+        new Uint8Array(await stream.digest),
+        new Uint8Array(await crypto.subtle.digest("SHA-256", hashedBody)),
+        "digest",
+      );
+    });
+    await t.test("DigestStream.empty", async () => {
+      const stream = new crypto.DigestStream("SHA-512");
+      const writer = stream.writable.getWriter();
+      const output = new Response(stream.readable).arrayBuffer();
+      await writer.close();
+      strictEqual((await output).byteLength, 0, "output.byteLength");
+      deepStrictEqual(
+        new Uint8Array(await stream.digest),
+        new Uint8Array(await crypto.subtle.digest("SHA-512", new Uint8Array())),
+        "digest",
+      );
+    });
+    await t.test("DigestStream.invalid-chunk", async () => {
+      const stream = new crypto.DigestStream("SHA-256");
+      const writer = stream.writable.getWriter();
+      await rejects(async () => await writer.write("not a buffer"), TypeError);
+      await rejects(async () => await stream.digest, TypeError);
+    });
+    await t.test("DigestStream.abort", async () => {
+      const stream = new crypto.DigestStream("SHA-256");
+      const writer = stream.writable.getWriter();
+      const reader = stream.readable.getReader();
+      const write = writer.write(new Uint8Array([1, 2, 3]));
+      await reader.read();
+      await write;
+      await writer.abort(new RangeError("aborted mid-stream"));
+      await rejects(async () => await stream.digest, RangeError, "aborted mid-stream");
+    });
+    await t.test("DigestStream.cancel", async () => {
+      const stream = new crypto.DigestStream("SHA-256");
+      const writer = stream.writable.getWriter();
+      const reader = stream.readable.getReader();
+      const write = writer.write(new Uint8Array([1, 2, 3]));
+      await reader.read();
+      await write;
+      await reader.cancel(new RangeError("canceled mid-stream"));
+      await rejects(async () => await stream.digest, RangeError, "canceled mid-stream");
+      await rejects(async () => await writer.write(new Uint8Array([4])), RangeError);
+    });
+  }
+  {
+    const message = new TextEncoder().encode("header.payload");
+    const tampered = new TextEncoder().encode("header.payloaD");
+    // Keys cache the contexts they set up for signing and verifying, so using the same key
+    // repeatedly mustn't carry any state over from one operation to the next.
+    await t.test("subtle.sign.repeated-hmac", async () => {
+      const key = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(32).fill(7),
+        { name: "HMAC", hash: "SHA-256" },
+        false,
+        ["sign", "verify"],
+      );
+      const first = new Uint8Array(await crypto.subtle.sign("HMAC", key, message));
+      for (let i = 0; i < 3; i++) {
+        const signature = new Uint8Array(await crypto.subtle.sign("HMAC", key, message));
+        deepStrictEqual(signature, first, `signature ${i}`);
+        strictEqual(
+          await crypto.subtle.verify("HMAC", key, signature, message),
+          true,
+          `verify ${i}`,
+        );
+        strictEqual(
+          await crypto.subtle.verify("HMAC", key, signature, tampered),
+          false,
+          `verify tampered ${i}`,
+        );
+      }
+    });
+    await t.test("subtle.sign.repeated-rsa", async () => {
+      const privateKey = await crypto.subtle.importKey(
+        "jwk",
+        createPrivateRsaJsonWebKeyData(),
+        createRsaJsonWebKeyAlgorithm(),
+        false,
+        ["sign"],
+      );
+      const publicKey = await crypto.subtle.importKey(
+        "jwk",
+        createPublicRsaJsonWebKeyData(),
+        createRsaJsonWebKeyAlgorithm(),
+        false,
+        ["verify"],
+      );
+      const algorithm = "RSASSA-PKCS1-v1_5";
+      const first = new Uint8Array(await crypto.subtle.sign(algorithm, privateKey, message));
+      for (let i = 0; i < 3; i++) {
+        const signature = new Uint8Array(
+          await crypto.subtle.sign(algorithm, privateKey, message),
+        );
+        deepStrictEqual(signature, first, `signature ${i}`);
+        strictEqual(
+          await crypto.subtle.verify(algorithm, publicKey, signature, tampered),
+          false,
+          `verify tampered ${i}`,
+        );
+        strictEqual(
+          await crypto.subtle.verify(algorithm, publicKey, signature, message),
+          true,
+          `verify ${i}`,
+        );
+      }
+    });
+    await t.test("subtle.sign.repeated-ecdsa-hashes", async () => {
+      const privateKey = await crypto.subtle.importKey(
+        "jwk",
+        createPrivateEcdsaJsonWebKeyData(),
+        ecdsaJsonWebKeyAlgorithm,
+        false,
+        ["sign"],
+      );
+      const publicKey = await crypto.subtle.importKey(
+        "jwk",
+        createPublicEcdsaJsonWebKeyData(),
+        ecdsaJsonWebKeyAlgorithm,
+        false,
+        ["verify"],
+      );
+      for (const hash of ["SHA-256", "SHA-384", "SHA-256"]) {
+        const algorithm = { name: "ECDSA", hash };
+        const signature = await crypto.subtle.sign(algorithm, privateKey, message);
+        strictEqual(
+          await crypto.subtle.verify(algorithm, publicKey, signature, message),
+          true,
+          `verify ${hash}`,
+        );
+        const other = { name: "ECDSA", hash: hash === "SHA-256" ? "SHA-384" : "SHA-256" };
+        strictEqual(
+          await crypto.subtle.verify(other, publicKey, signature, message),
+          false,
+          `verify ${hash} signature with ${other.hash}`,
+        );
+      }
+    });
+  }
+  {
+    const encoder = new TextEncoder();
+    const importHmacKey = (bytes, usages = ["sign", "verify"]) =>
+      crypto.subtle.importKey(
+        "raw",
+        bytes,
+        { name: "HMAC", hash: "SHA-256" },
+        false,
+        usages,
+      );
+
+    await t.test("subtle.verifyBatch", async () => {
+      strictEqual(
+        typeof crypto.subtle.verifyBatch,
+        "function",
+        "typeof crypto.subtle.verifyBatch",
+      );
+      strictEqual(crypto.subtle.verifyBatch.length, 2, "crypto.subtle.verifyBatch.length");
+      strictEqual(
+        Object.getOwnPropertyDescriptor(SubtleCrypto.prototype, "verifyBatch").enumerable,
+        false,
+        "SubtleCrypto.prototype.verifyBatch is non-enumerable",
+      );
+    });
+    await t.test("subtle.verifyBatch.hmac", async () => {
+      const first = await importHmacKey(new Uint8Array(32).fill(1));
+      const second = await importHmacKey(new Uint8Array(32).fill(2));
+      const header = encoder.encode("header");
+      const payload = encoder.encode("payload");
+      const headerSignature = await crypto.subtle.sign("HMAC", first, header);
+      const payloadSignature = await crypto.subtle.sign("HMAC", second, payload);
+      const results = await crypto.subtle.verifyBatch("HMAC", [
+        { key: first, signature: headerSignature, data: header },
+        { key: second, signature: payloadSignature, data: payload },
+        { key: first, signature: payloadSignature, data: payload },
+        { key: second, signature: payloadSignature, data: header },
+      ]);
+      deepStrictEqual(results, [true, true, false, false], "results");
+      deepStrictEqual(await crypto.subtle.verifyBatch("HMAC", []), [], "empty batch");
+    });
+    await t.test("subtle.verifyBatch.ecdsa", async () => {
+      const algorithm = { name: "ECDSA", hash: "SHA-256" };
+      const privateKey = await crypto.subtle.importKey(
+        "jwk",
+        createPrivateEcdsaJsonWebKeyData(),
+        ecdsaJsonWebKeyAlgorithm,
+        false,
+        ["sign"],
+      );
+      const publicKey = await crypto.subtle.importKey(
+        "jwk",
+        createPublicEcdsaJsonWebKeyData(),
+        ecdsaJsonWebKeyAlgorithm,
+        false,
+        ["verify"],
+      );
+      const entries = [];
+      for (const text of ["a", "b", "c"]) {
+        const data = encoder.encode(text);
+        const signature = await crypto.subtle.sign(algorithm, privateKey, data);
+        entries.push({ key: publicKey, signature, data });
+      }
+      entries.push({ key: publicKey, signature: entries[0].signature, data: entries[1].data });
+      deepStrictEqual(
+        await crypto.subtle.verifyBatch(algorithm, entries),
+        [true, true, true, false],
+        "results",
+      );
+    });
+    await t.test("subtle.verifyBatch.errors", async () => {
+      const key = await importHmacKey(new Uint8Array(32).fill(1));
+      const signOnlyKey = await importHmacKey(new Uint8Array(32).fill(1), ["sign"]);
+      const data = encoder.encode("data");
+      const signature = await crypto.subtle.sign("HMAC", key, data);
+      await rejects(
+        async () => await crypto.subtle.verifyBatch("HMAC", { key, signature, data }),
+        TypeError,
+      );
+      await rejects(
+        async () => await crypto.subtle.verifyBatch("HMAC", [{ key: {}, signature, data }]),
+        TypeError,
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.verifyBatch("HMAC", [
+            { key, signature, data },
+            { key: signOnlyKey, signature, data },
+          ]),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.verifyBatch({ name: "ECDSA", hash: "SHA-256" }, [
+            { key, signature, data },
+          ]),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+    });
+  }
+
+  // generateKey and exportKey
+  {
+    const encoder = new TextEncoder();
+    const data = encoder.encode("data");
+    const toBytes = (buffer) => Array.from(new Uint8Array(buffer));
+
+    await t.test("subtle.generateKey", async () => {
+      strictEqual(
+        typeof crypto.subtle.generateKey,
+        "function",
+        "typeof crypto.subtle.generateKey",
+      );
+      strictEqual(crypto.subtle.generateKey.length, 3, "crypto.subtle.generateKey.length");
+      strictEqual(
+        typeof crypto.subtle.exportKey,
+        "function",
+        "typeof crypto.subtle.exportKey",
+      );
+      strictEqual(crypto.subtle.exportKey.length, 2, "crypto.subtle.exportKey.length");
+    });
+    await t.test("subtle.generateKey.ecdsa", async () => {
+      const { privateKey, publicKey } = await crypto.subtle.generateKey(
+        ecdsaP256Algorithm,
+        false,
+        ["sign", "verify"],
+      );
+      strictEqual(privateKey.type, "private", "privateKey.type");
+      strictEqual(privateKey.extractable, false, "privateKey.extractable");
+      deepStrictEqual(privateKey.usages, ["sign"], "privateKey.usages");
+      strictEqual(privateKey.algorithm.namedCurve, "P-256", "privateKey.algorithm.namedCurve");
+      strictEqual(publicKey.type, "public", "publicKey.type");
+      strictEqual(publicKey.extractable, true, "publicKey.extractable");
+      deepStrictEqual(publicKey.usages, ["verify"], "publicKey.usages");
+
+      const algorithm = { name: "ECDSA", hash: "SHA-256" };
+      const signature = await crypto.subtle.sign(algorithm, privateKey, data);
+      strictEqual(
+        await crypto.subtle.verify(algorithm, publicKey, signature, data),
+        true,
+        "verify",
+      );
+
+      const raw = new Uint8Array(await crypto.subtle.exportKey("raw", publicKey));
+      strictEqual(raw.length, 65, "raw.length");
+      strictEqual(raw[0], 4, "raw[0]");
+      const jwk = await crypto.subtle.exportKey("jwk", publicKey);
+      strictEqual(jwk.kty, "EC", "jwk.kty");
+      strictEqual(jwk.crv, "P-256", "jwk.crv");
+      strictEqual(jwk.x.length, 43, "jwk.x.length");
+      strictEqual(jwk.y.length, 43, "jwk.y.length");
+      strictEqual(jwk.d, undefined, "jwk.d");
+    });
+    await t.test("subtle.generateKey.ecdsa-pkcs8-roundtrip", async () => {
+      const { privateKey, publicKey } = await crypto.subtle.generateKey(
+        ecdsaP384Algorithm,
+        true,
+        ["sign", "verify"],
+      );
+      const pkcs8 = await crypto.subtle.exportKey("pkcs8", privateKey);
+      const imported = await crypto.subtle.importKey(
+        "pkcs8",
+        pkcs8,
+        ecdsaP384Algorithm,
+        false,
+        ["sign"],
+      );
+      const algorithm = { name: "ECDSA", hash: "SHA-384" };
+      const signature = await crypto.subtle.sign(algorithm, imported, data);
+      strictEqual(
+        await crypto.subtle.verify(algorithm, publicKey, signature, data),
+        true,
+        "verify",
+      );
+    });
+    await t.test("subtle.algorithm-name-tampering", async () => {
+      // Keys keep the algorithm they were created for, regardless of changes to the object their
+      // algorithm attribute returns.
+      const { privateKey } = await crypto.subtle.generateKey(
+        { name: "ECDSA", namedCurve: "P-256" },
+        true,
+        ["sign", "verify"],
+      );
+      privateKey.algorithm.name = "HMAC";
+      privateKey.algorithm.namedCurve = "P-384";
+      const jwk = await crypto.subtle.exportKey("jwk", privateKey);
+      strictEqual(jwk.kty, "EC", "jwk.kty");
+      strictEqual(jwk.crv, "P-256", "jwk.crv");
+      await rejects(
+        async () => await crypto.subtle.exportKey("raw", privateKey),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+
+      const hkdfKey = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(16),
+        "HKDF",
+        false,
+        ["deriveBits"],
+      );
+      hkdfKey.algorithm.name = "PBKDF2";
+      await rejects(
+        async () =>
+          await crypto.subtle.deriveBits(
+            { name: "PBKDF2", hash: "SHA-256", salt: new Uint8Array(8), iterations: 1 },
+            hkdfKey,
+            256,
+          ),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+
+      const aesKey = await crypto.subtle.generateKey(
+        { name: "AES-GCM", length: 128 },
+        false,
+        ["encrypt"],
+      );
+      aesKey.algorithm.name = "AES-CBC";
+      await rejects(
+        async () =>
+          await crypto.subtle.encrypt(
+            { name: "AES-CBC", iv: new Uint8Array(16) },
+            aesKey,
+            data,
+          ),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      const ciphertext = await crypto.subtle.encrypt(
+        { name: "AES-GCM", iv: new Uint8Array(12) },
+        aesKey,
+        data,
+      );
+      strictEqual(ciphertext.byteLength, data.byteLength + 16, "ciphertext.byteLength");
+    });
+    await t.test("subtle.generateKey.rsa", async () => {
+      const { privateKey, publicKey } = await crypto.subtle.generateKey(
+        {
+          ...rsaPkcs1Sha256Algorithm,
+          modulusLength: 1024,
+          publicExponent: new Uint8Array([1, 0, 1]),
+        },
+        true,
+        ["sign", "verify"],
+      );
+      strictEqual(privateKey.algorithm.modulusLength, 1024, "algorithm.modulusLength");
+      deepStrictEqual(
+        toBytes(privateKey.algorithm.publicExponent),
+        [1, 0, 1],
+        "algorithm.publicExponent",
+      );
+
+      const jwk = await crypto.subtle.exportKey("jwk", privateKey);
+      strictEqual(jwk.kty, "RSA", "jwk.kty");
+      strictEqual(jwk.alg, "RS256", "jwk.alg");
+      strictEqual(jwk.e, "AQAB", "jwk.e");
+      const imported = await crypto.subtle.importKey(
+        "jwk",
+        jwk,
+        rsaPkcs1Sha256Algorithm,
+        false,
+        ["sign"],
+      );
+      const signature = await crypto.subtle.sign(rsaPkcs1Sha256Algorithm, imported, data);
+      strictEqual(
+        await crypto.subtle.verify(rsaPkcs1Sha256Algorithm, publicKey, signature, data),
+        true,
+        "verify",
+      );
+    });
+    await t.test("subtle.generateKey.hmac", async () => {
+      const key = await crypto.subtle.generateKey(
+        { name: "HMAC", hash: "SHA-256" },
+        true,
+        ["sign", "verify"],
+      );
+      strictEqual(key.type, "secret", "key.type");
+      strictEqual(key.algorithm.length, 512, "key.algorithm.length");
+      strictEqual((await crypto.subtle.exportKey("raw", key)).byteLength, 64, "raw.byteLength");
+
+      const short = await crypto.subtle.generateKey(
+        { name: "HMAC", hash: "SHA-256", length: 128 },
+        true,
+        ["sign"],
+      );
+      strictEqual((await crypto.subtle.exportKey("raw", short)).byteLength, 16, "raw.byteLength");
+    });
+    await t.test("subtle.generateKey.aes", async () => {
+      const key = await crypto.subtle.generateKey(
+        { name: "AES-GCM", length: 256 },
+        true,
+        ["encrypt", "decrypt"],
+      );
+      strictEqual(key.algorithm.length, 256, "key.algorithm.length");
+      const iv = new Uint8Array(12);
+      const ciphertext = await crypto.subtle.encrypt({ name: "AES-GCM", iv }, key, data);
+      deepStrictEqual(
+        toBytes(await crypto.subtle.decrypt({ name: "AES-GCM", iv }, key, ciphertext)),
+        toBytes(data),
+        "decrypted",
+      );
+      const jwk = await crypto.subtle.exportKey("jwk", key);
+      strictEqual(jwk.alg, "A256GCM", "jwk.alg");
+      strictEqual(jwk.k.length, 43, "jwk.k.length");
+    });
+    await t.test("subtle.generateKey.errors", async () => {
+      await rejects(
+        async () => await crypto.subtle.generateKey(ecdsaP256Algorithm, true, ["verify"]),
+        DOMException,
+        null,
+        "SyntaxError",
+      );
+      await rejects(
+        async () => await crypto.subtle.generateKey(ecdsaP256Algorithm, true, ["encrypt"]),
+        DOMException,
+        null,
+        "SyntaxError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.generateKey({ name: "HMAC", hash: "SHA-256" }, true, []),
+        DOMException,
+        null,
+        "SyntaxError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.generateKey({ name: "ECDSA", namedCurve: "P-192" }, true, [
+            "sign",
+          ]),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.generateKey({ name: "ECDH", namedCurve: "P-256" }, true, [
+            "deriveBits",
+          ]),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.generateKey({ name: "AES-GCM", length: 100 }, true, [
+            "encrypt",
+          ]),
+        DOMException,
+        null,
+        "OperationError",
+      );
+      await rejects(
+        async () =>
+          await crypto.subtle.generateKey(
+            {
+              ...rsaPkcs1Sha256Algorithm,
+              modulusLength: 1024,
+              publicExponent: new Uint8Array([2]),
+            },
+            true,
+            ["sign"],
+          ),
+        DOMException,
+        null,
+        "OperationError",
+      );
+    });
+    await t.test("subtle.exportKey.jwk", async () => {
+      const ecdsa = await crypto.subtle.importKey(
+        "jwk",
+        createPrivateEcdsaJsonWebKeyData(),
+        ecdsaJsonWebKeyAlgorithm,
+        true,
+        ["sign"],
+      );
+      const { use, kid, ...ecdsaData } = createPrivateEcdsaJsonWebKeyData();
+      deepStrictEqual(await crypto.subtle.exportKey("jwk", ecdsa), ecdsaData, "ecdsa");
+
+      const rsa = await crypto.subtle.importKey(
+        "jwk",
+        createPrivateRsaJsonWebKeyData(),
+        createRsaJsonWebKeyAlgorithm(),
+        true,
+        ["sign"],
+      );
+      deepStrictEqual(
+        await crypto.subtle.exportKey("jwk", rsa),
+        createPrivateRsaJsonWebKeyData(),
+        "rsa",
+      );
+
+      const hmac = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(32).fill(1),
+        { name: "HMAC", hash: "SHA-256" },
+        true,
+        ["sign", "verify"],
+      );
+      deepStrictEqual(
+        await crypto.subtle.exportKey("jwk", hmac),
+        {
+          alg: "HS256",
+          ext: true,
+          k: "AQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQE",
+          key_ops: ["sign", "verify"],
+          kty: "oct",
+        },
+        "hmac",
+      );
+
+      const aes = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(16).map((_, i) => i),
+        "AES-CBC",
+        true,
+        ["decrypt", "encrypt"],
+      );
+      deepStrictEqual(
+        await crypto.subtle.exportKey("jwk", aes),
+        {
+          alg: "A128CBC",
+          ext: true,
+          k: "AAECAwQFBgcICQoLDA0ODw",
+          key_ops: ["decrypt", "encrypt"],
+          kty: "oct",
+        },
+        "aes",
+      );
+    });
+    await t.test("subtle.exportKey.der", async () => {
+      for (const [format, keyData, algorithm, usages] of [
+        ["spki", ecdsaP256Spki, ecdsaP256Algorithm, ["verify"]],
+        ["pkcs8", ecdsaP256Pkcs8, ecdsaP256Algorithm, ["sign"]],
+        ["spki", rsa2048Spki, rsaPkcs1Sha256Algorithm, ["verify"]],
+        ["pkcs8", rsa2048Pkcs8, rsaPkcs1Sha256Algorithm, ["sign"]],
+      ]) {
+        const key = await crypto.subtle.importKey(format, keyData, algorithm, true, usages);
+        deepStrictEqual(
+          toBytes(await crypto.subtle.exportKey(format, key)),
+          toBytes(keyData),
+          `${algorithm.name} ${format}`,
+        );
+      }
+    });
+    await t.test("subtle.exportKey.errors", async () => {
+      const nonExtractable = await crypto.subtle.importKey(
+        "spki",
+        ecdsaP256Spki,
+        ecdsaP256Algorithm,
+        false,
+        ["verify"],
+      );
+      await rejects(
+        async () => await crypto.subtle.exportKey("spki", nonExtractable),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      const publicKey = await crypto.subtle.importKey(
+        "spki",
+        ecdsaP256Spki,
+        ecdsaP256Algorithm,
+        true,
+        ["verify"],
+      );
+      await rejects(
+        async () => await crypto.subtle.exportKey("pkcs8", publicKey),
+        DOMException,
+        null,
+        "InvalidAccessError",
+      );
+      const rsa = await crypto.subtle.importKey(
+        "spki",
+        rsa2048Spki,
+        rsaPkcs1Sha256Algorithm,
+        true,
+        ["verify"],
+      );
+      await rejects(
+        async () => await crypto.subtle.exportKey("raw", rsa),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+      await rejects(
+        async () => await crypto.subtle.exportKey("pem", rsa),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+    });
+  }
+
+  // algorithm normalization
+  {
+    const data = new TextEncoder().encode("data");
+    const toBytes = (buffer) => Array.from(new Uint8Array(buffer));
+
+    await t.test("subtle.digest.algorithm-names", async () => {
+      const expected = toBytes(await crypto.subtle.digest("SHA-256", data));
+      const suffix = String(256);
+      for (const algorithm of [
+        "sha-256",
+        "Sha-256",
+        `SHA-${suffix}`,
+        { name: "SHA-256" },
+        { name: `sha-${suffix}` },
+        { name: { toString: () => "SHA-256" } },
+      ]) {
+        deepStrictEqual(
+          toBytes(await crypto.subtle.digest(algorithm, data)),
+          expected,
+          JSON.stringify(algorithm),
+        );
+      }
+    });
+    await t.test("subtle.digest.algorithm-object-reread", async () => {
+      // The algorithm's members are read on every call, so reusing a mutated object or one with
+      // getters observes the changes.
+      let reads = 0;
+      const algorithm = {
+        get name() {
+          reads++;
+          return reads === 1 ? "SHA-256" : "SHA-512";
+        },
+      };
+      strictEqual((await crypto.subtle.digest(algorithm, data)).byteLength, 32, "first digest");
+      strictEqual((await crypto.subtle.digest(algorithm, data)).byteLength, 64, "second digest");
+      strictEqual(reads, 2, "reads");
+
+      const mutated = { name: "SHA-1" };
+      strictEqual((await crypto.subtle.digest(mutated, data)).byteLength, 20, "SHA-1 digest");
+      mutated.name = "SHA-384";
+      strictEqual((await crypto.subtle.digest(mutated, data)).byteLength, 48, "SHA-384 digest");
+      mutated.name = "SHA-3";
+      await rejects(
+        async () => await crypto.subtle.digest(mutated, data),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+    });
+    await t.test("subtle.sign.hash-names", async () => {
+      const key = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(32).fill(1),
+        { name: "hmac", hash: { name: "sha-256" } },
+        false,
+        ["sign"],
+      );
+      strictEqual(key.algorithm.name, "HMAC", "key.algorithm.name");
+      strictEqual(key.algorithm.hash.name, "SHA-256", "key.algorithm.hash.name");
+      await rejects(
+        async () =>
+          await crypto.subtle.importKey(
+            "raw",
+            new Uint8Array(32).fill(1),
+            { name: "HMAC", hash: "AES-GCM" },
+            false,
+            ["sign"],
+          ),
+        DOMException,
+        null,
+        "NotSupportedError",
+      );
+    });
+  }
+
+  // getRandomValues and randomUUID
+  {
+    await t.test("randomUUID.unique", () => {
+      const uuids = new Set();
+      for (let i = 0; i < 2000; i++) {
+        const uuid = crypto.randomUUID();
+        strictEqual(
+          /^[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12}$/.test(uuid),
+          true,
+          `format of ${uuid}`,
+        );
+        uuids.add(uuid);
+      }
+      strictEqual(uuids.size, 2000, "uuids.size");
+    });
+    await t.test("getRandomValues.small", () => {
+      // Many small requests are served from the same buffered block of random data, which must
+      // never hand out the same bytes twice.
+      const values = new Set();
+      for (let i = 0; i < 1000; i++) {
+        values.add(crypto.getRandomValues(new BigUint64Array(1))[0]);
+      }
+      strictEqual(values.size, 1000, "values.size");
+    });
+    await t.test("getRandomValues.large", () => {
+      // Larger than the generator's buffer, so this spans several refills.
+      const bytes = crypto.getRandomValues(new Uint8Array(65536));
+      const counts = new Uint32Array(256);
+      for (const byte of bytes) {
+        counts[byte]++;
+      }
+      for (let i = 0; i < 256; i++) {
+        strictEqual(counts[i] > 128 && counts[i] < 384, true, `count of ${i}: ${counts[i]}`);
+      }
+      const again = crypto.getRandomValues(new Uint8Array(65536));
+      strictEqual(
+        bytes.some((byte, i) => byte !== again[i]),
+        true,
+        "consecutive results differ",
+      );
+    });
+  }
+
+  // operation results
+  {
+    const data = new TextEncoder().encode("data");
+
+    await t.test("subtle.sign.ecdsa-signature-size", async () => {
+      // r and s are padded to the size of the curve's order, so signatures always have the same
+      // length, even when r or s have leading zero bytes, which happens for about one in 128
+      // signatures.
+      for (const [algorithm, hash, size] of [
+        [ecdsaP256Algorithm, "SHA-256", 64],
+        [ecdsaP384Algorithm, "SHA-384", 96],
+        [ecdsaP521Algorithm, "SHA-512", 132],
+      ]) {
+        const { privateKey, publicKey } = await crypto.subtle.generateKey(algorithm, false, [
+          "sign",
+          "verify",
+        ]);
+        const params = { name: "ECDSA", hash };
+        for (let i = 0; i < 200; i++) {
+          const signature = await crypto.subtle.sign(params, privateKey, data);
+          strictEqual(signature.byteLength, size, `${algorithm.namedCurve} signature size`);
+          strictEqual(
+            await crypto.subtle.verify(params, publicKey, signature, data),
+            true,
+            `${algorithm.namedCurve} verify`,
+          );
+        }
+      }
+    });
+    await t.test("subtle.results-are-distinct", async () => {
+      const key = await crypto.subtle.importKey(
+        "raw",
+        new Uint8Array(32).fill(1),
+        { name: "HMAC", hash: "SHA-256" },
+        false,
+        ["sign"],
+      );
+      const first = await crypto.subtle.sign("HMAC", key, data);
+      const second = await crypto.subtle.sign("HMAC", key, data);
+      strictEqual(first === second, false, "sign results are new ArrayBuffers");
+      new Uint8Array(first).fill(0);
+      strictEqual(new Uint8Array(second).some((byte) => byte !== 0), true, "second result");
+      strictEqual(first.byteLength, 32, "first.byteLength");
+
+      const digest = await crypto.subtle.digest("SHA-512", data);
+      strictEqual(digest.byteLength, 64, "digest.byteLength");
+    });
+  }
+
+  // large inputs
+  {
+    // Inputs this large are handed to the host by builds that offload bulk encryption, so these
+    // check that both paths produce the same results.
+    const data = new Uint8Array(128 * 1024).map((_, i) => i & 0xff);
+    const rawKey = new Uint8Array(16).fill(1);
+    const toHex = (buffer) =>
+      Array.from(new Uint8Array(buffer), (byte) => byte.toString(16).padStart(2, "0")).join("");
+    const sha256 = async (buffer) => toHex(await crypto.subtle.digest("SHA-256", buffer));
+
+    await t.test("subtle.encrypt.aes-gcm-large-input", async () => {
+      const key = await crypto.subtle.importKey("raw", rawKey, "AES-GCM", false, [
+        "encrypt",
+        "decrypt",
+      ]);
+      const params = {
+        name: "AES-GCM",
+        iv: new Uint8Array(12).fill(2),
+        additionalData: new Uint8Array([1, 2, 3]),
+      };
+      const ciphertext = await crypto.subtle.encrypt(params, key, data);
+      strictEqual(ciphertext.byteLength, data.length + 16, "ciphertext.byteLength");
+      strictEqual(
+        await sha256(ciphertext),
+        "647709e0cecfbceabd15e5dda2fc62a607639435b5d34e79a568fee89032995c",
+        "ciphertext",
+      );
+      const plaintext = await crypto.subtle.decrypt(params, key, ciphertext);
+      deepStrictEqual(new Uint8Array(plaintext), data, "plaintext");
+
+      const tampered = new Uint8Array(ciphertext);
+      tampered[tampered.length - 1] ^= 1;
+      await rejects(
+        () => crypto.subtle.decrypt(params, key, tampered),
+        DOMException,
+        "AES-GCM decryption failed",
+        "OperationError",
+      );
+    });
+    await t.test("subtle.encrypt.aes-cbc-large-input", async () => {
+      const key = await crypto.subtle.importKey("raw", rawKey, "AES-CBC", false, [
+        "encrypt",
+        "decrypt",
+      ]);
+      const params = { name: "AES-CBC", iv: new Uint8Array(16).fill(2) };
+      const ciphertext = await crypto.subtle.encrypt(params, key, data);
+      strictEqual(ciphertext.byteLength, data.length + 16, "ciphertext.byteLength");
+      strictEqual(
+        await sha256(ciphertext),
+        "a60f66b9bb4111dab445b6ead19ee5ed044891a02f8cac6cbf52725aa7be983b",
+        "ciphertext",
+      );
+      const plaintext = await crypto.subtle.decrypt(params, key, ciphertext);
+      deepStrictEqual(new Uint8Array(plaintext), data, "plaintext");
+    });
+  }
 });
@@ -12,6 +12,24 @@ export const handler = serveTest(async (t) => {
     strictEqual(decoded, "é");
   });
 
+  t.test('headers-long-values', () => {
+    const cookie = Array.from({ length: 128 }, (_, i) => `session_${i}=${'x'.repeat(24)}`).join('; ');
+    const headers = new Headers({ cookie: `  ${cookie}\t` });
+    strictEqual(headers.get('Cookie'), cookie);
+
+    for (const pos of [1, 15, 16, 1000, cookie.length - 1]) {
+      for (const ch of ['\r', '\n', '\0']) {
+        const value = cookie.slice(0, pos) + ch + 'a' + cookie.slice(pos);
+        throws(() => headers.set('cookie', value), TypeError);
+      }
+    }
+
+    throws(() => headers.set('x-\u00e9', 'a'), TypeError);
+    throws(() => headers.set('x-a b', 'a'), TypeError);
+    headers.set('X-Custom_Header.1~', 'a');
+    deepStrictEqual([...headers.keys()], ['cookie', 'x-custom_header.1~']);
+  });
+
   t.test('request-clone-bad-calls', () => {
     throws(() => new Request.prototype.clone(), TypeError);
     throws(() => new Request.prototype.clone.call(undefined), TypeError);
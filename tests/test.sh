@@ -6,9 +6,12 @@ test_component="${3:-}"
 test_name="$(basename $test_dir)"
 test_serve_path="${4:-}"
 componentize_flags="${COMPONENTIZE_FLAGS:-}"
+serve_flags="${SERVE_FLAGS:-}"
+plug_components="${PLUG_COMPONENTS:-}"
 runtime_args_file="$test_dir/runtime-args"
 
 wasmtime="${WASMTIME:-wasmtime}"
+wac="${WAC:-wac}"
 
 # Load test expectation fails to check, only those defined apply
 test_serve_body_expectation="$test_dir/expect_serve_body.txt"
@@ -99,7 +102,18 @@ if [ -z "$test_component" ]; then
    fi
 fi
 
-$wasmtime serve -S common --addr 0.0.0.0:0 "$test_component" 1> "$stdout_log" 2> "$stderr_log" &
+# Plug in the components providing imports that wasmtime doesn't, e.g. the crypto-offload shim
+served_component="$test_component"
+if [ -n "$plug_components" ]; then
+   served_component="$test_dir/$test_name.plugged.wasm"
+   plug_args=""
+   for plug in $plug_components; do
+      plug_args="$plug_args --plug $plug"
+   done
+   $wac plug $plug_args -o "$served_component" "$test_component"
+fi
+
+$wasmtime serve -S common $serve_flags --addr 0.0.0.0:0 "$served_component" 1> "$stdout_log" 2> "$stderr_log" &
 wasmtime_pid="$!"
 
 function cleanup {
@@ -166,6 +180,9 @@ rm "$body_log"
 rm "$headers_log"
 rm "$stdout_log"
 rm "$stderr_log"
+if [ -n "$plug_components" ]; then
+   rm "$served_component"
+fi
 
 trap '' EXIT
 echo "Test Completed Successfully"
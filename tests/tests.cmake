@@ -4,10 +4,20 @@ find_program(BASH_PROGRAM bash)
 include("wasmtime")
 include("weval")
 
+# Components built with ENABLE_CRYPTO_OFFLOAD import the crypto-offload interface, which wasmtime doesn't provide, so
+# tests plug the shim implementing it into the components they run. This also runs the crypto tests against the
+# runtime's offloading code paths.
+function(plug_test_imports TEST)
+    if (ENABLE_CRYPTO_OFFLOAD)
+        set_property(TEST ${TEST} APPEND PROPERTY ENVIRONMENT "WAC=${WAC_BIN}" "PLUG_COMPONENTS=${CRYPTO_OFFLOAD_SHIM}")
+    endif()
+endfunction()
+
 function(test_e2e TEST_NAME)
     get_target_property(RUNTIME_DIR starling-raw.wasm BINARY_DIR)
     add_test(e2e-${TEST_NAME} ${BASH_PROGRAM} ${CMAKE_SOURCE_DIR}/tests/test.sh ${RUNTIME_DIR} ${CMAKE_SOURCE_DIR}/tests/e2e/${TEST_NAME})
     set_property(TEST e2e-${TEST_NAME} PROPERTY ENVIRONMENT "WASMTIME=${WASMTIME};WASM_TOOLS=${WASM_TOOLS_DIR}/wasm-tools")
+    plug_test_imports(e2e-${TEST_NAME})
     set_tests_properties(e2e-${TEST_NAME} PROPERTIES TIMEOUT 120)
 endfunction()
 
@@ -16,6 +26,7 @@ function(test_integration TEST_NAME)
 
     add_test(integration-${TEST_NAME} ${BASH_PROGRAM} ${CMAKE_SOURCE_DIR}/tests/test.sh ${RUNTIME_DIR} ${CMAKE_SOURCE_DIR}/tests/integration/${TEST_NAME} test-server.wasm ${TEST_NAME})
     set_property(TEST integration-${TEST_NAME} PROPERTY ENVIRONMENT "WASMTIME=${WASMTIME};WASM_TOOLS=${WASM_TOOLS_DIR}/wasm-tools;")
+    plug_test_imports(integration-${TEST_NAME})
     set_tests_properties(integration-${TEST_NAME} PROPERTIES TIMEOUT 120)
 endfunction()
 
@@ -39,6 +50,9 @@ function(integration_tests)
     if(WEVAL)
         add_dependencies(integration-test-server starling-ics.wevalcache)
     endif()
+    if(ENABLE_CRYPTO_OFFLOAD)
+        add_dependencies(integration-test-server crypto-offload-shim)
+    endif()
 
     foreach(TEST_NAME ${ARGV})
         test_integration(${TEST_NAME})
@@ -57,6 +71,17 @@ test_e2e(tla)
 test_e2e(stream-forwarding)
 test_e2e(multi-stream-forwarding)
 test_e2e(teed-stream-as-outgoing-body)
+test_e2e(cloned-response-forwarding)
+test_e2e(compressed-stream-forwarding)
+test_e2e(byob-body-read)
+if (ENABLE_FETCH_FILE_SCHEME)
+    test_e2e(fetch-file)
+    set_property(TEST e2e-fetch-file APPEND PROPERTY ENVIRONMENT "SERVE_FLAGS=--dir ${CMAKE_SOURCE_DIR}/tests/e2e/fetch-file/public::/public")
+endif()
+test_e2e(blob-body)
+test_e2e(multipart-form-data)
+test_e2e(url-cache)
+test_e2e(url-pattern)
 test_e2e(init-script)
 test_e2e(no-init-location)
 test_e2e(init-location)
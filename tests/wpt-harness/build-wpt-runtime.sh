@@ -19,3 +19,13 @@ inputs=(
 
 cat "${inputs[@]}" > wpt-test-runner.js
 ./componentize.sh $componentize_flags --verbose --wpt-mode --legacy-script wpt-test-runner.js wpt-runtime.wasm
+
+# Plug in the components providing imports that wasmtime doesn't, e.g. the crypto-offload shim
+if [ -n "${PLUG_COMPONENTS:-}" ]; then
+  plug_args=""
+  for plug in $PLUG_COMPONENTS; do
+    plug_args="$plug_args --plug $plug"
+  done
+  "${WAC:-wac}" plug $plug_args -o wpt-runtime.plugged.wasm wpt-runtime.wasm
+  mv wpt-runtime.plugged.wasm wpt-runtime.wasm
+fi
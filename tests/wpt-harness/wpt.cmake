@@ -30,11 +30,19 @@ add_builtin(wpt_support
     SRC "${CMAKE_CURRENT_LIST_DIR}/wpt_builtins.cpp"
     INCLUDE_DIRS "${CMAKE_CURRENT_SOURCE_DIR}/builtins/web/")
 
+# Like the other tests, the WPT runtime gets the crypto-offload shim plugged in when offloading is enabled.
+set(WPT_RUNTIME_DEPS starling-raw.wasm componentize.sh tests/wpt-harness/build-wpt-runtime.sh tests/wpt-harness/pre-harness.js tests/wpt-harness/post-harness.js)
+set(WPT_RUNTIME_PLUG_ENV "")
+if(ENABLE_CRYPTO_OFFLOAD)
+    set(WPT_RUNTIME_PLUG_ENV "WAC=${WAC_BIN}" "PLUG_COMPONENTS=${CRYPTO_OFFLOAD_SHIM}")
+    list(APPEND WPT_RUNTIME_DEPS crypto-offload-shim)
+endif()
+
 add_custom_command(
         OUTPUT wpt-runtime.wasm
         WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
-        COMMAND ${CMAKE_COMMAND} -E env PATH=${WASM_TOOLS_DIR}:${WASMTIME_DIR}:$ENV{PATH} env "COMPONENTIZE_FLAGS=${COMPONENTIZE_FLAGS}" WPT_ROOT=${WPT_ROOT} ${CMAKE_CURRENT_SOURCE_DIR}/tests/wpt-harness/build-wpt-runtime.sh
-        DEPENDS starling-raw.wasm componentize.sh tests/wpt-harness/build-wpt-runtime.sh tests/wpt-harness/pre-harness.js tests/wpt-harness/post-harness.js
+        COMMAND ${CMAKE_COMMAND} -E env PATH=${WASM_TOOLS_DIR}:${WASMTIME_DIR}:$ENV{PATH} env "COMPONENTIZE_FLAGS=${COMPONENTIZE_FLAGS}" ${WPT_RUNTIME_PLUG_ENV} WPT_ROOT=${WPT_ROOT} ${CMAKE_CURRENT_SOURCE_DIR}/tests/wpt-harness/build-wpt-runtime.sh
+        DEPENDS ${WPT_RUNTIME_DEPS}
         VERBATIM
 )
 